@@ -3,10 +3,56 @@
 # found in the LICENSE file.
 
 import os
+import shutil
 import subprocess
+import tempfile
 import timeit
 
 
+_JS_READY_LINE = 'mojo_benchmark_startup_js: ready'
+
+
+def _time_js_app_launch(paths, code_cache_dir):
+  """Launches the JS startup app and returns the seconds until it is ready."""
+  app_url = 'file://' + os.path.join(paths.src_root, 'benchmarks', 'startup',
+                                     'startup.js')
+  command = [paths.mojo_shell_path, app_url]
+  if code_cache_dir:
+    command.append('--args-for=mojo:js_content_handler '
+                   '--js-code-cache-dir=%s' % code_cache_dir)
+  start = timeit.default_timer()
+  process = subprocess.Popen(command, stdout=subprocess.PIPE)
+  try:
+    for line in iter(process.stdout.readline, ''):
+      if _JS_READY_LINE in line:
+        return timeit.default_timer() - start
+    raise Exception('JS startup app exited before becoming ready')
+  finally:
+    process.kill()
+    process.wait()
+
+
+def _run_js(paths):
+  rounds = 20
+
+  no_cache_time = sum(_time_js_app_launch(paths, None)
+                      for _ in range(rounds))
+
+  code_cache_dir = tempfile.mkdtemp()
+  try:
+    # The first launch populates the code cache.
+    _time_js_app_launch(paths, code_cache_dir)
+    code_cache_time = sum(_time_js_app_launch(paths, code_cache_dir)
+                          for _ in range(rounds))
+  finally:
+    shutil.rmtree(code_cache_dir)
+
+  return ("Result: rounds tested: %d; average JS app launch time: %f ms "
+          "without code cache, %f ms with code cache" %
+          (rounds, no_cache_time * 1000 / rounds,
+           code_cache_time * 1000 / rounds))
+
+
 def run(args, paths):
   rounds = 1000
 
@@ -31,5 +77,5 @@ def run(args, paths):
   # Convert the execution time to milliseconds and compute the average for
   # a single run.
   result = (startup_time - noop_time) * 1000 / rounds
-  return ("Result: rounds tested: %d; average startup time: %f ms" %
-          (rounds, result))
+  return ("Result: rounds tested: %d; average startup time: %f ms\n%s" %
+          (rounds, result, _run_js(paths)))
@@ -0,0 +1,27 @@
+#!mojo:js_content_handler
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Loads the mojo JS bindings modules and reports that it is ready. run.py
+// measures the time from launching mojo_shell until the ready line appears.
+
+define("main", [
+  "console",
+  "mojo/public/js/connection",
+  "mojo/public/js/core",
+  "mojo/public/interfaces/application/service_provider.mojom",
+], function(console) {
+
+  function Application(shell, url) {
+  }
+
+  Application.prototype.initialize = function(args) {
+    console.log("mojo_benchmark_startup_js: ready");
+  };
+
+  Application.prototype.acceptConnection = function(url, serviceProvider) {
+  };
+
+  return Application;
+});
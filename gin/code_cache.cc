@@ -0,0 +1,68 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gin/code_cache.h"
+
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/logging.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
+#include "gin/converter.h"
+
+namespace gin {
+
+CodeCache::CodeCache(const base::FilePath& directory)
+    : directory_(directory) {
+  if (!base::CreateDirectory(directory_))
+    LOG(WARNING) << "Failed to create code cache at " << directory_.value();
+}
+
+CodeCache::~CodeCache() {
+}
+
+v8::Handle<v8::Script> CodeCache::Compile(v8::Isolate* isolate,
+                                          const std::string& source,
+                                          const std::string& resource_name) {
+  v8::ScriptOrigin origin(StringToV8(isolate, resource_name));
+  base::FilePath entry_path = GetEntryPath(source);
+
+  std::string cached_data;
+  if (base::ReadFileToString(entry_path, &cached_data) &&
+      !cached_data.empty()) {
+    v8::ScriptCompiler::Source script_source(
+        StringToV8(isolate, source), origin,
+        new v8::ScriptCompiler::CachedData(
+            reinterpret_cast<const uint8_t*>(cached_data.data()),
+            static_cast<int>(cached_data.size())));
+    v8::Handle<v8::Script> script = v8::ScriptCompiler::Compile(
+        isolate, &script_source, v8::ScriptCompiler::kConsumeCodeCache);
+    if (!script_source.GetCachedData()->rejected)
+      return script;
+    // The entry was produced by a different V8 build or flags. Fall through
+    // and replace it.
+  }
+
+  v8::ScriptCompiler::Source script_source(StringToV8(isolate, source),
+                                           origin);
+  v8::Handle<v8::Script> script = v8::ScriptCompiler::Compile(
+      isolate, &script_source, v8::ScriptCompiler::kProduceCodeCache);
+  const v8::ScriptCompiler::CachedData* produced =
+      script_source.GetCachedData();
+  if (!script.IsEmpty() && produced && produced->length > 0) {
+    base::ImportantFileWriter::WriteFileAtomically(
+        entry_path,
+        std::string(reinterpret_cast<const char*>(produced->data),
+                    produced->length));
+  }
+  return script;
+}
+
+base::FilePath CodeCache::GetEntryPath(const std::string& source) const {
+  std::string hash = base::SHA1HashString(source);
+  return directory_.AppendASCII(
+      base::HexEncode(hash.data(), hash.size()) + ".cache");
+}
+
+}  // namespace gin
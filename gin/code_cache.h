@@ -0,0 +1,46 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GIN_CODE_CACHE_H_
+#define GIN_CODE_CACHE_H_
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "gin/gin_export.h"
+#include "v8/include/v8.h"
+
+namespace gin {
+
+// CodeCache persists V8's compiled code for scripts in a directory on disk so
+// that later runs of the same script can skip parsing and compilation. Entries
+// are keyed by a hash of the script source, so edited scripts simply miss the
+// cache. CodeCache keeps no in-memory state and may be shared by runners on
+// different threads.
+class GIN_EXPORT CodeCache {
+ public:
+  explicit CodeCache(const base::FilePath& directory);
+  ~CodeCache();
+
+  // Compiles |source|, consuming a cached entry if one exists and producing
+  // one otherwise. Returns an empty handle if compilation throws; the caller
+  // is expected to have a v8::TryCatch on the stack.
+  v8::Handle<v8::Script> Compile(v8::Isolate* isolate,
+                                 const std::string& source,
+                                 const std::string& resource_name);
+
+  const base::FilePath& directory() const { return directory_; }
+
+ private:
+  base::FilePath GetEntryPath(const std::string& source) const;
+
+  base::FilePath directory_;
+
+  DISALLOW_COPY_AND_ASSIGN(CodeCache);
+};
+
+}  // namespace gin
+
+#endif  // GIN_CODE_CACHE_H_
@@ -0,0 +1,94 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gin/code_cache.h"
+
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "gin/converter.h"
+#include "gin/public/isolate_holder.h"
+#include "gin/test/v8_test.h"
+#include "v8/include/v8.h"
+
+namespace gin {
+
+namespace {
+
+int CountEntries(const base::FilePath& directory) {
+  base::FileEnumerator enumerator(directory, false,
+                                  base::FileEnumerator::FILES);
+  int count = 0;
+  while (!enumerator.Next().empty())
+    ++count;
+  return count;
+}
+
+}  // namespace
+
+typedef V8Test CodeCacheTest;
+
+// Verifies that compiling a script stores an entry and that a later compile
+// of the same source, served from that entry, still runs correctly.
+TEST_F(CodeCacheTest, ProduceAndConsume) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  CodeCache code_cache(temp_dir.path());
+
+  v8::Isolate* isolate = instance_->isolate();
+  v8::HandleScope handle_scope(isolate);
+
+  const std::string source =
+      "function square(x) { return x * x; }\n"
+      "square(7);\n";
+  for (int i = 0; i < 2; ++i) {
+    v8::TryCatch try_catch;
+    v8::Handle<v8::Script> script =
+        code_cache.Compile(isolate, source, "square.js");
+    ASSERT_FALSE(script.IsEmpty());
+    int result = 0;
+    EXPECT_TRUE(ConvertFromV8(isolate, script->Run(), &result));
+    EXPECT_EQ(49, result);
+    EXPECT_FALSE(try_catch.HasCaught());
+    EXPECT_EQ(1, CountEntries(temp_dir.path()));
+  }
+
+  v8::TryCatch try_catch;
+  code_cache.Compile(isolate, "1 + 1;", "other.js");
+  EXPECT_EQ(2, CountEntries(temp_dir.path()));
+}
+
+// Verifies that an unusable entry is replaced rather than trusted.
+TEST_F(CodeCacheTest, CorruptEntryIsIgnored) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  CodeCache code_cache(temp_dir.path());
+
+  v8::Isolate* isolate = instance_->isolate();
+  v8::HandleScope handle_scope(isolate);
+
+  const std::string source = "6 * 7;";
+  {
+    v8::TryCatch try_catch;
+    code_cache.Compile(isolate, source, "answer.js");
+  }
+  ASSERT_EQ(1, CountEntries(temp_dir.path()));
+
+  base::FileEnumerator enumerator(temp_dir.path(), false,
+                                  base::FileEnumerator::FILES);
+  base::FilePath entry = enumerator.Next();
+  const char kGarbage[] = "not a code cache";
+  ASSERT_EQ(static_cast<int>(sizeof(kGarbage)),
+            base::WriteFile(entry, kGarbage, sizeof(kGarbage)));
+
+  v8::TryCatch try_catch;
+  v8::Handle<v8::Script> script =
+      code_cache.Compile(isolate, source, "answer.js");
+  ASSERT_FALSE(script.IsEmpty());
+  int result = 0;
+  EXPECT_TRUE(ConvertFromV8(isolate, script->Run(), &result));
+  EXPECT_EQ(42, result);
+}
+
+}  // namespace gin
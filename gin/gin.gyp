@@ -28,6 +28,8 @@
         'arguments.h',
         'array_buffer.cc',
         'array_buffer.h',
+        'code_cache.cc',
+        'code_cache.h',
         'context_holder.cc',
         'converter.cc',
         'converter.h',
@@ -131,6 +133,7 @@
         'gin_test',
       ],
       'sources': [
+        'code_cache_unittest.cc',
         'converter_unittest.cc',
         'interceptor_unittest.cc',
         'modules/module_registry_unittest.cc',
@@ -9,6 +9,7 @@
 
 namespace gin {
 
+class CodeCache;
 class ContextHolder;
 class ShellRunner;
 class TryCatch;
@@ -51,12 +52,17 @@ class GIN_EXPORT ShellRunner : public Runner {
                              v8::Handle<v8::Value> argv[]) override;
   ContextHolder* GetContextHolder() override;
 
+  // If set, scripts passed to Run() are compiled through |code_cache|, which
+  // must outlive this runner.
+  void set_code_cache(CodeCache* code_cache) { code_cache_ = code_cache; }
+
  private:
   friend class Scope;
 
   void Run(v8::Handle<v8::Script> script);
 
   ShellRunnerDelegate* delegate_;
+  CodeCache* code_cache_;
 
   scoped_ptr<ContextHolder> context_holder_;
 
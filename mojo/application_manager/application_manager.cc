@@ -6,6 +6,8 @@
 
 #include <stdio.h>
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
@@ -26,6 +28,11 @@ namespace {
 // Used by TestAPI.
 bool has_created_instance = false;
 
+bool CompareStatsByURL(const ApplicationManager::ApplicationStats& a,
+                       const ApplicationManager::ApplicationStats& b) {
+  return a.url < b.url;
+}
+
 class StubServiceProvider : public InterfaceImpl<ServiceProvider> {
  public:
   ServiceProvider* GetRemoteServiceProvider() { return client(); }
@@ -72,6 +79,7 @@ class ApplicationManager::ShellImpl : public Shell, public ErrorHandler {
 
   void ConnectToClient(const GURL& requestor_url,
                        ServiceProviderPtr service_provider) {
+    ++stats_.incoming_connections;
     client()->AcceptConnection(String::From(requestor_url),
                                service_provider.Pass());
   }
@@ -79,6 +87,7 @@ class ApplicationManager::ShellImpl : public Shell, public ErrorHandler {
   Application* client() { return binding_.client(); }
   const GURL& url() const { return url_; }
   const GURL& requested_url() const { return requested_url_; }
+  const ApplicationStats& stats() const { return stats_; }
 
  private:
   ShellImpl(ApplicationManager* manager,
@@ -89,12 +98,15 @@ class ApplicationManager::ShellImpl : public Shell, public ErrorHandler {
         url_(url),
         binding_(this) {
     binding_.set_error_handler(this);
+    stats_.url = url;
+    stats_.start_time = base::TimeTicks::Now();
   }
 
   // Shell implementation:
   void ConnectToApplication(
       const String& app_url,
       InterfaceRequest<ServiceProvider> in_service_provider) override {
+    ++stats_.outgoing_connections;
     ServiceProviderPtr out_service_provider;
     out_service_provider.Bind(in_service_provider.PassMessagePipe());
     GURL app_gurl(app_url);
@@ -112,6 +124,7 @@ class ApplicationManager::ShellImpl : public Shell, public ErrorHandler {
   const GURL requested_url_;
   const GURL url_;
   Binding<Shell> binding_;
+  ApplicationStats stats_;
 
   DISALLOW_COPY_AND_ASSIGN(ShellImpl);
 };
@@ -145,6 +158,13 @@ class ApplicationManager::ContentHandlerConnection : public ErrorHandler {
   DISALLOW_COPY_AND_ASSIGN(ContentHandlerConnection);
 };
 
+ApplicationManager::ApplicationStats::ApplicationStats()
+    : incoming_connections(0), outgoing_connections(0) {
+}
+
+ApplicationManager::ApplicationStats::~ApplicationStats() {
+}
+
 // static
 ApplicationManager::TestAPI::TestAPI(ApplicationManager* manager)
     : manager_(manager) {
@@ -179,6 +199,16 @@ void ApplicationManager::TerminateShellConnections() {
   STLDeleteValues(&url_to_shell_impl_);
 }
 
+std::vector<ApplicationManager::ApplicationStats>
+ApplicationManager::GetApplicationStats() const {
+  std::vector<ApplicationStats> stats;
+  stats.reserve(url_to_shell_impl_.size());
+  for (const auto& entry : url_to_shell_impl_)
+    stats.push_back(entry.second->stats());
+  std::sort(stats.begin(), stats.end(), &CompareStatsByURL);
+  return stats;
+}
+
 void ApplicationManager::ConnectToApplication(
     const GURL& requested_url,
     const GURL& requestor_url,
@@ -7,11 +7,14 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 #include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "mojo/application_manager/application_loader.h"
 #include "mojo/application_manager/application_manager_export.h"
 #include "mojo/public/interfaces/application/service_provider.mojom.h"
@@ -57,6 +60,21 @@ class MOJO_APPLICATION_MANAGER_EXPORT ApplicationManager {
         ServiceProviderPtr service_provider) = 0;
   };
 
+  // The start time and connection counts of one running application, as
+  // observed by the ApplicationManager. Resource usage (memory, CPU, handles)
+  // is not tracked here.
+  struct MOJO_APPLICATION_MANAGER_EXPORT ApplicationStats {
+    ApplicationStats();
+    ~ApplicationStats();
+
+    GURL url;
+    base::TimeTicks start_time;
+    // Connections other applications (or the embedder) made to this one.
+    uint64 incoming_connections;
+    // Connections this application requested through its Shell.
+    uint64 outgoing_connections;
+  };
+
   ApplicationManager(Delegate* delegate);
   ~ApplicationManager();
 
@@ -97,6 +115,10 @@ class MOJO_APPLICATION_MANAGER_EXPORT ApplicationManager {
   // Allows to interpose a debugger to service connections.
   void SetInterceptor(Interceptor* interceptor);
 
+  // Returns the start time and connection counts of every application
+  // currently running, sorted by URL.
+  std::vector<ApplicationStats> GetApplicationStats() const;
+
   // Destroys all Shell-ends of connections established with Applications.
   // Applications connected by this ApplicationManager will observe pipe errors
   // and have a chance to shutdown.
@@ -112,10 +134,11 @@ class MOJO_APPLICATION_MANAGER_EXPORT ApplicationManager {
   class ShellImpl;
 
   typedef std::map<std::string, ApplicationLoader*> SchemeToLoaderMap;
-  typedef std::map<GURL, ApplicationLoader*> URLToLoaderMap;
-  typedef std::map<GURL, ShellImpl*> URLToShellImplMap;
-  typedef std::map<GURL, ContentHandlerConnection*> URLToContentHandlerMap;
-  typedef std::map<GURL, std::vector<std::string> > URLToArgsMap;
+  typedef base::hash_map<GURL, ApplicationLoader*> URLToLoaderMap;
+  typedef base::hash_map<GURL, ShellImpl*> URLToShellImplMap;
+  typedef base::hash_map<GURL, ContentHandlerConnection*>
+      URLToContentHandlerMap;
+  typedef base::hash_map<GURL, std::vector<std::string> > URLToArgsMap;
 
   void ConnectToApplicationImpl(const GURL& url,
                                 const GURL& original_url,
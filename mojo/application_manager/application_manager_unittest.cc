@@ -614,6 +614,35 @@ TEST_F(ApplicationManagerTest, ACallB) {
   EXPECT_TRUE(tester_context_.a_called_quit());
 }
 
+// Confirm that connections to and from each application are accounted for.
+TEST_F(ApplicationManagerTest, ApplicationStats) {
+  AddLoaderForURL(GURL(kTestAURLString), std::string());
+  AddLoaderForURL(GURL(kTestBURLString), kTestAURLString);
+
+  TestAPtr a;
+  application_manager_->ConnectToService(GURL(kTestAURLString), &a);
+  a->CallB();
+  loop_.Run();
+
+  std::vector<ApplicationManager::ApplicationStats> stats =
+      application_manager_->GetApplicationStats();
+  const ApplicationManager::ApplicationStats* a_stats = nullptr;
+  const ApplicationManager::ApplicationStats* b_stats = nullptr;
+  for (const auto& entry : stats) {
+    EXPECT_FALSE(entry.start_time.is_null());
+    if (entry.url == GURL(kTestAURLString))
+      a_stats = &entry;
+    else if (entry.url == GURL(kTestBURLString))
+      b_stats = &entry;
+  }
+  ASSERT_TRUE(a_stats);
+  ASSERT_TRUE(b_stats);
+  EXPECT_EQ(1u, a_stats->incoming_connections);
+  EXPECT_EQ(1u, a_stats->outgoing_connections);
+  EXPECT_EQ(1u, b_stats->incoming_connections);
+  EXPECT_EQ(0u, b_stats->outgoing_connections);
+}
+
 // A calls B which calls C.
 TEST_F(ApplicationManagerTest, BCallC) {
   // Any url can load a.
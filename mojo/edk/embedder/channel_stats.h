@@ -0,0 +1,33 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MOJO_EDK_EMBEDDER_CHANNEL_STATS_H_
+#define MOJO_EDK_EMBEDDER_CHANNEL_STATS_H_
+
+#include <stdint.h>
+
+namespace mojo {
+namespace embedder {
+
+// The traffic a channel has carried since it was created. Messages are counted
+// as they are handed to and received from the OS "pipe", so the byte counts
+// include message headers, serialized handles and the channel's own control
+// messages.
+struct ChannelStats {
+  ChannelStats()
+      : messages_written(0),
+        bytes_written(0),
+        messages_read(0),
+        bytes_read(0) {}
+
+  uint64_t messages_written;
+  uint64_t bytes_written;
+  uint64_t messages_read;
+  uint64_t bytes_read;
+};
+
+}  // namespace embedder
+}  // namespace mojo
+
+#endif  // MOJO_EDK_EMBEDDER_CHANNEL_STATS_H_
@@ -168,6 +168,19 @@ void WillDestroyChannelSoon(ChannelInfo* channel_info) {
   internal::g_channel_manager->WillShutdownChannel(channel_info->channel_id);
 }
 
+void GetChannelStats(ChannelInfo* channel_info, ChannelStats* stats) {
+  DCHECK(channel_info);
+  DCHECK(stats);
+  *stats = ChannelStats();
+  if (!channel_info->channel_id) {
+    // Presumably, |Init()| on the channel failed.
+    return;
+  }
+
+  DCHECK(internal::g_channel_manager);
+  internal::g_channel_manager->GetChannelStats(channel_info->channel_id, stats);
+}
+
 MojoResult CreatePlatformHandleWrapper(
     ScopedPlatformHandle platform_handle,
     MojoHandle* platform_handle_wrapper_handle) {
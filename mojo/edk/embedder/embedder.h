@@ -10,6 +10,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/task_runner.h"
 #include "mojo/edk/embedder/channel_info_forward.h"
+#include "mojo/edk/embedder/channel_stats.h"
 #include "mojo/edk/embedder/scoped_platform_handle.h"
 #include "mojo/edk/system/system_impl_export.h"
 #include "mojo/public/cpp/system/message_pipe.h"
@@ -102,6 +103,12 @@ MOJO_SYSTEM_IMPL_EXPORT void DestroyChannel(ChannelInfo* channel_info);
 // called before |DestroyChannel()|.
 MOJO_SYSTEM_IMPL_EXPORT void WillDestroyChannelSoon(ChannelInfo* channel_info);
 
+// Gets the traffic the channel has carried so far; may be called from any
+// thread, but not after |DestroyChannel()|. If the channel failed to
+// initialize, |*stats| is left zeroed.
+MOJO_SYSTEM_IMPL_EXPORT void GetChannelStats(ChannelInfo* channel_info,
+                                             ChannelStats* stats);
+
 // Creates a |MojoHandle| that wraps the given |PlatformHandle| (taking
 // ownership of it). This |MojoHandle| can then, e.g., be passed through message
 // pipes. Note: This takes ownership (and thus closes) |platform_handle| even on
@@ -61,6 +61,13 @@ class ScopedTestChannel {
   // that it's not null.
   const ChannelInfo* channel_info() const { return channel_info_; }
 
+  // Call only after |WaitForChannelCreationCompletion()|.
+  ChannelStats GetStats() {
+    ChannelStats stats;
+    GetChannelStats(channel_info_, &stats);
+    return stats;
+  }
+
  private:
   void DidCreateChannel(ChannelInfo* channel_info) {
     CHECK(channel_info);
@@ -149,6 +156,63 @@ TEST_F(EmbedderTest, ChannelsBasic) {
   EXPECT_TRUE(test::Shutdown());
 }
 
+TEST_F(EmbedderTest, ChannelStats) {
+  mojo::embedder::test::InitWithSimplePlatformSupport();
+
+  {
+    PlatformChannelPair channel_pair;
+    ScopedTestChannel server_channel(test_io_thread()->task_runner(),
+                                     channel_pair.PassServerHandle());
+    MojoHandle server_mp = server_channel.bootstrap_message_pipe();
+    ScopedTestChannel client_channel(test_io_thread()->task_runner(),
+                                     channel_pair.PassClientHandle());
+    MojoHandle client_mp = client_channel.bootstrap_message_pipe();
+    server_channel.WaitForChannelCreationCompletion();
+    client_channel.WaitForChannelCreationCompletion();
+
+    // Nothing has been sent on the bootstrap message pipes yet.
+    ChannelStats server_stats = server_channel.GetStats();
+    EXPECT_EQ(0u, server_stats.messages_written);
+    EXPECT_EQ(0u, server_stats.bytes_written);
+    EXPECT_EQ(0u, server_stats.messages_read);
+    EXPECT_EQ(0u, server_stats.bytes_read);
+
+    const char kHello[] = "hello";
+    for (int i = 0; i < 2; i++) {
+      EXPECT_EQ(MOJO_RESULT_OK,
+                MojoWriteMessage(server_mp, kHello,
+                                 static_cast<uint32_t>(sizeof(kHello)),
+                                 nullptr, 0, MOJO_WRITE_MESSAGE_FLAG_NONE));
+      EXPECT_EQ(MOJO_RESULT_OK,
+                MojoWait(client_mp, MOJO_HANDLE_SIGNAL_READABLE,
+                         MOJO_DEADLINE_INDEFINITE));
+      char buffer[1000] = {};
+      uint32_t num_bytes = static_cast<uint32_t>(sizeof(buffer));
+      EXPECT_EQ(MOJO_RESULT_OK,
+                MojoReadMessage(client_mp, buffer, &num_bytes, nullptr,
+                                nullptr, MOJO_READ_MESSAGE_FLAG_NONE));
+    }
+
+    // Each message is counted with its header, on both sides.
+    server_stats = server_channel.GetStats();
+    EXPECT_EQ(2u, server_stats.messages_written);
+    EXPECT_LT(2 * sizeof(kHello), server_stats.bytes_written);
+    EXPECT_EQ(0u, server_stats.messages_read);
+    EXPECT_EQ(0u, server_stats.bytes_read);
+
+    ChannelStats client_stats = client_channel.GetStats();
+    EXPECT_EQ(0u, client_stats.messages_written);
+    EXPECT_EQ(0u, client_stats.bytes_written);
+    EXPECT_EQ(2u, client_stats.messages_read);
+    EXPECT_EQ(server_stats.bytes_written, client_stats.bytes_read);
+
+    EXPECT_EQ(MOJO_RESULT_OK, MojoClose(server_mp));
+    EXPECT_EQ(MOJO_RESULT_OK, MojoClose(client_mp));
+  }
+
+  EXPECT_TRUE(test::Shutdown());
+}
+
 TEST_F(EmbedderTest, ChannelsHandlePassing) {
   mojo::embedder::test::InitWithSimplePlatformSupport();
 
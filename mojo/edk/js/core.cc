@@ -4,6 +4,8 @@
 
 #include "mojo/edk/js/core.h"
 
+#include <string.h>
+
 #include "base/bind.h"
 #include "base/logging.h"
 #include "gin/arguments.h"
@@ -24,6 +26,12 @@ namespace js {
 
 namespace {
 
+// Messages up to this size (with up to this many handles) are read with a
+// single MojoReadMessage call into a stack buffer, avoiding the extra call
+// needed to size the ArrayBuffer up front.
+const uint32_t kInlineMessageNumBytes = 4096;
+const uint32_t kInlineMessageNumHandles = 16;
+
 MojoResult CloseHandle(gin::Handle<HandleWrapper> handle) {
   if (!handle->get().is_valid())
     return MOJO_RESULT_INVALID_ARGUMENT;
@@ -109,8 +117,39 @@ gin::Dictionary ReadMessage(const gin::Arguments& args,
                             MojoReadMessageFlags flags) {
   uint32_t num_bytes = 0;
   uint32_t num_handles = 0;
-  MojoResult result = MojoReadMessage(
-      handle.value(), NULL, &num_bytes, NULL, &num_handles, flags);
+  MojoResult result;
+  if (flags & MOJO_READ_MESSAGE_FLAG_MAY_DISCARD) {
+    result = MojoReadMessage(
+        handle.value(), NULL, &num_bytes, NULL, &num_handles, flags);
+  } else {
+    char inline_bytes[kInlineMessageNumBytes];
+    MojoHandle inline_handles[kInlineMessageNumHandles];
+    num_bytes = kInlineMessageNumBytes;
+    num_handles = kInlineMessageNumHandles;
+    result = MojoReadMessage(handle.value(), inline_bytes, &num_bytes,
+                             inline_handles, &num_handles, flags);
+    if (result == MOJO_RESULT_OK) {
+      v8::Handle<v8::ArrayBuffer> array_buffer =
+          v8::ArrayBuffer::New(args.isolate(), num_bytes);
+      gin::ArrayBuffer buffer;
+      ConvertFromV8(args.isolate(), array_buffer, &buffer);
+      CHECK(buffer.num_bytes() == num_bytes);
+      if (num_bytes)
+        memcpy(buffer.bytes(), inline_bytes, num_bytes);
+      std::vector<mojo::Handle> handles(num_handles);
+      for (uint32_t i = 0; i < num_handles; ++i)
+        handles[i] = mojo::Handle(inline_handles[i]);
+
+      gin::Dictionary dictionary =
+          gin::Dictionary::CreateEmpty(args.isolate());
+      dictionary.Set("result", result);
+      dictionary.Set("buffer", array_buffer);
+      dictionary.Set("handles", handles);
+      return dictionary;
+    }
+    // On MOJO_RESULT_RESOURCE_EXHAUSTED, |num_bytes| and |num_handles| now
+    // hold the size of the message.
+  }
   if (result != MOJO_RESULT_RESOURCE_EXHAUSTED) {
     gin::Dictionary dictionary = gin::Dictionary::CreateEmpty(args.isolate());
     dictionary.Set("result", result);
@@ -198,6 +237,33 @@ gin::Dictionary WriteData(const gin::Arguments& args,
 gin::Dictionary ReadData(const gin::Arguments& args,
                          mojo::Handle handle,
                          MojoReadDataFlags flags) {
+  if (flags == MOJO_READ_DATA_FLAG_NONE) {
+    // Copy straight out of the pipe's buffer with a two-phase read. This may
+    // return less than is available if the pipe's data wraps around, which
+    // MojoReadData also permits.
+    const void* pipe_buffer = NULL;
+    uint32_t num_bytes = 0;
+    MojoResult result = MojoBeginReadData(handle.value(), &pipe_buffer,
+                                          &num_bytes, flags);
+    if (result == MOJO_RESULT_OK) {
+      v8::Handle<v8::ArrayBuffer> array_buffer =
+          v8::ArrayBuffer::New(args.isolate(), num_bytes);
+      gin::ArrayBuffer buffer;
+      ConvertFromV8(args.isolate(), array_buffer, &buffer);
+      CHECK_EQ(num_bytes, buffer.num_bytes());
+      if (num_bytes)
+        memcpy(buffer.bytes(), pipe_buffer, num_bytes);
+      result = MojoEndReadData(handle.value(), num_bytes);
+
+      gin::Dictionary dictionary = gin::Dictionary::CreateEmpty(args.isolate());
+      dictionary.Set("result", result);
+      dictionary.Set("buffer", array_buffer);
+      return dictionary;
+    }
+    // Fall through so that an empty pipe and errors are reported exactly as
+    // MojoReadData reports them.
+  }
+
   uint32_t num_bytes = 0;
   MojoResult result = MojoReadData(
       handle.value(), NULL, &num_bytes, MOJO_READ_DATA_FLAG_QUERY);
@@ -154,6 +154,8 @@ bool Channel::WriteMessage(scoped_ptr<MessageInTransit> message) {
   }
 
   DLOG_IF(WARNING, is_shutting_down_) << "WriteMessage() while shutting down";
+  stats_.messages_written++;
+  stats_.bytes_written += message->total_size();
   return raw_channel_->WriteMessage(message.Pass());
 }
 
@@ -226,6 +228,13 @@ size_t Channel::GetSerializedPlatformHandleSize() const {
   return raw_channel_->GetSerializedPlatformHandleSize();
 }
 
+void Channel::GetStats(embedder::ChannelStats* stats) {
+  DCHECK(stats);
+
+  base::AutoLock locker(lock_);
+  *stats = stats_;
+}
+
 Channel::~Channel() {
   // The channel should have been shut down first.
   DCHECK(!is_running_);
@@ -236,6 +245,12 @@ void Channel::OnReadMessage(
     embedder::ScopedPlatformHandleVectorPtr platform_handles) {
   DCHECK(creation_thread_checker_.CalledOnValidThread());
 
+  {
+    base::AutoLock locker(lock_);
+    stats_.messages_read++;
+    stats_.bytes_read += message_view.total_size();
+  }
+
   switch (message_view.type()) {
     case MessageInTransit::kTypeMessagePipeEndpoint:
     case MessageInTransit::kTypeMessagePipe:
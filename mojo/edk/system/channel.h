@@ -14,6 +14,7 @@
 #include "base/strings/string_piece.h"
 #include "base/synchronization/lock.h"
 #include "base/threading/thread_checker.h"
+#include "mojo/edk/embedder/channel_stats.h"
 #include "mojo/edk/embedder/scoped_platform_handle.h"
 #include "mojo/edk/system/channel_endpoint.h"
 #include "mojo/edk/system/channel_endpoint_id.h"
@@ -124,6 +125,10 @@ class MOJO_SYSTEM_IMPL_EXPORT Channel
   // See |RawChannel::GetSerializedPlatformHandleSize()|.
   size_t GetSerializedPlatformHandleSize() const;
 
+  // Gets the traffic this channel has carried so far. (This remains valid after
+  // |Shutdown()|.)
+  void GetStats(embedder::ChannelStats* stats);
+
   embedder::PlatformSupport* platform_support() const {
     return platform_support_;
   }
@@ -210,6 +215,9 @@ class MOJO_SYSTEM_IMPL_EXPORT Channel
   // if/when we wrap).
   RemoteChannelEndpointIdGenerator remote_id_generator_;
 
+  // Messages written by |WriteMessage()| and read by |OnReadMessage()|.
+  embedder::ChannelStats stats_;
+
   DISALLOW_COPY_AND_ASSIGN(Channel);
 };
 
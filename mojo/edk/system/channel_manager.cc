@@ -67,6 +67,11 @@ void ChannelManager::ShutdownChannel(ChannelId channel_id) {
   ShutdownChannelHelper(channel_info);
 }
 
+void ChannelManager::GetChannelStats(ChannelId channel_id,
+                                     embedder::ChannelStats* stats) {
+  GetChannelInfo(channel_id).channel->GetStats(stats);
+}
+
 ChannelInfo ChannelManager::GetChannelInfo(ChannelId channel_id) {
   base::AutoLock locker(lock_);
   auto it = channel_infos_.find(channel_id);
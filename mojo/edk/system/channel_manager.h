@@ -12,6 +12,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/lock.h"
 #include "base/task_runner.h"
+#include "mojo/edk/embedder/channel_stats.h"
 #include "mojo/edk/system/channel.h"
 #include "mojo/edk/system/channel_info.h"
 
@@ -55,6 +56,10 @@ class MOJO_SYSTEM_IMPL_EXPORT ChannelManager {
   // this will complete synchronously.
   void ShutdownChannel(ChannelId channel_id);
 
+  // Gets the traffic the channel specified by the given ID has carried. This
+  // must not be called after |ShutdownChannel()|.
+  void GetChannelStats(ChannelId channel_id, embedder::ChannelStats* stats);
+
  private:
   // Gets the ID for a given channel.
   //
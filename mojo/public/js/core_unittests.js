@@ -11,10 +11,12 @@ define([
   runWithMessagePipe(testReadAndWriteMessage);
   runWithMessagePipeWithOptions(testNop);
   runWithMessagePipeWithOptions(testReadAndWriteMessage);
+  runWithMessagePipe(testReadAndWriteLargeMessage);
   runWithDataPipe(testNop);
   runWithDataPipe(testReadAndWriteDataPipe);
   runWithDataPipeWithOptions(testNop);
   runWithDataPipeWithOptions(testReadAndWriteDataPipe);
+  runWithDataPipe(testReadDataNoFlags);
   gc.collectGarbage();  // should not crash
   this.result = "PASS";
 
@@ -91,6 +93,30 @@ define([
       expect(memory[i]).toBe((i * i) & 0xFF);
   }
 
+  function testReadAndWriteLargeMessage(pipe) {
+    var senderData = new Uint8Array(10000);
+    for (var i = 0; i < senderData.length; ++i) {
+      senderData[i] = i * i;
+    }
+
+    var result = core.writeMessage(
+      pipe.handle0, senderData, [],
+      core.WRITE_MESSAGE_FLAG_NONE);
+
+    expect(result).toBe(core.RESULT_OK);
+
+    var read = core.readMessage(
+      pipe.handle1, core.READ_MESSAGE_FLAG_NONE);
+
+    expect(read.result).toBe(core.RESULT_OK);
+    expect(read.buffer.byteLength).toBe(10000);
+    expect(read.handles.length).toBe(0);
+
+    var memory = new Uint8Array(read.buffer);
+    for (var i = 0; i < memory.length; ++i)
+      expect(memory[i]).toBe((i * i) & 0xFF);
+  }
+
   function testReadAndWriteDataPipe(pipe) {
     var senderData = new Uint8Array(42);
     for (var i = 0; i < senderData.length; ++i) {
@@ -125,4 +151,28 @@ define([
       expect(memory[i]).toBe((i * i) & 0xFF);
   }
 
+  function testReadDataNoFlags(pipe) {
+    var empty = core.readData(pipe.consumerHandle, core.READ_DATA_FLAG_NONE);
+    expect(empty.result).toBe(core.RESULT_OK);
+    expect(empty.buffer.byteLength).toBe(0);
+
+    var senderData = new Uint8Array(42);
+    for (var i = 0; i < senderData.length; ++i) {
+      senderData[i] = i * i;
+    }
+
+    var write = core.writeData(
+      pipe.producerHandle, senderData,
+      core.WRITE_DATA_FLAG_ALL_OR_NONE);
+    expect(write.result).toBe(core.RESULT_OK);
+
+    var read = core.readData(pipe.consumerHandle, core.READ_DATA_FLAG_NONE);
+    expect(read.result).toBe(core.RESULT_OK);
+    expect(read.buffer.byteLength).toBe(42);
+
+    var memory = new Uint8Array(read.buffer);
+    for (var i = 0; i < memory.length; ++i)
+      expect(memory[i]).toBe((i * i) & 0xFF);
+  }
+
 });
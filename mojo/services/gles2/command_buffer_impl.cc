@@ -6,6 +6,7 @@
 
 #include "base/bind.h"
 #include "base/message_loop/message_loop.h"
+#include "base/synchronization/lock.h"
 #include "gpu/command_buffer/service/sync_point_manager.h"
 #include "mojo/services/gles2/command_buffer_driver.h"
 
@@ -20,6 +21,49 @@ void RunCallback(const Callback<void()>& callback) {
 }
 }
 
+// Holds the put offset of a flush posted to the driver thread. Heavy clients
+// flush many times per frame; while a flush is still queued on the driver
+// thread, later flushes only advance its put offset instead of posting more
+// tasks.
+class CommandBufferImpl::PendingFlush
+    : public base::RefCountedThreadSafe<PendingFlush> {
+ public:
+  explicit PendingFlush(int32_t put_offset)
+      : put_offset_(put_offset), has_run_(false) {}
+
+  // Called on the control thread. Returns false if the flush already ran, in
+  // which case a new one needs to be posted.
+  bool Update(int32_t put_offset) {
+    base::AutoLock lock(lock_);
+    if (has_run_)
+      return false;
+    put_offset_ = put_offset;
+    return true;
+  }
+
+  // Called on the driver thread.
+  static void Run(CommandBufferDriver* driver,
+                  scoped_refptr<PendingFlush> flush) {
+    int32_t put_offset;
+    {
+      base::AutoLock lock(flush->lock_);
+      flush->has_run_ = true;
+      put_offset = flush->put_offset_;
+    }
+    driver->Flush(put_offset);
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<PendingFlush>;
+  ~PendingFlush() {}
+
+  base::Lock lock_;
+  int32_t put_offset_;
+  bool has_run_;
+
+  DISALLOW_COPY_AND_ASSIGN(PendingFlush);
+};
+
 CommandBufferImpl::CommandBufferImpl(
     InterfaceRequest<CommandBuffer> request,
     scoped_refptr<base::SingleThreadTaskRunner> control_task_runner,
@@ -50,6 +94,7 @@ void CommandBufferImpl::Initialize(
     CommandBufferSyncPointClientPtr sync_point_client,
     ScopedSharedBufferHandle shared_state) {
   sync_point_client_ = sync_point_client.Pass();
+  ClearPendingFlush();
   driver_task_runner_->PostTask(
       FROM_HERE,
       base::Bind(&CommandBufferDriver::Initialize,
@@ -58,18 +103,23 @@ void CommandBufferImpl::Initialize(
 }
 
 void CommandBufferImpl::SetGetBuffer(int32_t buffer) {
+  ClearPendingFlush();
   driver_task_runner_->PostTask(
       FROM_HERE, base::Bind(&CommandBufferDriver::SetGetBuffer,
                             base::Unretained(driver_.get()), buffer));
 }
 
 void CommandBufferImpl::Flush(int32_t put_offset) {
+  if (pending_flush_ && pending_flush_->Update(put_offset))
+    return;
+  pending_flush_ = new PendingFlush(put_offset);
   driver_task_runner_->PostTask(
-      FROM_HERE, base::Bind(&CommandBufferDriver::Flush,
-                            base::Unretained(driver_.get()), put_offset));
+      FROM_HERE, base::Bind(&PendingFlush::Run, base::Unretained(driver_.get()),
+                            pending_flush_));
 }
 
 void CommandBufferImpl::MakeProgress(int32_t last_get_offset) {
+  ClearPendingFlush();
   driver_task_runner_->PostTask(
       FROM_HERE, base::Bind(&CommandBufferDriver::MakeProgress,
                             base::Unretained(driver_.get()), last_get_offset));
@@ -79,6 +129,7 @@ void CommandBufferImpl::RegisterTransferBuffer(
     int32_t id,
     ScopedSharedBufferHandle transfer_buffer,
     uint32_t size) {
+  ClearPendingFlush();
   driver_task_runner_->PostTask(
       FROM_HERE, base::Bind(&CommandBufferDriver::RegisterTransferBuffer,
                             base::Unretained(driver_.get()), id,
@@ -86,6 +137,7 @@ void CommandBufferImpl::RegisterTransferBuffer(
 }
 
 void CommandBufferImpl::DestroyTransferBuffer(int32_t id) {
+  ClearPendingFlush();
   driver_task_runner_->PostTask(
       FROM_HERE, base::Bind(&CommandBufferDriver::DestroyTransferBuffer,
                             base::Unretained(driver_.get()), id));
@@ -95,6 +147,7 @@ void CommandBufferImpl::InsertSyncPoint(bool retire) {
   uint32_t sync_point = sync_point_manager_->GenerateSyncPoint();
   sync_point_client_->DidInsertSyncPoint(sync_point);
   if (retire) {
+    ClearPendingFlush();
     driver_task_runner_->PostTask(
         FROM_HERE, base::Bind(&gpu::SyncPointManager::RetireSyncPoint,
                               sync_point_manager_, sync_point));
@@ -102,16 +155,22 @@ void CommandBufferImpl::InsertSyncPoint(bool retire) {
 }
 
 void CommandBufferImpl::RetireSyncPoint(uint32_t sync_point) {
+  ClearPendingFlush();
   driver_task_runner_->PostTask(
       FROM_HERE, base::Bind(&gpu::SyncPointManager::RetireSyncPoint,
                             sync_point_manager_, sync_point));
 }
 
 void CommandBufferImpl::Echo(const Callback<void()>& callback) {
+  ClearPendingFlush();
   driver_task_runner_->PostTaskAndReply(FROM_HERE, base::Bind(&base::DoNothing),
                                         base::Bind(&RunCallback, callback));
 }
 
+void CommandBufferImpl::ClearPendingFlush() {
+  pending_flush_ = nullptr;
+}
+
 void CommandBufferImpl::BindToRequest(InterfaceRequest<CommandBuffer> request) {
   binding_.Bind(request.Pass());
 }
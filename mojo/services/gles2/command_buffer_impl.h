@@ -46,6 +46,13 @@ class CommandBufferImpl : public CommandBuffer {
   void Echo(const Callback<void()>& callback) override;
 
  private:
+  class PendingFlush;
+
+  // Forgets the pending flush so that the next Flush() posts a new task.
+  // Called before posting any other task to the driver so that flushes are
+  // never reordered with respect to other commands.
+  void ClearPendingFlush();
+
   void BindToRequest(InterfaceRequest<CommandBuffer> request);
   void OnContextLost(int32_t reason);
 
@@ -55,6 +62,10 @@ class CommandBufferImpl : public CommandBuffer {
   CommandBufferSyncPointClientPtr sync_point_client_;
   StrongBinding<CommandBuffer> binding_;
 
+  // The most recently posted flush that may not have run yet. Further flushes
+  // arriving before it runs just update its put offset.
+  scoped_refptr<PendingFlush> pending_flush_;
+
   base::WeakPtrFactory<CommandBufferImpl> weak_factory_;
   DISALLOW_COPY_AND_ASSIGN(CommandBufferImpl);
 };
@@ -5,14 +5,27 @@
 #include "mojo/services/network/network_context.h"
 
 #include "base/base_paths.h"
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/logging.h"
 #include "base/path_service.h"
+#include "base/pickle.h"
+#include "net/base/net_log.h"
+#include "net/base/sdch_manager.h"
+#include "net/base/sdch_net_log_params.h"
 #include "net/proxy/proxy_service.h"
+#include "net/socket/ssl_client_socket.h"
+#include "net/url_request/sdch_dictionary_fetcher.h"
 #include "net/url_request/url_request_context.h"
 #include "net/url_request/url_request_context_builder.h"
 
 namespace mojo {
 
-NetworkContext::NetworkContext(const base::FilePath& base_path) {
+NetworkContext::NetworkContext(const base::FilePath& base_path)
+    : ssl_session_cache_path_(
+          base_path.Append(FILE_PATH_LITERAL("TLS Sessions"))),
+      sdch_manager_(new net::SdchManager) {
   net::URLRequestContextBuilder builder;
   builder.set_accept_language("en-us,en");
   // TODO(darin): This is surely the wrong UA string.
@@ -31,10 +44,66 @@ NetworkContext::NetworkContext(const base::FilePath& base_path) {
   builder.set_file_enabled(true);
 
   url_request_context_.reset(builder.Build());
+
+  url_request_context_->set_sdch_manager(sdch_manager_.get());
+  sdch_dictionary_fetcher_.reset(new net::SdchDictionaryFetcher(
+      url_request_context_.get(),
+      base::Bind(&NetworkContext::OnDictionaryFetched,
+                 base::Unretained(this))));
+  sdch_manager_->AddObserver(this);
+
+  RestoreSSLSessionCache();
 }
 
 NetworkContext::~NetworkContext() {
   // TODO(darin): Be careful about destruction order of member variables?
+  sdch_manager_->RemoveObserver(this);
+  SaveSSLSessionCache();
+}
+
+void NetworkContext::OnGetDictionary(net::SdchManager* manager,
+                                     const GURL& request_url,
+                                     const GURL& dictionary_url) {
+  sdch_dictionary_fetcher_->Schedule(dictionary_url);
+}
+
+void NetworkContext::OnClearDictionaries(net::SdchManager* manager) {
+  sdch_dictionary_fetcher_->Cancel();
+}
+
+void NetworkContext::OnDictionaryFetched(const std::string& dictionary_text,
+                                         const GURL& dictionary_url,
+                                         const net::BoundNetLog& net_log) {
+  net::SdchProblemCode problem =
+      sdch_manager_->AddSdchDictionary(dictionary_text, dictionary_url);
+  if (problem != net::SDCH_OK) {
+    net::SdchManager::SdchErrorRecovery(problem);
+    net_log.AddEvent(
+        net::NetLog::TYPE_SDCH_DICTIONARY_ERROR,
+        base::Bind(&net::NetLogSdchDictionaryFetchProblemCallback, problem,
+                   dictionary_url, true));
+  }
+}
+
+void NetworkContext::RestoreSSLSessionCache() {
+  std::string data;
+  if (!base::ReadFileToString(ssl_session_cache_path_, &data))
+    return;
+  Pickle pickle(data.data(), static_cast<int>(data.size()));
+  if (!net::SSLClientSocket::RestoreSessionCache(pickle))
+    DLOG(WARNING) << "Ignoring malformed " << ssl_session_cache_path_.value();
+}
+
+void NetworkContext::SaveSSLSessionCache() {
+  Pickle pickle;
+  if (!net::SSLClientSocket::SaveSessionCache(&pickle))
+    return;
+  // Another service may be writing the file too, so replace it atomically.
+  if (!base::CreateDirectory(ssl_session_cache_path_.DirName()))
+    return;
+  base::ImportantFileWriter::WriteFileAtomically(
+      ssl_session_cache_path_,
+      std::string(static_cast<const char*>(pickle.data()), pickle.size()));
 }
 
 }  // namespace mojo
@@ -5,30 +5,62 @@
 #ifndef MOJO_SERVICES_NETWORK_NETWORK_CONTEXT_H_
 #define MOJO_SERVICES_NETWORK_NETWORK_CONTEXT_H_
 
+#include <string>
+
+#include "base/files/file_path.h"
 #include "base/macros.h"
 #include "base/memory/scoped_ptr.h"
+#include "net/base/sdch_observer.h"
 
-namespace base {
-class FilePath;
-}
+class GURL;
 
 namespace net {
+class BoundNetLog;
+class SdchDictionaryFetcher;
+class SdchManager;
 class URLRequestContext;
 }
 
 namespace mojo {
 
-class NetworkContext {
+class NetworkContext : public net::SdchObserver {
  public:
   explicit NetworkContext(const base::FilePath& base_path);
-  ~NetworkContext();
+  ~NetworkContext() override;
 
   net::URLRequestContext* url_request_context() {
     return url_request_context_.get();
   }
 
+  // The SDCH dictionaries are shared by every application using the context.
+  net::SdchManager* sdch_manager() { return sdch_manager_.get(); }
+
+  // net::SdchObserver implementation.
+  void OnGetDictionary(net::SdchManager* manager,
+                       const GURL& request_url,
+                       const GURL& dictionary_url) override;
+  void OnClearDictionaries(net::SdchManager* manager) override;
+
  private:
+  void OnDictionaryFetched(const std::string& dictionary_text,
+                           const GURL& dictionary_url,
+                           const net::BoundNetLog& net_log);
+
+  // The SSL session cache is kept in a file between runs of the service, and
+  // shared by the services of shells running at the same time, so that they
+  // resume the sessions of hosts they talked to before rather than making
+  // full handshakes. Reading and writing it blocks the calling thread.
+  void RestoreSSLSessionCache();
+  void SaveSSLSessionCache();
+
+  const base::FilePath ssl_session_cache_path_;
+
+  // The manager is referenced by requests of |url_request_context_|, and the
+  // fetcher issues requests on it, so the members are destroyed in this
+  // order: fetcher, context, manager.
+  scoped_ptr<net::SdchManager> sdch_manager_;
   scoped_ptr<net::URLRequestContext> url_request_context_;
+  scoped_ptr<net::SdchDictionaryFetcher> sdch_dictionary_fetcher_;
 
   DISALLOW_COPY_AND_ASSIGN(NetworkContext);
 };
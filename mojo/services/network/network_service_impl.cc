@@ -7,10 +7,12 @@
 #include "mojo/public/cpp/application/application_connection.h"
 #include "mojo/services/network/cookie_store_impl.h"
 #include "mojo/services/network/net_adapters.h"
+#include "mojo/services/network/network_context.h"
 #include "mojo/services/network/tcp_bound_socket_impl.h"
 #include "mojo/services/network/udp_socket_impl.h"
 #include "mojo/services/network/url_loader_impl.h"
 #include "mojo/services/network/web_socket_impl.h"
+#include "net/base/sdch_manager.h"
 
 namespace mojo {
 
@@ -67,4 +69,20 @@ void NetworkServiceImpl::CreateUDPSocket(InterfaceRequest<UDPSocket> socket) {
   BindToRequest(new UDPSocketImpl(), &socket);
 }
 
+void NetworkServiceImpl::RegisterSdchDictionary(
+    const String& dictionary_url,
+    const String& dictionary_text,
+    const Callback<void(NetworkErrorPtr)>& callback) {
+  GURL url(dictionary_url.get());
+  if (!url.is_valid()) {
+    callback.Run(MakeNetworkError(net::ERR_INVALID_URL));
+    return;
+  }
+  net::SdchProblemCode problem =
+      context_->sdch_manager()->AddSdchDictionary(dictionary_text.get(), url);
+  callback.Run(MakeNetworkError(problem == net::SDCH_OK
+                                    ? net::OK
+                                    : net::ERR_INVALID_ARGUMENT));
+}
+
 }  // namespace mojo
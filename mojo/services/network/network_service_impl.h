@@ -35,6 +35,10 @@ class NetworkServiceImpl : public InterfaceImpl<NetworkService> {
       InterfaceRequest<TCPConnectedSocket> client_socket,
       const Callback<void(NetworkErrorPtr, NetAddressPtr)>& callback) override;
   void CreateUDPSocket(InterfaceRequest<UDPSocket> socket) override;
+  void RegisterSdchDictionary(
+      const String& dictionary_url,
+      const String& dictionary_text,
+      const Callback<void(NetworkErrorPtr)>& callback) override;
 
  private:
   NetworkContext* context_;
@@ -0,0 +1,128 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/macros.h"
+#include "base/run_loop.h"
+#include "mojo/common/data_pipe_utils.h"
+#include "mojo/public/cpp/application/application_connection.h"
+#include "mojo/public/cpp/application/application_delegate.h"
+#include "mojo/public/cpp/application/application_impl.h"
+#include "mojo/public/cpp/application/application_test_base.h"
+#include "mojo/services/public/interfaces/network/network_service.mojom.h"
+#include "mojo/services/public/interfaces/network/url_loader.mojom.h"
+#include "net/base/filename_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace mojo {
+namespace service {
+namespace {
+
+// Sinks that store the result of a URLLoader call and quit |run_loop|.
+struct StartSink {
+  StartSink(URLResponsePtr* response, base::RunLoop* run_loop)
+      : response(response), run_loop(run_loop) {}
+  void Run(URLResponsePtr result) const {
+    *response = result.Pass();
+    run_loop->Quit();
+  }
+
+  URLResponsePtr* response;
+  base::RunLoop* run_loop;
+};
+
+struct QueryStatusSink {
+  QueryStatusSink(URLLoaderStatusPtr* status, base::RunLoop* run_loop)
+      : status(status), run_loop(run_loop) {}
+  void Run(URLLoaderStatusPtr result) const {
+    *status = result.Pass();
+    run_loop->Quit();
+  }
+
+  URLLoaderStatusPtr* status;
+  base::RunLoop* run_loop;
+};
+
+class URLLoaderAppTest : public test::ApplicationTestBase,
+                         public ApplicationDelegate {
+ public:
+  URLLoaderAppTest() {}
+  ~URLLoaderAppTest() override {}
+
+  void SetUp() override {
+    ApplicationTestBase::SetUp();
+
+    ApplicationConnection* connection =
+        application_impl()->ConnectToApplication("mojo:network_service");
+    connection->ConnectToService(&network_service_);
+
+    network_service_->CreateURLLoader(GetProxy(&url_loader_));
+  }
+
+ protected:
+  URLResponsePtr Start(URLRequestPtr request) {
+    URLResponsePtr response;
+    base::RunLoop run_loop;
+    url_loader_->Start(request.Pass(), StartSink(&response, &run_loop));
+    run_loop.Run();
+    return response.Pass();
+  }
+
+  URLLoaderStatusPtr QueryStatus() {
+    URLLoaderStatusPtr status;
+    base::RunLoop run_loop;
+    url_loader_->QueryStatus(QueryStatusSink(&status, &run_loop));
+    run_loop.Run();
+    return status.Pass();
+  }
+
+  URLLoaderPtr url_loader_;
+
+ private:
+  // ApplicationTestBase:
+  ApplicationDelegate* GetApplicationDelegate() override { return this; }
+
+  NetworkServicePtr network_service_;
+
+  DISALLOW_COPY_AND_ASSIGN(URLLoaderAppTest);
+};
+
+}  // namespace
+
+TEST_F(URLLoaderAppTest, QueryStatusAfterBodyIsDrained) {
+  // Big enough to take several reads through the response body pipe.
+  const std::string kBody(300 * 1024, 'x');
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath path = temp_dir.path().AppendASCII("body.txt");
+  ASSERT_EQ(static_cast<int>(kBody.size()),
+            base::WriteFile(path, kBody.data(), kBody.size()));
+
+  URLRequestPtr request(URLRequest::New());
+  request->url = net::FilePathToFileURL(path).spec();
+  URLResponsePtr response = Start(request.Pass());
+  ASSERT_TRUE(response);
+  EXPECT_FALSE(response->error);
+  ASSERT_TRUE(response->body.is_valid());
+
+  std::string body;
+  EXPECT_TRUE(common::BlockingCopyToString(response->body.Pass(), &body));
+  EXPECT_EQ(kBody, body);
+
+  URLLoaderStatusPtr status = QueryStatus();
+  ASSERT_TRUE(status);
+  EXPECT_FALSE(status->error);
+  EXPECT_FALSE(status->is_loading);
+  EXPECT_EQ(static_cast<int64>(kBody.size()), status->body_bytes_written);
+  EXPECT_GE(status->stall_time_ms, 0);
+}
+
+}  // namespace service
+}  // namespace mojo
@@ -4,6 +4,8 @@
 
 #include "mojo/services/network/url_loader_impl.h"
 
+#include <algorithm>
+
 #include "base/memory/scoped_vector.h"
 #include "base/message_loop/message_loop.h"
 #include "mojo/common/common_type_converters.h"
@@ -20,6 +22,11 @@
 namespace mojo {
 namespace {
 
+// Bounds on the capacity of the response body data pipe. The lower bound only
+// applies when the capacity is derived from the expected content size.
+const uint32_t kMinResponseBodyBufferSize = 64 * 1024;
+const uint32_t kMaxResponseBodyBufferSize = 16 * 1024 * 1024;
+
 // Generates an URLResponsePtr from the response state of a net::URLRequest.
 URLResponsePtr MakeURLResponse(const net::URLRequest* url_request) {
   URLResponsePtr response(URLResponse::New());
@@ -95,12 +102,30 @@ URLLoaderImpl::URLLoaderImpl(NetworkContext* context)
     : context_(context),
       response_body_buffer_size_(0),
       auto_follow_redirects_(true),
+      body_bytes_written_(0),
       weak_ptr_factory_(this) {
 }
 
 URLLoaderImpl::~URLLoaderImpl() {
 }
 
+// static
+uint32_t URLLoaderImpl::ComputeResponseBodyBufferSize(
+    uint32_t requested_size,
+    int64 expected_content_size) {
+  // An explicit size requested by the client wins, up to the upper bound.
+  if (requested_size)
+    return std::min(requested_size, kMaxResponseBodyBufferSize);
+  if (expected_content_size <= 0)
+    return 0;
+  // Otherwise the pipe is sized to hold the expected body, so that large
+  // downloads are not throttled by a small default buffer.
+  int64 size =
+      std::max<int64>(expected_content_size, kMinResponseBodyBufferSize);
+  size = std::min<int64>(size, kMaxResponseBodyBufferSize);
+  return static_cast<uint32_t>(size);
+}
+
 void URLLoaderImpl::Start(URLRequestPtr request,
                           const Callback<void(URLResponsePtr)>& callback) {
   if (url_request_) {
@@ -171,6 +196,19 @@ void URLLoaderImpl::QueryStatus(
   } else {
     status->is_loading = false;
   }
+
+  base::TimeDelta stall_time = stall_time_;
+  if (!stall_start_time_.is_null())
+    stall_time += base::TimeTicks::Now() - stall_start_time_;
+  status->body_bytes_written = body_bytes_written_;
+  status->stall_time_ms = stall_time.InMilliseconds();
+  if (!response_start_time_.is_null()) {
+    base::TimeDelta elapsed = base::TimeTicks::Now() - response_start_time_;
+    if (elapsed > base::TimeDelta()) {
+      status->bytes_per_second = static_cast<int64>(
+          body_bytes_written_ / elapsed.InSecondsF());
+    }
+  }
   // TODO(darin): Populate more status fields.
   callback.Run(status.Pass());
 }
@@ -206,12 +244,18 @@ void URLLoaderImpl::OnResponseStarted(net::URLRequest* url_request) {
 
   // TODO(darin): Add support for optional MIME sniffing.
 
-  DataPipe data_pipe;
-  // TODO(darin): Honor given buffer size.
+  MojoCreateDataPipeOptions options;
+  options.struct_size = sizeof(MojoCreateDataPipeOptions);
+  options.flags = MOJO_CREATE_DATA_PIPE_OPTIONS_FLAG_NONE;
+  options.element_num_bytes = 1;
+  options.capacity_num_bytes = ComputeResponseBodyBufferSize(
+      response_body_buffer_size_, url_request->GetExpectedContentSize());
+  DataPipe data_pipe(options);
 
   URLResponsePtr response = MakeURLResponse(url_request);
   response->body = data_pipe.consumer_handle.Pass();
   response_body_stream_ = data_pipe.producer_handle.Pass();
+  response_start_time_ = base::TimeTicks::Now();
 
   SendResponse(response.Pass());
 
@@ -247,6 +291,8 @@ void URLLoaderImpl::SendResponse(URLResponsePtr response) {
 }
 
 void URLLoaderImpl::OnResponseBodyStreamReady(MojoResult result) {
+  stall_time_ += base::TimeTicks::Now() - stall_start_time_;
+  stall_start_time_ = base::TimeTicks();
   // TODO(darin): Handle a bad |result| value.
   ReadMore();
 }
@@ -260,6 +306,7 @@ void URLLoaderImpl::ReadMore() {
 
   if (result == MOJO_RESULT_SHOULD_WAIT) {
     // The pipe is full. We need to wait for it to have more space.
+    stall_start_time_ = base::TimeTicks::Now();
     handle_watcher_.Start(response_body_stream_.get(),
                           MOJO_HANDLE_SIGNAL_WRITABLE,
                           MOJO_DEADLINE_INDEFINITE,
@@ -292,6 +339,7 @@ void URLLoaderImpl::DidRead(uint32_t num_bytes, bool completed_synchronously) {
 
   response_body_stream_ = pending_write_->Complete(num_bytes);
   pending_write_ = NULL;
+  body_bytes_written_ += num_bytes;
 
   if (completed_synchronously) {
     base::MessageLoop::current()->PostTask(
@@ -7,6 +7,7 @@
 
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "mojo/common/handle_watcher.h"
 #include "mojo/public/cpp/bindings/interface_impl.h"
 #include "mojo/services/public/interfaces/network/url_loader.mojom.h"
@@ -24,6 +25,13 @@ class URLLoaderImpl : public InterfaceImpl<URLLoader>,
   explicit URLLoaderImpl(NetworkContext* context);
   ~URLLoaderImpl() override;
 
+  // Picks the capacity of the response body data pipe from the client's
+  // |requested_size| (0 if none) and the |expected_content_size| of the body
+  // (-1 if unknown). Returns 0 to request the system default capacity. Exposed
+  // for testing.
+  static uint32_t ComputeResponseBodyBufferSize(uint32_t requested_size,
+                                                int64 expected_content_size);
+
  private:
   // URLLoader methods:
   void Start(URLRequestPtr request,
@@ -55,6 +63,12 @@ class URLLoaderImpl : public InterfaceImpl<URLLoader>,
   uint32 response_body_buffer_size_;
   bool auto_follow_redirects_;
 
+  // Response body throughput accounting, reported through QueryStatus.
+  int64 body_bytes_written_;
+  base::TimeTicks response_start_time_;
+  base::TimeTicks stall_start_time_;
+  base::TimeDelta stall_time_;
+
   base::WeakPtrFactory<URLLoaderImpl> weak_ptr_factory_;
 };
 
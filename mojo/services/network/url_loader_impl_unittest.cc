@@ -0,0 +1,53 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mojo/services/network/url_loader_impl.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace mojo {
+namespace {
+
+const uint32_t kMinSize = 64 * 1024;
+const uint32_t kMaxSize = 16 * 1024 * 1024;
+
+uint32_t ComputeSize(uint32_t requested_size, int64 expected_content_size) {
+  return URLLoaderImpl::ComputeResponseBodyBufferSize(requested_size,
+                                                      expected_content_size);
+}
+
+TEST(URLLoaderImplTest, NoSizeUsesSystemDefault) {
+  EXPECT_EQ(0u, ComputeSize(0, 0));
+  // An unknown or bogus expected size gives no hint either.
+  EXPECT_EQ(0u, ComputeSize(0, -1));
+  EXPECT_EQ(0u, ComputeSize(0, -1024 * 1024));
+}
+
+TEST(URLLoaderImplTest, ExplicitSizeWins) {
+  EXPECT_EQ(4096u, ComputeSize(4096, 0));
+  EXPECT_EQ(4096u, ComputeSize(4096, 1024 * 1024));
+  EXPECT_EQ(4096u, ComputeSize(4096, -1));
+  EXPECT_EQ(1u, ComputeSize(1, 0));
+  EXPECT_EQ(1024u * 1024u, ComputeSize(1024 * 1024, 100));
+  // Up to the upper bound.
+  EXPECT_EQ(kMaxSize, ComputeSize(kMaxSize, 0));
+  EXPECT_EQ(kMaxSize, ComputeSize(kMaxSize + 1, 0));
+  EXPECT_EQ(kMaxSize, ComputeSize(0xFFFFFFFF, 0));
+}
+
+TEST(URLLoaderImplTest, ExpectedSizeIsClamped) {
+  EXPECT_EQ(kMinSize, ComputeSize(0, 1));
+  EXPECT_EQ(kMinSize, ComputeSize(0, kMinSize - 1));
+  EXPECT_EQ(kMinSize, ComputeSize(0, kMinSize));
+  EXPECT_EQ(kMinSize + 1, ComputeSize(0, kMinSize + 1));
+  EXPECT_EQ(1024u * 1024u, ComputeSize(0, 1024 * 1024));
+  EXPECT_EQ(kMaxSize, ComputeSize(0, kMaxSize));
+  EXPECT_EQ(kMaxSize, ComputeSize(0, kMaxSize + 1));
+  // Sizes that do not fit in 32 bits.
+  EXPECT_EQ(kMaxSize, ComputeSize(0, 0x100000000LL));
+  EXPECT_EQ(kMaxSize, ComputeSize(0, 0x7FFFFFFFFFFFFFFFLL));
+}
+
+}  // namespace
+}  // namespace mojo
@@ -50,6 +50,13 @@ void AppChildProcessHost::DidStart(bool success) {
   }
 }
 
+bool AppChildProcessHost::GetChannelStats(embedder::ChannelStats* stats) {
+  if (!channel_info_)
+    return false;
+  embedder::GetChannelStats(channel_info_, stats);
+  return true;
+}
+
 // Callback for |embedder::CreateChannel()|.
 void AppChildProcessHost::DidCreateChannel(
     embedder::ChannelInfo* channel_info) {
@@ -7,6 +7,7 @@
 
 #include "base/macros.h"
 #include "mojo/edk/embedder/channel_info_forward.h"
+#include "mojo/edk/embedder/channel_stats.h"
 #include "mojo/shell/app_child_process.mojom.h"
 #include "mojo/shell/child_process_host.h"
 
@@ -29,6 +30,10 @@ class AppChildProcessHost : public ChildProcessHost,
     return controller_.get();
   }
 
+  // Gets the traffic on the channel to the child process. Returns false if the
+  // channel has not been created yet.
+  bool GetChannelStats(embedder::ChannelStats* stats);
+
  private:
   // |ChildProcessHost::Delegate| methods:
   void WillStart() override;
@@ -0,0 +1,71 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mojo/shell/application_stats_loader.h"
+
+#include "base/logging.h"
+#include "mojo/public/cpp/application/application_connection.h"
+#include "mojo/public/cpp/application/application_impl.h"
+#include "mojo/public/cpp/bindings/interface_impl.h"
+#include "mojo/shell/context.h"
+
+namespace mojo {
+namespace shell {
+namespace {
+
+class ApplicationStatsProviderImpl
+    : public InterfaceImpl<ApplicationStatsProvider> {
+ public:
+  explicit ApplicationStatsProviderImpl(Context* context)
+      : context_(context) {}
+  ~ApplicationStatsProviderImpl() override {}
+
+ private:
+  // ApplicationStatsProvider implementation:
+  void GetApplicationStats(
+      const Callback<void(Array<ApplicationStatsPtr>)>& callback) override {
+    callback.Run(context_->GetApplicationStats());
+  }
+
+  Context* const context_;
+
+  DISALLOW_COPY_AND_ASSIGN(ApplicationStatsProviderImpl);
+};
+
+}  // namespace
+
+ApplicationStatsLoader::ApplicationStatsLoader(Context* context)
+    : context_(context) {
+}
+
+ApplicationStatsLoader::~ApplicationStatsLoader() {
+}
+
+void ApplicationStatsLoader::Load(ApplicationManager* manager,
+                                  const GURL& url,
+                                  ScopedMessagePipeHandle shell_handle,
+                                  LoadCallback callback) {
+  DCHECK(shell_handle.is_valid());
+  app_.reset(new ApplicationImpl(this, shell_handle.Pass()));
+}
+
+void ApplicationStatsLoader::OnApplicationError(ApplicationManager* manager,
+                                                const GURL& url) {
+  app_.reset();
+}
+
+bool ApplicationStatsLoader::ConfigureIncomingConnection(
+    ApplicationConnection* connection) {
+  connection->AddService(this);
+  return true;
+}
+
+void ApplicationStatsLoader::Create(
+    ApplicationConnection* connection,
+    InterfaceRequest<ApplicationStatsProvider> request) {
+  BindToRequest(new ApplicationStatsProviderImpl(context_), &request);
+}
+
+}  // namespace shell
+}  // namespace mojo
@@ -0,0 +1,58 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MOJO_SHELL_APPLICATION_STATS_LOADER_H_
+#define MOJO_SHELL_APPLICATION_STATS_LOADER_H_
+
+#include "base/macros.h"
+#include "base/memory/scoped_ptr.h"
+#include "mojo/application_manager/application_loader.h"
+#include "mojo/public/cpp/application/application_delegate.h"
+#include "mojo/public/cpp/application/interface_factory.h"
+#include "mojo/shell/application_stats.mojom.h"
+
+namespace mojo {
+
+class ApplicationImpl;
+
+namespace shell {
+
+class Context;
+
+// ApplicationLoader that runs, on the shell thread, an application providing
+// ApplicationStatsProvider over |context|'s stats.
+class ApplicationStatsLoader
+    : public ApplicationLoader,
+      public ApplicationDelegate,
+      public InterfaceFactory<ApplicationStatsProvider> {
+ public:
+  explicit ApplicationStatsLoader(Context* context);
+  ~ApplicationStatsLoader() override;
+
+ private:
+  // ApplicationLoader overrides:
+  void Load(ApplicationManager* manager,
+            const GURL& url,
+            ScopedMessagePipeHandle shell_handle,
+            LoadCallback callback) override;
+  void OnApplicationError(ApplicationManager* manager,
+                          const GURL& url) override;
+
+  // ApplicationDelegate overrides:
+  bool ConfigureIncomingConnection(ApplicationConnection* connection) override;
+
+  // InterfaceFactory<ApplicationStatsProvider> overrides:
+  void Create(ApplicationConnection* connection,
+              InterfaceRequest<ApplicationStatsProvider> request) override;
+
+  Context* const context_;
+  scoped_ptr<ApplicationImpl> app_;
+
+  DISALLOW_COPY_AND_ASSIGN(ApplicationStatsLoader);
+};
+
+}  // namespace shell
+}  // namespace mojo
+
+#endif  // MOJO_SHELL_APPLICATION_STATS_LOADER_H_
@@ -13,16 +13,20 @@
 #include "base/macros.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
 #include "build/build_config.h"
 #include "mojo/application_manager/application_loader.h"
 #include "mojo/application_manager/application_manager.h"
 #include "mojo/application_manager/background_shell_application_loader.h"
+#include "mojo/common/common_type_converters.h"
 #include "mojo/edk/embedder/embedder.h"
 #include "mojo/edk/embedder/simple_platform_support.h"
 #include "mojo/public/cpp/application/application_connection.h"
 #include "mojo/public/cpp/application/application_delegate.h"
 #include "mojo/public/cpp/application/application_impl.h"
+#include "mojo/shell/app_child_process_host.h"
+#include "mojo/shell/application_stats_loader.h"
 #include "mojo/shell/dynamic_application_loader.h"
 #include "mojo/shell/external_application_listener.h"
 #include "mojo/shell/in_process_dynamic_service_runner.h"
@@ -239,6 +243,10 @@ bool Context::Init() {
       GURL("mojo:native_viewport_service"));
 #endif
 
+  application_manager_.SetLoaderForURL(
+      scoped_ptr<ApplicationLoader>(new ApplicationStatsLoader(this)),
+      GURL("mojo:application_stats"));
+
   if (command_line->HasSwitch(switches::kSpy)) {
     spy_.reset(
         new mojo::Spy(&application_manager_,
@@ -262,6 +270,20 @@ bool Context::Init() {
   }
 #endif
 
+  if (command_line->HasSwitch(switches::kDumpAppStats)) {
+    int interval_seconds = 0;
+    if (!base::StringToInt(
+            command_line->GetSwitchValueASCII(switches::kDumpAppStats),
+            &interval_seconds) ||
+        interval_seconds <= 0) {
+      LOG(ERROR) << "Invalid value for --" << switches::kDumpAppStats;
+      return false;
+    }
+    app_stats_timer_.Start(FROM_HERE,
+                           base::TimeDelta::FromSeconds(interval_seconds),
+                           this, &Context::DumpApplicationStats);
+  }
+
   if (listener_)
     listener_->WaitForListening();
 
@@ -280,6 +302,67 @@ GURL Context::ResolveURL(const GURL& url) {
   return mojo_url_resolver_.Resolve(url);
 }
 
+void Context::AddOutOfProcessApp(const GURL& url, AppChildProcessHost* host) {
+  DCHECK(host);
+  out_of_process_apps_[url] = host;
+}
+
+void Context::RemoveOutOfProcessApp(const GURL& url,
+                                    AppChildProcessHost* host) {
+  std::map<GURL, AppChildProcessHost*>::iterator it =
+      out_of_process_apps_.find(url);
+  if (it != out_of_process_apps_.end() && it->second == host)
+    out_of_process_apps_.erase(it);
+}
+
+Array<ApplicationStatsPtr> Context::GetApplicationStats() {
+  std::vector<ApplicationManager::ApplicationStats> manager_stats =
+      application_manager_.GetApplicationStats();
+  base::TimeTicks now = base::TimeTicks::Now();
+  Array<ApplicationStatsPtr> stats(manager_stats.size());
+  for (size_t i = 0; i < manager_stats.size(); ++i) {
+    ApplicationStatsPtr app_stats(ApplicationStats::New());
+    app_stats->url = String::From(manager_stats[i].url);
+    app_stats->uptime_seconds =
+        (now - manager_stats[i].start_time).InSeconds();
+    app_stats->incoming_connections = manager_stats[i].incoming_connections;
+    app_stats->outgoing_connections = manager_stats[i].outgoing_connections;
+
+    std::map<GURL, AppChildProcessHost*>::const_iterator it =
+        out_of_process_apps_.find(manager_stats[i].url);
+    if (it != out_of_process_apps_.end()) {
+      app_stats->out_of_process = true;
+      embedder::ChannelStats channel_stats;
+      if (it->second->GetChannelStats(&channel_stats)) {
+        app_stats->messages_sent = channel_stats.messages_written;
+        app_stats->bytes_sent = channel_stats.bytes_written;
+        app_stats->messages_received = channel_stats.messages_read;
+        app_stats->bytes_received = channel_stats.bytes_read;
+      }
+    }
+    stats[i] = app_stats.Pass();
+  }
+  return stats.Pass();
+}
+
+void Context::DumpApplicationStats() {
+  Array<ApplicationStatsPtr> stats = GetApplicationStats();
+  LOG(INFO) << "Application stats (" << stats.size() << " running):";
+  for (size_t i = 0; i < stats.size(); ++i) {
+    const ApplicationStatsPtr& app_stats = stats[i];
+    LOG(INFO) << "  " << app_stats->url
+              << ": up " << app_stats->uptime_seconds << "s"
+              << ", incoming connections " << app_stats->incoming_connections
+              << ", outgoing connections " << app_stats->outgoing_connections;
+    if (app_stats->out_of_process) {
+      LOG(INFO) << "    sent " << app_stats->messages_sent << " messages ("
+                << app_stats->bytes_sent << " bytes), received "
+                << app_stats->messages_received << " messages ("
+                << app_stats->bytes_received << " bytes)";
+    }
+  }
+}
+
 void Context::Run(const GURL& url) {
   EmptyServiceProvider* sp = new EmptyServiceProvider;
   ServiceProviderPtr spp;
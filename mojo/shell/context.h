@@ -5,10 +5,13 @@
 #ifndef MOJO_SHELL_CONTEXT_H_
 #define MOJO_SHELL_CONTEXT_H_
 
+#include <map>
 #include <string>
 
 #include "base/macros.h"
+#include "base/timer/timer.h"
 #include "mojo/application_manager/application_manager.h"
+#include "mojo/shell/application_stats.mojom.h"
 #include "mojo/shell/mojo_url_resolver.h"
 #include "mojo/shell/task_runners.h"
 
@@ -22,6 +25,7 @@ class Spy;
 
 namespace shell {
 
+class AppChildProcessHost;
 class DynamicApplicationLoader;
 class ExternalApplicationListener;
 
@@ -43,6 +47,15 @@ class Context : ApplicationManager::Delegate {
   ApplicationManager* application_manager() { return &application_manager_; }
   MojoURLResolver* mojo_url_resolver() { return &mojo_url_resolver_; }
 
+  // An app running in a child process is registered here while the process
+  // runs, so that the traffic on its channel can be reported.
+  void AddOutOfProcessApp(const GURL& url, AppChildProcessHost* host);
+  // Does nothing if |url| has since been registered with another host.
+  void RemoveOutOfProcessApp(const GURL& url, AppChildProcessHost* host);
+
+  // Returns the stats of every running application, sorted by URL.
+  Array<ApplicationStatsPtr> GetApplicationStats();
+
 #if defined(OS_ANDROID)
   base::MessageLoop* ui_loop() const { return ui_loop_; }
   void set_ui_loop(base::MessageLoop* ui_loop) { ui_loop_ = ui_loop; }
@@ -55,12 +68,17 @@ class Context : ApplicationManager::Delegate {
   void OnApplicationError(const GURL& url) override;
   GURL ResolveURL(const GURL& url) override;
 
+  // Logs the stats of every running application.
+  void DumpApplicationStats();
+
   std::set<GURL> app_urls_;
   scoped_ptr<TaskRunners> task_runners_;
   scoped_ptr<ExternalApplicationListener> listener_;
   ApplicationManager application_manager_;
   MojoURLResolver mojo_url_resolver_;
   scoped_ptr<Spy> spy_;
+  base::RepeatingTimer<Context> app_stats_timer_;
+  std::map<GURL, AppChildProcessHost*> out_of_process_apps_;
 #if defined(OS_ANDROID)
   base::MessageLoop* ui_loop_;
 #endif  // defined(OS_ANDROID)
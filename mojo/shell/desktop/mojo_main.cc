@@ -76,6 +76,7 @@ void Usage() {
       << " [--" << switches::kContentHandlers << "=<handlers>]"
       << " [--" << switches::kEnableExternalApplications << "]"
       << " [--" << switches::kDisableCache << "]"
+      << " [--" << switches::kDumpAppStats << "=<seconds>]"
       << " [--" << switches::kEnableMultiprocess << "]"
       << " [--" << switches::kOrigin << "=<url-lib-path>]"
       << " [--" << switches::kURLMappings << "=from1=to1,from2=to2]"
@@ -50,13 +50,15 @@ void IgnoreResult(bool result) {
 // while the async operation is outstanding.
 class DynamicApplicationLoader::Loader {
  public:
-  Loader(MimeTypeToURLMap* mime_type_to_url,
+  Loader(const GURL& url,
+         MimeTypeToURLMap* mime_type_to_url,
          Context* context,
          DynamicServiceRunnerFactory* runner_factory,
          ScopedMessagePipeHandle shell_handle,
          ApplicationLoader::LoadCallback load_callback,
          const LoaderCompleteCallback& loader_complete_callback)
-      : shell_handle_(shell_handle.Pass()),
+      : url_(url),
+        shell_handle_(shell_handle.Pass()),
         load_callback_(load_callback),
         loader_complete_callback_(loader_complete_callback),
         context_(context),
@@ -111,6 +113,8 @@ class DynamicApplicationLoader::Loader {
 
   void ReportComplete() { loader_complete_callback_.Run(this); }
 
+  const GURL& url() const { return url_; }
+
  private:
   bool PeekContentHandler(std::string* mojo_shebang,
                           GURL* mojo_content_handler_url) {
@@ -138,10 +142,11 @@ class DynamicApplicationLoader::Loader {
 
     runner_ = runner_factory_->Create(context_);
     runner_->Start(
-        path, shell_handle_.Pass(),
+        url_, path, shell_handle_.Pass(),
         base::Bind(&Loader::ReportComplete, weak_ptr_factory_.GetWeakPtr()));
   }
 
+  const GURL url_;
   ScopedMessagePipeHandle shell_handle_;
   ApplicationLoader::LoadCallback load_callback_;
   LoaderCompleteCallback loader_complete_callback_;
@@ -162,13 +167,13 @@ class DynamicApplicationLoader::LocalLoader : public Loader {
               ScopedMessagePipeHandle shell_handle,
               ApplicationLoader::LoadCallback load_callback,
               const LoaderCompleteCallback& loader_complete_callback)
-      : Loader(mime_type_to_url,
+      : Loader(url,
+               mime_type_to_url,
                context,
                runner_factory,
                shell_handle.Pass(),
                load_callback,
                loader_complete_callback),
-        url_(url),
         path_(UrlToFile(url)) {
     Load();
   }
@@ -193,7 +198,7 @@ class DynamicApplicationLoader::LocalLoader : public Loader {
   URLResponsePtr AsURLResponse(base::TaskRunner* task_runner,
                                uint32_t skip) override {
     URLResponsePtr response(URLResponse::New());
-    response->url = String::From(url_);
+    response->url = String::From(url());
     DataPipe data_pipe;
     response->body = data_pipe.consumer_handle.Pass();
     int64 file_size;
@@ -233,7 +238,6 @@ class DynamicApplicationLoader::LocalLoader : public Loader {
     return true;
   }
 
-  GURL url_;
   base::FilePath path_;
 
   DISALLOW_COPY_AND_ASSIGN(LocalLoader);
@@ -250,7 +254,8 @@ class DynamicApplicationLoader::NetworkLoader : public Loader {
                 ScopedMessagePipeHandle shell_handle,
                 ApplicationLoader::LoadCallback load_callback,
                 const LoaderCompleteCallback& loader_complete_callback)
-      : Loader(mime_type_to_url,
+      : Loader(url,
+               mime_type_to_url,
                context,
                runner_factory,
                shell_handle.Pass(),
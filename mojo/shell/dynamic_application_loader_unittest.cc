@@ -34,7 +34,8 @@ class TestDynamicServiceRunner : public DynamicServiceRunner {
     state_->runner_was_destroyed = true;
     base::MessageLoop::current()->Quit();
   }
-  void Start(const base::FilePath& app_path,
+  void Start(const GURL& app_url,
+             const base::FilePath& app_path,
              ScopedMessagePipeHandle service_handle,
              const base::Closure& app_completed_callback) override {
     state_->runner_was_started = true;
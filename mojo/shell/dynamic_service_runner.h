@@ -9,6 +9,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/native_library.h"
 #include "mojo/public/cpp/system/core.h"
+#include "url/gurl.h"
 
 namespace base {
 class FilePath;
@@ -26,9 +27,11 @@ class DynamicServiceRunner {
   virtual ~DynamicServiceRunner() {}
 
   // Takes ownership of the file at |app_path|. Loads the app in that file and
-  // runs it on some other thread/process. |app_completed_callback| is posted
-  // (to the thread on which |Start()| was called) after |MojoMain()| completes.
-  virtual void Start(const base::FilePath& app_path,
+  // runs it on some other thread/process. |app_url| is the URL the app was
+  // loaded from. |app_completed_callback| is posted (to the thread on which
+  // |Start()| was called) after |MojoMain()| completes.
+  virtual void Start(const GURL& app_url,
+                     const base::FilePath& app_path,
                      ScopedMessagePipeHandle service_handle,
                      const base::Closure& app_completed_callback) = 0;
 
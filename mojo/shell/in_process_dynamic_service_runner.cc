@@ -32,6 +32,7 @@ InProcessDynamicServiceRunner::~InProcessDynamicServiceRunner() {
 }
 
 void InProcessDynamicServiceRunner::Start(
+    const GURL& app_url,
     const base::FilePath& app_path,
     ScopedMessagePipeHandle service_handle,
     const base::Closure& app_completed_callback) {
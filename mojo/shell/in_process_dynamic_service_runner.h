@@ -24,7 +24,8 @@ class InProcessDynamicServiceRunner
   ~InProcessDynamicServiceRunner() override;
 
   // |DynamicServiceRunner| method:
-  void Start(const base::FilePath& app_path,
+  void Start(const GURL& app_url,
+             const base::FilePath& app_path,
              ScopedMessagePipeHandle service_handle,
              const base::Closure& app_completed_callback) override;
 
@@ -9,6 +9,7 @@
 #include "base/files/file_util.h"
 #include "base/logging.h"
 #include "base/scoped_native_library.h"
+#include "mojo/shell/context.h"
 
 namespace mojo {
 namespace shell {
@@ -20,6 +21,7 @@ OutOfProcessDynamicServiceRunner::OutOfProcessDynamicServiceRunner(
 
 OutOfProcessDynamicServiceRunner::~OutOfProcessDynamicServiceRunner() {
   if (app_child_process_host_) {
+    context_->RemoveOutOfProcessApp(app_url_, app_child_process_host_.get());
     // TODO(vtl): Race condition: If |AppChildProcessHost::DidStart()| hasn't
     // been called yet, we shouldn't call |Join()| here. (Until |DidStart()|, we
     // may not have a child process to wait on.) Probably we should fix
@@ -29,9 +31,11 @@ OutOfProcessDynamicServiceRunner::~OutOfProcessDynamicServiceRunner() {
 }
 
 void OutOfProcessDynamicServiceRunner::Start(
+    const GURL& app_url,
     const base::FilePath& app_path,
     ScopedMessagePipeHandle service_handle,
     const base::Closure& app_completed_callback) {
+  app_url_ = app_url;
   app_path_ = app_path;
 
   DCHECK(!service_handle_.is_valid());
@@ -42,6 +46,7 @@ void OutOfProcessDynamicServiceRunner::Start(
 
   app_child_process_host_.reset(new AppChildProcessHost(context_, this));
   app_child_process_host_->Start();
+  context_->AddOutOfProcessApp(app_url_, app_child_process_host_.get());
 
   // TODO(vtl): |app_path.AsUTF8Unsafe()| is unsafe.
   app_child_process_host_->controller()->StartApp(
@@ -54,6 +59,7 @@ void OutOfProcessDynamicServiceRunner::AppCompleted(int32_t result) {
   DVLOG(2) << "OutOfProcessDynamicServiceRunner::AppCompleted(" << result
            << ")";
 
+  context_->RemoveOutOfProcessApp(app_url_, app_child_process_host_.get());
   app_completed_callback_.Run();
   app_completed_callback_.Reset();
   app_child_process_host_.reset();
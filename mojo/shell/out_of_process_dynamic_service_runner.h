@@ -25,7 +25,8 @@ class OutOfProcessDynamicServiceRunner
   ~OutOfProcessDynamicServiceRunner() override;
 
   // |DynamicServiceRunner| method:
-  void Start(const base::FilePath& app_path,
+  void Start(const GURL& app_url,
+             const base::FilePath& app_path,
              ScopedMessagePipeHandle service_handle,
              const base::Closure& app_completed_callback) override;
 
@@ -35,6 +36,7 @@ class OutOfProcessDynamicServiceRunner
 
   Context* const context_;
 
+  GURL app_url_;
   base::FilePath app_path_;
   ScopedMessagePipeHandle service_handle_;
   base::Closure app_completed_callback_;
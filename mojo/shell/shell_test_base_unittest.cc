@@ -14,6 +14,7 @@
 #include "mojo/public/cpp/system/core.h"
 #include "mojo/services/test_service/test_request_tracker.mojom.h"
 #include "mojo/services/test_service/test_service.mojom.h"
+#include "mojo/shell/application_stats.mojom.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "url/gurl.h"
 
@@ -39,6 +40,13 @@ void GetReportCallback(base::MessageLoop* loop,
   loop->QuitWhenIdle();
 }
 
+void GetApplicationStatsCallback(base::MessageLoop* loop,
+                                 Array<ApplicationStatsPtr>* stats_out,
+                                 Array<ApplicationStatsPtr> stats) {
+  *stats_out = stats.Pass();
+  loop->QuitWhenIdle();
+}
+
 class ShellTestBaseTest : public ShellTestBase {
  public:
   // Convenience helpers for use as callbacks in tests.
@@ -302,6 +310,40 @@ TEST_F(ShellTestBaseTest, ConnectManyClientsAndServices) {
   EXPECT_EQ(20U, reports[2].total_requests);
 }
 
+// Tests that the shell reports the applications it runs through
+// ApplicationStatsProvider.
+TEST_F(ShellTestBaseTest, ApplicationStats) {
+  TestServicePtr service;
+  ConnectToService(test_app_url(), &service);
+  bool was_run = false;
+  service->Ping(SetAndQuit<bool>(&was_run, true));
+  message_loop()->Run();
+  ASSERT_TRUE(was_run);
+
+  ApplicationStatsProviderPtr stats_provider;
+  ConnectToService(GURL("mojo:application_stats"), &stats_provider);
+  Array<ApplicationStatsPtr> stats;
+  stats_provider->GetApplicationStats(
+      base::Bind(&GetApplicationStatsCallback,
+                 base::Unretained(message_loop()), base::Unretained(&stats)));
+  message_loop()->Run();
+
+  // The test app (under its resolved URL) and the stats app itself, sorted by
+  // URL. Both run in the shell's process.
+  ASSERT_EQ(2u, stats.size());
+  EXPECT_LT(stats[0]->url.get(), stats[1]->url.get());
+  for (size_t i = 0; i < stats.size(); i++) {
+    EXPECT_EQ(1u, stats[i]->incoming_connections);
+    EXPECT_EQ(0u, stats[i]->outgoing_connections);
+    EXPECT_LE(0, stats[i]->uptime_seconds);
+    EXPECT_FALSE(stats[i]->out_of_process);
+    EXPECT_EQ(0u, stats[i]->messages_sent);
+    EXPECT_EQ(0u, stats[i]->bytes_received);
+  }
+  EXPECT_TRUE(stats[0]->url == "mojo:application_stats" ||
+              stats[1]->url == "mojo:application_stats");
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace shell
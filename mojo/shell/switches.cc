@@ -32,6 +32,12 @@ const char kContentHandlers[] = "content-handlers";
 // instructions.
 const char kDisableCache[] = "disable-cache";
 
+// Periodically log, for each running application, when it was started and how
+// many connections were made to and by it, plus the message traffic with it if
+// it runs in a process of its own. No memory, CPU or handle usage is reported.
+// The value is the interval between dumps, in seconds.
+const char kDumpAppStats[] = "dump-app-stats";
+
 // Allow externally-running applications to discover, connect to, and register
 // themselves with the shell.
 // TODO(cmasone): Work in progress. Once we're sure this works, remove.
@@ -65,6 +71,7 @@ const char* kSwitchArray[] = {
   kChildProcessType,
   kContentHandlers,
   kDisableCache,
+  kDumpAppStats,
   kEnableExternalApplications,
   kEnableMultiprocess,
   kHelp,
@@ -18,6 +18,7 @@ extern const char kHelp[];
 extern const char kChildProcessType[];
 extern const char kContentHandlers[];
 extern const char kDisableCache[];
+extern const char kDumpAppStats[];
 extern const char kEnableExternalApplications[];
 extern const char kEnableMultiprocess[];
 extern const char kOrigin[];
@@ -136,6 +136,19 @@ class ExpiringCache {
     return &it->second.first;
   }
 
+  // Returns the value matching |key| whether or not it has expired, and sets
+  // |*out_expiration| to when it expires. Returns NULL if the item is not
+  // found. Unlike Get(), this never removes the item from the cache.
+  const ValueType* GetIncludingExpired(const KeyType& key,
+                                       ExpirationType* out_expiration) const {
+    typename EntryMap::const_iterator it = entries_.find(key);
+    if (it == entries_.end())
+      return NULL;
+
+    *out_expiration = it->second.second;
+    return &it->second.first;
+  }
+
   // Updates or replaces the value associated with |key|.
   void Put(const KeyType& key,
            const ValueType& value,
@@ -60,6 +60,15 @@ EVENT_TYPE(HOST_RESOLVER_IMPL_IPV6_SUPPORTED)
 // This event is logged when a request is handled by a cache entry.
 EVENT_TYPE(HOST_RESOLVER_IMPL_CACHE_HIT)
 
+// This event is logged when a request is handled by a cache entry that has
+// expired, but is within the resolver's stale result window. A refresh of the
+// entry is started in the background.
+EVENT_TYPE(HOST_RESOLVER_IMPL_STALE_CACHE_HIT)
+
+// This event is logged when a request is handled by a cache entry that is
+// close to expiring, and a refresh of the entry is started in the background.
+EVENT_TYPE(HOST_RESOLVER_IMPL_CACHE_REFRESH)
+
 // This event is logged when a request is handled by a HOSTS entry.
 EVENT_TYPE(HOST_RESOLVER_IMPL_HOSTS_HIT)
 
@@ -441,6 +450,15 @@ EVENT_TYPE(SOCKS_UNKNOWN_ADDRESS_TYPE)
 // The start/end of an SSL "connect" (aka client handshake).
 EVENT_TYPE(SSL_CONNECT)
 
+// A lookup in the SSL session cache for a session to resume, at the start of
+// an SSL "connect". The following parameters are attached to the event:
+//   {
+//     "hit": <True if a cached session will be offered to the server>,
+//     "lookups": <Number of lookups made in the session cache so far>,
+//     "hits": <Number of those lookups which found a session>,
+//   }
+EVENT_TYPE(SSL_SESSION_CACHE_LOOKUP)
+
 // The start/end of an SSL server handshake (aka "accept").
 EVENT_TYPE(SSL_SERVER_HANDSHAKE)
 
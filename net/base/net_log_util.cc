@@ -383,6 +383,10 @@ NET_EXPORT scoped_ptr<base::DictionaryValue> GetNetInfo(
       cache_info_dict->SetInteger(
           "capacity",
           static_cast<int>(cache->max_entries()));
+      cache_info_dict->SetInteger("hits", static_cast<int>(cache->hits()));
+      cache_info_dict->SetInteger("stale_hits",
+                                  static_cast<int>(cache->stale_hits()));
+      cache_info_dict->SetInteger("misses", static_cast<int>(cache->misses()));
 
       base::ListValue* entry_list = new base::ListValue();
 
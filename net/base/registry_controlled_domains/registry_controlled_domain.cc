@@ -59,7 +59,8 @@ namespace registry_controlled_domains {
 namespace {
 #include "net/base/registry_controlled_domains/effective_tld_names-inc.cc"
 
-// See make_dafsa.py for documentation of the generated dafsa byte array.
+// See make_dafsa.py for documentation of the generated dafsa byte array. It is
+// generated with --reverse, so the domain names in it are reversed.
 
 const unsigned char* g_graph = kDafsa;
 size_t g_graph_length = sizeof(kDafsa);
@@ -109,22 +110,6 @@ bool IsEOL(const unsigned char* offset, const unsigned char* end) {
   return (*offset & 0x80) != 0;
 }
 
-// Check if byte at offset matches first character in key.
-// This version matches characters not last in label.
-bool IsMatch(const unsigned char* offset, const unsigned char* end,
-             const char* key) {
-  CHECK_LT(offset, end);
-  return *offset == *key;
-}
-
-// Check if byte at offset matches first character in key.
-// This version matches characters last in label.
-bool IsEndCharMatch(const unsigned char* offset, const unsigned char* end,
-                    const char* key) {
-  CHECK_LT(offset, end);
-  return *offset == (*key | 0x80);
-}
-
 // Read return value at offset.
 // Returns true if a return value could be read, false otherwise.
 bool GetReturnValue(const unsigned char* offset, const unsigned char* end,
@@ -137,67 +122,94 @@ bool GetReturnValue(const unsigned char* offset, const unsigned char* end,
   return false;
 }
 
-// Lookup a domain key in a byte array generated by make_dafsa.py.
-// The rule type is returned if key is found, otherwise kNotFound is returned.
-int LookupString(const unsigned char* graph, size_t length, const char* key,
-                 size_t key_length) {
-  const unsigned char* pos = graph;
-  const unsigned char* end = graph + length;
-  const unsigned char* offset = pos;
-  const char* key_end = key + key_length;
-  while (GetNextOffset(&pos, end, &offset)) {
-    //   char <char>+ end_char offsets
-    //   char <char>+ return value
-    //   char end_char offsets
-    //   char return value
-    //   end_char offsets
-    //   return_value
-    bool did_consume = false;
-    if (key != key_end && !IsEOL(offset, end)) {
-      // Leading <char> is not a match. Don't dive into this child
-      if (!IsMatch(offset, end, key))
-        continue;
-      did_consume = true;
-      ++offset;
-      ++key;
-      // Possible matches at this point:
-      // <char>+ end_char offsets
-      // <char>+ return value
-      // end_char offsets
-      // return value
-      // Remove all remaining <char> nodes possible
-      while (!IsEOL(offset, end) && key != key_end) {
-        if (!IsMatch(offset, end, key))
-          return kNotFound;
-        ++key;
-        ++offset;
+// Check if byte at offset is a return value rather than a label character.
+bool IsReturnValue(const unsigned char* offset, const unsigned char* end) {
+  CHECK_LT(offset, end);
+  return (*offset & 0xE0) == 0x80;
+}
+
+// Check if byte at offset matches character c, whether or not it is last in
+// its label.
+bool IsCharMatch(const unsigned char* offset, const unsigned char* end,
+                 char c) {
+  CHECK_LT(offset, end);
+  return (*offset & 0x7F) == static_cast<unsigned char>(c);
+}
+
+// Walks a byte array generated by make_dafsa.py one character at a time, so
+// that a key and all of its prefixes are looked up in a single pass. The
+// registry graph is generated from reversed domain names, so feeding a host
+// from its end finds the rules for each of its suffixes in turn.
+class IncrementalLookup {
+ public:
+  IncrementalLookup(const unsigned char* graph, size_t length)
+      : pos_(graph), end_(graph + length), pos_is_label_character_(false) {}
+
+  // Consumes |c|. Returns false if no key in the graph starts with the
+  // characters consumed so far, after which nothing else matches.
+  bool Advance(char c) {
+    if (!pos_)
+      return false;
+    // Only printable 7-bit ASCII characters are in the graph.
+    if (static_cast<unsigned char>(c) < 0x20 ||
+        static_cast<unsigned char>(c) >= 0x80) {
+      pos_ = NULL;
+      return false;
+    }
+
+    if (pos_is_label_character_) {
+      // In the middle of a label, the next character must match.
+      if (!IsReturnValue(pos_, end_) && IsCharMatch(pos_, end_, c)) {
+        pos_is_label_character_ = !IsEOL(pos_, end_);
+        ++pos_;
+        return true;
+      }
+    } else {
+      // At a list of offsets, at most one child starts with |c|.
+      const unsigned char* pos = pos_;
+      const unsigned char* offset = pos_;
+      while (GetNextOffset(&pos, end_, &offset)) {
+        if (!IsReturnValue(offset, end_) && IsCharMatch(offset, end_, c)) {
+          pos_is_label_character_ = !IsEOL(offset, end_);
+          pos_ = offset + 1;
+          return true;
+        }
       }
     }
-    // Possible matches at this point:
-    // end_char offsets
-    // return_value
-    // If one or more <char> elements were consumed, a failure
-    // to match is terminal. Otherwise, try the next node.
-    if (key == key_end) {
-      int return_value;
-      if (GetReturnValue(offset, end, &return_value))
+    pos_ = NULL;
+    return false;
+  }
+
+  // Returns the rule type if the characters consumed so far are a key in the
+  // graph, otherwise kNotFound.
+  int GetResultForCurrentSequence() const {
+    if (!pos_)
+      return kNotFound;
+    int return_value;
+    if (pos_is_label_character_) {
+      if (GetReturnValue(pos_, end_, &return_value))
         return return_value;
-      // The DAFSA guarantees that if the first char is a match, all
-      // remaining char elements MUST match if the key is truly present.
-      if (did_consume)
-        return kNotFound;
-      continue;
+      return kNotFound;
     }
-    if (!IsEndCharMatch(offset, end, key)) {
-      if (did_consume)
-        return kNotFound;  // Unexpected
-      continue;
+    const unsigned char* pos = pos_;
+    const unsigned char* offset = pos_;
+    while (GetNextOffset(&pos, end_, &offset)) {
+      if (GetReturnValue(offset, end_, &return_value))
+        return return_value;
     }
-    ++key;
-    pos = ++offset;  // Dive into child
+    return kNotFound;
   }
-  return kNotFound;  // No match
-}
+
+ private:
+  // Position of the next label character or list of offsets to read, or NULL
+  // once the characters consumed so far match nothing.
+  const unsigned char* pos_;
+  const unsigned char* const end_;
+  // Whether |pos_| is within a label rather than at a list of offsets.
+  bool pos_is_label_character_;
+
+  DISALLOW_COPY_AND_ASSIGN(IncrementalLookup);
+};
 
 size_t GetRegistryLengthImpl(
     const std::string& host,
@@ -221,64 +233,64 @@ size_t GetRegistryLengthImpl(
       return 0;  // Multiple trailing dots.
   }
 
-  // Walk up the domain tree, most specific to least specific,
-  // looking for matches at each level.
-  size_t prev_start = std::string::npos;
-  size_t curr_start = host_check_begin;
-  size_t next_dot = host.find('.', curr_start);
-  if (next_dot >= host_check_len)  // Catches std::string::npos as well.
+  if (host.find('.', host_check_begin) >= host_check_len)
     return 0;  // This can't have a registry + domain.
-  while (1) {
-    const char* domain_str = host.data() + curr_start;
-    size_t domain_length = host_check_len - curr_start;
-    int type = LookupString(g_graph, g_graph_length, domain_str, domain_length);
-    bool do_check =
-        type != kNotFound && (!(type & kPrivateRule) ||
-                              private_filter == INCLUDE_PRIVATE_REGISTRIES);
-
-    // If the apparent match is a private registry and we're not including
-    // those, it can't be an actual match.
-    if (do_check) {
-      // Exception rules override wildcard rules when the domain is an exact
-      // match, but wildcards take precedence when there's a subdomain.
-      if (type & kWildcardRule && (prev_start != std::string::npos)) {
-        // If prev_start == host_check_begin, then the host is the registry
-        // itself, so return 0.
-        return (prev_start == host_check_begin) ? 0
-                                                : (host.length() - prev_start);
-      }
 
-      if (type & kExceptionRule) {
-        if (next_dot == std::string::npos) {
-          // If we get here, we had an exception rule with no dots (e.g.
-          // "!foo").  This would only be valid if we had a corresponding
-          // wildcard rule, which would have to be "*".  But we explicitly
-          // disallow that case, so this kind of rule is invalid.
-          NOTREACHED() << "Invalid exception rule";
-          return 0;
-        }
-        return host.length() - next_dot - 1;
+  // Walk the host from its end, least specific to most specific, looking up
+  // each suffix that starts at a label boundary as it is reached. The most
+  // specific rule that applies wins.
+  IncrementalLookup lookup(g_graph, g_graph_length);
+  size_t match_start = std::string::npos;
+  int match_type = kNotFound;
+  for (size_t i = host_check_len; ; --i) {
+    if (i == host_check_begin || host[i - 1] == '.') {
+      int type = lookup.GetResultForCurrentSequence();
+      // If the apparent match is a private registry and we're not including
+      // those, it can't be an actual match.
+      if (type != kNotFound && (!(type & kPrivateRule) ||
+                                private_filter == INCLUDE_PRIVATE_REGISTRIES)) {
+        match_start = i;
+        match_type = type;
       }
-
-      // If curr_start == host_check_begin, then the host is the registry
-      // itself, so return 0.
-      return (curr_start == host_check_begin) ? 0
-                                              : (host.length() - curr_start);
     }
-
-    if (next_dot >= host_check_len)  // Catches std::string::npos as well.
+    if (i == host_check_begin || !lookup.Advance(host[i - 1]))
       break;
+  }
+
+  if (match_start == std::string::npos) {
+    // No rule found in the registry.  If we allow unknown registries, return
+    // the length of the last subcomponent of the host.
+    const size_t last_start = host.rfind('.', host_check_len - 1) + 1;
+    return unknown_filter == INCLUDE_UNKNOWN_REGISTRIES ?
+        (host.length() - last_start) : 0;
+  }
+
+  // Exception rules override wildcard rules when the domain is an exact
+  // match, but wildcards take precedence when there's a subdomain.
+  if ((match_type & kWildcardRule) && match_start != host_check_begin) {
+    // The subcomponent before the match is part of the registry.
+    const size_t prev_start = host.rfind('.', match_start - 2) + 1;
+    // If prev_start == host_check_begin, then the host is the registry
+    // itself, so return 0.
+    return (prev_start == host_check_begin) ? 0 : (host.length() - prev_start);
+  }
 
-    prev_start = curr_start;
-    curr_start = next_dot + 1;
-    next_dot = host.find('.', curr_start);
+  if (match_type & kExceptionRule) {
+    const size_t next_dot = host.find('.', match_start);
+    if (next_dot == std::string::npos) {
+      // If we get here, we had an exception rule with no dots (e.g.
+      // "!foo").  This would only be valid if we had a corresponding
+      // wildcard rule, which would have to be "*".  But we explicitly
+      // disallow that case, so this kind of rule is invalid.
+      NOTREACHED() << "Invalid exception rule";
+      return 0;
+    }
+    return host.length() - next_dot - 1;
   }
 
-  // No rule found in the registry.  curr_start now points to the first
-  // character of the last subcomponent of the host, so if we allow unknown
-  // registries, return the length of this subcomponent.
-  return unknown_filter == INCLUDE_UNKNOWN_REGISTRIES ?
-      (host.length() - curr_start) : 0;
+  // If match_start == host_check_begin, then the host is the registry itself,
+  // so return 0.
+  return (match_start == host_check_begin) ? 0 : (host.length() - match_start);
 }
 
 std::string GetDomainAndRegistryImpl(
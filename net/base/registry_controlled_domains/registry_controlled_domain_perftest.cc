@@ -0,0 +1,74 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+#include "url/gurl.h"
+
+namespace net {
+namespace registry_controlled_domains {
+
+namespace {
+
+const int kIterations = 200000;
+
+// Hosts with registries of one, two and three labels, private and wildcard
+// registries, deep subdomains and an unknown registry.
+const char* const kUrls[] = {
+    "http://www.google.com/",
+    "http://mail.google.co.uk/",
+    "http://a.b.c.d.example.blogspot.com/",
+    "http://static.ak.fbcdn.net/",
+    "http://foo.bar.baz.unknowntld/",
+    "http://en.m.wikipedia.org/",
+    "http://www.city.kawasaki.jp/",
+    "http://bucket.s3.amazonaws.com/",
+};
+
+class RegistryControlledDomainPerfTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (size_t i = 0; i < arraysize(kUrls); ++i)
+      urls_.push_back(GURL(kUrls[i]));
+  }
+
+  void PrintRate(const std::string& trace, base::TimeDelta elapsed) {
+    perf_test::PrintResult("registry_controlled_domain", "", trace,
+                           kIterations * urls_.size() / elapsed.InSecondsF(),
+                           "lookups/s", true);
+  }
+
+  std::vector<GURL> urls_;
+};
+
+TEST_F(RegistryControlledDomainPerfTest, GetDomainAndRegistry) {
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < urls_.size(); ++j)
+      GetDomainAndRegistry(urls_[j], EXCLUDE_PRIVATE_REGISTRIES);
+  }
+  PrintRate("get_domain_and_registry", base::TimeTicks::Now() - start);
+}
+
+TEST_F(RegistryControlledDomainPerfTest, SameDomainOrHost) {
+  const GURL other("http://accounts.google.com/");
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < urls_.size(); ++j)
+      SameDomainOrHost(urls_[j], other, INCLUDE_PRIVATE_REGISTRIES);
+  }
+  PrintRate("same_domain_or_host", base::TimeTicks::Now() - start);
+}
+
+}  // namespace
+
+}  // namespace registry_controlled_domains
+}  // namespace net
@@ -126,6 +126,9 @@ typedef std::vector<CanonicalCookie*> CanonicalCookieVector;
 // will update it again.
 const int kDefaultAccessUpdateThresholdSeconds = 60;
 
+// Maximum number of cookie lines kept by GetCookiesWithOptions().
+const size_t kCookieLineCacheSize = 50;
+
 // Comparator to sort cookies from highest creation date to lowest
 // creation date.
 struct OrderByCreationTimeDesc {
@@ -290,6 +293,18 @@ ChangeCausePair ChangeCauseMapping[] = {
   { CookieMonsterDelegate::CHANGE_COOKIE_EXPLICIT, false }
 };
 
+// Returns the cookie line cache key for requests to |url| with |options|. It
+// covers every input to CanonicalCookie::IncludeForRequestURL().
+std::string GetCookieLineCacheKey(const GURL& url,
+                                  const CookieOptions& options) {
+  std::string cache_key;
+  cache_key += url.SchemeIsSecure() ? 's' : '-';
+  cache_key += options.exclude_httponly() ? '-' : 'h';
+  cache_key += url.host();
+  cache_key += url.path();
+  return cache_key;
+}
+
 std::string BuildCookieLine(const CanonicalCookieVector& cookies) {
   std::string cookie_line;
   for (CanonicalCookieVector::const_iterator it = cookies.begin();
@@ -317,7 +332,8 @@ void RunAsync(scoped_refptr<base::TaskRunner> proxy,
 
 CookieMonster::CookieMonster(PersistentCookieStore* store,
                              CookieMonsterDelegate* delegate)
-    : initialized_(false),
+    : cookie_line_cache_(kCookieLineCacheSize),
+      initialized_(false),
       loaded_(store == NULL),
       store_(store),
       last_access_threshold_(
@@ -333,7 +349,8 @@ CookieMonster::CookieMonster(PersistentCookieStore* store,
 CookieMonster::CookieMonster(PersistentCookieStore* store,
                              CookieMonsterDelegate* delegate,
                              int last_access_threshold_milliseconds)
-    : initialized_(false),
+    : cookie_line_cache_(kCookieLineCacheSize),
+      initialized_(false),
       loaded_(store == NULL),
       store_(store),
       last_access_threshold_(base::TimeDelta::FromMilliseconds(
@@ -1319,15 +1336,45 @@ std::string CookieMonster::GetCookiesWithOptions(const GURL& url,
   if (!HasCookieableScheme(url))
     return std::string();
 
-  std::vector<CanonicalCookie*> cookies;
-  FindCookiesForHostAndDomain(url, options, true, &cookies);
-  std::sort(cookies.begin(), cookies.end(), CookieSorter);
-
-  std::string cookie_line = BuildCookieLine(cookies);
-
-  VLOG(kVlogGetCookies) << "GetCookies() result: " << cookie_line;
+  const std::string cache_key(GetCookieLineCacheKey(url, options));
+  CookieLineCache::iterator cached = cookie_line_cache_.Get(cache_key);
+  if (cached != cookie_line_cache_.end()) {
+    const Time current_time(CurrentTime());
+    if (current_time < cached->second.expiry) {
+      RecordPeriodicStats(current_time);
+      const CachedCookieLine& cookie_line = cached->second;
+      for (std::vector<CanonicalCookie*>::const_iterator it =
+               cookie_line.cookies.begin();
+           it != cookie_line.cookies.end(); ++it) {
+        InternalUpdateCookieAccessTime(*it, current_time);
+      }
+      VLOG(kVlogGetCookies) << "GetCookies() cached result: "
+                            << cookie_line.line;
+      return cookie_line.line;
+    }
+  }
 
-  return cookie_line;
+  CachedCookieLine cookie_line;
+  FindCookiesForHostAndDomain(url, options, true, &cookie_line.cookies);
+  std::sort(cookie_line.cookies.begin(), cookie_line.cookies.end(),
+            CookieSorter);
+  cookie_line.line = BuildCookieLine(cookie_line.cookies);
+
+  VLOG(kVlogGetCookies) << "GetCookies() result: " << cookie_line.line;
+
+  // Expired cookies are left in place rather than deleted when
+  // |keep_expired_cookies_| is set, and then expiry does not change the line.
+  cookie_line.key = GetKey(url.host());
+  cookie_line.expiry = Time::Max();
+  if (!keep_expired_cookies_) {
+    for (CookieMapItPair its = cookies_.equal_range(cookie_line.key);
+         its.first != its.second; ++its.first) {
+      const Time& expiry_date = its.first->second->ExpiryDate();
+      if (!expiry_date.is_null() && expiry_date < cookie_line.expiry)
+        cookie_line.expiry = expiry_date;
+    }
+  }
+  return cookie_line_cache_.Put(cache_key, cookie_line)->second.line;
 }
 
 void CookieMonster::DeleteCookie(const GURL& url,
@@ -1765,6 +1812,22 @@ bool CookieMonster::DeleteAnyEquivalentCookie(const std::string& key,
   return skipped_httponly;
 }
 
+CookieMonster::CachedCookieLine::CachedCookieLine() {}
+
+CookieMonster::CachedCookieLine::~CachedCookieLine() {}
+
+void CookieMonster::InvalidateCookieLinesForKey(const std::string& key) {
+  lock_.AssertAcquired();
+
+  for (CookieLineCache::iterator it = cookie_line_cache_.begin();
+       it != cookie_line_cache_.end();) {
+    if (it->second.key == key)
+      it = cookie_line_cache_.Erase(it);
+    else
+      ++it;
+  }
+}
+
 CookieMonster::CookieMap::iterator CookieMonster::InternalInsertCookie(
     const std::string& key,
     CanonicalCookie* cc,
@@ -1776,6 +1839,7 @@ CookieMonster::CookieMap::iterator CookieMonster::InternalInsertCookie(
     store_->AddCookie(*cc);
   CookieMap::iterator inserted =
       cookies_.insert(CookieMap::value_type(key, cc));
+  InvalidateCookieLinesForKey(key);
   if (delegate_.get()) {
     delegate_->OnCookieChanged(
         *cc, false, CookieMonsterDelegate::CHANGE_COOKIE_EXPLICIT);
@@ -1902,6 +1966,7 @@ void CookieMonster::InternalDeleteCookie(CookieMap::iterator it,
       delegate_->OnCookieChanged(*cc, true, mapping.cause);
   }
   RunCallbacks(*cc, true);
+  InvalidateCookieLinesForKey(it->first);
   cookies_.erase(it);
   delete cc;
 }
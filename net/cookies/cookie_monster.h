@@ -17,6 +17,7 @@
 
 #include "base/basictypes.h"
 #include "base/callback_forward.h"
+#include "base/containers/mru_cache.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/linked_ptr.h"
 #include "base/memory/ref_counted.h"
@@ -358,6 +359,9 @@ class NET_EXPORT CookieMonster : public CookieStore {
   FRIEND_TEST_ALL_PREFIXES(CookieMonsterTest, TestDomainTree);
   FRIEND_TEST_ALL_PREFIXES(CookieMonsterTest, TestImport);
   FRIEND_TEST_ALL_PREFIXES(CookieMonsterTest, GetKey);
+
+  // For the cookie line cache.
+  FRIEND_TEST_ALL_PREFIXES(CookieMonsterTest, CookieLineCache);
   FRIEND_TEST_ALL_PREFIXES(CookieMonsterTest, TestGetKey);
 
   // For FindCookiesForKey.
@@ -518,6 +522,26 @@ class NET_EXPORT CookieMonster : public CookieStore {
 
   void SetDefaultCookieableSchemes();
 
+  // A cookie line built by GetCookiesWithOptions(). It stays valid until a
+  // cookie is added to or deleted from its CookieMap key, or one of the cookies
+  // under that key expires.
+  struct CachedCookieLine {
+    CachedCookieLine();
+    ~CachedCookieLine();
+
+    // The CookieMap key the cookies in the line were found under.
+    std::string key;
+    // The cookies in the line, in the order they are listed in it.
+    std::vector<CanonicalCookie*> cookies;
+    std::string line;
+    // When the first of the cookies under |key| expires.
+    base::Time expiry;
+  };
+  typedef base::HashingMRUCache<std::string, CachedCookieLine> CookieLineCache;
+
+  // Drops the cached cookie lines built from the cookies under |key|.
+  void InvalidateCookieLinesForKey(const std::string& key);
+
   void FindCookiesForHostAndDomain(const GURL& url,
                                    const CookieOptions& options,
                                    bool update_access_time,
@@ -640,6 +664,11 @@ class NET_EXPORT CookieMonster : public CookieStore {
 
   CookieMap cookies_;
 
+  // Recently built cookie lines, keyed by everything about a request that
+  // decides which cookies it gets. Lets repeated requests to the same host and
+  // path skip filtering, sorting and joining their cookies.
+  CookieLineCache cookie_line_cache_;
+
   // Indicates whether the cookie store has been initialized. This happens
   // lazily in InitStoreIfNecessary().
   bool initialized_;
@@ -182,6 +182,42 @@ TEST_F(CookieMonsterTest, TestAddCookieOnManyHosts) {
   timer3.Done();
 }
 
+// Sets cookies on far more hosts than the jar holds, so that most of the
+// additions garbage collect, and then repeatedly queries a page worth of the
+// hosts that survive.
+TEST_F(CookieMonsterTest, TestLargeCookieJar) {
+  const int kNumLargeJarCookies = 100000;
+  const int kNumQueriedHosts = 20;
+  scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
+  std::vector<GURL> gurls;
+  for (int i = 0; i < kNumLargeJarCookies; ++i) {
+    gurls.push_back(GURL(base::StringPrintf("http://a%06d.izzle/path", i)));
+  }
+
+  SetCookieCallback setCookieCallback;
+
+  base::PerfTimeLogger timer("Cookie_monster_add_large_jar");
+  for (std::vector<GURL>::const_iterator it = gurls.begin();
+       it != gurls.end(); ++it) {
+    setCookieCallback.SetCookie(cm.get(), *it, "a=b; path=/");
+  }
+  timer.Done();
+
+  GetCookiesCallback getCookiesCallback;
+
+  base::PerfTimeLogger timer2("Cookie_monster_query_large_jar");
+  for (int i = 0; i < kNumCookies; ++i) {
+    const GURL& gurl = gurls[kNumLargeJarCookies - 1 - i % kNumQueriedHosts];
+    EXPECT_EQ("a=b", getCookiesCallback.GetCookies(cm.get(), gurl));
+  }
+  timer2.Done();
+
+  base::PerfTimeLogger timer3("Cookie_monster_deleteall_large_jar");
+  cm->DeleteAllAsync(CookieMonster::DeleteCallback());
+  base::MessageLoop::current()->RunUntilIdle();
+  timer3.Done();
+}
+
 TEST_F(CookieMonsterTest, TestDomainTree) {
   scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
   GetCookiesCallback getCookiesCallback;
@@ -1933,6 +1933,45 @@ TEST_F(CookieMonsterTest, GetKey) {
   EXPECT_EQ("localhost", cm->GetKey("localhost"));
 }
 
+TEST_F(CookieMonsterTest, CookieLineCache) {
+  scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
+  CookieOptions options;
+  options.set_include_httponly();
+
+  EXPECT_TRUE(SetCookie(cm.get(), url_google_, "A=B"));
+  EXPECT_TRUE(SetCookieWithOptions(cm.get(), url_google_, "C=D; httponly",
+                                   options));
+  EXPECT_TRUE(SetCookie(cm.get(), url_google_secure_, "E=F; secure"));
+  EXPECT_EQ("A=B", GetCookies(cm.get(), url_google_));
+  EXPECT_EQ("A=B", GetCookies(cm.get(), url_google_));
+  EXPECT_EQ(1u, cm->cookie_line_cache_.size());
+
+  // Requests that can see different cookies get lines of their own.
+  EXPECT_EQ("A=B; C=D", GetCookiesWithOptions(cm.get(), url_google_, options));
+  EXPECT_EQ("A=B; E=F", GetCookies(cm.get(), url_google_secure_));
+  EXPECT_EQ(3u, cm->cookie_line_cache_.size());
+
+  // Adding or deleting a cookie under the same key drops the lines built from
+  // it; changes to other keys leave them alone.
+  EXPECT_TRUE(SetCookie(cm.get(), GURL("http://www.example.com"), "G=H"));
+  EXPECT_EQ(3u, cm->cookie_line_cache_.size());
+  EXPECT_TRUE(SetCookie(cm.get(), url_google_foo_, "I=J; domain=google.izzle"));
+  EXPECT_EQ(0u, cm->cookie_line_cache_.size());
+  EXPECT_EQ("A=B; I=J", GetCookies(cm.get(), url_google_));
+  DeleteCookie(cm.get(), url_google_, "A");
+  EXPECT_EQ("I=J", GetCookies(cm.get(), url_google_));
+
+  // A cookie that expires is dropped from the line once it does.
+  EXPECT_TRUE(SetCookieWithDetails(
+      cm.get(), url_google_, "K", "L", std::string(), "/",
+      base::Time::Now() + base::TimeDelta::FromMilliseconds(kAccessDelayMs),
+      false, false, COOKIE_PRIORITY_DEFAULT));
+  EXPECT_EQ("I=J; K=L", GetCookies(cm.get(), url_google_));
+  base::PlatformThread::Sleep(
+      base::TimeDelta::FromMilliseconds(2 * kAccessDelayMs));
+  EXPECT_EQ("I=J", GetCookies(cm.get(), url_google_));
+}
+
 // Test that cookies transfer from/to the backing store correctly.
 TEST_F(CookieMonsterTest, BackingStoreCommunication) {
   // Store details for cookies transforming through the backing store interface.
@@ -8,6 +8,7 @@
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/hash.h"
+#include "base/rand_util.h"
 #include "base/strings/string_util.h"
 #include "base/test/perf_time_logger.h"
 #include "base/test/test_file_util.h"
@@ -21,6 +22,10 @@
 #include "net/disk_cache/disk_cache.h"
 #include "net/disk_cache/disk_cache_test_base.h"
 #include "net/disk_cache/disk_cache_test_util.h"
+#include "net/disk_cache/simple/simple_index.h"
+#include "net/disk_cache/simple/simple_index_file.h"
+#include "net/disk_cache/simple/simple_index_snapshot.h"
+#include "net/disk_cache/simple/simple_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
 
@@ -143,6 +148,14 @@ int BlockSize() {
   return (rand() & 0x3) + 1;
 }
 
+void OnSnapshotReady(
+    base::PerfTimeLogger* timer,
+    scoped_refptr<disk_cache::SimpleIndexSnapshot>* out_snapshot,
+    const scoped_refptr<disk_cache::SimpleIndexSnapshot>& snapshot) {
+  timer->Done();
+  *out_snapshot = snapshot;
+}
+
 }  // namespace
 
 TEST_F(DiskCacheTest, Hash) {
@@ -217,6 +230,65 @@ TEST_F(DiskCacheTest, CacheBackendPerformance) {
   base::MessageLoop::current()->RunUntilIdle();
 }
 
+// Loading the simple cache index must not hold up the first requests to a
+// large cache. This test measures how long an index of a million entries
+// takes to be usable for lookups, and to be fully loaded in memory.
+TEST_F(DiskCacheTest, SimpleIndexLoadPerformance) {
+  base::Thread cache_thread("CacheThread");
+  ASSERT_TRUE(cache_thread.StartWithOptions(
+                  base::Thread::Options(base::MessageLoop::TYPE_IO, 0)));
+  ASSERT_TRUE(CleanupCacheDir());
+
+  const int kNumEntries = 1000000;
+  disk_cache::SimpleIndex::EntrySet entries;
+  for (int i = 0; i < kNumEntries; i++) {
+    disk_cache::SimpleIndex::InsertInEntrySet(
+        base::RandUint64(),
+        disk_cache::EntryMetadata(Time::Now(), rand() % kMaxSize),
+        &entries);
+  }
+
+  disk_cache::SimpleIndexFile index_file(cache_thread.task_runner(),
+                                         cache_thread.task_runner(),
+                                         net::DISK_CACHE,
+                                         cache_path_);
+  net::TestClosure closure;
+  base::PerfTimeLogger write_timer("Write simple cache index");
+  index_file.WriteToDisk(entries, 0, base::TimeTicks::Now(), false,
+                         closure.closure());
+  closure.WaitForResult();
+  write_timer.Done();
+
+  ASSERT_TRUE(base::EvictFileFromSystemCache(
+              cache_path_.AppendASCII("index-dir")
+                  .AppendASCII("the-real-index")));
+  Time cache_mtime;
+  ASSERT_TRUE(disk_cache::simple_util::GetMTime(cache_path_, &cache_mtime));
+
+  disk_cache::SimpleIndexLoadResult load_result;
+  scoped_refptr<disk_cache::SimpleIndexSnapshot> snapshot;
+  base::PerfTimeLogger snapshot_timer("Map simple cache index (cold)");
+  base::PerfTimeLogger load_timer("Load simple cache index (cold)");
+  index_file.LoadIndexEntries(
+      cache_mtime, base::Bind(&OnSnapshotReady, &snapshot_timer, &snapshot),
+      closure.closure(), &load_result);
+  closure.WaitForResult();
+  load_timer.Done();
+
+  ASSERT_TRUE(snapshot.get());
+  EXPECT_EQ(entries.size(), load_result.entries.size());
+
+  base::PerfTimeLogger lookup_timer("Look up simple cache index snapshot");
+  size_t found = 0;
+  for (disk_cache::SimpleIndex::EntrySet::const_iterator it = entries.begin();
+       it != entries.end(); ++it) {
+    if (snapshot->Find(it->first, NULL))
+      found++;
+  }
+  lookup_timer.Done();
+  EXPECT_EQ(entries.size(), found);
+}
+
 // Creating and deleting "entries" on a block-file is something quite frequent
 // (after all, almost everything is stored on block files). The operation is
 // almost free when the file is empty, but can be expensive if the file gets
@@ -28,6 +28,7 @@
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index_delegate.h"
 #include "net/disk_cache/simple/simple_index_file.h"
+#include "net/disk_cache/simple/simple_index_snapshot.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_util.h"
 
@@ -152,6 +153,7 @@ SimpleIndex::SimpleIndex(
 
 SimpleIndex::~SimpleIndex() {
   DCHECK(io_thread_checker_.CalledOnValidThread());
+  index_file_->ReleaseSnapshotSoon(&snapshot_);
 
   // Fail all callbacks waiting for the index to come up.
   for (CallbackList::iterator it = to_run_when_initialized_.begin(),
@@ -176,7 +178,9 @@ void SimpleIndex::Initialize(base::Time cache_mtime) {
       &SimpleIndex::MergeInitializingSet,
       AsWeakPtr(),
       base::Passed(&load_result_scoped));
-  index_file_->LoadIndexEntries(cache_mtime, reply, load_result);
+  index_file_->LoadIndexEntries(
+      cache_mtime, base::Bind(&SimpleIndex::SetSnapshot, AsWeakPtr()), reply,
+      load_result);
 }
 
 bool SimpleIndex::SetMaxSize(int max_bytes) {
@@ -231,7 +235,9 @@ scoped_ptr<SimpleIndex::HashList> SimpleIndex::GetAllHashes() {
 }
 
 int32 SimpleIndex::GetEntryCount() const {
-  // TODO(pasko): return a meaningful initial estimate before initialized.
+  // Before initialization, the index file gives an estimate if it is fresh.
+  if (!initialized_ && snapshot_.get())
+    return static_cast<int32>(snapshot_->size());
   return entries_set_.size();
 }
 
@@ -262,8 +268,14 @@ void SimpleIndex::Remove(uint64 entry_hash) {
 
 bool SimpleIndex::Has(uint64 hash) const {
   DCHECK(io_thread_checker_.CalledOnValidThread());
-  // If not initialized, always return true, forcing it to go to the disk.
-  return !initialized_ || entries_set_.count(hash) > 0;
+  if (entries_set_.count(hash) > 0)
+    return true;
+  if (initialized_)
+    return false;
+  // If not initialized, return true, forcing it to go to the disk, unless the
+  // snapshot of the index file says the entry does not exist.
+  return !snapshot_.get() || removed_entries_.count(hash) > 0 ||
+         snapshot_->Find(hash, NULL);
 }
 
 bool SimpleIndex::UseIfExists(uint64 entry_hash) {
@@ -271,9 +283,23 @@ bool SimpleIndex::UseIfExists(uint64 entry_hash) {
   // Always update the last used time, even if it is during initialization.
   // It will be merged later.
   EntrySet::iterator it = entries_set_.find(entry_hash);
-  if (it == entries_set_.end())
-    // If not initialized, always return true, forcing it to go to the disk.
-    return !initialized_;
+  if (it == entries_set_.end()) {
+    if (initialized_)
+      return false;
+    // If not initialized, return true, forcing it to go to the disk, unless the
+    // snapshot of the index file says the entry does not exist.
+    if (!snapshot_.get() || removed_entries_.count(entry_hash) > 0)
+      return true;
+    EntryMetadata entry_metadata;
+    if (!snapshot_->Find(entry_hash, &entry_metadata))
+      return false;
+    // Entries in |entries_set_| take precedence over the index file when the
+    // two are merged, so the use is recorded there.
+    entry_metadata.SetLastUsedTime(base::Time::Now());
+    InsertInEntrySet(entry_hash, entry_metadata, &entries_set_);
+    cache_size_ += entry_metadata.GetEntrySize();
+    return true;
+  }
   it->second.SetLastUsedTime(base::Time::Now());
   PostponeWritingToDisk();
   return true;
@@ -383,10 +409,19 @@ void SimpleIndex::UpdateEntryIteratorSize(EntrySet::iterator* it,
   (*it)->second.SetEntrySize(entry_size);
 }
 
+void SimpleIndex::SetSnapshot(
+    const scoped_refptr<SimpleIndexSnapshot>& snapshot) {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
+  DCHECK(snapshot->searchable());
+  if (!initialized_)
+    snapshot_ = snapshot;
+}
+
 void SimpleIndex::MergeInitializingSet(
     scoped_ptr<SimpleIndexLoadResult> load_result) {
   DCHECK(io_thread_checker_.CalledOnValidThread());
   DCHECK(load_result->did_load);
+  index_file_->ReleaseSnapshotSoon(&snapshot_);
 
   EntrySet* index_file_entries = &load_result->entries;
 
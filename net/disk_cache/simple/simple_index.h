@@ -35,6 +35,7 @@ namespace disk_cache {
 
 class SimpleIndexDelegate;
 class SimpleIndexFile;
+class SimpleIndexSnapshot;
 struct SimpleIndexLoadResult;
 
 class NET_EXPORT_PRIVATE EntryMetadata {
@@ -145,6 +146,9 @@ class NET_EXPORT_PRIVATE SimpleIndex
 
   void UpdateEntryIteratorSize(EntrySet::iterator* it, int entry_size);
 
+  // Must run on IO Thread.
+  void SetSnapshot(const scoped_refptr<SimpleIndexSnapshot>& snapshot);
+
   // Must run on IO Thread.
   void MergeInitializingSet(scoped_ptr<SimpleIndexLoadResult> load_result);
 
@@ -172,6 +176,10 @@ class NET_EXPORT_PRIVATE SimpleIndex
   base::hash_set<uint64> removed_entries_;
   bool initialized_;
 
+  // The entries of a fresh index file, used to answer lookups until the index
+  // is initialized.
+  scoped_refptr<SimpleIndexSnapshot> snapshot_;
+
   scoped_ptr<SimpleIndexFile> index_file_;
 
   scoped_refptr<base::SingleThreadTaskRunner> io_thread_;
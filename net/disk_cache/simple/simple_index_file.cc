@@ -4,8 +4,13 @@
 
 #include "net/disk_cache/simple/simple_index_file.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
 #include <vector>
 
+#include "base/bind.h"
 #include "base/files/file.h"
 #include "base/files/file_util.h"
 #include "base/files/memory_mapped_file.h"
@@ -14,11 +19,13 @@
 #include "base/pickle.h"
 #include "base/single_thread_task_runner.h"
 #include "base/task_runner_util.h"
+#include "base/thread_task_runner_handle.h"
 #include "base/threading/thread_restrictions.h"
 #include "net/disk_cache/simple/simple_backend_version.h"
 #include "net/disk_cache/simple/simple_entry_format.h"
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index.h"
+#include "net/disk_cache/simple/simple_index_snapshot.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "third_party/zlib/zlib.h"
@@ -68,6 +75,57 @@ void UmaRecordIndexInitMethod(IndexInitMethod method,
                    method, INITIALIZE_METHOD_MAX);
 }
 
+// The layout of one entry of the index file, as written by
+// SimpleIndexFile::Serialize().
+struct EntryRecord {
+  uint64 entry_hash;
+  int64 last_used_time;
+  uint64 entry_size;
+};
+COMPILE_ASSERT(sizeof(EntryRecord) == SimpleIndexSnapshot::kRecordSize,
+               entry_record_size);
+
+bool CompareEntryRecordHashes(const EntryRecord& a, const EntryRecord& b) {
+  return a.entry_hash < b.entry_hash;
+}
+
+// Sorts the |entry_count| records at |records| by entry hash. The records are
+// only aligned to 32 bits within the pickle, so they are sorted in a copy.
+void SortEntryRecords(char* records, size_t entry_count) {
+  if (entry_count == 0)
+    return;
+  std::vector<EntryRecord> sorted_records(entry_count);
+  memcpy(&sorted_records.front(), records, entry_count * sizeof(EntryRecord));
+  std::sort(sorted_records.begin(), sorted_records.end(),
+            CompareEntryRecordHashes);
+  memcpy(records, &sorted_records.front(), entry_count * sizeof(EntryRecord));
+}
+
+// Runs |snapshot_callback| with |snapshot|, then hands the reference taken by
+// PostSnapshot() to |cache_thread|. The callback does not run if the index is
+// gone, and the last reference must not be dropped here: it unmaps the file.
+void RunSnapshotCallback(
+    const scoped_refptr<base::SingleThreadTaskRunner>& cache_thread,
+    const SimpleIndexFile::SnapshotCallback& snapshot_callback,
+    SimpleIndexSnapshot* snapshot) {
+  snapshot_callback.Run(make_scoped_refptr(snapshot));
+  cache_thread->ReleaseSoon(FROM_HERE, snapshot);
+}
+
+// Posts |snapshot_callback| to |task_runner| with |snapshot|.
+void PostSnapshot(
+    const scoped_refptr<base::SingleThreadTaskRunner>& task_runner,
+    const scoped_refptr<base::SingleThreadTaskRunner>& cache_thread,
+    const SimpleIndexFile::SnapshotCallback& snapshot_callback,
+    const scoped_refptr<SimpleIndexSnapshot>& snapshot) {
+  // Released by RunSnapshotCallback().
+  snapshot->AddRef();
+  task_runner->PostTask(FROM_HERE,
+                        base::Bind(&RunSnapshotCallback, cache_thread,
+                                   snapshot_callback,
+                                   base::Unretained(snapshot.get())));
+}
+
 bool WritePickleFile(Pickle* pickle, const base::FilePath& file_name) {
   File file(
       file_name,
@@ -177,6 +235,20 @@ void SimpleIndexFile::IndexMetadata::Serialize(Pickle* pickle) const {
 // static
 bool SimpleIndexFile::SerializeFinalData(base::Time cache_modified,
                                          Pickle* pickle) {
+  PickleIterator pickle_it(*pickle);
+  IndexMetadata index_metadata;
+  const char* records = NULL;
+  if (!index_metadata.Deserialize(&pickle_it) ||
+      !pickle_it.ReadBytes(
+          &records,
+          static_cast<int>(index_metadata.GetNumberOfEntries() *
+                           SimpleIndexSnapshot::kRecordSize))) {
+    return false;
+  }
+  // The records point into |pickle|, which is ours to modify.
+  SortEntryRecords(const_cast<char*>(records),
+                   index_metadata.GetNumberOfEntries());
+
   if (!pickle->WriteInt64(cache_modified.ToInternalValue()))
     return false;
   SimpleIndexFile::PickleHeader* header_p = pickle->headerT<PickleHeader>();
@@ -265,16 +337,33 @@ SimpleIndexFile::SimpleIndexFile(
 
 SimpleIndexFile::~SimpleIndexFile() {}
 
-void SimpleIndexFile::LoadIndexEntries(base::Time cache_last_modified,
-                                       const base::Closure& callback,
-                                       SimpleIndexLoadResult* out_result) {
+void SimpleIndexFile::LoadIndexEntries(
+    base::Time cache_last_modified,
+    const SnapshotCallback& snapshot_callback,
+    const base::Closure& callback,
+    SimpleIndexLoadResult* out_result) {
+  SnapshotCallback post_snapshot;
+  if (!snapshot_callback.is_null()) {
+    post_snapshot = base::Bind(&PostSnapshot,
+                               base::ThreadTaskRunnerHandle::Get(),
+                               cache_thread_, snapshot_callback);
+  }
   base::Closure task = base::Bind(&SimpleIndexFile::SyncLoadIndexEntries,
                                   cache_type_,
                                   cache_last_modified, cache_directory_,
-                                  index_file_, out_result);
+                                  index_file_, post_snapshot, out_result);
   worker_pool_->PostTaskAndReply(FROM_HERE, task, callback);
 }
 
+void SimpleIndexFile::ReleaseSnapshotSoon(
+    scoped_refptr<SimpleIndexSnapshot>* snapshot) {
+  // Take over the reference without releasing it on this thread.
+  SimpleIndexSnapshot* raw_snapshot = NULL;
+  snapshot->swap(&raw_snapshot);
+  if (raw_snapshot)
+    cache_thread_->ReleaseSoon(FROM_HERE, raw_snapshot);
+}
+
 void SimpleIndexFile::WriteToDisk(const SimpleIndex::EntrySet& entry_set,
                                   uint64 cache_size,
                                   const base::TimeTicks& start,
@@ -298,14 +387,18 @@ void SimpleIndexFile::SyncLoadIndexEntries(
     base::Time cache_last_modified,
     const base::FilePath& cache_directory,
     const base::FilePath& index_file_path,
+    const SnapshotCallback& snapshot_callback,
     SimpleIndexLoadResult* out_result) {
+  out_result->Reset();
+
   // Load the index and find its age.
   base::Time last_cache_seen_by_index;
-  SyncLoadFromDisk(index_file_path, &last_cache_seen_by_index, out_result);
+  scoped_refptr<SimpleIndexSnapshot> snapshot =
+      SyncLoadFromDisk(index_file_path, &last_cache_seen_by_index);
 
   // Consider the index loaded if it is fresh.
   const bool index_file_existed = base::PathExists(index_file_path);
-  if (!out_result->did_load) {
+  if (!snapshot.get()) {
     if (index_file_existed)
       UmaRecordIndexFileState(INDEX_STATE_CORRUPT, cache_type);
   } else {
@@ -319,6 +412,11 @@ void SimpleIndexFile::SyncLoadIndexEntries(
         UmaRecordIndexFileState(INDEX_STATE_FRESH, cache_type);
       }
       UmaRecordIndexInitMethod(INITIALIZE_METHOD_LOADED, cache_type);
+
+      // The snapshot can answer lookups while the EntrySet is built from it.
+      if (snapshot->searchable() && !snapshot_callback.is_null())
+        snapshot_callback.Run(snapshot);
+      CopySnapshotToLoadResult(*snapshot, out_result);
       return;
     }
     UmaRecordIndexFileState(INDEX_STATE_STALE, cache_type);
@@ -342,30 +440,47 @@ void SimpleIndexFile::SyncLoadIndexEntries(
 }
 
 // static
-void SimpleIndexFile::SyncLoadFromDisk(const base::FilePath& index_filename,
-                                       base::Time* out_last_cache_seen_by_index,
-                                       SimpleIndexLoadResult* out_result) {
-  out_result->Reset();
-
+scoped_refptr<SimpleIndexSnapshot> SimpleIndexFile::SyncLoadFromDisk(
+    const base::FilePath& index_filename,
+    base::Time* out_last_cache_seen_by_index) {
   File file(index_filename,
             File::FLAG_OPEN | File::FLAG_READ | File::FLAG_SHARE_DELETE);
   if (!file.IsValid())
-    return;
+    return NULL;
 
-  base::MemoryMappedFile index_file_map;
-  if (!index_file_map.Initialize(file.Pass())) {
+  scoped_ptr<base::MemoryMappedFile> index_file_map(
+      new base::MemoryMappedFile());
+  if (!index_file_map->Initialize(file.Pass())) {
     simple_util::SimpleCacheDeleteFile(index_filename);
-    return;
+    return NULL;
   }
 
-  SimpleIndexFile::Deserialize(
-      reinterpret_cast<const char*>(index_file_map.data()),
-      index_file_map.length(),
-      out_last_cache_seen_by_index,
-      out_result);
-
-  if (!out_result->did_load)
+  const char* records = NULL;
+  size_t entry_count = 0;
+  if (!ParseIndexFile(reinterpret_cast<const char*>(index_file_map->data()),
+                      index_file_map->length(),
+                      out_last_cache_seen_by_index,
+                      &records,
+                      &entry_count)) {
     simple_util::SimpleCacheDeleteFile(index_filename);
+    return NULL;
+  }
+
+  return SimpleIndexSnapshot::Create(index_file_map.Pass(), records,
+                                     entry_count);
+}
+
+// static
+void SimpleIndexFile::CopySnapshotToLoadResult(
+    const SimpleIndexSnapshot& snapshot,
+    SimpleIndexLoadResult* out_result) {
+  out_result->Reset();
+#if !defined(OS_WIN)
+  // TODO(gavinp): Consider using std::unordered_map.
+  out_result->entries.resize(snapshot.size() + kExtraSizeForMerge);
+#endif
+  snapshot.CopyToEntrySet(&out_result->entries);
+  out_result->did_load = true;
 }
 
 // static
@@ -384,18 +499,16 @@ scoped_ptr<Pickle> SimpleIndexFile::Serialize(
 }
 
 // static
-void SimpleIndexFile::Deserialize(const char* data, int data_len,
-                                  base::Time* out_cache_last_modified,
-                                  SimpleIndexLoadResult* out_result) {
+bool SimpleIndexFile::ParseIndexFile(const char* data, int data_len,
+                                     base::Time* out_cache_last_modified,
+                                     const char** out_records,
+                                     size_t* out_entry_count) {
   DCHECK(data);
 
-  out_result->Reset();
-  SimpleIndex::EntrySet* entries = &out_result->entries;
-
   Pickle pickle(data, data_len);
   if (!pickle.data()) {
     LOG(WARNING) << "Corrupt Simple Index File.";
-    return;
+    return false;
   }
 
   PickleIterator pickle_it(pickle);
@@ -406,45 +519,57 @@ void SimpleIndexFile::Deserialize(const char* data, int data_len,
 
   if (crc_read != crc_calculated) {
     LOG(WARNING) << "Invalid CRC in Simple Index file.";
-    return;
+    return false;
   }
 
   SimpleIndexFile::IndexMetadata index_metadata;
   if (!index_metadata.Deserialize(&pickle_it)) {
     LOG(ERROR) << "Invalid index_metadata on Simple Cache Index.";
-    return;
+    return false;
   }
 
   if (!index_metadata.CheckIndexMetadata()) {
     LOG(ERROR) << "Invalid index_metadata on Simple Cache Index.";
-    return;
+    return false;
   }
 
-#if !defined(OS_WIN)
-  // TODO(gavinp): Consider using std::unordered_map.
-  entries->resize(index_metadata.GetNumberOfEntries() + kExtraSizeForMerge);
-#endif
-  while (entries->size() < index_metadata.GetNumberOfEntries()) {
-    uint64 hash_key;
-    EntryMetadata entry_metadata;
-    if (!pickle_it.ReadUInt64(&hash_key) ||
-        !entry_metadata.Deserialize(&pickle_it)) {
-      LOG(WARNING) << "Invalid EntryMetadata in Simple Index file.";
-      entries->clear();
-      return;
-    }
-    SimpleIndex::InsertInEntrySet(hash_key, entry_metadata, entries);
+  // The records are used in place, so they must all be present.
+  const uint64 entry_count = index_metadata.GetNumberOfEntries();
+  if (entry_count > static_cast<uint64>(std::numeric_limits<int>::max()) /
+                        SimpleIndexSnapshot::kRecordSize ||
+      !pickle_it.ReadBytes(out_records,
+                           static_cast<int>(entry_count *
+                                            SimpleIndexSnapshot::kRecordSize))) {
+    LOG(WARNING) << "Invalid EntryMetadata in Simple Index file.";
+    return false;
   }
 
   int64 cache_last_modified;
-  if (!pickle_it.ReadInt64(&cache_last_modified)) {
-    entries->clear();
-    return;
-  }
+  if (!pickle_it.ReadInt64(&cache_last_modified))
+    return false;
   DCHECK(out_cache_last_modified);
   *out_cache_last_modified = base::Time::FromInternalValue(cache_last_modified);
+  *out_entry_count = entry_count;
+  return true;
+}
 
-  out_result->did_load = true;
+// static
+void SimpleIndexFile::Deserialize(const char* data, int data_len,
+                                  base::Time* out_cache_last_modified,
+                                  SimpleIndexLoadResult* out_result) {
+  out_result->Reset();
+
+  const char* records = NULL;
+  size_t entry_count = 0;
+  if (!ParseIndexFile(data, data_len, out_cache_last_modified, &records,
+                      &entry_count)) {
+    return;
+  }
+
+  // |data| outlives the snapshot, which does not need to own it.
+  scoped_refptr<SimpleIndexSnapshot> snapshot = SimpleIndexSnapshot::Create(
+      scoped_ptr<base::MemoryMappedFile>(), records, entry_count);
+  CopySnapshotToLoadResult(*snapshot, out_result);
 }
 
 // static
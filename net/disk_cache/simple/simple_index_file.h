@@ -9,10 +9,12 @@
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/callback.h"
 #include "base/containers/hash_tables.h"
 #include "base/files/file_path.h"
 #include "base/gtest_prod_util.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/pickle.h"
 #include "base/port.h"
@@ -27,6 +29,8 @@ class TaskRunner;
 
 namespace disk_cache {
 
+class SimpleIndexSnapshot;
+
 const uint64 kSimpleIndexMagicNumber = GG_UINT64_C(0x656e74657220796f);
 
 struct NET_EXPORT_PRIVATE SimpleIndexLoadResult {
@@ -44,7 +48,9 @@ struct NET_EXPORT_PRIVATE SimpleIndexLoadResult {
 // serialized |IndexMetadata| followed serialized |EntryMetadata| entries
 // repeated |number_of_entries| amount of times. To know more about the format,
 // see SimpleIndexFile::Serialize() and SeeSimpleIndexFile::LoadFromDisk()
-// methods.
+// methods. Each entry is a fixed size record, and the records are written in
+// increasing order of entry hash so that a loaded index file can be searched
+// in place through a SimpleIndexSnapshot.
 //
 // The non-static methods must run on the IO thread. All the real
 // work is done in the static methods, which are run on the cache thread
@@ -74,6 +80,9 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
     uint64 cache_size_;  // Total cache storage size in bytes.
   };
 
+  typedef base::Callback<void(const scoped_refptr<SimpleIndexSnapshot>&)>
+      SnapshotCallback;
+
   SimpleIndexFile(
       const scoped_refptr<base::SingleThreadTaskRunner>& cache_thread,
       const scoped_refptr<base::TaskRunner>& worker_pool,
@@ -81,11 +90,19 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
       const base::FilePath& cache_directory);
   virtual ~SimpleIndexFile();
 
-  // Get index entries based on current disk context.
+  // Get index entries based on current disk context. If the index file is
+  // fresh, |snapshot_callback| is run on the calling thread with a snapshot of
+  // its entries before |callback|, as soon as the file is mapped and verified
+  // and while |out_result| is still being filled in.
   virtual void LoadIndexEntries(base::Time cache_last_modified,
+                                const SnapshotCallback& snapshot_callback,
                                 const base::Closure& callback,
                                 SimpleIndexLoadResult* out_result);
 
+  // Clears |snapshot| and releases its reference on the cache thread. The last
+  // reference to a snapshot unmaps the index file, which is blocking I/O.
+  void ReleaseSnapshotSoon(scoped_refptr<SimpleIndexSnapshot>* snapshot);
+
   // Write the specified set of entries to disk.
   virtual void WriteToDisk(const SimpleIndex::EntrySet& entry_set,
                            uint64 cache_size,
@@ -108,12 +125,18 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
                                    base::Time cache_last_modified,
                                    const base::FilePath& cache_directory,
                                    const base::FilePath& index_file_path,
+                                   const SnapshotCallback& snapshot_callback,
                                    SimpleIndexLoadResult* out_result);
 
-  // Load the index file from disk returning an EntrySet.
-  static void SyncLoadFromDisk(const base::FilePath& index_filename,
-                               base::Time* out_last_cache_seen_by_index,
-                               SimpleIndexLoadResult* out_result);
+  // Maps the index file and verifies it, returning a snapshot of its entries
+  // or NULL if the file is missing or corrupt.
+  static scoped_refptr<SimpleIndexSnapshot> SyncLoadFromDisk(
+      const base::FilePath& index_filename,
+      base::Time* out_last_cache_seen_by_index);
+
+  // Fills |out_result| with the entries of |snapshot|.
+  static void CopySnapshotToLoadResult(const SimpleIndexSnapshot& snapshot,
+                                       SimpleIndexLoadResult* out_result);
 
   // Returns a scoped_ptr for a newly allocated Pickle containing the serialized
   // data to be written to a file. Note: the pickle is not in a consistent state
@@ -123,12 +146,21 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
       const SimpleIndexFile::IndexMetadata& index_metadata,
       const SimpleIndex::EntrySet& entries);
 
-  // Appends cache modification time data to the serialized format. This is
-  // performed on a thread accessing the disk. It is not combined with the main
-  // serialization path to avoid extra thread hops or copying the pickle to the
-  // worker thread.
+  // Sorts the entry records by hash and appends cache modification time data
+  // to the serialized format. This is performed on a thread accessing the disk.
+  // It is not combined with the main serialization path to avoid extra thread
+  // hops or copying the pickle to the worker thread, and to keep the sort off
+  // the IO thread.
   static bool SerializeFinalData(base::Time cache_modified, Pickle* pickle);
 
+  // Checks the CRC and metadata of the index file |data| of length |data_len|
+  // and finds its |out_entry_count| records, which start at |out_records| and
+  // are SimpleIndexSnapshot::kRecordSize bytes each. Returns false on error.
+  static bool ParseIndexFile(const char* data, int data_len,
+                             base::Time* out_cache_last_modified,
+                             const char** out_records,
+                             size_t* out_entry_count);
+
   // Given the contents of an index file |data| of length |data_len|, returns
   // the corresponding EntrySet. Returns NULL on error.
   static void Deserialize(const char* data, int data_len,
@@ -2,8 +2,10 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/bind.h"
 #include "base/files/file.h"
 #include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/hash.h"
 #include "base/logging.h"
@@ -22,6 +24,7 @@
 #include "net/disk_cache/simple/simple_entry_format.h"
 #include "net/disk_cache/simple/simple_index.h"
 #include "net/disk_cache/simple/simple_index_file.h"
+#include "net/disk_cache/simple/simple_index_snapshot.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "net/disk_cache/simple/simple_version_upgrade.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -32,6 +35,15 @@ using disk_cache::SimpleIndex;
 
 namespace disk_cache {
 
+namespace {
+
+void SaveSnapshot(scoped_refptr<SimpleIndexSnapshot>* out_snapshot,
+                  const scoped_refptr<SimpleIndexSnapshot>& snapshot) {
+  *out_snapshot = snapshot;
+}
+
+}  // namespace
+
 // The Simple Cache backend requires a few guarantees from the filesystem like
 // atomic renaming of recently open files. Those guarantees are not provided in
 // general on Windows.
@@ -71,6 +83,7 @@ class WrappedSimpleIndexFile : public SimpleIndexFile {
  public:
   using SimpleIndexFile::Deserialize;
   using SimpleIndexFile::LegacyIsIndexFileStale;
+  using SimpleIndexFile::ParseIndexFile;
   using SimpleIndexFile::Serialize;
   using SimpleIndexFile::SerializeFinalData;
 
@@ -137,6 +150,68 @@ TEST_F(SimpleIndexFileTest, Serialize) {
   }
 }
 
+TEST_F(SimpleIndexFileTest, SerializeSortsEntries) {
+  SimpleIndex::EntrySet entries;
+  const size_t kNumHashes = 1000;
+  for (size_t i = 0; i < kNumHashes; ++i) {
+    SimpleIndex::InsertInEntrySet(
+        simple_util::GetEntryHashKey(base::StringPrintf("key%d",
+                                                        static_cast<int>(i))),
+        EntryMetadata(Time::Now(), i), &entries);
+  }
+
+  SimpleIndexFile::IndexMetadata index_metadata(entries.size(), 456);
+  scoped_ptr<Pickle> pickle = WrappedSimpleIndexFile::Serialize(
+      index_metadata, entries);
+  EXPECT_TRUE(WrappedSimpleIndexFile::SerializeFinalData(Time::Now(),
+                                                         pickle.get()));
+
+  base::Time when_index_last_saw_cache;
+  const char* records = NULL;
+  size_t entry_count = 0;
+  ASSERT_TRUE(WrappedSimpleIndexFile::ParseIndexFile(
+      static_cast<const char*>(pickle->data()), pickle->size(),
+      &when_index_last_saw_cache, &records, &entry_count));
+  EXPECT_EQ(kNumHashes, entry_count);
+
+  scoped_refptr<SimpleIndexSnapshot> snapshot = SimpleIndexSnapshot::Create(
+      scoped_ptr<base::MemoryMappedFile>(), records, entry_count);
+  ASSERT_TRUE(snapshot->searchable());
+  for (SimpleIndex::EntrySet::const_iterator it = entries.begin();
+       it != entries.end(); ++it) {
+    EntryMetadata entry_metadata;
+    EXPECT_TRUE(snapshot->Find(it->first, &entry_metadata));
+    EXPECT_TRUE(CompareTwoEntryMetadata(it->second, entry_metadata));
+  }
+  EXPECT_FALSE(snapshot->Find(simple_util::GetEntryHashKey("missing"), NULL));
+}
+
+// Index files written before the entries were sorted still load, but can not
+// be searched in place.
+TEST_F(SimpleIndexFileTest, SnapshotOfUnsortedRecords) {
+  static const uint64 kHashes[] = { 33, 11, 22 };
+  Pickle records;
+  for (size_t i = 0; i < arraysize(kHashes); ++i) {
+    records.WriteUInt64(kHashes[i]);
+    EntryMetadata(Time(), kHashes[i]).Serialize(&records);
+  }
+
+  scoped_refptr<SimpleIndexSnapshot> snapshot = SimpleIndexSnapshot::Create(
+      scoped_ptr<base::MemoryMappedFile>(), records.payload(),
+      arraysize(kHashes));
+  EXPECT_FALSE(snapshot->searchable());
+  EXPECT_EQ(arraysize(kHashes), snapshot->size());
+
+  SimpleIndex::EntrySet entries;
+  snapshot->CopyToEntrySet(&entries);
+  EXPECT_EQ(arraysize(kHashes), entries.size());
+  for (size_t i = 0; i < arraysize(kHashes); ++i) {
+    SimpleIndex::EntrySet::iterator it = entries.find(kHashes[i]);
+    ASSERT_TRUE(entries.end() != it);
+    EXPECT_EQ(static_cast<int>(kHashes[i]), it->second.GetEntrySize());
+  }
+}
+
 TEST_F(SimpleIndexFileTest, LegacyIsIndexFileStale) {
   base::ScopedTempDir cache_dir;
   ASSERT_TRUE(cache_dir.CreateUniqueTempDir());
@@ -198,8 +273,10 @@ TEST_F(SimpleIndexFileTest, WriteThenLoadIndex) {
   base::Time fake_cache_mtime;
   ASSERT_TRUE(simple_util::GetMTime(cache_dir.path(), &fake_cache_mtime));
   SimpleIndexLoadResult load_index_result;
-  simple_index_file.LoadIndexEntries(fake_cache_mtime, closure.closure(),
-                                     &load_index_result);
+  scoped_refptr<SimpleIndexSnapshot> snapshot;
+  simple_index_file.LoadIndexEntries(fake_cache_mtime,
+                                     base::Bind(&SaveSnapshot, &snapshot),
+                                     closure.closure(), &load_index_result);
   closure.WaitForResult();
 
   EXPECT_TRUE(base::PathExists(simple_index_file.GetIndexFilePath()));
@@ -209,6 +286,18 @@ TEST_F(SimpleIndexFileTest, WriteThenLoadIndex) {
   EXPECT_EQ(kNumHashes, load_index_result.entries.size());
   for (size_t i = 0; i < kNumHashes; ++i)
     EXPECT_EQ(1U, load_index_result.entries.count(kHashes[i]));
+
+  // The fresh index file was handed out for lookups before the load finished.
+  ASSERT_TRUE(snapshot.get());
+  EXPECT_EQ(kNumHashes, snapshot->size());
+  for (size_t i = 0; i < kNumHashes; ++i)
+    EXPECT_TRUE(snapshot->Find(kHashes[i], NULL));
+  EXPECT_FALSE(snapshot->Find(44, NULL));
+
+  // The reference that carried the snapshot over is released on the cache
+  // thread.
+  base::RunLoop().RunUntilIdle();
+  EXPECT_TRUE(snapshot->HasOneRef());
 }
 
 TEST_F(SimpleIndexFileTest, LoadCorruptIndex) {
@@ -228,11 +317,14 @@ TEST_F(SimpleIndexFileTest, LoadCorruptIndex) {
   EXPECT_FALSE(WrappedSimpleIndexFile::LegacyIsIndexFileStale(fake_cache_mtime,
                                                               index_path));
   SimpleIndexLoadResult load_index_result;
+  scoped_refptr<SimpleIndexSnapshot> snapshot;
   net::TestClosure closure;
-  simple_index_file.LoadIndexEntries(fake_cache_mtime, closure.closure(),
-                                     &load_index_result);
+  simple_index_file.LoadIndexEntries(fake_cache_mtime,
+                                     base::Bind(&SaveSnapshot, &snapshot),
+                                     closure.closure(), &load_index_result);
   closure.WaitForResult();
 
+  EXPECT_FALSE(snapshot.get());
   EXPECT_FALSE(base::PathExists(index_path));
   EXPECT_TRUE(load_index_result.did_load);
   EXPECT_TRUE(load_index_result.flush_required);
@@ -0,0 +1,107 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_index_snapshot.h"
+
+#include <string.h>
+
+#include "base/files/memory_mapped_file.h"
+#include "base/logging.h"
+#include "base/time/time.h"
+
+namespace disk_cache {
+
+namespace {
+
+// Records are only aligned to 32 bits within the index pickle, so their fields
+// are copied out rather than read through a cast.
+uint64 ReadUInt64(const char* data) {
+  uint64 value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void ReadRecord(const char* record,
+                uint64* out_entry_hash,
+                EntryMetadata* out_entry_metadata) {
+  *out_entry_hash = ReadUInt64(record);
+  out_entry_metadata->SetLastUsedTime(base::Time::FromInternalValue(
+      static_cast<int64>(ReadUInt64(record + 8))));
+  out_entry_metadata->SetEntrySize(static_cast<int>(ReadUInt64(record + 16)));
+}
+
+}  // namespace
+
+// static
+const size_t SimpleIndexSnapshot::kRecordSize;
+
+// static
+scoped_refptr<SimpleIndexSnapshot> SimpleIndexSnapshot::Create(
+    scoped_ptr<base::MemoryMappedFile> map,
+    const char* records,
+    size_t entry_count) {
+  DCHECK(records || entry_count == 0);
+  scoped_refptr<SimpleIndexSnapshot> snapshot(
+      new SimpleIndexSnapshot(map.Pass(), records, entry_count));
+  for (size_t i = 1; i < entry_count; ++i) {
+    if (snapshot->GetEntryHash(i - 1) >= snapshot->GetEntryHash(i)) {
+      snapshot->searchable_ = false;
+      break;
+    }
+  }
+  return snapshot;
+}
+
+bool SimpleIndexSnapshot::Find(uint64 entry_hash,
+                               EntryMetadata* out_entry_metadata) const {
+  DCHECK(searchable_);
+  size_t low = 0;
+  size_t high = entry_count_;
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    const uint64 middle_hash = GetEntryHash(middle);
+    if (middle_hash < entry_hash) {
+      low = middle + 1;
+    } else if (entry_hash < middle_hash) {
+      high = middle;
+    } else {
+      if (out_entry_metadata) {
+        uint64 found_hash;
+        ReadRecord(records_ + middle * kRecordSize, &found_hash,
+                   out_entry_metadata);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+void SimpleIndexSnapshot::CopyToEntrySet(
+    SimpleIndex::EntrySet* entry_set) const {
+  for (size_t i = 0; i < entry_count_; ++i) {
+    uint64 entry_hash;
+    EntryMetadata entry_metadata;
+    ReadRecord(records_ + i * kRecordSize, &entry_hash, &entry_metadata);
+    SimpleIndex::InsertInEntrySet(entry_hash, entry_metadata, entry_set);
+  }
+}
+
+SimpleIndexSnapshot::SimpleIndexSnapshot(
+    scoped_ptr<base::MemoryMappedFile> map,
+    const char* records,
+    size_t entry_count)
+    : map_(map.Pass()),
+      records_(records),
+      entry_count_(entry_count),
+      searchable_(true) {
+}
+
+SimpleIndexSnapshot::~SimpleIndexSnapshot() {}
+
+uint64 SimpleIndexSnapshot::GetEntryHash(size_t i) const {
+  DCHECK_LT(i, entry_count_);
+  return ReadUInt64(records_ + i * kRecordSize);
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,74 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_INDEX_SNAPSHOT_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_INDEX_SNAPSHOT_H_
+
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/net_export.h"
+#include "net/disk_cache/simple/simple_index.h"
+
+namespace base {
+class MemoryMappedFile;
+}
+
+namespace disk_cache {
+
+// A read-only view of the entry records of an index file, used in place in the
+// mapped file. The records are sorted by entry hash when the index is written,
+// so lookups are a binary search and the index can answer them as soon as the
+// file is mapped, before the EntrySet is built. A snapshot never changes after
+// creation, so it can be shared and read from any thread without locking.
+class NET_EXPORT_PRIVATE SimpleIndexSnapshot
+    : public base::RefCountedThreadSafe<SimpleIndexSnapshot> {
+ public:
+  // Size of one serialized entry: the entry hash, the last used time and the
+  // entry size, each written as a 64-bit value.
+  static const size_t kRecordSize = 24;
+
+  // Returns a snapshot of the |entry_count| records starting at |records|. The
+  // records are owned by |map| if it is not NULL; otherwise the caller must
+  // keep them alive for the lifetime of the snapshot.
+  static scoped_refptr<SimpleIndexSnapshot> Create(
+      scoped_ptr<base::MemoryMappedFile> map,
+      const char* records,
+      size_t entry_count);
+
+  // Returns true if the snapshot has an entry for |entry_hash|, filling in
+  // |out_entry_metadata| if it is not NULL. Must only be called on searchable
+  // snapshots.
+  bool Find(uint64 entry_hash, EntryMetadata* out_entry_metadata) const;
+
+  // Adds every entry of the snapshot to |entry_set|.
+  void CopyToEntrySet(SimpleIndex::EntrySet* entry_set) const;
+
+  size_t size() const { return entry_count_; }
+
+  // Whether the records are in strictly increasing hash order, which is not the
+  // case for index files written by older versions.
+  bool searchable() const { return searchable_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<SimpleIndexSnapshot>;
+
+  SimpleIndexSnapshot(scoped_ptr<base::MemoryMappedFile> map,
+                      const char* records,
+                      size_t entry_count);
+  ~SimpleIndexSnapshot();
+
+  uint64 GetEntryHash(size_t i) const;
+
+  const scoped_ptr<base::MemoryMappedFile> map_;
+  const char* const records_;
+  const size_t entry_count_;
+  bool searchable_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleIndexSnapshot);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_INDEX_SNAPSHOT_H_
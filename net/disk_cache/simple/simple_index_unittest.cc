@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <functional>
 
+#include "base/files/memory_mapped_file.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/hash.h"
 #include "base/logging.h"
@@ -13,12 +14,14 @@
 #include "base/sha1.h"
 #include "base/strings/stringprintf.h"
 #include "base/task_runner.h"
+#include "base/test/test_simple_task_runner.h"
 #include "base/threading/platform_thread.h"
 #include "base/time/time.h"
 #include "net/base/cache_type.h"
 #include "net/disk_cache/simple/simple_index.h"
 #include "net/disk_cache/simple/simple_index_delegate.h"
 #include "net/disk_cache/simple/simple_index_file.h"
+#include "net/disk_cache/simple/simple_index_snapshot.h"
 #include "net/disk_cache/simple/simple_test_util.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -51,15 +54,18 @@ class EntryMetadataTest  : public testing::Test {
 class MockSimpleIndexFile : public SimpleIndexFile,
                             public base::SupportsWeakPtr<MockSimpleIndexFile> {
  public:
-  MockSimpleIndexFile()
-      : SimpleIndexFile(NULL, NULL, net::DISK_CACHE, base::FilePath()),
+  explicit MockSimpleIndexFile(
+      const scoped_refptr<base::SingleThreadTaskRunner>& cache_thread)
+      : SimpleIndexFile(cache_thread, NULL, net::DISK_CACHE, base::FilePath()),
         load_result_(NULL),
         load_index_entries_calls_(0),
         disk_writes_(0) {}
 
   void LoadIndexEntries(base::Time cache_last_modified,
+                        const SnapshotCallback& snapshot_callback,
                         const base::Closure& callback,
                         SimpleIndexLoadResult* out_load_result) override {
+    snapshot_callback_ = snapshot_callback;
     load_callback_ = callback;
     load_result_ = out_load_result;
     ++load_index_entries_calls_;
@@ -78,12 +84,16 @@ class MockSimpleIndexFile : public SimpleIndexFile,
     entry_set->swap(disk_write_entry_set_);
   }
 
+  const SnapshotCallback& snapshot_callback() const {
+    return snapshot_callback_;
+  }
   const base::Closure& load_callback() const { return load_callback_; }
   SimpleIndexLoadResult* load_result() const { return load_result_; }
   int load_index_entries_calls() const { return load_index_entries_calls_; }
   int disk_writes() const { return disk_writes_; }
 
  private:
+  SnapshotCallback snapshot_callback_;
   base::Closure load_callback_;
   SimpleIndexLoadResult* load_result_;
   int load_index_entries_calls_;
@@ -95,6 +105,7 @@ class SimpleIndexTest  : public testing::Test, public SimpleIndexDelegate {
  protected:
   SimpleIndexTest()
       : hashes_(base::Bind(&HashesInitializer)),
+        cache_thread_(new base::TestSimpleTaskRunner),
         doom_entries_calls_(0) {}
 
   static uint64 HashesInitializer(size_t hash_index) {
@@ -103,7 +114,8 @@ class SimpleIndexTest  : public testing::Test, public SimpleIndexDelegate {
   }
 
   void SetUp() override {
-    scoped_ptr<MockSimpleIndexFile> index_file(new MockSimpleIndexFile());
+    scoped_ptr<MockSimpleIndexFile> index_file(
+        new MockSimpleIndexFile(cache_thread_));
     index_file_ = index_file->AsWeakPtr();
     index_.reset(
         new SimpleIndex(NULL, this, net::DISK_CACHE, index_file.Pass()));
@@ -111,6 +123,12 @@ class SimpleIndexTest  : public testing::Test, public SimpleIndexDelegate {
     index_->Initialize(base::Time());
   }
 
+  void TearDown() override {
+    index_.reset();
+    // Release any snapshot handed to the cache thread.
+    cache_thread_->RunUntilIdle();
+  }
+
   void WaitForTimeChange() {
     const base::Time initial_time = base::Time::Now();
     do {
@@ -150,6 +168,23 @@ class SimpleIndexTest  : public testing::Test, public SimpleIndexDelegate {
     index_file_->load_callback().Run();
   }
 
+  // Hands the index a snapshot of an index file holding |entry_hashes|, as
+  // the index file does once a fresh file is mapped.
+  scoped_refptr<SimpleIndexSnapshot> ReturnSnapshot(
+      std::vector<uint64> entry_hashes) {
+    std::sort(entry_hashes.begin(), entry_hashes.end());
+    for (size_t i = 0; i < entry_hashes.size(); ++i) {
+      snapshot_records_.WriteUInt64(entry_hashes[i]);
+      EntryMetadata(kTestLastUsedTime, kTestEntrySize)
+          .Serialize(&snapshot_records_);
+    }
+    scoped_refptr<SimpleIndexSnapshot> snapshot = SimpleIndexSnapshot::Create(
+        scoped_ptr<base::MemoryMappedFile>(), snapshot_records_.payload(),
+        entry_hashes.size());
+    index_file_->snapshot_callback().Run(snapshot);
+    return snapshot;
+  }
+
   // Non-const for timer manipulation.
   SimpleIndex* index() { return index_.get(); }
   const MockSimpleIndexFile* index_file() const { return index_file_.get(); }
@@ -161,11 +196,13 @@ class SimpleIndexTest  : public testing::Test, public SimpleIndexDelegate {
 
 
   const simple_util::ImmutableArray<uint64, 16> hashes_;
+  scoped_refptr<base::TestSimpleTaskRunner> cache_thread_;
   scoped_ptr<SimpleIndex> index_;
   base::WeakPtr<MockSimpleIndexFile> index_file_;
 
   std::vector<uint64> last_doom_entry_hashes_;
   int doom_entries_calls_;
+  Pickle snapshot_records_;
 };
 
 TEST_F(EntryMetadataTest, Basics) {
@@ -394,6 +431,76 @@ TEST_F(SimpleIndexTest, BasicInit) {
   EXPECT_EQ(100, metadata.GetEntrySize());
 }
 
+// Lookups before initialization are answered from a snapshot of the index
+// file, when there is one.
+TEST_F(SimpleIndexTest, SnapshotBeforeInit) {
+  const uint64 kHash1 = hashes_.at<1>();
+  const uint64 kHash2 = hashes_.at<2>();
+  const uint64 kHash3 = hashes_.at<3>();
+  std::vector<uint64> snapshot_hashes;
+  snapshot_hashes.push_back(kHash1);
+  snapshot_hashes.push_back(kHash2);
+  ReturnSnapshot(snapshot_hashes);
+
+  EXPECT_EQ(2, index()->GetEntryCount());
+  EXPECT_TRUE(index()->Has(kHash1));
+  EXPECT_FALSE(index()->Has(kHash3));
+  index()->Insert(kHash3);
+  EXPECT_TRUE(index()->Has(kHash3));
+
+  // Removed entries still go to the disk.
+  index()->Remove(kHash2);
+  EXPECT_TRUE(index()->Has(kHash2));
+  EXPECT_TRUE(index()->UseIfExists(kHash2));
+
+  EXPECT_FALSE(index()->UseIfExists(hashes_.at<4>()));
+  EXPECT_TRUE(index()->UseIfExists(kHash1));
+  EntryMetadata metadata;
+  EXPECT_TRUE(GetEntryForTesting(kHash1, &metadata));
+  EXPECT_EQ(kTestEntrySize, metadata.GetEntrySize());
+  EXPECT_LT(kTestLastUsedTime, metadata.GetLastUsedTime());
+
+  InsertIntoIndexFileReturn(kHash1, kTestLastUsedTime, kTestEntrySize);
+  InsertIntoIndexFileReturn(kHash2, kTestLastUsedTime, kTestEntrySize);
+  ReturnIndexFile();
+
+  EXPECT_EQ(2, index()->GetEntryCount());
+  EXPECT_TRUE(index()->Has(kHash1));
+  EXPECT_FALSE(index()->Has(kHash2));
+  EXPECT_TRUE(index()->Has(kHash3));
+  EXPECT_FALSE(index()->Has(hashes_.at<4>()));
+  EXPECT_TRUE(GetEntryForTesting(kHash1, &metadata));
+  EXPECT_LT(kTestLastUsedTime, metadata.GetLastUsedTime());
+}
+
+// Dropping the last reference to a snapshot unmaps the index file, so the
+// index releases its snapshot on the cache thread once the load completes.
+TEST_F(SimpleIndexTest, SnapshotReleasedOnCacheThreadAfterInit) {
+  scoped_refptr<SimpleIndexSnapshot> snapshot =
+      ReturnSnapshot(std::vector<uint64>(1, hashes_.at<1>()));
+  EXPECT_FALSE(snapshot->HasOneRef());
+
+  InsertIntoIndexFileReturn(hashes_.at<1>(), kTestLastUsedTime,
+                            kTestEntrySize);
+  ReturnIndexFile();
+  EXPECT_FALSE(snapshot->HasOneRef());
+
+  cache_thread_->RunUntilIdle();
+  EXPECT_TRUE(snapshot->HasOneRef());
+}
+
+// Likewise when the index is destroyed before the load completes.
+TEST_F(SimpleIndexTest, SnapshotReleasedOnCacheThreadOnDestruction) {
+  scoped_refptr<SimpleIndexSnapshot> snapshot =
+      ReturnSnapshot(std::vector<uint64>(1, hashes_.at<1>()));
+
+  index_.reset();
+  EXPECT_FALSE(snapshot->HasOneRef());
+
+  cache_thread_->RunUntilIdle();
+  EXPECT_TRUE(snapshot->HasOneRef());
+}
+
 // Remove something that's going to come in from the loaded index.
 TEST_F(SimpleIndexTest, RemoveBeforeInit) {
   const uint64 kHash1 = hashes_.at<1>();
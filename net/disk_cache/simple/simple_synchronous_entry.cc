@@ -16,7 +16,9 @@
 #include "base/location.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/sha1.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/stringprintf.h"
+#include "base/time/time.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/disk_cache/simple/simple_backend_version.h"
@@ -26,10 +28,20 @@
 
 using base::File;
 using base::FilePath;
+using base::StringPiece;
 using base::Time;
+using base::TimeTicks;
 
 namespace {
 
+// Number of bytes of the key read along with the entry header when opening a
+// file. Most keys are URLs short enough to come in with the header.
+const int kKeySpeculativeReadSize = 256;
+
+// Number of bytes in front of the stream 0 EOF record read along with it when
+// opening an entry. Stream 0 holds the response headers, which usually fit.
+const int kStream0SpeculativeReadSize = 4096;
+
 // Used in histograms, please only add entries at the end.
 enum OpenEntryResult {
   OPEN_ENTRY_SUCCESS = 0,
@@ -120,6 +132,7 @@ using simple_util::GetSparseFilenameFromEntryHash;
 using simple_util::GetDataSizeFromKeyAndFileSize;
 using simple_util::GetFileSizeFromKeyAndDataSize;
 using simple_util::GetFileIndexFromStreamIndex;
+using simple_util::WriteBuffersToFile;
 
 SimpleEntryStat::SimpleEntryStat(base::Time last_used,
                                  base::Time last_modified,
@@ -280,6 +293,7 @@ void SimpleSynchronousEntry::ReadData(const EntryOperationData& in_entry_op,
                                       int* out_result) const {
   DCHECK(initialized_);
   DCHECK_NE(0, in_entry_op.index);
+  const TimeTicks start_time = TimeTicks::Now();
   const int64 file_offset =
       entry_stat->GetOffsetInFile(key_, in_entry_op.offset, in_entry_op.index);
   int file_index = GetFileIndexFromStreamIndex(in_entry_op.index);
@@ -302,6 +316,8 @@ void SimpleSynchronousEntry::ReadData(const EntryOperationData& in_entry_op,
     *out_result = net::ERR_CACHE_READ_FAILURE;
     Doom();
   }
+  SIMPLE_CACHE_UMA(TIMES, "SyncReadDataTime", cache_type_,
+                   TimeTicks::Now() - start_time);
 }
 
 void SimpleSynchronousEntry::WriteData(const EntryOperationData& in_entry_op,
@@ -310,6 +326,7 @@ void SimpleSynchronousEntry::WriteData(const EntryOperationData& in_entry_op,
                                        int* out_result) {
   DCHECK(initialized_);
   DCHECK_NE(0, in_entry_op.index);
+  const TimeTicks start_time = TimeTicks::Now();
   int index = in_entry_op.index;
   int file_index = GetFileIndexFromStreamIndex(index);
   int offset = in_entry_op.offset;
@@ -386,6 +403,8 @@ void SimpleSynchronousEntry::WriteData(const EntryOperationData& in_entry_op,
   out_entry_stat->set_last_used(modification_time);
   out_entry_stat->set_last_modified(modification_time);
   *out_result = buf_len;
+  SIMPLE_CACHE_UMA(TIMES, "SyncWriteDataTime", cache_type_,
+                   TimeTicks::Now() - start_time);
 }
 
 void SimpleSynchronousEntry::ReadSparseData(
@@ -394,6 +413,7 @@ void SimpleSynchronousEntry::ReadSparseData(
     base::Time* out_last_used,
     int* out_result) {
   DCHECK(initialized_);
+  const TimeTicks start_time = TimeTicks::Now();
   int64 offset = in_entry_op.sparse_offset;
   int buf_len = in_entry_op.buf_len;
 
@@ -446,6 +466,8 @@ void SimpleSynchronousEntry::ReadSparseData(
   }
 
   *out_result = read_so_far;
+  SIMPLE_CACHE_UMA(TIMES, "SyncReadSparseDataTime", cache_type_,
+                   TimeTicks::Now() - start_time);
 }
 
 void SimpleSynchronousEntry::WriteSparseData(
@@ -455,6 +477,7 @@ void SimpleSynchronousEntry::WriteSparseData(
     SimpleEntryStat* out_entry_stat,
     int* out_result) {
   DCHECK(initialized_);
+  const TimeTicks start_time = TimeTicks::Now();
   int64 offset = in_entry_op.sparse_offset;
   int buf_len = in_entry_op.buf_len;
 
@@ -550,6 +573,8 @@ void SimpleSynchronousEntry::WriteSparseData(
   int32 old_sparse_data_size = out_entry_stat->sparse_data_size();
   out_entry_stat->set_sparse_data_size(old_sparse_data_size + appended_so_far);
   *out_result = written_so_far;
+  SIMPLE_CACHE_UMA(TIMES, "SyncWriteSparseDataTime", cache_type_,
+                   TimeTicks::Now() - start_time);
 }
 
 void SimpleSynchronousEntry::GetAvailableRange(
@@ -619,15 +644,11 @@ void SimpleSynchronousEntry::Close(
     scoped_ptr<std::vector<CRCRecord> > crc32s_to_write,
     net::GrowableIOBuffer* stream_0_data) {
   DCHECK(stream_0_data);
-  // Write stream 0 data.
-  int stream_0_offset = entry_stat.GetOffsetInFile(key_, 0, 0);
-  if (files_[0].Write(stream_0_offset, stream_0_data->data(),
-                      entry_stat.data_size(0)) !=
-      entry_stat.data_size(0)) {
-    RecordCloseResult(cache_type_, CLOSE_RESULT_WRITE_FAILURE);
-    DVLOG(1) << "Could not write stream 0 data.";
-    Doom();
-  }
+  const TimeTicks start_time = TimeTicks::Now();
+  const int stream_0_offset = entry_stat.GetOffsetInFile(key_, 0, 0);
+  const StringPiece stream_0(stream_0_data->data(), entry_stat.data_size(0));
+  // Whether stream 0 was written, or failed to be, along with its EOF record.
+  bool stream_0_handled = false;
 
   for (std::vector<CRCRecord>::const_iterator it = crc32s_to_write->begin();
        it != crc32s_to_write->end(); ++it) {
@@ -644,26 +665,45 @@ void SimpleSynchronousEntry::Close(
       eof_record.flags |= SimpleFileEOF::FLAG_HAS_CRC32;
     eof_record.data_crc32 = it->data_crc32;
     int eof_offset = entry_stat.GetEOFOffsetInFile(key_, stream_index);
-    // If stream 0 changed size, the file needs to be resized, otherwise the
-    // next open will yield wrong stream sizes. On stream 1 and stream 2 proper
-    // resizing of the file is handled in SimpleSynchronousEntry::WriteData().
-    if (stream_index == 0 &&
-        !files_[file_index].SetLength(eof_offset)) {
-      RecordCloseResult(cache_type_, CLOSE_RESULT_WRITE_FAILURE);
-      DVLOG(1) << "Could not truncate stream 0 file.";
-      Doom();
-      break;
+    const StringPiece eof(reinterpret_cast<const char*>(&eof_record),
+                          sizeof(eof_record));
+    if (stream_index == 0) {
+      stream_0_handled = true;
+      // If stream 0 changed size, the file needs to be resized, otherwise the
+      // next open will yield wrong stream sizes. On stream 1 and stream 2
+      // proper resizing of the file is handled in
+      // SimpleSynchronousEntry::WriteData().
+      if (!files_[file_index].SetLength(eof_offset)) {
+        RecordCloseResult(cache_type_, CLOSE_RESULT_WRITE_FAILURE);
+        DVLOG(1) << "Could not truncate stream 0 file.";
+        Doom();
+        break;
+      }
+      // The stream 0 EOF record directly follows the stream 0 data, so both
+      // go to the file in one write.
+      const StringPiece buffers[] = { stream_0, eof };
+      if (!WriteBuffersToFile(&files_[file_index], stream_0_offset, buffers,
+                              arraysize(buffers))) {
+        RecordCloseResult(cache_type_, CLOSE_RESULT_WRITE_FAILURE);
+        DVLOG(1) << "Could not write stream 0 data and eof record.";
+        Doom();
+        break;
+      }
+      continue;
     }
-    if (files_[file_index].Write(eof_offset,
-                                 reinterpret_cast<const char*>(&eof_record),
-                                 sizeof(eof_record)) !=
-        sizeof(eof_record)) {
+    if (!WriteBuffersToFile(&files_[file_index], eof_offset, &eof, 1)) {
       RecordCloseResult(cache_type_, CLOSE_RESULT_WRITE_FAILURE);
       DVLOG(1) << "Could not write eof record.";
       Doom();
       break;
     }
   }
+  if (!stream_0_handled &&
+      !WriteBuffersToFile(&files_[0], stream_0_offset, &stream_0, 1)) {
+    RecordCloseResult(cache_type_, CLOSE_RESULT_WRITE_FAILURE);
+    DVLOG(1) << "Could not write stream 0 data.";
+    Doom();
+  }
   for (int i = 0; i < kSimpleEntryFileCount; ++i) {
     if (empty_file_omitted_[i])
       continue;
@@ -689,6 +729,8 @@ void SimpleSynchronousEntry::Close(
                      empty_file_omitted_[stream2_file_index]);
   }
   RecordCloseResult(cache_type_, CLOSE_RESULT_SUCCESS);
+  SIMPLE_CACHE_UMA(TIMES, "SyncCloseTime", cache_type_,
+                   TimeTicks::Now() - start_time);
   have_open_files_ = false;
   delete this;
 }
@@ -907,14 +949,16 @@ int SimpleSynchronousEntry::InitializeForOpen(
     if (empty_file_omitted_[i])
       continue;
 
-    SimpleFileHeader header;
+    char header_and_key[sizeof(SimpleFileHeader) + kKeySpeculativeReadSize];
     int header_read_result =
-        files_[i].Read(0, reinterpret_cast<char*>(&header), sizeof(header));
-    if (header_read_result != sizeof(header)) {
+        files_[i].Read(0, header_and_key, sizeof(header_and_key));
+    if (header_read_result < implicit_cast<int>(sizeof(SimpleFileHeader))) {
       DLOG(WARNING) << "Cannot read header from entry.";
       RecordSyncOpenResult(cache_type_, OPEN_ENTRY_CANT_READ_HEADER, had_index);
       return net::ERR_FAILED;
     }
+    SimpleFileHeader header;
+    memcpy(&header, header_and_key, sizeof(header));
 
     if (header.initial_magic_number != kSimpleInitialMagicNumber) {
       // TODO(gavinp): This seems very bad; for now we log at WARNING, but we
@@ -931,16 +975,24 @@ int SimpleSynchronousEntry::InitializeForOpen(
       return net::ERR_FAILED;
     }
 
-    scoped_ptr<char[]> key(new char[header.key_length]);
-    int key_read_result = files_[i].Read(sizeof(header), key.get(),
-                                         header.key_length);
-    if (key_read_result != implicit_cast<int>(header.key_length)) {
-      DLOG(WARNING) << "Cannot read key from entry.";
-      RecordSyncOpenResult(cache_type_, OPEN_ENTRY_CANT_READ_KEY, had_index);
-      return net::ERR_FAILED;
+    // Only read what is left of the key after the speculative read above.
+    const uint32 key_bytes_read = std::min<uint32>(
+        header_read_result - sizeof(header), header.key_length);
+    std::string key(header_and_key + sizeof(header), key_bytes_read);
+    if (key_bytes_read < header.key_length) {
+      const int key_bytes_left = header.key_length - key_bytes_read;
+      key.resize(header.key_length);
+      int key_read_result = files_[i].Read(sizeof(header) + key_bytes_read,
+                                           &key[key_bytes_read],
+                                           key_bytes_left);
+      if (key_read_result != key_bytes_left) {
+        DLOG(WARNING) << "Cannot read key from entry.";
+        RecordSyncOpenResult(cache_type_, OPEN_ENTRY_CANT_READ_KEY, had_index);
+        return net::ERR_FAILED;
+      }
     }
 
-    key_ = std::string(key.get(), header.key_length);
+    key_.swap(key);
     if (i == 0) {
       // File size for stream 0 has been stored temporarily in data_size[1].
       int total_data_size =
@@ -958,7 +1010,7 @@ int SimpleSynchronousEntry::InitializeForOpen(
       }
     }
 
-    if (base::Hash(key.get(), header.key_length) != header.key_hash) {
+    if (base::Hash(key_) != header.key_hash) {
       DLOG(WARNING) << "Hash mismatch on key.";
       RecordSyncOpenResult(
           cache_type_, OPEN_ENTRY_KEY_HASH_MISMATCH, had_index);
@@ -1004,20 +1056,15 @@ bool SimpleSynchronousEntry::InitializeCreatedFile(
   header.key_length = key_.size();
   header.key_hash = base::Hash(key_);
 
-  int bytes_written = files_[file_index].Write(
-      0, reinterpret_cast<char*>(&header), sizeof(header));
-  if (bytes_written != sizeof(header)) {
+  const StringPiece buffers[] = {
+      StringPiece(reinterpret_cast<char*>(&header), sizeof(header)),
+      key_ };
+  if (!WriteBuffersToFile(&files_[file_index], 0, buffers,
+                          arraysize(buffers))) {
     *out_result = CREATE_ENTRY_CANT_WRITE_HEADER;
     return false;
   }
 
-  bytes_written = files_[file_index].Write(sizeof(header), key_.data(),
-                                           key_.size());
-  if (bytes_written != implicit_cast<int>(key_.size())) {
-    *out_result = CREATE_ENTRY_CANT_WRITE_KEY;
-    return false;
-  }
-
   return true;
 }
 
@@ -1054,15 +1101,31 @@ int SimpleSynchronousEntry::ReadAndValidateStream0(
   out_entry_stat->set_data_size(0, 0);
   out_entry_stat->set_data_size(1, total_data_size - sizeof(SimpleFileEOF));
 
+  // Stream 0 is read along with its EOF record, which saves a read for the
+  // common case where it fits in the speculative read.
+  const int64 eof_offset = out_entry_stat->GetEOFOffsetInFile(key_, 0);
+  const int tail_data_size = std::max(
+      0, std::min(out_entry_stat->data_size(1), kStream0SpeculativeReadSize));
+  const int tail_size = tail_data_size + sizeof(SimpleFileEOF);
+  scoped_ptr<char[]> tail(new char[tail_size]);
+  File* file = const_cast<File*>(&files_[0]);
+  if (file->Read(eof_offset - tail_data_size, tail.get(), tail_size) !=
+      tail_size) {
+    RecordCheckEOFResult(cache_type_, CHECK_EOF_RESULT_READ_FAILURE);
+    return net::ERR_CACHE_CHECKSUM_READ_FAILURE;
+  }
+  SimpleFileEOF eof_record;
+  memcpy(&eof_record, tail.get() + tail_data_size, sizeof(eof_record));
+
   bool has_crc32;
   uint32 read_crc32;
   int stream_0_size;
-  int ret_value_crc32 = GetEOFRecordData(
-      0, *out_entry_stat, &has_crc32, &read_crc32, &stream_0_size);
+  int ret_value_crc32 =
+      ParseEOFRecord(eof_record, &has_crc32, &read_crc32, &stream_0_size);
   if (ret_value_crc32 != net::OK)
     return ret_value_crc32;
 
-  if (stream_0_size > out_entry_stat->data_size(1))
+  if (stream_0_size < 0 || stream_0_size > out_entry_stat->data_size(1))
     return net::ERR_FAILED;
 
   // These are the real values of data size.
@@ -1073,12 +1136,17 @@ int SimpleSynchronousEntry::ReadAndValidateStream0(
   // Put stream 0 data in memory.
   *stream_0_data = new net::GrowableIOBuffer();
   (*stream_0_data)->SetCapacity(stream_0_size);
-  int file_offset = out_entry_stat->GetOffsetInFile(key_, 0, 0);
-  File* file = const_cast<File*>(&files_[0]);
-  int bytes_read =
-      file->Read(file_offset, (*stream_0_data)->data(), stream_0_size);
-  if (bytes_read != stream_0_size)
-    return net::ERR_FAILED;
+  if (stream_0_size <= tail_data_size) {
+    const char* stream_0_start = tail.get() + tail_data_size - stream_0_size;
+    std::copy(stream_0_start, stream_0_start + stream_0_size,
+              (*stream_0_data)->data());
+  } else {
+    int file_offset = out_entry_stat->GetOffsetInFile(key_, 0, 0);
+    int bytes_read =
+        file->Read(file_offset, (*stream_0_data)->data(), stream_0_size);
+    if (bytes_read != stream_0_size)
+      return net::ERR_FAILED;
+  }
 
   // Check the CRC32.
   uint32 expected_crc32 =
@@ -1112,7 +1180,13 @@ int SimpleSynchronousEntry::GetEOFRecordData(int index,
     RecordCheckEOFResult(cache_type_, CHECK_EOF_RESULT_READ_FAILURE);
     return net::ERR_CACHE_CHECKSUM_READ_FAILURE;
   }
+  return ParseEOFRecord(eof_record, out_has_crc32, out_crc32, out_data_size);
+}
 
+int SimpleSynchronousEntry::ParseEOFRecord(const SimpleFileEOF& eof_record,
+                                           bool* out_has_crc32,
+                                           uint32* out_crc32,
+                                           int* out_data_size) const {
   if (eof_record.final_magic_number != kSimpleFinalMagicNumber) {
     RecordCheckEOFResult(cache_type_, CHECK_EOF_RESULT_MAGIC_NUMBER_MISMATCH);
     DVLOG(1) << "EOF record had bad magic number.";
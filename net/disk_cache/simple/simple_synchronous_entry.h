@@ -179,7 +179,7 @@ class SimpleSynchronousEntry {
     CREATE_ENTRY_SUCCESS = 0,
     CREATE_ENTRY_PLATFORM_FILE_ERROR = 1,
     CREATE_ENTRY_CANT_WRITE_HEADER = 2,
-    CREATE_ENTRY_CANT_WRITE_KEY = 3,
+    // CREATE_ENTRY_CANT_WRITE_KEY = 3, Deprecated.
     CREATE_ENTRY_MAX = 4,
   };
 
@@ -259,6 +259,12 @@ class SimpleSynchronousEntry {
                        bool* out_has_crc32,
                        uint32* out_crc32,
                        int* out_data_size) const;
+
+  // Checks the magic number of |eof_record| and extracts its fields.
+  int ParseEOFRecord(const SimpleFileEOF& eof_record,
+                     bool* out_has_crc32,
+                     uint32* out_crc32,
+                     int* out_data_size) const;
   void Doom() const;
 
   // Opens the sparse data file and scans it if it exists.
@@ -6,6 +6,7 @@
 
 #include <limits>
 
+#include "base/files/file.h"
 #include "base/files/file_util.h"
 #include "base/format_macros.h"
 #include "base/logging.h"
@@ -17,6 +18,13 @@
 #include "base/time/time.h"
 #include "net/disk_cache/simple/simple_entry_format.h"
 
+#if defined(OS_LINUX)
+#include <limits.h>
+#include <sys/uio.h>
+
+#include "base/posix/eintr_wrapper.h"
+#endif
+
 namespace {
 
 // Size of the uint64 hash_key number in Hex format in a string.
@@ -134,6 +142,61 @@ bool GetMTime(const base::FilePath& path, base::Time* out_mtime) {
   return true;
 }
 
+bool WriteBuffersToFile(base::File* file,
+                        int64 offset,
+                        const base::StringPiece* buffers,
+                        size_t buffer_count) {
+  DCHECK(file->IsValid());
+#if defined(OS_LINUX)
+  base::ThreadRestrictions::AssertIOAllowed();
+  // Gather the buffers a batch at a time. POSIX guarantees that pwritev()
+  // takes at least this many, and callers rarely pass more.
+  const size_t kMaxBuffersPerWrite = 16;
+  COMPILE_ASSERT(kMaxBuffersPerWrite <= IOV_MAX, too_many_buffers_per_write);
+  size_t next_buffer = 0;
+  while (next_buffer < buffer_count) {
+    struct iovec iov[kMaxBuffersPerWrite];
+    size_t iov_count = 0;
+    for (; next_buffer < buffer_count && iov_count < kMaxBuffersPerWrite;
+         ++next_buffer) {
+      if (buffers[next_buffer].empty())
+        continue;
+      iov[iov_count].iov_base = const_cast<char*>(buffers[next_buffer].data());
+      iov[iov_count].iov_len = buffers[next_buffer].size();
+      ++iov_count;
+    }
+    struct iovec* next = iov;
+    while (iov_count > 0) {
+      ssize_t bytes_written = HANDLE_EINTR(
+          pwritev(file->GetPlatformFile(), next, iov_count, offset));
+      if (bytes_written <= 0)
+        return false;
+      offset += bytes_written;
+      // Skip past whatever a short write did get to the disk.
+      size_t remaining = static_cast<size_t>(bytes_written);
+      while (iov_count > 0 && remaining >= next->iov_len) {
+        remaining -= next->iov_len;
+        ++next;
+        --iov_count;
+      }
+      if (iov_count > 0) {
+        next->iov_base = static_cast<char*>(next->iov_base) + remaining;
+        next->iov_len -= remaining;
+      }
+    }
+  }
+  return true;
+#else
+  for (size_t i = 0; i < buffer_count; ++i) {
+    const int size = base::checked_cast<int>(buffers[i].size());
+    if (size > 0 && file->Write(offset, buffers[i].data(), size) != size)
+      return false;
+    offset += size;
+  }
+  return true;
+#endif
+}
+
 }  // namespace simple_backend
 
 }  // namespace disk_cache
@@ -12,6 +12,7 @@
 #include "net/base/net_export.h"
 
 namespace base {
+class File;
 class FilePath;
 class Time;
 }
@@ -76,6 +77,15 @@ NET_EXPORT_PRIVATE bool GetMTime(const base::FilePath& path,
 // is possible to immediately create a new file with the same name.
 NET_EXPORT_PRIVATE bool SimpleCacheDeleteFile(const base::FilePath& path);
 
+// Writes the |buffer_count| buffers in |buffers| back to back into |file|,
+// starting at |offset|. Where the platform has a gathering write, up to 16
+// buffers go to the file in each system call. Returns true if all of the data
+// was written.
+NET_EXPORT_PRIVATE bool WriteBuffersToFile(base::File* file,
+                                           int64 offset,
+                                           const base::StringPiece* buffers,
+                                           size_t buffer_count);
+
 }  // namespace simple_util
 
 }  // namespace disk_cache
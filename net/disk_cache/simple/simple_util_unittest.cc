@@ -2,8 +2,16 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string>
+#include <vector>
+
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/logging.h"
 #include "base/port.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -13,6 +21,7 @@ using disk_cache::simple_util::GetEntryHashKeyFromHexString;
 using disk_cache::simple_util::GetEntryHashKey;
 using disk_cache::simple_util::GetFileSizeFromKeyAndDataSize;
 using disk_cache::simple_util::GetDataSizeFromKeyAndFileSize;
+using disk_cache::simple_util::WriteBuffersToFile;
 
 class SimpleUtilTest : public testing::Test {};
 
@@ -74,3 +83,47 @@ TEST_F(SimpleUtilTest, SizesAndOffsets) {
   const int file_size = GetFileSizeFromKeyAndDataSize(key, data_size);
   EXPECT_EQ(data_size, GetDataSizeFromKeyAndFileSize(key, file_size));
 }
+
+TEST_F(SimpleUtilTest, WriteBuffersToFile) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath path = temp_dir.path().AppendASCII("buffers");
+  base::File file(path, base::File::FLAG_CREATE | base::File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+
+  const std::string large(100000, 'x');
+  const base::StringPiece buffers[] = {"header", "", large, "eof"};
+  ASSERT_TRUE(WriteBuffersToFile(&file, 0, buffers, arraysize(buffers)));
+
+  // Writing at an offset overwrites the data that is already there.
+  const base::StringPiece tail[] = {"more", "data"};
+  ASSERT_TRUE(WriteBuffersToFile(&file, 6, tail, arraysize(tail)));
+  file.Close();
+
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(path, &contents));
+  EXPECT_EQ("headermoredata" + large.substr(8) + "eof", contents);
+}
+
+// More buffers than one gathering write takes are all written, in order.
+TEST_F(SimpleUtilTest, WriteManyBuffersToFile) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath path = temp_dir.path().AppendASCII("buffers");
+  base::File file(path, base::File::FLAG_CREATE | base::File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+
+  std::vector<std::string> strings;
+  std::string expected;
+  for (int i = 0; i < 100; ++i) {
+    strings.push_back(base::IntToString(i) + ",");
+    expected += strings.back();
+  }
+  std::vector<base::StringPiece> buffers(strings.begin(), strings.end());
+  ASSERT_TRUE(WriteBuffersToFile(&file, 0, &buffers[0], buffers.size()));
+  file.Close();
+
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(path, &contents));
+  EXPECT_EQ(expected, contents);
+}
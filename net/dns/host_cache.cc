@@ -34,7 +34,10 @@ HostCache::Entry::~Entry() {
 //-----------------------------------------------------------------------------
 
 HostCache::HostCache(size_t max_entries)
-    : entries_(max_entries) {
+    : entries_(max_entries),
+      hits_(0),
+      stale_hits_(0),
+      misses_(0) {
 }
 
 HostCache::~HostCache() {
@@ -46,7 +49,38 @@ const HostCache::Entry* HostCache::Lookup(const Key& key,
   if (caching_is_disabled())
     return NULL;
 
-  return entries_.Get(key, now);
+  const Entry* entry = entries_.Get(key, now);
+  if (entry)
+    ++hits_;
+  else
+    ++misses_;
+  return entry;
+}
+
+const HostCache::Entry* HostCache::LookupStale(
+    const Key& key,
+    base::TimeTicks now,
+    base::TimeDelta max_stale,
+    base::TimeDelta* out_expires_in) {
+  DCHECK(CalledOnValidThread());
+  if (caching_is_disabled())
+    return NULL;
+
+  base::TimeTicks expiration;
+  const Entry* entry = entries_.GetIncludingExpired(key, &expiration);
+  if (entry && expiration <= now) {
+    // Only successful results are worth serving past their expiration.
+    if (entry->error != OK || now - expiration >= max_stale)
+      return Lookup(key, now);
+    ++stale_hits_;
+  } else if (entry) {
+    ++hits_;
+  } else {
+    ++misses_;
+  }
+  if (entry)
+    *out_expires_in = expiration - now;
+  return entry;
 }
 
 void HostCache::Set(const Key& key,
@@ -82,6 +82,15 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // |now|. If there is no such entry, returns NULL.
   const Entry* Lookup(const Key& key, base::TimeTicks now);
 
+  // Like Lookup(), but a successful entry that expired less than |max_stale|
+  // before |now| is still returned. Sets |*out_expires_in| to the
+  // time left until the returned entry expires, which is zero or negative if
+  // it is stale.
+  const Entry* LookupStale(const Key& key,
+                           base::TimeTicks now,
+                           base::TimeDelta max_stale,
+                           base::TimeDelta* out_expires_in);
+
   // Overwrites or creates an entry for |key|.
   // |entry| is the value to set, |now| is the current time
   // |ttl| is the "time to live".
@@ -99,6 +108,12 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // Following are used by net_internals UI.
   size_t max_entries() const;
 
+  // Number of lookups answered by a valid entry, answered by a stale entry,
+  // and not answered, respectively.
+  size_t hits() const { return hits_; }
+  size_t stale_hits() const { return stale_hits_; }
+  size_t misses() const { return misses_; }
+
   const EntryMap& entries() const;
 
   // Creates a default cache.
@@ -116,6 +131,10 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // a resolved result entry.
   EntryMap entries_;
 
+  size_t hits_;
+  size_t stale_hits_;
+  size_t misses_;
+
   DISALLOW_COPY_AND_ASSIGN(HostCache);
 };
 
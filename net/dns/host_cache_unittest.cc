@@ -175,6 +175,46 @@ TEST(HostCacheTest, CacheNegativeEntry) {
   EXPECT_FALSE(cache.Lookup(key2, now));
 }
 
+TEST(HostCacheTest, LookupStale) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+  const base::TimeDelta kMaxStale = base::TimeDelta::FromSeconds(5);
+
+  HostCache cache(kMaxCacheEntries);
+
+  // Start at t=0.
+  base::TimeTicks now;
+  base::TimeDelta expires_in;
+
+  HostCache::Key key1 = Key("foobar.com");
+  HostCache::Key key2 = Key("foobar2.com");
+  cache.Set(key1, HostCache::Entry(OK, AddressList()), now, kTTL);
+  cache.Set(key2, HostCache::Entry(ERR_NAME_NOT_RESOLVED, AddressList()), now,
+            kTTL);
+
+  EXPECT_TRUE(cache.LookupStale(key1, now, kMaxStale, &expires_in));
+  EXPECT_EQ(kTTL, expires_in);
+  EXPECT_EQ(1u, cache.hits());
+
+  // Advance to t=12; both entries are expired, but only the successful one
+  // is served stale. The failed one is evicted.
+  now += base::TimeDelta::FromSeconds(12);
+  EXPECT_TRUE(cache.LookupStale(key1, now, kMaxStale, &expires_in));
+  EXPECT_EQ(base::TimeDelta::FromSeconds(-2), expires_in);
+  EXPECT_FALSE(cache.LookupStale(key2, now, kMaxStale, &expires_in));
+  EXPECT_FALSE(cache.Lookup(key1, now));
+  EXPECT_EQ(1u, cache.stale_hits());
+  EXPECT_EQ(2u, cache.misses());
+  EXPECT_EQ(1u, cache.size());
+
+  // Advance to t=15; key1 is now too stale, and is evicted.
+  now += base::TimeDelta::FromSeconds(3);
+  EXPECT_FALSE(cache.LookupStale(key1, now, kMaxStale, &expires_in));
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_EQ(1u, cache.hits());
+  EXPECT_EQ(1u, cache.stale_hits());
+  EXPECT_EQ(3u, cache.misses());
+}
+
 // Tests that the same hostname can be duplicated in the cache, so long as
 // the address family differs.
 TEST(HostCacheTest, AddressFamilyIsPartOfKey) {
@@ -9,6 +9,7 @@
 
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
 #include "net/base/address_family.h"
 #include "net/base/completion_callback.h"
 #include "net/base/host_port_pair.h"
@@ -47,6 +48,12 @@ class NET_EXPORT HostResolver {
   // resolution. Pass HostResolver::kDefaultRetryAttempts to choose a default
   // value.
   // |enable_caching| controls whether a HostCache is used.
+  // |max_stale_age| is how long after expiring a cached result may still be
+  // returned while a fresh one is looked up in the background. Zero, the
+  // default, disables serving stale results.
+  // |refresh_window| is how long before expiring a cached result that is used
+  // gets refreshed in the background, so that hot entries do not expire. Zero,
+  // the default, disables proactive refreshes.
   struct NET_EXPORT Options {
     Options();
 
@@ -55,6 +62,8 @@ class NET_EXPORT HostResolver {
     size_t max_concurrent_resolves;
     size_t max_retry_attempts;
     bool enable_caching;
+    base::TimeDelta max_stale_age;
+    base::TimeDelta refresh_window;
   };
 
   // The parameters for doing a Resolve(). A hostname and port are
@@ -1177,12 +1177,16 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
  public:
   // Creates new job for |key| where |request_net_log| is bound to the
   // request that spawned it.
+  // If |is_refresh| is true, the Job was started to refresh the cache entry
+  // for |key| and runs whether or not any Requests are attached to it.
   Job(const base::WeakPtr<HostResolverImpl>& resolver,
       const Key& key,
       RequestPriority priority,
-      const BoundNetLog& source_net_log)
+      const BoundNetLog& source_net_log,
+      bool is_refresh)
       : resolver_(resolver),
         key_(key),
+        is_refresh_(is_refresh),
         priority_tracker_(priority),
         had_non_speculative_request_(false),
         had_dns_config_(false),
@@ -1295,7 +1299,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
                                  req->source_net_log().source(),
                                  priority()));
 
-    if (num_active_requests() > 0) {
+    if (num_active_requests() > 0 || is_refresh_) {
       UpdatePriority();
     } else {
       // If we were called from a Request's callback within CompleteRequests,
@@ -1337,7 +1341,10 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
   // Attempts to serve the job from HOSTS. Returns true if succeeded and
   // this Job was destroyed.
   bool ServeFromHosts() {
-    DCHECK_GT(num_active_requests(), 0u);
+    // A refresh without Requests has no RequestInfo to resolve with, and
+    // HOSTS entries are never cached anyway.
+    if (num_active_requests() == 0)
+      return false;
     AddressList addr_list;
     if (resolver_->ServeFromHosts(key(),
                                   requests_.front()->info(),
@@ -1644,7 +1651,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
       handle_.Reset();
     }
 
-    if (num_active_requests() == 0) {
+    if (num_active_requests() == 0 && !is_refresh_) {
       net_log_.AddEvent(NetLog::TYPE_CANCELLED);
       net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB,
                                         OK);
@@ -1654,7 +1661,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
     net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB,
                                       entry.error);
 
-    DCHECK(!requests_.empty());
+    DCHECK(is_refresh_ || !requests_.empty());
 
     if (entry.error == OK) {
       // Record this histogram here, when we know the system has a valid DNS
@@ -1665,7 +1672,11 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
 
     bool did_complete = (entry.error != ERR_NETWORK_CHANGED) &&
                         (entry.error != ERR_HOST_RESOLVER_QUEUE_TOO_LARGE);
-    if (did_complete)
+    // A failed refresh that nobody is waiting on leaves the old entry in
+    // place, so that it can keep being served while it is stale.
+    bool should_cache =
+        did_complete && (entry.error == OK || num_active_requests() > 0);
+    if (should_cache)
       resolver_->CacheResult(key_, entry, ttl);
 
     // Complete all of the requests that were attached to the job.
@@ -1720,6 +1731,9 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
 
   Key key_;
 
+  // Whether this Job refreshes the cache entry for |key_|.
+  const bool is_refresh_;
+
   // Tracks the highest priority across |requests_|.
   PriorityTracker priority_tracker_;
 
@@ -1781,6 +1795,8 @@ HostResolverImpl::HostResolverImpl(const Options& options, NetLog* net_log)
       resolved_known_ipv6_hostname_(false),
       additional_resolver_flags_(0),
       fallback_to_proctask_(true),
+      max_stale_age_(options.max_stale_age),
+      refresh_window_(options.refresh_window),
       weak_ptr_factory_(this),
       probe_weak_ptr_factory_(this) {
   if (options.enable_caching)
@@ -1867,8 +1883,8 @@ int HostResolverImpl::Resolve(const RequestInfo& info,
   JobMap::iterator jobit = jobs_.find(key);
   Job* job;
   if (jobit == jobs_.end()) {
-    job =
-        new Job(weak_ptr_factory_.GetWeakPtr(), key, priority, source_net_log);
+    job = new Job(weak_ptr_factory_.GetWeakPtr(), key, priority,
+                  source_net_log, false);
     job->Schedule(false);
 
     // Check for queue overflow.
@@ -1911,8 +1927,18 @@ int HostResolverImpl::ResolveHelper(const Key& key,
   int net_error = ERR_UNEXPECTED;
   if (ResolveAsIP(key, info, &net_error, addresses))
     return net_error;
-  if (ServeFromCache(key, info, &net_error, addresses)) {
-    source_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CACHE_HIT);
+  base::TimeDelta expires_in;
+  if (ServeFromCache(key, info, &net_error, addresses, &expires_in)) {
+    if (expires_in <= base::TimeDelta()) {
+      source_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_STALE_CACHE_HIT);
+      RefreshCacheEntry(key, source_net_log);
+    } else {
+      source_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CACHE_HIT);
+      if (net_error == OK && expires_in <= refresh_window_) {
+        source_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CACHE_REFRESH);
+        RefreshCacheEntry(key, source_net_log);
+      }
+    }
     return net_error;
   }
   // TODO(szym): Do not do this if nsswitch.conf instructs not to.
@@ -2026,14 +2052,16 @@ bool HostResolverImpl::ResolveAsIP(const Key& key,
 bool HostResolverImpl::ServeFromCache(const Key& key,
                                       const RequestInfo& info,
                                       int* net_error,
-                                      AddressList* addresses) {
+                                      AddressList* addresses,
+                                      base::TimeDelta* expires_in) {
   DCHECK(addresses);
   DCHECK(net_error);
+  DCHECK(expires_in);
   if (!info.allow_cached_response() || !cache_.get())
     return false;
 
-  const HostCache::Entry* cache_entry = cache_->Lookup(
-      key, base::TimeTicks::Now());
+  const HostCache::Entry* cache_entry = cache_->LookupStale(
+      key, base::TimeTicks::Now(), max_stale_age_, expires_in);
   if (!cache_entry)
     return false;
 
@@ -2101,6 +2129,26 @@ void HostResolverImpl::CacheResult(const Key& key,
     cache_->Set(key, entry, base::TimeTicks::Now(), ttl);
 }
 
+void HostResolverImpl::RefreshCacheEntry(const Key& key,
+                                         const BoundNetLog& source_net_log) {
+  if (jobs_.find(key) != jobs_.end())
+    return;
+
+  Job* job = new Job(weak_ptr_factory_.GetWeakPtr(), key, IDLE,
+                     source_net_log, true);
+  job->Schedule(false);
+
+  // Check for queue overflow.
+  if (dispatcher_->num_queued_jobs() > max_queued_jobs_) {
+    Job* evicted = static_cast<Job*>(dispatcher_->EvictOldestLowest());
+    DCHECK(evicted);
+    evicted->OnEvicted();  // Deletes |evicted|.
+    if (evicted == job)
+      return;
+  }
+  jobs_.insert(std::make_pair(key, job));
+}
+
 void HostResolverImpl::RemoveJob(Job* job) {
   DCHECK(job);
   JobMap::iterator it = jobs_.find(job->key());
@@ -177,11 +177,17 @@ class NET_EXPORT HostResolverImpl
 
   // If |key| is not found in cache returns false, otherwise returns
   // true, sets |net_error| to the cached error code and fills |addresses|
-  // if it is a positive entry.
+  // if it is a positive entry. Sets |expires_in| to the time left until the
+  // entry expires, which is zero or negative for a stale entry.
   bool ServeFromCache(const Key& key,
                       const RequestInfo& info,
                       int* net_error,
-                      AddressList* addresses);
+                      AddressList* addresses,
+                      base::TimeDelta* expires_in);
+
+  // Starts a background Job to refresh the cache entry for |key|, unless one
+  // is already resolving it.
+  void RefreshCacheEntry(const Key& key, const BoundNetLog& source_net_log);
 
   // If we have a DnsClient with a valid DnsConfig, and |key| is found in the
   // HOSTS file, returns true and fills |addresses|. Otherwise returns false.
@@ -287,6 +293,10 @@ class NET_EXPORT HostResolverImpl
   // Allow fallback to ProcTask if DnsTask fails.
   bool fallback_to_proctask_;
 
+  // See HostResolver::Options.
+  const base::TimeDelta max_stale_age_;
+  const base::TimeDelta refresh_window_;
+
   base::WeakPtrFactory<HostResolverImpl> weak_ptr_factory_;
 
   base::WeakPtrFactory<HostResolverImpl> probe_weak_ptr_factory_;
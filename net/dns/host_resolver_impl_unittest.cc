@@ -888,6 +888,52 @@ TEST_F(HostResolverImplTest, BypassCache) {
   EXPECT_EQ(2u, proc_->GetCaptureList().size());
 }
 
+// Test that an expired cache entry is served while it is refreshed in the
+// background, when the resolver is configured to serve stale results.
+TEST_F(HostResolverImplTest, ServeStaleCacheEntry) {
+  HostResolver::Options options = DefaultOptions();
+  options.max_stale_age = base::TimeDelta::FromHours(1);
+  resolver_.reset(new HostResolverImpl(options, NULL));
+  resolver_->set_proc_params_for_test(DefaultParams(proc_.get()));
+
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.42");
+  proc_->SignalMultiple(1u);
+
+  Request* req = CreateRequest("just.testing", 80);
+  EXPECT_EQ(ERR_IO_PENDING, req->Resolve());
+  EXPECT_EQ(OK, req->WaitForResult());
+
+  // Expire the cached result, and change what the name resolves to.
+  HostCache* cache = resolver_->GetHostCache();
+  ASSERT_EQ(1u, cache->size());
+  HostCache::EntryMap::Iterator it(cache->entries());
+  const HostCache::Key key = it.key();
+  const HostCache::Entry entry = it.value();
+  cache->Set(key, entry, base::TimeTicks::Now(), base::TimeDelta());
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.43");
+
+  // The stale result is served synchronously, and starts a refresh.
+  req = CreateRequest("just.testing", 81);
+  EXPECT_EQ(OK, req->Resolve());
+  EXPECT_TRUE(req->HasOneAddress("192.168.1.42", 81));
+  EXPECT_EQ(1u, cache->stale_hits());
+
+  // A request that bypasses the cache attaches to the refresh.
+  HostResolver::RequestInfo info(HostPortPair("just.testing", 82));
+  info.set_allow_cached_response(false);
+  req = CreateRequest(info, DEFAULT_PRIORITY);
+  EXPECT_EQ(ERR_IO_PENDING, req->Resolve());
+  proc_->SignalMultiple(1u);
+  EXPECT_EQ(OK, req->WaitForResult());
+  EXPECT_TRUE(req->HasOneAddress("192.168.1.43", 82));
+  EXPECT_EQ(2u, proc_->GetCaptureList().size());
+
+  // The refreshed result replaced the stale one.
+  req = CreateRequest("just.testing", 83);
+  EXPECT_EQ(OK, req->Resolve());
+  EXPECT_TRUE(req->HasOneAddress("192.168.1.43", 83));
+}
+
 // Test that IP address changes flush the cache.
 TEST_F(HostResolverImplTest, FlushCacheOnIPAddressChange) {
   proc_->SignalMultiple(2u);  // One before the flush, one after.
@@ -0,0 +1,135 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/filter/gzip_filter.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "net/base/io_buffer.h"
+#include "net/filter/mock_filter_context.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+#include "third_party/zlib/zlib.h"
+
+namespace net {
+
+namespace {
+
+const int kIterations = 50;
+const int kDocumentLines = 20000;
+
+// Returns a stylesheet-like document of |kDocumentLines| lines, which
+// compresses about as well as the text resources most responses carry.
+std::string MakeDocument() {
+  std::string document;
+  for (int i = 0; i < kDocumentLines; ++i) {
+    document.append(".widget-");
+    document.append(base::IntToString(i % 997));
+    document.append(" > .item:hover { margin: ");
+    document.append(base::IntToString(i % 13));
+    document.append("px auto; color: #");
+    document.append(base::IntToString(100000 + i * 37 % 900000));
+    document.append("; }\n");
+  }
+  return document;
+}
+
+class GZipFilterPerfTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    expanded_ = MakeDocument();
+
+    // A window of 15 bits plus 16 asks zlib for a gzip header and footer.
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    ASSERT_EQ(Z_OK, deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                                 MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY));
+    compressed_.resize(deflateBound(&stream, expanded_.size()));
+    stream.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(expanded_.data()));
+    stream.avail_in = expanded_.size();
+    stream.next_out = reinterpret_cast<Bytef*>(&compressed_[0]);
+    stream.avail_out = compressed_.size();
+    ASSERT_EQ(Z_STREAM_END, deflate(&stream, Z_FINISH));
+    compressed_.resize(compressed_.size() - stream.avail_out);
+    deflateEnd(&stream);
+  }
+
+  // Decodes |compressed_| through a new gzip filter into |output|, reading
+  // at most |output_buffer_size| bytes at a time, the way URLRequestJob reads
+  // into the consumer's buffer.
+  bool Decode(size_t output_buffer_size, std::string* output) {
+    std::vector<Filter::FilterType> filter_types;
+    filter_types.push_back(Filter::FILTER_TYPE_GZIP);
+    scoped_ptr<Filter> filter(Filter::Factory(filter_types, filter_context_));
+
+    output->clear();
+    scoped_ptr<char[]> output_buffer(new char[output_buffer_size]);
+    Filter::FilterStatus status = Filter::FILTER_NEED_MORE_DATA;
+    size_t source_index = 0;
+    while (true) {
+      int copy_amount =
+          std::min(static_cast<size_t>(filter->stream_buffer_size()),
+                   compressed_.size() - source_index);
+      if (copy_amount > 0 && status == Filter::FILTER_NEED_MORE_DATA) {
+        memcpy(filter->stream_buffer()->data(),
+               compressed_.data() + source_index, copy_amount);
+        filter->FlushStreamBuffer(copy_amount);
+        source_index += copy_amount;
+      }
+      int buffer_length = output_buffer_size;
+      status = filter->ReadData(output_buffer.get(), &buffer_length);
+      output->append(output_buffer.get(), buffer_length);
+      if (status == Filter::FILTER_ERROR)
+        return false;
+      if (status == Filter::FILTER_DONE)
+        return true;
+      if (copy_amount == 0 && buffer_length == 0)
+        return true;
+    }
+  }
+
+  void RunDecode(const std::string& trace, size_t output_buffer_size) {
+    std::string output;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kIterations; ++i)
+      ASSERT_TRUE(Decode(output_buffer_size, &output));
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    EXPECT_EQ(expanded_, output);
+
+    double megabytes =
+        static_cast<double>(expanded_.size()) * kIterations / (1024 * 1024);
+    perf_test::PrintResult("gzip_filter", "", trace,
+                           megabytes / elapsed.InSecondsF(), "MB/s", true);
+  }
+
+  std::string expanded_;
+  std::string compressed_;
+  MockFilterContext filter_context_;
+};
+
+TEST_F(GZipFilterPerfTest, Decode) {
+  perf_test::PrintResult("gzip_filter", "", "expanded_bytes",
+                         expanded_.size(), "bytes", true);
+  perf_test::PrintResult("gzip_filter", "", "compressed_bytes",
+                         compressed_.size(), "bytes", true);
+  RunDecode("decode", 32 * 1024);
+}
+
+// Small reads make zlib copy more of each match out of its window rather than
+// out of the output it has just written.
+TEST_F(GZipFilterPerfTest, DecodeSmallReads) {
+  RunDecode("decode_small_reads", 4 * 1024);
+}
+
+}  // namespace
+
+}  // namespace net
@@ -0,0 +1,145 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/filter/sdch_filter.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "net/base/sdch_manager.h"
+#include "net/filter/mock_filter_context.h"
+#include "net/url_request/url_request_context.h"
+#include "sdch/open-vcdiff/src/google/vcencoder.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+#include "url/gurl.h"
+
+namespace net {
+
+namespace {
+
+const int kIterations = 50;
+const int kBundleLines = 5000;
+const size_t kOutputBufferSize = 32 * 1024;
+const char kDomain[] = "sdchtest.com";
+
+// Returns a script bundle of |kBundleLines| lines. Bundles of different
+// |version|s differ in one line out of every hundred, the way successive
+// releases of an application's resources mostly do.
+std::string MakeBundle(int version) {
+  std::string bundle;
+  for (int i = 0; i < kBundleLines; ++i) {
+    bundle.append("function handler");
+    bundle.append(base::IntToString(i));
+    bundle.append("(event) { return dispatch(event, \"");
+    bundle.append(i % 100 == 0 ? base::IntToString(version)
+                               : base::IntToString(i * 7));
+    bundle.append("\"); }\n");
+  }
+  return bundle;
+}
+
+class SdchFilterPerfTest : public ::testing::Test {
+ protected:
+  SdchFilterPerfTest()
+      : url_(std::string("http://") + kDomain + "/bundle.js"),
+        sdch_manager_(new SdchManager),
+        filter_context_(new MockFilterContext) {
+    filter_context_->GetModifiableURLRequestContext()->set_sdch_manager(
+        sdch_manager_.get());
+  }
+
+  void SetUp() override {
+    // The dictionary is the previous release of the bundle.
+    std::string vcdiff_dictionary(MakeBundle(1));
+    dictionary_ = std::string("Domain: ") + kDomain + "\n\n";
+    dictionary_.append(vcdiff_dictionary);
+    ASSERT_EQ(SDCH_OK, sdch_manager_->AddSdchDictionary(dictionary_, url_));
+
+    // The response is the current release, encoded against the dictionary.
+    expanded_ = MakeBundle(2);
+    std::string client_hash;
+    std::string server_hash;
+    SdchManager::GenerateHash(dictionary_, &client_hash, &server_hash);
+    open_vcdiff::VCDiffEncoder encoder(vcdiff_dictionary.data(),
+                                       vcdiff_dictionary.size());
+    std::string delta;
+    ASSERT_TRUE(encoder.Encode(expanded_.data(), expanded_.size(), &delta));
+    compressed_ = server_hash;
+    compressed_.append("\0", 1);
+    compressed_.append(delta);
+
+    filter_context_->SetURL(url_);
+  }
+
+  // Decodes |compressed_| through a new SDCH filter into |output|, feeding it
+  // the filter's whole stream buffer at a time, the way URLRequestJob does.
+  bool Decode(std::string* output) {
+    filter_context_->SetSdchResponse(sdch_manager_->GetDictionarySet(url_));
+    std::vector<Filter::FilterType> filter_types;
+    filter_types.push_back(Filter::FILTER_TYPE_SDCH);
+    scoped_ptr<Filter> filter(Filter::Factory(filter_types, *filter_context_));
+
+    output->clear();
+    scoped_ptr<char[]> output_buffer(new char[kOutputBufferSize]);
+    Filter::FilterStatus status = Filter::FILTER_NEED_MORE_DATA;
+    size_t source_index = 0;
+    while (true) {
+      int copy_amount =
+          std::min(static_cast<size_t>(filter->stream_buffer_size()),
+                   compressed_.size() - source_index);
+      if (copy_amount > 0 && status == Filter::FILTER_NEED_MORE_DATA) {
+        memcpy(filter->stream_buffer()->data(),
+               compressed_.data() + source_index, copy_amount);
+        filter->FlushStreamBuffer(copy_amount);
+        source_index += copy_amount;
+      }
+      int buffer_length = kOutputBufferSize;
+      status = filter->ReadData(output_buffer.get(), &buffer_length);
+      output->append(output_buffer.get(), buffer_length);
+      if (status == Filter::FILTER_ERROR)
+        return false;
+      if (status == Filter::FILTER_OK && buffer_length == 0)
+        return true;
+      if (copy_amount == 0 && buffer_length == 0)
+        return true;
+    }
+  }
+
+  const GURL url_;
+  std::string dictionary_;
+  std::string expanded_;
+  std::string compressed_;
+  scoped_ptr<SdchManager> sdch_manager_;
+  scoped_ptr<MockFilterContext> filter_context_;
+};
+
+// Reports how many bytes a response that mostly matches a registered
+// dictionary takes on the wire, and how fast it is decoded.
+TEST_F(SdchFilterPerfTest, DecodeBundle) {
+  perf_test::PrintResult("sdch_filter", "", "expanded_bytes",
+                         expanded_.size(), "bytes", true);
+  perf_test::PrintResult("sdch_filter", "", "compressed_bytes",
+                         compressed_.size(), "bytes", true);
+
+  std::string output;
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i)
+    ASSERT_TRUE(Decode(&output));
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+  EXPECT_EQ(expanded_, output);
+
+  double megabytes =
+      static_cast<double>(expanded_.size()) * kIterations / (1024 * 1024);
+  perf_test::PrintResult("sdch_filter", "", "decode",
+                         megabytes / elapsed.InSecondsF(), "MB/s", true);
+}
+
+}  // namespace
+
+}  // namespace net
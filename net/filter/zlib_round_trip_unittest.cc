@@ -0,0 +1,356 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Round-trip tests for zlib's inflate_fast(), where GZipFilter and the
+// WebSocket inflater spend most of their time. Each case deflates generated
+// data with random parameters and checks that inflate() or inflateBack()
+// gives it back. Run them under ASan after changing third_party/zlib.
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+#include "base/strings/stringprintf.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/zlib/zlib.h"
+
+namespace net {
+
+namespace {
+
+const int kNumCases = 300;
+
+// A small deterministic generator, so that a failing case can be replayed.
+class TestRandom {
+ public:
+  explicit TestRandom(uint64 seed) : state_(seed) {}
+
+  // Returns a value in [0, range).
+  uint32 Next(uint32 range) {
+    state_ = state_ * GG_UINT64_C(6364136223846793005) +
+             GG_UINT64_C(1442695040888963407);
+    return static_cast<uint32>(state_ >> 33) % range;
+  }
+
+ private:
+  uint64 state_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestRandom);
+};
+
+enum Format {
+  FORMAT_RAW,
+  FORMAT_ZLIB,
+  FORMAT_GZIP,
+  NUM_FORMATS
+};
+
+// Returns |size| bytes over an alphabet of |alphabet| letters, a third of
+// them copied from up to |max_distance| bytes back.
+std::string MakeData(TestRandom* random,
+                     size_t size,
+                     uint32 alphabet,
+                     uint32 max_distance) {
+  std::string data;
+  data.reserve(size);
+  while (data.size() < size) {
+    if (data.size() > 20 && random->Next(3) == 0) {
+      size_t distance = 1 + random->Next(
+          std::min<uint32>(data.size(), random->Next(2) ? 16 : max_distance));
+      size_t length = std::min<size_t>(random->Next(300), size - data.size());
+      for (size_t i = 0; i < length; ++i)
+        data.push_back(data[data.size() - distance]);
+    } else {
+      data.push_back(static_cast<char>(random->Next(alphabet)));
+    }
+  }
+  return data;
+}
+
+// Writes a raw deflate stream of one block with the fixed Huffman codes of
+// RFC 1951, for matches that zlib's deflate() never makes.
+class FixedHuffmanWriter {
+ public:
+  FixedHuffmanWriter() : bits_(0), num_bits_(0) {
+    WriteBits(1, 1);  // BFINAL.
+    WriteBits(1, 2);  // BTYPE: fixed Huffman codes.
+  }
+
+  void WriteLiteral(unsigned char literal) {
+    if (literal < 144)
+      WriteCode(0x30 + literal, 8);
+    else
+      WriteCode(0x190 + literal - 144, 9);
+  }
+
+  // Writes a match of 258 bytes from |distance| bytes back.
+  void WriteMatch(uint32 distance) {
+    WriteCode(0xc0 + 285 - 280, 8);
+    uint32 code = 0;
+    while (code + 1 < 30 && DistanceBase(code + 1) <= distance)
+      ++code;
+    WriteCode(code, 5);
+    WriteBits(distance - DistanceBase(code), DistanceExtraBits(code));
+  }
+
+  // Writes the end of the block and returns the stream.
+  std::string Finish() {
+    WriteCode(0, 7);
+    if (num_bits_)
+      output_.push_back(static_cast<char>(bits_));
+    return output_;
+  }
+
+ private:
+  static uint32 DistanceExtraBits(uint32 code) {
+    return code < 4 ? 0 : code / 2 - 1;
+  }
+
+  static uint32 DistanceBase(uint32 code) {
+    if (code < 4)
+      return code + 1;
+    return (1 << (code / 2)) + (code % 2) * (1 << DistanceExtraBits(code)) + 1;
+  }
+
+  // Huffman codes go out most significant bit first.
+  void WriteCode(uint32 code, int length) {
+    for (int i = length - 1; i >= 0; --i)
+      WriteBits((code >> i) & 1, 1);
+  }
+
+  void WriteBits(uint32 value, int count) {
+    for (int i = 0; i < count; ++i) {
+      bits_ |= ((value >> i) & 1) << num_bits_;
+      if (++num_bits_ == 8) {
+        output_.push_back(static_cast<char>(bits_));
+        bits_ = 0;
+        num_bits_ = 0;
+      }
+    }
+  }
+
+  std::string output_;
+  uint32 bits_;
+  int num_bits_;
+
+  DISALLOW_COPY_AND_ASSIGN(FixedHuffmanWriter);
+};
+
+int WindowBitsForFormat(Format format, int window_bits) {
+  switch (format) {
+    case FORMAT_RAW:
+      return -window_bits;
+    case FORMAT_ZLIB:
+      return window_bits;
+    case FORMAT_GZIP:
+      return window_bits + 16;
+    case NUM_FORMATS:
+      break;
+  }
+  NOTREACHED();
+  return 0;
+}
+
+// Deflates |data| in one call, returning false on failure.
+bool Deflate(const std::string& data,
+             int level,
+             int window_bits,
+             int mem_level,
+             int strategy,
+             std::string* compressed) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, level, Z_DEFLATED, window_bits, mem_level,
+                   strategy) != Z_OK) {
+    return false;
+  }
+  std::vector<Bytef> buffer(deflateBound(&stream, data.size()));
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = data.size();
+  stream.next_out = &buffer[0];
+  stream.avail_out = buffer.size();
+  int result = deflate(&stream, Z_FINISH);
+  compressed->assign(reinterpret_cast<char*>(&buffer[0]),
+                     buffer.size() - stream.avail_out);
+  deflateEnd(&stream);
+  return result == Z_STREAM_END;
+}
+
+// Inflates |compressed| with inflate(), feeding it input and output in
+// random chunks. Each output chunk is its own exactly sized buffer, so that
+// ASan catches writes past the end of the output.
+bool Inflate(TestRandom* random,
+             const std::string& compressed,
+             int window_bits,
+             std::string* data) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, window_bits) != Z_OK)
+    return false;
+  uint32 max_output = random->Next(2) ? 300 : 70000;
+  size_t input_offset = 0;
+  int result = Z_OK;
+  while (result != Z_STREAM_END) {
+    size_t input_size =
+        std::min<size_t>(compressed.size() - input_offset,
+                         1 + random->Next(random->Next(3) ? 70000 : 16));
+    std::vector<Bytef> output(1 + random->Next(max_output));
+    stream.next_in = reinterpret_cast<Bytef*>(
+        const_cast<char*>(compressed.data() + input_offset));
+    stream.avail_in = input_size;
+    stream.next_out = &output[0];
+    stream.avail_out = output.size();
+    result = inflate(&stream, Z_NO_FLUSH);
+    if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+      break;
+    if (result == Z_BUF_ERROR && input_offset == compressed.size())
+      break;
+    input_offset += input_size - stream.avail_in;
+    data->append(reinterpret_cast<char*>(&output[0]),
+                 output.size() - stream.avail_out);
+  }
+  inflateEnd(&stream);
+  return result == Z_STREAM_END;
+}
+
+struct InflateBackInput {
+  TestRandom* random;
+  const std::string* compressed;
+  size_t offset;
+};
+
+unsigned InflateBackRead(void* context, unsigned char** buffer) {
+  InflateBackInput* input = static_cast<InflateBackInput*>(context);
+  size_t size = std::min<size_t>(input->compressed->size() - input->offset,
+                                 1 + input->random->Next(70000));
+  *buffer = reinterpret_cast<unsigned char*>(
+      const_cast<char*>(input->compressed->data() + input->offset));
+  input->offset += size;
+  return size;
+}
+
+int InflateBackWrite(void* context, unsigned char* buffer, unsigned size) {
+  static_cast<std::string*>(context)
+      ->append(reinterpret_cast<char*>(buffer), size);
+  return 0;
+}
+
+// Inflates the raw deflate data |compressed| with inflateBack(), which
+// decodes into its window of 1 << |window_bits| bytes.
+bool InflateBack(TestRandom* random,
+                 const std::string& compressed,
+                 int window_bits,
+                 std::string* data) {
+  std::vector<unsigned char> window(1 << window_bits);
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateBackInit(&stream, window_bits, &window[0]) != Z_OK)
+    return false;
+  InflateBackInput input = { random, &compressed, 0 };
+  int result = inflateBack(&stream, &InflateBackRead, &input,
+                           &InflateBackWrite, data);
+  inflateBackEnd(&stream);
+  return result == Z_STREAM_END;
+}
+
+}  // namespace
+
+TEST(ZlibRoundTripTest, Inflate) {
+  TestRandom random(1);
+  for (int i = 0; i < kNumCases; ++i) {
+    size_t size = random.Next(random.Next(4) ? 5000 : 200000);
+    std::string data =
+        MakeData(&random, size, 1 + random.Next(256), 40000);
+    Format format = static_cast<Format>(random.Next(NUM_FORMATS));
+    int window_bits = 9 + random.Next(7);
+    int level = random.Next(10);
+    int mem_level = 1 + random.Next(9);
+    const int kStrategies[] = { Z_DEFAULT_STRATEGY, Z_FILTERED,
+                                Z_HUFFMAN_ONLY, Z_RLE };
+    int strategy = kStrategies[random.Next(arraysize(kStrategies))];
+    SCOPED_TRACE(base::StringPrintf(
+        "case %d: size %d, format %d, window bits %d, level %d", i,
+        static_cast<int>(size), format, window_bits, level));
+
+    std::string compressed;
+    ASSERT_TRUE(Deflate(data, level, WindowBitsForFormat(format, window_bits),
+                        mem_level, strategy, &compressed));
+    // Decode with either the window size of the stream or the largest one.
+    if (random.Next(2))
+      window_bits = 15;
+    std::string inflated;
+    ASSERT_TRUE(Inflate(&random, compressed,
+                        WindowBitsForFormat(format, window_bits), &inflated));
+    ASSERT_TRUE(data == inflated);
+  }
+}
+
+TEST(ZlibRoundTripTest, InflateBack) {
+  TestRandom random(2);
+  for (int i = 0; i < kNumCases; ++i) {
+    size_t size = random.Next(random.Next(4) ? 5000 : 200000);
+    int window_bits = 9 + random.Next(7);
+    std::string data = MakeData(&random, size, 1 + random.Next(256),
+                                1 << window_bits);
+    int level = random.Next(10);
+    SCOPED_TRACE(base::StringPrintf("case %d: size %d, window bits %d, level %d",
+                                    i, static_cast<int>(size), window_bits,
+                                    level));
+
+    std::string compressed;
+    ASSERT_TRUE(Deflate(data, level, -window_bits, 8, Z_DEFAULT_STRATEGY,
+                        &compressed));
+    std::string inflated;
+    ASSERT_TRUE(InflateBack(&random, compressed, window_bits, &inflated));
+    ASSERT_TRUE(data == inflated);
+  }
+}
+
+// Matches from nearly a whole window back make inflateBack() copy from the
+// part of its window that it is about to write over, and read bytes just past
+// the end of the matches before them. deflate() keeps matches at least 262
+// bytes short of the window size, so the stream is made by hand.
+TEST(ZlibRoundTripTest, InflateBackLongDistance) {
+  TestRandom random(3);
+  const uint32 kDistances[] = { 32768, 32767, 32764, 32760, 32506, 30000 };
+  const uint32 kShortDistance = 100;
+  const uint32 kMatchLength = 258;
+  const int kNumMatches = 500;
+  for (size_t i = 0; i < arraysize(kDistances); ++i) {
+    SCOPED_TRACE(base::StringPrintf("distance %d",
+                                    static_cast<int>(kDistances[i])));
+    std::string data;
+    FixedHuffmanWriter writer;
+    for (uint32 j = 0; j < kDistances[i]; ++j) {
+      data.push_back(static_cast<char>(random.Next(256)));
+      writer.WriteLiteral(data.back());
+    }
+    // Each long match follows a short one and a literal, which keeps the
+    // window from repeating itself.
+    for (int j = 0; j < 2 * kNumMatches; ++j) {
+      uint32 distance = j % 2 ? kShortDistance : kDistances[i];
+      data.push_back(static_cast<char>(random.Next(256)));
+      writer.WriteLiteral(data.back());
+      for (uint32 k = 0; k < kMatchLength; ++k)
+        data.push_back(data[data.size() - distance]);
+      writer.WriteMatch(distance);
+    }
+    std::string compressed = writer.Finish();
+
+    std::string inflated;
+    ASSERT_TRUE(InflateBack(&random, compressed, 15, &inflated));
+    ASSERT_TRUE(data == inflated);
+
+    inflated.clear();
+    ASSERT_TRUE(Inflate(&random, compressed, -15, &inflated));
+    ASSERT_TRUE(data == inflated);
+  }
+}
+
+}  // namespace net
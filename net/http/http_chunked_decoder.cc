@@ -69,21 +69,30 @@ HttpChunkedDecoder::HttpChunkedDecoder()
 int HttpChunkedDecoder::FilterBuf(char* buf, int buf_len) {
   int result = 0;
 
+  // Decoded data is compacted to |out| as chunk markers are skipped, so each
+  // byte is moved at most once, and data ahead of the first marker not at all.
+  char* out = buf;
   while (buf_len) {
     if (chunk_remaining_) {
       int num = std::min(chunk_remaining_, buf_len);
+      if (out != buf)
+        memmove(out, buf, num);
 
       buf_len -= num;
       chunk_remaining_ -= num;
 
       result += num;
       buf += num;
+      out += num;
 
       // After each chunk's data there should be a CRLF
       if (!chunk_remaining_)
         chunk_terminator_remaining_ = true;
       continue;
     } else if (reached_eof_) {
+      // Callers expect the extra bytes to follow the decoded data.
+      if (out != buf)
+        memmove(out, buf, buf_len);
       bytes_after_eof_ += buf_len;
       break;  // Done!
     }
@@ -93,8 +102,7 @@ int HttpChunkedDecoder::FilterBuf(char* buf, int buf_len) {
       return bytes_consumed; // Error
 
     buf_len -= bytes_consumed;
-    if (buf_len)
-      memmove(buf, buf + bytes_consumed, buf_len);
+    buf += bytes_consumed;
   }
 
   return result;
@@ -324,6 +324,18 @@ TEST(HttpChunkedDecoderTest, MultipleExtraDataBlocks) {
   RunTest(inputs, arraysize(inputs), "hello", true, 11);
 }
 
+TEST(HttpChunkedDecoderTest, ManyChunksExtraData) {
+  // The extra bytes are moved along with the decoded data, to directly after
+  // it, where HttpStreamParser looks for them.
+  std::string input = "3\r\none\r\n3\r\ntwo\r\n5\r\nthree\r\n0\r\n\r\nextra";
+  HttpChunkedDecoder decoder;
+  int n = decoder.FilterBuf(&input[0], static_cast<int>(input.size()));
+  EXPECT_EQ(11, n);
+  EXPECT_TRUE(decoder.reached_eof());
+  EXPECT_EQ(5, decoder.bytes_after_eof());
+  EXPECT_EQ("onetwothreeextra", input.substr(0, 16));
+}
+
 // Test when the line with the chunk length is too long.
 TEST(HttpChunkedDecoderTest, LongChunkLengthLine) {
   int big_chunk_length = HttpChunkedDecoder::kMaxLineBufLen;
@@ -129,12 +129,19 @@ struct HttpResponseHeaders::ParsedHeader {
   std::string::const_iterator name_end;
   std::string::const_iterator value_begin;
   std::string::const_iterator value_end;
+
+  // Index in parsed_ of the next line with the same header name, or
+  // std::string::npos. Unused for continuations.
+  size_t next_same_name;
 };
 
 //-----------------------------------------------------------------------------
 
 HttpResponseHeaders::HttpResponseHeaders(const std::string& raw_input)
-    : response_code_(-1) {
+    : response_code_(-1),
+      content_length_(-1),
+      has_max_age_(false),
+      has_stale_while_revalidate_(false) {
   Parse(raw_input);
 
   // The most important thing to do with this histogram is find out
@@ -158,7 +165,10 @@ HttpResponseHeaders::HttpResponseHeaders(const std::string& raw_input)
 
 HttpResponseHeaders::HttpResponseHeaders(const Pickle& pickle,
                                          PickleIterator* iter)
-    : response_code_(-1) {
+    : response_code_(-1),
+      content_length_(-1),
+      has_max_age_(false),
+      has_stale_while_revalidate_(false) {
   std::string raw_input;
   if (pickle.ReadString(iter, &raw_input))
     Parse(raw_input);
@@ -293,6 +303,7 @@ void HttpResponseHeaders::MergeWithHeaders(const std::string& raw_headers,
   // Make this object hold the new data.
   raw_headers_.clear();
   parsed_.clear();
+  header_index_.clear();
   Parse(new_raw_headers);
 }
 
@@ -340,6 +351,7 @@ void HttpResponseHeaders::RemoveHeaderLine(const std::string& name,
   // Make this object hold the new data.
   raw_headers_.clear();
   parsed_.clear();
+  header_index_.clear();
   Parse(new_raw_headers);
 }
 
@@ -356,6 +368,7 @@ void HttpResponseHeaders::AddHeader(const std::string& header) {
   // Make this object hold the new data.
   raw_headers_.clear();
   parsed_.clear();
+  header_index_.clear();
   Parse(new_raw_headers);
 }
 
@@ -415,6 +428,7 @@ void HttpResponseHeaders::Parse(const std::string& raw_input) {
 
     DCHECK_EQ('\0', raw_headers_[raw_headers_.size() - 2]);
     DCHECK_EQ('\0', raw_headers_[raw_headers_.size() - 1]);
+    CacheHeaderValues();
     return;
   }
 
@@ -446,6 +460,15 @@ void HttpResponseHeaders::Parse(const std::string& raw_input) {
 
   DCHECK_EQ('\0', raw_headers_[raw_headers_.size() - 2]);
   DCHECK_EQ('\0', raw_headers_[raw_headers_.size() - 1]);
+  CacheHeaderValues();
+}
+
+void HttpResponseHeaders::CacheHeaderValues() {
+  content_length_ = GetInt64HeaderValue("content-length");
+  has_max_age_ = GetCacheControlDirective("max-age", &max_age_);
+  has_stale_while_revalidate_ =
+      GetCacheControlDirective("stale-while-revalidate",
+                               &stale_while_revalidate_);
 }
 
 // Append all of our headers to the final output string.
@@ -614,7 +637,11 @@ bool HttpResponseHeaders::HasHeader(const base::StringPiece& name) const {
   return FindHeader(0, name) != std::string::npos;
 }
 
-HttpResponseHeaders::HttpResponseHeaders() : response_code_(-1) {
+HttpResponseHeaders::HttpResponseHeaders()
+    : response_code_(-1),
+      content_length_(-1),
+      has_max_age_(false),
+      has_stale_while_revalidate_(false) {
 }
 
 HttpResponseHeaders::~HttpResponseHeaders() {
@@ -739,18 +766,21 @@ void HttpResponseHeaders::ParseStatusLine(
 
 size_t HttpResponseHeaders::FindHeader(size_t from,
                                        const base::StringPiece& search) const {
-  for (size_t i = from; i < parsed_.size(); ++i) {
-    if (parsed_[i].is_continuation())
-      continue;
-    const std::string::const_iterator& name_begin = parsed_[i].name_begin;
-    const std::string::const_iterator& name_end = parsed_[i].name_end;
-    if (static_cast<size_t>(name_end - name_begin) == search.size() &&
-        std::equal(name_begin, name_end, search.begin(),
-                   base::CaseInsensitiveCompare<char>()))
-      return i;
-  }
+  std::string lowercase_search(search.data(), search.size());
+  base::StringToLowerASCII(&lowercase_search);
+  return FindLowerCaseHeader(from, lowercase_search);
+}
+
+size_t HttpResponseHeaders::FindLowerCaseHeader(size_t from,
+                                                const std::string& name) const {
+  HeaderIndex::const_iterator it = header_index_.find(name);
+  if (it == header_index_.end() || it->second.last < from)
+    return std::string::npos;
 
-  return std::string::npos;
+  size_t i = it->second.first;
+  while (i < from)
+    i = parsed_[i].next_same_name;
+  return i;
 }
 
 bool HttpResponseHeaders::GetCacheControlDirective(const StringPiece& directive,
@@ -806,7 +836,23 @@ void HttpResponseHeaders::AddToParsed(std::string::const_iterator name_begin,
   header.name_end = name_end;
   header.value_begin = value_begin;
   header.value_end = value_end;
+  header.next_same_name = std::string::npos;
   parsed_.push_back(header);
+
+  if (header.is_continuation())
+    return;
+
+  const size_t index = parsed_.size() - 1;
+  std::string lowercase_name(name_begin, name_end);
+  base::StringToLowerASCII(&lowercase_name);
+  std::pair<HeaderIndex::iterator, bool> result = header_index_.insert(
+      std::make_pair(lowercase_name, HeaderIndexEntry()));
+  HeaderIndexEntry& entry = result.first->second;
+  if (result.second)
+    entry.first = index;
+  else
+    parsed_[entry.last].next_same_name = index;
+  entry.last = index;
 }
 
 void HttpResponseHeaders::AddNonCacheableHeaders(HeaderSet* result) const {
@@ -1152,7 +1198,10 @@ TimeDelta HttpResponseHeaders::GetCurrentAge(const Time& request_time,
 }
 
 bool HttpResponseHeaders::GetMaxAgeValue(TimeDelta* result) const {
-  return GetCacheControlDirective("max-age", result);
+  if (!has_max_age_)
+    return false;
+  *result = max_age_;
+  return true;
 }
 
 bool HttpResponseHeaders::GetAgeValue(TimeDelta* result) const {
@@ -1180,7 +1229,10 @@ bool HttpResponseHeaders::GetExpiresValue(Time* result) const {
 
 bool HttpResponseHeaders::GetStaleWhileRevalidateValue(
     TimeDelta* result) const {
-  return GetCacheControlDirective("stale-while-revalidate", result);
+  if (!has_stale_while_revalidate_)
+    return false;
+  *result = stale_while_revalidate_;
+  return true;
 }
 
 bool HttpResponseHeaders::GetTimeValuedHeader(const std::string& name,
@@ -1255,7 +1307,7 @@ bool HttpResponseHeaders::HasStrongValidators() const {
 // From RFC 2616:
 // Content-Length = "Content-Length" ":" 1*DIGIT
 int64 HttpResponseHeaders::GetContentLength() const {
-  return GetInt64HeaderValue("content-length");
+  return content_length_;
 }
 
 int64 HttpResponseHeaders::GetInt64HeaderValue(
@@ -12,6 +12,7 @@
 #include "base/containers/hash_tables.h"
 #include "base/memory/ref_counted.h"
 #include "base/strings/string_piece.h"
+#include "base/time/time.h"
 #include "net/base/net_export.h"
 #include "net/base/net_log.h"
 #include "net/http/http_version.h"
@@ -19,11 +20,6 @@
 class Pickle;
 class PickleIterator;
 
-namespace base {
-class Time;
-class TimeDelta;
-}
-
 namespace net {
 
 class HttpByteRange;
@@ -314,12 +310,24 @@ class NET_EXPORT HttpResponseHeaders
   struct ParsedHeader;
   typedef std::vector<ParsedHeader> HeaderList;
 
+  // The indices in parsed_ of the first and last (non-continuation) lines of a
+  // header. The lines in between are chained through ParsedHeader.
+  struct HeaderIndexEntry {
+    size_t first;
+    size_t last;
+  };
+  typedef base::hash_map<std::string, HeaderIndexEntry> HeaderIndex;
+
   HttpResponseHeaders();
   ~HttpResponseHeaders();
 
   // Initializes from the given raw headers.
   void Parse(const std::string& raw_input);
 
+  // Computes the cached values of frequently queried headers, once parsed_ is
+  // complete.
+  void CacheHeaderValues();
+
   // Helper function for ParseStatusLine.
   // Tries to extract the "HTTP/X.Y" from a status line formatted like:
   //    HTTP/1.1 200 OK
@@ -342,6 +350,9 @@ class NET_EXPORT HttpResponseHeaders
   // index |from|.  Returns string::npos if not found.
   size_t FindHeader(size_t from, const base::StringPiece& name) const;
 
+  // Like FindHeader(), for a name that is already in lower case.
+  size_t FindLowerCaseHeader(size_t from, const std::string& name) const;
+
   // Search the Cache-Control header for a directive matching |directive|. If
   // present, treat its value as a time offset in seconds, write it to |result|,
   // and return true.
@@ -393,6 +404,10 @@ class NET_EXPORT HttpResponseHeaders
   // header-value pairs within raw_headers_.
   HeaderList parsed_;
 
+  // Maps the lower case name of each header in parsed_ to its lines, so that
+  // lookups do not scan and case-fold the whole list.
+  HeaderIndex header_index_;
+
   // The raw_headers_ consists of the normalized status line (terminated with a
   // null byte) and then followed by the raw null-terminated headers from the
   // input that was passed to our constructor.  We preserve the input [*] to
@@ -410,6 +425,15 @@ class NET_EXPORT HttpResponseHeaders
   // The parsed http version number (not normalized).
   HttpVersion parsed_http_version_;
 
+  // Values of headers the HTTP cache queries for every response, computed by
+  // CacheHeaderValues(). |content_length_| is -1 if there is no valid
+  // Content-Length header.
+  int64 content_length_;
+  bool has_max_age_;
+  base::TimeDelta max_age_;
+  bool has_stale_while_revalidate_;
+  base::TimeDelta stale_while_revalidate_;
+
   DISALLOW_COPY_AND_ASSIGN(HttpResponseHeaders);
 };
 
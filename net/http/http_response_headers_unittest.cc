@@ -543,6 +543,50 @@ TEST(HttpResponseHeadersTest, EnumerateHeader_Coalesced) {
   EXPECT_FALSE(parsed->EnumerateHeader(&iter, "cache-control", &value));
 }
 
+TEST(HttpResponseHeadersTest, EnumerateHeader_Interleaved) {
+  // Lines of the same header that are separated by other headers, and differ
+  // in case, are enumerated in order.
+  std::string headers =
+      "HTTP/1.1 200 OK\n"
+      "Vary: Accept-Encoding\n"
+      "Content-Length: 10\n"
+      "X-Other: a, b\n"
+      "VARY: Cookie, Accept-Language\n"
+      "x-other: c\n"
+      "vary: Referer\n";
+  HeadersToRaw(&headers);
+  scoped_refptr<net::HttpResponseHeaders> parsed(
+      new net::HttpResponseHeaders(headers));
+
+  void* iter = NULL;
+  std::string value;
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, "vary", &value));
+  EXPECT_EQ("Accept-Encoding", value);
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, "vary", &value));
+  EXPECT_EQ("Cookie", value);
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, "vary", &value));
+  EXPECT_EQ("Accept-Language", value);
+  EXPECT_TRUE(parsed->EnumerateHeader(&iter, "vary", &value));
+  EXPECT_EQ("Referer", value);
+  EXPECT_FALSE(parsed->EnumerateHeader(&iter, "vary", &value));
+
+  EXPECT_TRUE(parsed->GetNormalizedHeader("X-OTHER", &value));
+  EXPECT_EQ("a, b, c", value);
+  EXPECT_FALSE(parsed->HasHeader("x-othe"));
+  EXPECT_EQ(10, parsed->GetContentLength());
+
+  // The index and cached values follow changes to the headers.
+  parsed->RemoveHeader("Vary");
+  parsed->AddHeader("Content-Length: 20");
+  EXPECT_FALSE(parsed->HasHeader("vary"));
+  EXPECT_TRUE(parsed->HasHeader("X-Other"));
+  EXPECT_EQ(10, parsed->GetContentLength());
+  parsed->RemoveHeader("Content-Length");
+  EXPECT_EQ(-1, parsed->GetContentLength());
+  parsed->AddHeader("Content-Length: 20");
+  EXPECT_EQ(20, parsed->GetContentLength());
+}
+
 TEST(HttpResponseHeadersTest, EnumerateHeader_Challenge) {
   // Even though WWW-Authenticate has commas, it should not be treated as
   // coalesced values.
@@ -68,6 +68,7 @@
           'action': [
             'python',
             'tools/tld_cleanup/make_dafsa.py',
+            '--reverse',
             '<(RULE_INPUT_PATH)',
             '<(SHARED_INTERMEDIATE_DIR)/net/<(RULE_INPUT_DIRNAME)/<(RULE_INPUT_ROOT)-inc.cc',
           ],
@@ -813,15 +814,27 @@
         '../base/base.gyp:base',
         '../base/base.gyp:base_i18n',
         '../base/base.gyp:test_support_perf',
+        '../sdch/sdch.gyp:sdch',
         '../testing/gtest.gyp:gtest',
+        '../testing/perf/perf_test.gyp:perf_test',
+        '../third_party/zlib/zlib.gyp:zlib',
         '../url/url.gyp:url_lib',
         'net',
         'net_test_support',
       ],
       'sources': [
+        'base/registry_controlled_domains/registry_controlled_domain_perftest.cc',
         'cookies/cookie_monster_perftest.cc',
         'disk_cache/blockfile/disk_cache_perftest.cc',
+        'filter/gzip_filter_perftest.cc',
+        'filter/sdch_filter_perftest.cc',
+        'http/http_response_headers_perftest.cc',
         'proxy/proxy_resolver_perftest.cc',
+        'socket/client_socket_pool_base_perftest.cc',
+        'socket/transport_client_socket_pool_test_util.cc',
+        'socket/transport_client_socket_pool_test_util.h',
+        'spdy/hpack_encoder_perftest.cc',
+        'spdy/hpack_huffman_table_perftest.cc',
         'websockets/websocket_frame_perftest.cc',
       ],
       'conditions': [
@@ -853,6 +866,14 @@
             'websockets/websocket_frame_perftest.cc',
           ],
         }],
+        ['os_posix == 1 and OS != "mac" and OS != "ios" and OS != "android"', {
+          'dependencies': [
+            'quic_base',
+          ],
+          'sources': [
+            'tools/quic/quic_server_pool_perftest.cc',
+          ],
+        }],
       ],
     },
     {
@@ -1367,6 +1388,8 @@
           'sources': [
             'tools/epoll_server/epoll_server.cc',
             'tools/epoll_server/epoll_server.h',
+            'tools/epoll_server/epoll_server_pool.cc',
+            'tools/epoll_server/epoll_server_pool.h',
           ],
         },
         {
@@ -1477,12 +1500,16 @@
             'tools/quic/quic_epoll_connection_helper.h',
             'tools/quic/quic_in_memory_cache.cc',
             'tools/quic/quic_in_memory_cache.h',
+            'tools/quic/quic_packet_reader.cc',
+            'tools/quic/quic_packet_reader.h',
             'tools/quic/quic_packet_writer_wrapper.cc',
             'tools/quic/quic_packet_writer_wrapper.h',
             'tools/quic/quic_per_connection_packet_writer.cc',
             'tools/quic/quic_per_connection_packet_writer.h',
             'tools/quic/quic_server.cc',
             'tools/quic/quic_server.h',
+            'tools/quic/quic_server_pool.cc',
+            'tools/quic/quic_server_pool.h',
             'tools/quic/quic_server_session.cc',
             'tools/quic/quic_server_session.h',
             'tools/quic/quic_socket_utils.cc',
@@ -0,0 +1,533 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/congestion_control/bbr_tcp_sender.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "net/quic/congestion_control/rtt_stats.h"
+#include "net/quic/crypto/crypto_protocol.h"
+
+using std::max;
+using std::min;
+
+namespace net {
+
+namespace {
+const QuicByteCount kMaxSegmentSize = kDefaultTCPMSS;
+// The minimum congestion window, which is also the window used in PROBE_RTT.
+const QuicByteCount kMinimumCongestionWindow = 4 * kMaxSegmentSize;
+// The gain used in STARTUP to double the sending rate every round trip,
+// 2/ln(2).
+const float kHighGain = 2.885f;
+// The gain used in DRAIN to empty the queue STARTUP created in one round.
+const float kDrainGain = 1.f / kHighGain;
+// The congestion window gain used outside of STARTUP and DRAIN, which leaves
+// room for delayed and stretched acks.
+const float kCongestionWindowGain = 2.0f;
+// The pacing gains cycled through in PROBE_BW: probe for more bandwidth, then
+// drain any queue the probe built, then cruise at the estimate.
+const float kPacingGain[] = {1.25f, 0.75f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f};
+const int kGainCycleLength = arraysize(kPacingGain);
+// The number of round trips the max bandwidth filter remembers.
+const uint64 kBandwidthWindowSize = kGainCycleLength + 2;
+// STARTUP ends once the bandwidth estimate has grown by less than 25% for
+// three round trips in a row.
+const float kStartupGrowthTarget = 1.25f;
+const uint32 kRoundTripsWithoutGrowthBeforeExitingStartup = 3;
+// How long a min RTT sample is trusted before PROBE_RTT is entered, and how
+// long PROBE_RTT lasts once the data in flight has drained.
+const int64 kMinRttExpirySeconds = 10;
+const int64 kProbeRttTimeMs = 200;
+}  // namespace
+
+BbrTcpSender::SentPacketState::SentPacketState()
+    : sent_time(QuicTime::Zero()),
+      bytes(0),
+      delivered_bytes_at_send(0),
+      delivered_time_at_send(QuicTime::Zero()),
+      last_acked_sent_time_at_send(QuicTime::Zero()),
+      in_flight(false) {}
+
+BbrTcpSender::BbrTcpSender(const QuicClock* clock,
+                           const RttStats* rtt_stats,
+                           QuicPacketCount initial_tcp_congestion_window,
+                           QuicPacketCount max_tcp_congestion_window,
+                           QuicConnectionStats* stats)
+    : clock_(clock),
+      rtt_stats_(rtt_stats),
+      stats_(stats),
+      mode_(STARTUP),
+      pacing_gain_(kHighGain),
+      congestion_window_gain_(kHighGain),
+      least_tracked_sequence_number_(0),
+      largest_sent_sequence_number_(0),
+      largest_acked_sequence_number_(0),
+      delivered_bytes_(0),
+      delivered_time_(QuicTime::Zero()),
+      last_acked_sent_time_(QuicTime::Zero()),
+      round_count_(0),
+      current_round_end_(0),
+      round_started_(false),
+      min_rtt_(QuicTime::Delta::Zero()),
+      min_rtt_timestamp_(QuicTime::Zero()),
+      full_bandwidth_(QuicBandwidth::Zero()),
+      rounds_without_bandwidth_growth_(0),
+      is_at_full_bandwidth_(false),
+      cycle_index_(0),
+      cycle_start_(QuicTime::Zero()),
+      exit_probe_rtt_at_(QuicTime::Zero()),
+      congestion_window_(initial_tcp_congestion_window * kMaxSegmentSize),
+      previous_congestion_window_(0),
+      initial_congestion_window_(initial_tcp_congestion_window *
+                                 kMaxSegmentSize),
+      max_congestion_window_(max_tcp_congestion_window * kMaxSegmentSize),
+      largest_sent_at_last_cutback_(0),
+      recovery_window_(0) {}
+
+BbrTcpSender::~BbrTcpSender() {}
+
+void BbrTcpSender::SetFromConfig(const QuicConfig& config,
+                                 bool is_server,
+                                 bool using_pacing) {
+  if (is_server && config.HasReceivedConnectionOptions() &&
+      ContainsQuicTag(config.ReceivedConnectionOptions(), kIW10)) {
+    // Initial window experiment.
+    congestion_window_ = 10 * kMaxSegmentSize;
+  }
+  DLOG_IF(WARNING, !using_pacing)
+      << "BBR relies on pacing to send at the estimated bandwidth.";
+}
+
+void BbrTcpSender::ResumeConnectionState(
+    const CachedNetworkParameters& cached_network_params) {
+  // If the previous bandwidth estimate is less than an hour old, use it as
+  // the starting point of the model.
+  int64 seconds_since_estimate =
+      clock_->WallNow().ToUNIXSeconds() - cached_network_params.timestamp();
+  if (seconds_since_estimate > kNumSecondsPerHour) {
+    return;
+  }
+
+  QuicBandwidth bandwidth = QuicBandwidth::FromBytesPerSecond(
+      cached_network_params.bandwidth_estimate_bytes_per_second());
+  QuicTime::Delta rtt_ms =
+      QuicTime::Delta::FromMilliseconds(cached_network_params.min_rtt_ms());
+  AddBandwidthSample(bandwidth);
+  congestion_window_ =
+      max(kMinimumCongestionWindow,
+          min(max_congestion_window_, bandwidth.ToBytesPerPeriod(rtt_ms)));
+}
+
+void BbrTcpSender::SetNumEmulatedConnections(int num_connections) {
+  // BBR doesn't emulate multiple connections.
+}
+
+void BbrTcpSender::OnCongestionEvent(
+    bool rtt_updated,
+    QuicByteCount bytes_in_flight,
+    const CongestionVector& acked_packets,
+    const CongestionVector& lost_packets) {
+  const QuicTime now = clock_->ApproximateNow();
+  round_started_ = false;
+
+  QuicByteCount bytes_lost = 0;
+  for (CongestionVector::const_iterator it = lost_packets.begin();
+       it != lost_packets.end(); ++it) {
+    SentPacketState* state = GetSentPacketState(it->first);
+    if (state != nullptr) {
+      state->in_flight = false;
+    }
+    bytes_lost += it->second.bytes_sent;
+    OnPacketLost(it->first);
+  }
+
+  QuicByteCount bytes_acked = 0;
+  for (CongestionVector::const_iterator it = acked_packets.begin();
+       it != acked_packets.end(); ++it) {
+    largest_acked_sequence_number_ =
+        max(it->first, largest_acked_sequence_number_);
+    bytes_acked += it->second.bytes_sent;
+    SentPacketState* state = GetSentPacketState(it->first);
+    if (state == nullptr) {
+      continue;
+    }
+    state->in_flight = false;
+    OnPacketAcked(it->first, *state, now);
+  }
+  PopAckedPackets();
+
+  const QuicByteCount prior_in_flight = bytes_in_flight;
+  if (bytes_acked + bytes_lost < bytes_in_flight) {
+    bytes_in_flight -= bytes_acked + bytes_lost;
+  } else {
+    bytes_in_flight = 0;
+  }
+
+  const bool min_rtt_expired = rtt_updated && UpdateMinRtt(now);
+  CheckIfFullBandwidthReached();
+  UpdateMode(now, prior_in_flight, bytes_in_flight, !lost_packets.empty(),
+             min_rtt_expired);
+  UpdateCongestionWindow(bytes_acked, bytes_in_flight);
+}
+
+bool BbrTcpSender::OnPacketSent(QuicTime sent_time,
+                                QuicByteCount bytes_in_flight,
+                                QuicPacketSequenceNumber sequence_number,
+                                QuicByteCount bytes,
+                                HasRetransmittableData is_retransmittable) {
+  // Only data packets are congestion controlled.
+  if (is_retransmittable != HAS_RETRANSMITTABLE_DATA) {
+    return false;
+  }
+  DCHECK_LT(largest_sent_sequence_number_, sequence_number);
+  largest_sent_sequence_number_ = sequence_number;
+
+  if (bytes_in_flight == 0) {
+    // Don't let the idle period count towards the next delivery rate sample.
+    delivered_time_ = sent_time;
+    last_acked_sent_time_ = sent_time;
+  }
+
+  if (sent_packets_.empty()) {
+    least_tracked_sequence_number_ = sequence_number;
+  }
+  // Sequence numbers of packets which are not tracked are left as gaps.
+  while (least_tracked_sequence_number_ + sent_packets_.size() <
+         sequence_number) {
+    sent_packets_.push_back(SentPacketState());
+  }
+  SentPacketState state;
+  state.sent_time = sent_time;
+  state.bytes = bytes;
+  state.delivered_bytes_at_send = delivered_bytes_;
+  state.delivered_time_at_send = delivered_time_;
+  state.last_acked_sent_time_at_send = last_acked_sent_time_;
+  state.in_flight = true;
+  sent_packets_.push_back(state);
+  return true;
+}
+
+BbrTcpSender::SentPacketState* BbrTcpSender::GetSentPacketState(
+    QuicPacketSequenceNumber sequence_number) {
+  if (sequence_number < least_tracked_sequence_number_ ||
+      sequence_number >=
+          least_tracked_sequence_number_ + sent_packets_.size()) {
+    return nullptr;
+  }
+  SentPacketState* state =
+      &sent_packets_[sequence_number - least_tracked_sequence_number_];
+  return state->in_flight ? state : nullptr;
+}
+
+void BbrTcpSender::PopAckedPackets() {
+  while (!sent_packets_.empty() && !sent_packets_.front().in_flight) {
+    sent_packets_.pop_front();
+    ++least_tracked_sequence_number_;
+  }
+}
+
+void BbrTcpSender::OnPacketAcked(QuicPacketSequenceNumber sequence_number,
+                                 const SentPacketState& state,
+                                 QuicTime ack_time) {
+  delivered_bytes_ += state.bytes;
+  delivered_time_ = ack_time;
+  last_acked_sent_time_ = state.sent_time;
+
+  if (sequence_number > current_round_end_) {
+    ++round_count_;
+    current_round_end_ = largest_sent_sequence_number_;
+    round_started_ = true;
+  }
+
+  if (!state.delivered_time_at_send.IsInitialized()) {
+    return;
+  }
+  // The delivery rate is limited by whichever of the send or ack rate is
+  // slower, which filters out ack compression.
+  const QuicTime::Delta send_interval =
+      state.sent_time.Subtract(state.last_acked_sent_time_at_send);
+  const QuicTime::Delta ack_interval =
+      ack_time.Subtract(state.delivered_time_at_send);
+  const QuicTime::Delta interval =
+      QuicTime::Delta::Max(send_interval, ack_interval);
+  if (interval.IsZero()) {
+    return;
+  }
+  AddBandwidthSample(QuicBandwidth::FromBytesAndTimeDelta(
+      delivered_bytes_ - state.delivered_bytes_at_send, interval));
+}
+
+void BbrTcpSender::OnPacketLost(QuicPacketSequenceNumber sequence_number) {
+  // As in TCP NewReno, losses of packets sent before recovery began belong to
+  // the same loss event.
+  if (sequence_number <= largest_sent_at_last_cutback_) {
+    return;
+  }
+  ++stats_->tcp_loss_events;
+  if (InSlowStart()) {
+    ++stats_->slowstart_packets_lost;
+  }
+  largest_sent_at_last_cutback_ = largest_sent_sequence_number_;
+  // Recalculated by UpdateCongestionWindow.
+  recovery_window_ = 0;
+  DVLOG(1) << "Incoming loss; entering recovery until "
+           << largest_sent_at_last_cutback_ << " is acked.";
+}
+
+void BbrTcpSender::AddBandwidthSample(QuicBandwidth bandwidth) {
+  while (!max_bandwidth_filter_.empty() &&
+         max_bandwidth_filter_.back().bandwidth <= bandwidth) {
+    max_bandwidth_filter_.pop_back();
+  }
+  max_bandwidth_filter_.push_back(BandwidthSample(round_count_, bandwidth));
+  while (max_bandwidth_filter_.front().round + kBandwidthWindowSize <=
+         round_count_) {
+    max_bandwidth_filter_.pop_front();
+  }
+}
+
+void BbrTcpSender::CheckIfFullBandwidthReached() {
+  if (!round_started_ || is_at_full_bandwidth_) {
+    return;
+  }
+  const QuicBandwidth target = full_bandwidth_.Scale(kStartupGrowthTarget);
+  if (BandwidthEstimate() >= target) {
+    full_bandwidth_ = BandwidthEstimate();
+    rounds_without_bandwidth_growth_ = 0;
+    return;
+  }
+  if (++rounds_without_bandwidth_growth_ >=
+      kRoundTripsWithoutGrowthBeforeExitingStartup) {
+    is_at_full_bandwidth_ = true;
+    DVLOG(1) << "Full bandwidth reached at "
+             << full_bandwidth_.ToKBitsPerSecond() << " kbps.";
+  }
+}
+
+bool BbrTcpSender::UpdateMinRtt(QuicTime now) {
+  const QuicTime::Delta latest_rtt = rtt_stats_->latest_rtt();
+  const bool min_rtt_expired =
+      min_rtt_timestamp_.IsInitialized() &&
+      now > min_rtt_timestamp_.Add(
+          QuicTime::Delta::FromSeconds(kMinRttExpirySeconds));
+  if (min_rtt_.IsZero() || latest_rtt < min_rtt_ || min_rtt_expired) {
+    min_rtt_ = latest_rtt;
+    min_rtt_timestamp_ = now;
+  }
+  return min_rtt_expired;
+}
+
+void BbrTcpSender::UpdateMode(QuicTime now,
+                              QuicByteCount prior_in_flight,
+                              QuicByteCount bytes_in_flight,
+                              bool has_losses,
+                              bool min_rtt_expired) {
+  if (mode_ == PROBE_BW) {
+    UpdateGainCyclePhase(now, prior_in_flight, has_losses);
+  }
+
+  if (mode_ == STARTUP && is_at_full_bandwidth_) {
+    mode_ = DRAIN;
+    pacing_gain_ = kDrainGain;
+    congestion_window_gain_ = kHighGain;
+  }
+  if (mode_ == DRAIN && bytes_in_flight <= GetTargetCongestionWindow(1)) {
+    EnterProbeBandwidthMode(now);
+  }
+
+  if (mode_ != PROBE_RTT && min_rtt_expired) {
+    mode_ = PROBE_RTT;
+    pacing_gain_ = 1;
+    exit_probe_rtt_at_ = QuicTime::Zero();
+  }
+  if (mode_ == PROBE_RTT) {
+    if (!exit_probe_rtt_at_.IsInitialized()) {
+      // Keep the window small for kProbeRttTimeMs once the queue is drained,
+      // so the RTT samples taken meanwhile reflect the propagation delay.
+      if (bytes_in_flight <= kMinimumCongestionWindow) {
+        exit_probe_rtt_at_ =
+            now.Add(QuicTime::Delta::FromMilliseconds(kProbeRttTimeMs));
+      }
+    } else if (now >= exit_probe_rtt_at_) {
+      min_rtt_timestamp_ = now;
+      if (is_at_full_bandwidth_) {
+        EnterProbeBandwidthMode(now);
+      } else {
+        EnterStartupMode();
+      }
+    }
+  }
+}
+
+void BbrTcpSender::UpdateCongestionWindow(QuicByteCount bytes_acked,
+                                          QuicByteCount bytes_in_flight) {
+  const QuicByteCount target =
+      GetTargetCongestionWindow(congestion_window_gain_);
+  if (is_at_full_bandwidth_) {
+    congestion_window_ = min(target, congestion_window_ + bytes_acked);
+  } else if (congestion_window_ < target ||
+             delivered_bytes_ < initial_congestion_window_) {
+    // Grow by the bytes acked, as slow start does, until the model is usable.
+    congestion_window_ += bytes_acked;
+  }
+  congestion_window_ = max(kMinimumCongestionWindow,
+                           min(max_congestion_window_, congestion_window_));
+
+  if (InRecovery()) {
+    // Packet conservation: send no more than was delivered.
+    recovery_window_ =
+        max(kMinimumCongestionWindow, bytes_in_flight + bytes_acked);
+  }
+}
+
+void BbrTcpSender::EnterStartupMode() {
+  mode_ = STARTUP;
+  pacing_gain_ = kHighGain;
+  congestion_window_gain_ = kHighGain;
+}
+
+void BbrTcpSender::EnterProbeBandwidthMode(QuicTime now) {
+  mode_ = PROBE_BW;
+  congestion_window_gain_ = kCongestionWindowGain;
+  // Start cruising; the probing phase comes around at the end of the cycle.
+  cycle_index_ = 2;
+  cycle_start_ = now;
+  pacing_gain_ = kPacingGain[cycle_index_];
+}
+
+void BbrTcpSender::UpdateGainCyclePhase(QuicTime now,
+                                        QuicByteCount prior_in_flight,
+                                        bool has_losses) {
+  bool should_advance = now.Subtract(cycle_start_) > GetMinRtt();
+  // Keep probing until the probe has actually put more data in flight, unless
+  // the path is already dropping packets.
+  if (pacing_gain_ > 1 && !has_losses &&
+      prior_in_flight < GetTargetCongestionWindow(pacing_gain_)) {
+    should_advance = false;
+  }
+  // Stop draining early once the queue is gone.
+  if (pacing_gain_ < 1 && prior_in_flight <= GetTargetCongestionWindow(1)) {
+    should_advance = true;
+  }
+  if (should_advance) {
+    cycle_index_ = (cycle_index_ + 1) % kGainCycleLength;
+    cycle_start_ = now;
+    pacing_gain_ = kPacingGain[cycle_index_];
+  }
+}
+
+QuicByteCount BbrTcpSender::GetTargetCongestionWindow(float gain) const {
+  const QuicBandwidth bandwidth = BandwidthEstimate();
+  if (bandwidth.IsZero() || min_rtt_.IsZero()) {
+    return initial_congestion_window_;
+  }
+  const QuicByteCount bdp = bandwidth.ToBytesPerPeriod(min_rtt_);
+  return max(kMinimumCongestionWindow, static_cast<QuicByteCount>(gain * bdp));
+}
+
+QuicTime::Delta BbrTcpSender::GetMinRtt() const {
+  if (min_rtt_.IsZero()) {
+    return QuicTime::Delta::FromMicroseconds(rtt_stats_->initial_rtt_us());
+  }
+  return min_rtt_;
+}
+
+void BbrTcpSender::OnRetransmissionTimeout(bool packets_retransmitted) {
+  largest_sent_at_last_cutback_ = 0;
+  if (!packets_retransmitted) {
+    return;
+  }
+  previous_congestion_window_ = congestion_window_;
+  congestion_window_ = kMinimumCongestionWindow;
+}
+
+void BbrTcpSender::RevertRetransmissionTimeout() {
+  if (previous_congestion_window_ == 0) {
+    LOG(DFATAL) << "No previous congestion window to revert to.";
+    return;
+  }
+  congestion_window_ = previous_congestion_window_;
+  previous_congestion_window_ = 0;
+}
+
+QuicTime::Delta BbrTcpSender::TimeUntilSend(
+    QuicTime /* now */,
+    QuicByteCount bytes_in_flight,
+    HasRetransmittableData has_retransmittable_data) const {
+  if (has_retransmittable_data == NO_RETRANSMITTABLE_DATA) {
+    // An ACK can always be sent immediately.
+    return QuicTime::Delta::Zero();
+  }
+  // Pacing is applied by the PacingSender wrapping this sender.
+  if (GetCongestionWindow() > bytes_in_flight) {
+    return QuicTime::Delta::Zero();
+  }
+  return QuicTime::Delta::Infinite();
+}
+
+QuicBandwidth BbrTcpSender::PacingRate() const {
+  const QuicBandwidth bandwidth = BandwidthEstimate();
+  if (bandwidth.IsZero()) {
+    // Until there's a delivery rate sample, pace the initial window over the
+    // initial RTT at the STARTUP gain.
+    QuicTime::Delta srtt = rtt_stats_->smoothed_rtt();
+    if (srtt.IsZero()) {
+      srtt = QuicTime::Delta::FromMicroseconds(rtt_stats_->initial_rtt_us());
+    }
+    return QuicBandwidth::FromBytesAndTimeDelta(initial_congestion_window_,
+                                                srtt).Scale(kHighGain);
+  }
+  return bandwidth.Scale(pacing_gain_);
+}
+
+QuicBandwidth BbrTcpSender::BandwidthEstimate() const {
+  if (max_bandwidth_filter_.empty()) {
+    return QuicBandwidth::Zero();
+  }
+  return max_bandwidth_filter_.front().bandwidth;
+}
+
+bool BbrTcpSender::HasReliableBandwidthEstimate() const {
+  return is_at_full_bandwidth_ && !InRecovery();
+}
+
+QuicTime::Delta BbrTcpSender::RetransmissionDelay() const {
+  if (rtt_stats_->smoothed_rtt().IsZero()) {
+    return QuicTime::Delta::Zero();
+  }
+  return rtt_stats_->smoothed_rtt().Add(
+      rtt_stats_->mean_deviation().Multiply(4));
+}
+
+QuicByteCount BbrTcpSender::GetCongestionWindow() const {
+  if (mode_ == PROBE_RTT) {
+    return kMinimumCongestionWindow;
+  }
+  if (InRecovery() && recovery_window_ > 0) {
+    return min(congestion_window_, recovery_window_);
+  }
+  return congestion_window_;
+}
+
+bool BbrTcpSender::InSlowStart() const {
+  return mode_ == STARTUP;
+}
+
+bool BbrTcpSender::InRecovery() const {
+  return largest_acked_sequence_number_ <= largest_sent_at_last_cutback_ &&
+      largest_acked_sequence_number_ != 0;
+}
+
+QuicByteCount BbrTcpSender::GetSlowStartThreshold() const {
+  // BBR has no slow start threshold.
+  return 0;
+}
+
+CongestionControlType BbrTcpSender::GetCongestionControlType() const {
+  return kBBR;
+}
+
+}  // namespace net
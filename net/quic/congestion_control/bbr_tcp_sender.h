@@ -0,0 +1,220 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// BBR (Bottleneck Bandwidth and RTT) send side congestion algorithm.  Instead
+// of reacting to loss, it builds a model of the path from the maximum recent
+// delivery rate and the minimum recent RTT, paces at the estimated bottleneck
+// bandwidth and caps the data in flight at a small multiple of the
+// bandwidth-delay product.  It periodically probes for more bandwidth and for
+// a lower RTT.
+
+#ifndef NET_QUIC_CONGESTION_CONTROL_BBR_TCP_SENDER_H_
+#define NET_QUIC_CONGESTION_CONTROL_BBR_TCP_SENDER_H_
+
+#include <deque>
+
+#include "base/basictypes.h"
+#include "net/base/net_export.h"
+#include "net/quic/congestion_control/send_algorithm_interface.h"
+#include "net/quic/crypto/cached_network_parameters.h"
+#include "net/quic/quic_bandwidth.h"
+#include "net/quic/quic_connection_stats.h"
+#include "net/quic/quic_protocol.h"
+#include "net/quic/quic_time.h"
+
+namespace net {
+
+class RttStats;
+
+namespace test {
+class BbrTcpSenderPeer;
+}  // namespace test
+
+class NET_EXPORT_PRIVATE BbrTcpSender : public SendAlgorithmInterface {
+ public:
+  enum Mode {
+    // Exponential growth until the bandwidth estimate stops increasing.
+    STARTUP,
+    // Drains the queue built during STARTUP.
+    DRAIN,
+    // Cycles the pacing gain around 1 to probe for more bandwidth.
+    PROBE_BW,
+    // Temporarily shrinks the window to measure the minimum RTT.
+    PROBE_RTT,
+  };
+
+  // max_tcp_congestion_window is provided for testing.
+  BbrTcpSender(const QuicClock* clock,
+               const RttStats* rtt_stats,
+               QuicPacketCount initial_tcp_congestion_window,
+               QuicPacketCount max_tcp_congestion_window,
+               QuicConnectionStats* stats);
+  ~BbrTcpSender() override;
+
+  // Start implementation of SendAlgorithmInterface.
+  void SetFromConfig(const QuicConfig& config,
+                     bool is_server,
+                     bool using_pacing) override;
+  void ResumeConnectionState(
+      const CachedNetworkParameters& cached_network_params) override;
+  void SetNumEmulatedConnections(int num_connections) override;
+  void OnCongestionEvent(bool rtt_updated,
+                         QuicByteCount bytes_in_flight,
+                         const CongestionVector& acked_packets,
+                         const CongestionVector& lost_packets) override;
+  bool OnPacketSent(QuicTime sent_time,
+                    QuicByteCount bytes_in_flight,
+                    QuicPacketSequenceNumber sequence_number,
+                    QuicByteCount bytes,
+                    HasRetransmittableData is_retransmittable) override;
+  void OnRetransmissionTimeout(bool packets_retransmitted) override;
+  void RevertRetransmissionTimeout() override;
+  QuicTime::Delta TimeUntilSend(
+      QuicTime now,
+      QuicByteCount bytes_in_flight,
+      HasRetransmittableData has_retransmittable_data) const override;
+  QuicBandwidth PacingRate() const override;
+  QuicBandwidth BandwidthEstimate() const override;
+  bool HasReliableBandwidthEstimate() const override;
+  QuicTime::Delta RetransmissionDelay() const override;
+  QuicByteCount GetCongestionWindow() const override;
+  bool InSlowStart() const override;
+  bool InRecovery() const override;
+  QuicByteCount GetSlowStartThreshold() const override;
+  CongestionControlType GetCongestionControlType() const override;
+  // End implementation of SendAlgorithmInterface.
+
+  Mode mode() const { return mode_; }
+
+ private:
+  friend class test::BbrTcpSenderPeer;
+
+  // Delivery state recorded when a packet is sent, used to compute a
+  // delivery rate sample when it is acked.
+  struct SentPacketState {
+    SentPacketState();
+
+    QuicTime sent_time;
+    QuicByteCount bytes;
+    // Total bytes acked when the packet was sent.
+    QuicByteCount delivered_bytes_at_send;
+    // When the most recent ack before this packet's send arrived.
+    QuicTime delivered_time_at_send;
+    // Send time of the most recently acked packet when this one was sent.
+    QuicTime last_acked_sent_time_at_send;
+    // False for untracked sequence numbers and for packets already acked or
+    // lost.
+    bool in_flight;
+  };
+
+  struct BandwidthSample {
+    BandwidthSample(uint64 round, QuicBandwidth bandwidth)
+        : round(round), bandwidth(bandwidth) {}
+
+    uint64 round;
+    QuicBandwidth bandwidth;
+  };
+
+  // Returns the state of |sequence_number| if it is tracked and still in
+  // flight, nullptr otherwise.
+  SentPacketState* GetSentPacketState(QuicPacketSequenceNumber sequence_number);
+  void PopAckedPackets();
+
+  void OnPacketAcked(QuicPacketSequenceNumber sequence_number,
+                     const SentPacketState& state,
+                     QuicTime ack_time);
+  void OnPacketLost(QuicPacketSequenceNumber sequence_number);
+
+  // Adds a delivery rate sample to the windowed max filter.
+  void AddBandwidthSample(QuicBandwidth bandwidth);
+  // Checks whether STARTUP has stopped growing the bandwidth estimate.
+  void CheckIfFullBandwidthReached();
+  // Returns true if the previous min RTT had expired.
+  bool UpdateMinRtt(QuicTime now);
+  void UpdateMode(QuicTime now,
+                  QuicByteCount prior_in_flight,
+                  QuicByteCount bytes_in_flight,
+                  bool has_losses,
+                  bool min_rtt_expired);
+  void UpdateCongestionWindow(QuicByteCount bytes_acked,
+                              QuicByteCount bytes_in_flight);
+
+  void EnterStartupMode();
+  void EnterProbeBandwidthMode(QuicTime now);
+  void UpdateGainCyclePhase(QuicTime now,
+                            QuicByteCount prior_in_flight,
+                            bool has_losses);
+
+  // Returns the bandwidth-delay product scaled by |gain|, or the initial
+  // congestion window if there's no estimate yet.
+  QuicByteCount GetTargetCongestionWindow(float gain) const;
+  QuicTime::Delta GetMinRtt() const;
+
+  const QuicClock* clock_;
+  const RttStats* rtt_stats_;
+  QuicConnectionStats* stats_;
+
+  Mode mode_;
+  float pacing_gain_;
+  float congestion_window_gain_;
+
+  // Per-packet delivery state, indexed by sequence number starting at
+  // least_tracked_sequence_number_.
+  std::deque<SentPacketState> sent_packets_;
+  QuicPacketSequenceNumber least_tracked_sequence_number_;
+
+  QuicPacketSequenceNumber largest_sent_sequence_number_;
+  QuicPacketSequenceNumber largest_acked_sequence_number_;
+
+  // Total bytes acked, and when and for which packet that last happened.
+  QuicByteCount delivered_bytes_;
+  QuicTime delivered_time_;
+  QuicTime last_acked_sent_time_;
+
+  // A round trip ends when a packet sent after the previous round ended is
+  // acked.
+  uint64 round_count_;
+  QuicPacketSequenceNumber current_round_end_;
+  bool round_started_;
+
+  // Windowed max of the delivery rate over the last kBandwidthWindowSize
+  // rounds, kept as a monotonically decreasing queue.
+  std::deque<BandwidthSample> max_bandwidth_filter_;
+
+  // Windowed min of the RTT, refreshed at least every kMinRttExpiry.
+  QuicTime::Delta min_rtt_;
+  QuicTime min_rtt_timestamp_;
+
+  // Used to detect that STARTUP has filled the pipe.
+  QuicBandwidth full_bandwidth_;
+  uint32 rounds_without_bandwidth_growth_;
+  bool is_at_full_bandwidth_;
+
+  // PROBE_BW gain cycle state.
+  int cycle_index_;
+  QuicTime cycle_start_;
+
+  // When to leave PROBE_RTT.  Zero until the data in flight has drained to
+  // the minimum window.
+  QuicTime exit_probe_rtt_at_;
+
+  // Congestion window in bytes.
+  QuicByteCount congestion_window_;
+  // Congestion window before the last RTO.
+  QuicByteCount previous_congestion_window_;
+  const QuicByteCount initial_congestion_window_;
+  const QuicByteCount max_congestion_window_;
+
+  // Track the largest sequence number outstanding when loss recovery began.
+  QuicPacketSequenceNumber largest_sent_at_last_cutback_;
+  // Bytes the sender may have in flight while in recovery, following packet
+  // conservation.
+  QuicByteCount recovery_window_;
+
+  DISALLOW_COPY_AND_ASSIGN(BbrTcpSender);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CONGESTION_CONTROL_BBR_TCP_SENDER_H_
@@ -0,0 +1,309 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/congestion_control/bbr_tcp_sender.h"
+
+#include <deque>
+
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/quic/congestion_control/pacing_sender.h"
+#include "net/quic/congestion_control/rtt_stats.h"
+#include "net/quic/congestion_control/send_algorithm_simulator.h"
+#include "net/quic/congestion_control/tcp_cubic_sender.h"
+#include "net/quic/test_tools/mock_clock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using std::make_pair;
+
+namespace net {
+namespace test {
+
+namespace {
+const QuicPacketCount kInitialCongestionWindowPackets = 10;
+const QuicByteCount kMinimumCongestionWindow = 4 * kDefaultTCPMSS;
+}  // namespace
+
+class BbrTcpSenderPeer {
+ public:
+  static QuicTime::Delta min_rtt(const BbrTcpSender& sender) {
+    return sender.min_rtt_;
+  }
+
+  static bool is_at_full_bandwidth(const BbrTcpSender& sender) {
+    return sender.is_at_full_bandwidth_;
+  }
+};
+
+class BbrTcpSenderTest : public ::testing::Test {
+ protected:
+  BbrTcpSenderTest()
+      : rtt_(QuicTime::Delta::FromMilliseconds(100)),
+        bandwidth_(QuicBandwidth::FromKBytesPerSecond(500)),
+        sender_(new BbrTcpSender(&clock_, &rtt_stats_,
+                                 kInitialCongestionWindowPackets,
+                                 kMaxTcpCongestionWindow, &stats_)),
+        sequence_number_(1),
+        acked_sequence_number_(0),
+        bytes_in_flight_(0) {
+    clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(1));
+    standard_packet_.bytes_sent = kDefaultTCPMSS;
+  }
+
+  void SendPacket() {
+    sender_->OnPacketSent(clock_.Now(), bytes_in_flight_, sequence_number_,
+                          kDefaultTCPMSS, HAS_RETRANSMITTABLE_DATA);
+    sent_times_.push_back(make_pair(sequence_number_, clock_.Now()));
+    ++sequence_number_;
+    bytes_in_flight_ += kDefaultTCPMSS;
+  }
+
+  // Runs a single flow over a bottleneck of bandwidth_ with a round trip of
+  // rtt_ and no loss for |duration|, sending whenever both the congestion
+  // window and the pacing rate allow.  Acks arrive one rtt_ after the packet
+  // leaves the bottleneck.
+  void RunFlow(QuicTime::Delta duration) {
+    const QuicTime end = clock_.Now().Add(duration);
+    const QuicTime::Delta packet_time =
+        bandwidth_.TransferTime(kDefaultTCPMSS);
+    QuicTime bottleneck_free = clock_.Now();
+    QuicTime next_send = clock_.Now();
+    while (clock_.Now() < end) {
+      QuicTime next_ack = ack_times_.empty() ?
+          QuicTime::Infinite() : ack_times_.front().second;
+      bool can_send = sender_->TimeUntilSend(
+          clock_.Now(), bytes_in_flight_, HAS_RETRANSMITTABLE_DATA).IsZero();
+      if (can_send && next_send <= next_ack) {
+        if (next_send > clock_.Now()) {
+          clock_.AdvanceTime(next_send.Subtract(clock_.Now()));
+        }
+        bottleneck_free =
+            QuicTime::Max(bottleneck_free, clock_.Now()).Add(packet_time);
+        ack_times_.push_back(
+            make_pair(sequence_number_, bottleneck_free.Add(rtt_)));
+        SendPacket();
+        QuicBandwidth pacing_rate = sender_->PacingRate();
+        next_send = clock_.Now().Add(
+            pacing_rate.TransferTime(kDefaultTCPMSS));
+        continue;
+      }
+      if (next_ack.IsInitialized() && next_ack != QuicTime::Infinite()) {
+        clock_.AdvanceTime(next_ack.Subtract(clock_.Now()));
+        AckPacket(ack_times_.front().first);
+        ack_times_.pop_front();
+        continue;
+      }
+      clock_.AdvanceTime(packet_time);
+    }
+  }
+
+  void AckPacket(QuicPacketSequenceNumber sequence_number) {
+    QuicTime sent_time = QuicTime::Zero();
+    while (!sent_times_.empty() && sent_times_.front().first <=
+           sequence_number) {
+      sent_time = sent_times_.front().second;
+      sent_times_.pop_front();
+    }
+    rtt_stats_.UpdateRtt(clock_.Now().Subtract(sent_time),
+                         QuicTime::Delta::Zero(), clock_.Now());
+    SendAlgorithmInterface::CongestionVector acked_packets;
+    SendAlgorithmInterface::CongestionVector lost_packets;
+    acked_packets.push_back(make_pair(sequence_number, standard_packet_));
+    sender_->OnCongestionEvent(
+        true, bytes_in_flight_, acked_packets, lost_packets);
+    bytes_in_flight_ -= kDefaultTCPMSS;
+    acked_sequence_number_ = sequence_number;
+  }
+
+  void LosePacket(QuicPacketSequenceNumber sequence_number) {
+    SendAlgorithmInterface::CongestionVector acked_packets;
+    SendAlgorithmInterface::CongestionVector lost_packets;
+    lost_packets.push_back(make_pair(sequence_number, standard_packet_));
+    sender_->OnCongestionEvent(
+        false, bytes_in_flight_, acked_packets, lost_packets);
+    bytes_in_flight_ -= kDefaultTCPMSS;
+  }
+
+  const QuicTime::Delta rtt_;
+  const QuicBandwidth bandwidth_;
+  MockClock clock_;
+  RttStats rtt_stats_;
+  QuicConnectionStats stats_;
+  scoped_ptr<BbrTcpSender> sender_;
+  QuicPacketSequenceNumber sequence_number_;
+  QuicPacketSequenceNumber acked_sequence_number_;
+  QuicByteCount bytes_in_flight_;
+  TransmissionInfo standard_packet_;
+  std::deque<std::pair<QuicPacketSequenceNumber, QuicTime>> sent_times_;
+  std::deque<std::pair<QuicPacketSequenceNumber, QuicTime>> ack_times_;
+};
+
+TEST_F(BbrTcpSenderTest, InitialState) {
+  EXPECT_EQ(BbrTcpSender::STARTUP, sender_->mode());
+  EXPECT_TRUE(sender_->InSlowStart());
+  EXPECT_FALSE(sender_->InRecovery());
+  EXPECT_TRUE(sender_->BandwidthEstimate().IsZero());
+  EXPECT_FALSE(sender_->HasReliableBandwidthEstimate());
+  EXPECT_EQ(kInitialCongestionWindowPackets * kDefaultTCPMSS,
+            sender_->GetCongestionWindow());
+  EXPECT_FALSE(sender_->PacingRate().IsZero());
+  EXPECT_EQ(kBBR, sender_->GetCongestionControlType());
+}
+
+TEST_F(BbrTcpSenderTest, NonRetransmittablePacketsAreNotTracked) {
+  EXPECT_FALSE(sender_->OnPacketSent(clock_.Now(), 0, 1, kDefaultTCPMSS,
+                                     NO_RETRANSMITTABLE_DATA));
+  EXPECT_TRUE(sender_->TimeUntilSend(
+      clock_.Now(), sender_->GetCongestionWindow(),
+      NO_RETRANSMITTABLE_DATA).IsZero());
+  EXPECT_TRUE(sender_->TimeUntilSend(
+      clock_.Now(), sender_->GetCongestionWindow(),
+      HAS_RETRANSMITTABLE_DATA).IsInfinite());
+}
+
+TEST_F(BbrTcpSenderTest, ConvergesToBottleneckBandwidth) {
+  RunFlow(QuicTime::Delta::FromSeconds(5));
+
+  EXPECT_EQ(BbrTcpSender::PROBE_BW, sender_->mode());
+  EXPECT_TRUE(BbrTcpSenderPeer::is_at_full_bandwidth(*sender_));
+  EXPECT_TRUE(sender_->HasReliableBandwidthEstimate());
+  EXPECT_EQ(rtt_, BbrTcpSenderPeer::min_rtt(*sender_).Subtract(
+      bandwidth_.TransferTime(kDefaultTCPMSS)));
+  // The estimate tracks the bottleneck within 10%.
+  EXPECT_NEAR(bandwidth_.ToBytesPerSecond(),
+              sender_->BandwidthEstimate().ToBytesPerSecond(),
+              bandwidth_.ToBytesPerSecond() / 10);
+  // The window is about twice the bandwidth-delay product.
+  const QuicByteCount bdp = bandwidth_.ToBytesPerPeriod(rtt_);
+  EXPECT_LE(bdp, sender_->GetCongestionWindow());
+  EXPECT_GE(3 * bdp, sender_->GetCongestionWindow());
+}
+
+TEST_F(BbrTcpSenderTest, ProbeRttAfterMinRttExpires) {
+  RunFlow(QuicTime::Delta::FromSeconds(5));
+  ASSERT_EQ(BbrTcpSender::PROBE_BW, sender_->mode());
+
+  // Ten seconds without a lower RTT sample trigger PROBE_RTT, which shrinks
+  // the window to the minimum.
+  RunFlow(QuicTime::Delta::FromSeconds(6));
+  bool entered_probe_rtt = false;
+  for (int i = 0; i < 100 && !entered_probe_rtt; ++i) {
+    RunFlow(rtt_);
+    entered_probe_rtt = sender_->mode() == BbrTcpSender::PROBE_RTT;
+  }
+  ASSERT_TRUE(entered_probe_rtt);
+  EXPECT_EQ(kMinimumCongestionWindow, sender_->GetCongestionWindow());
+
+  // PROBE_RTT lasts 200ms once the queue has drained, then returns to
+  // PROBE_BW.
+  RunFlow(QuicTime::Delta::FromSeconds(1));
+  EXPECT_EQ(BbrTcpSender::PROBE_BW, sender_->mode());
+}
+
+TEST_F(BbrTcpSenderTest, RandomLossDoesNotReduceBandwidthEstimate) {
+  RunFlow(QuicTime::Delta::FromSeconds(5));
+  const QuicBandwidth estimate = sender_->BandwidthEstimate();
+
+  // Unlike Cubic, an isolated loss puts the sender in recovery without
+  // touching its model of the path.
+  SendPacket();
+  LosePacket(sequence_number_ - 1);
+  EXPECT_TRUE(sender_->InRecovery());
+  EXPECT_EQ(estimate, sender_->BandwidthEstimate());
+  EXPECT_EQ(1u, stats_.tcp_loss_events);
+}
+
+TEST_F(BbrTcpSenderTest, RetransmissionTimeout) {
+  RunFlow(QuicTime::Delta::FromSeconds(1));
+  const QuicByteCount window = sender_->GetCongestionWindow();
+
+  sender_->OnRetransmissionTimeout(true);
+  EXPECT_EQ(kMinimumCongestionWindow, sender_->GetCongestionWindow());
+
+  sender_->RevertRetransmissionTimeout();
+  EXPECT_EQ(window, sender_->GetCongestionWindow());
+}
+
+TEST_F(BbrTcpSenderTest, CreateFromFactory) {
+  scoped_ptr<SendAlgorithmInterface> sender(SendAlgorithmInterface::Create(
+      &clock_, &rtt_stats_, kBBR, &stats_, kInitialCongestionWindowPackets));
+  ASSERT_TRUE(sender.get() != nullptr);
+  EXPECT_EQ(kBBR, sender->GetCongestionControlType());
+}
+
+// Compares BBR and Cubic in the SendAlgorithmSimulator on a lossy long fat
+// link, where loss based congestion control leaves bandwidth unused.
+class BbrTcpSenderSimulationTest : public ::testing::Test {
+ protected:
+  BbrTcpSenderSimulationTest()
+      : bandwidth_(QuicBandwidth::FromKBitsPerSecond(10000)),
+        rtt_(QuicTime::Delta::FromMilliseconds(200)) {
+    clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(1));
+  }
+
+  // Returns the goodput of a transfer of |num_bytes| with |send_algorithm|,
+  // which is wrapped in a PacingSender, given |loss_rate|.
+  QuicBandwidth Transfer(SendAlgorithmInterface* send_algorithm,
+                         RttStats* rtt_stats,
+                         float loss_rate,
+                         QuicByteCount num_bytes) {
+    PacingSender pacing_sender(send_algorithm,
+                               QuicTime::Delta::FromMilliseconds(1), 10);
+    SendAlgorithmSimulator simulator(&clock_, bandwidth_, rtt_);
+    simulator.set_forward_loss_rate(loss_rate);
+    simulator.set_buffer_size(bandwidth_.ToBytesPerPeriod(rtt_));
+    SendAlgorithmSimulator::Sender sender(&pacing_sender, rtt_stats);
+    simulator.AddTransfer(&sender, num_bytes);
+    simulator.TransferBytes();
+    DVLOG(1) << (send_algorithm->GetCongestionControlType() == kBBR ?
+                 "BBR " : "Cubic ") << sender.DebugString();
+    return sender.last_transfer_bandwidth;
+  }
+
+  QuicBandwidth TransferWithBbr(float loss_rate, QuicByteCount num_bytes) {
+    RttStats rtt_stats;
+    return Transfer(new BbrTcpSender(&clock_, &rtt_stats,
+                                     kInitialCongestionWindowPackets,
+                                     kMaxTcpCongestionWindow, &stats_),
+                    &rtt_stats, loss_rate, num_bytes);
+  }
+
+  QuicBandwidth TransferWithCubic(float loss_rate, QuicByteCount num_bytes) {
+    RttStats rtt_stats;
+    return Transfer(new TcpCubicSender(&clock_, &rtt_stats, false,
+                                       kInitialCongestionWindowPackets,
+                                       kMaxTcpCongestionWindow, &stats_),
+                    &rtt_stats, loss_rate, num_bytes);
+  }
+
+  MockClock clock_;
+  QuicConnectionStats stats_;
+  const QuicBandwidth bandwidth_;
+  const QuicTime::Delta rtt_;
+};
+
+TEST_F(BbrTcpSenderSimulationTest, NoLoss) {
+  const QuicBandwidth bbr = TransferWithBbr(0, 10 * 1024 * 1024);
+  // Most of the link is used despite the startup and probing phases.
+  EXPECT_LT(bandwidth_.Scale(0.7f), bbr);
+}
+
+TEST_F(BbrTcpSenderSimulationTest, OutperformsCubicWithRandomLoss) {
+  const float kLossRates[] = {0.01f, 0.02f, 0.05f};
+  for (size_t i = 0; i < arraysize(kLossRates); ++i) {
+    const QuicBandwidth bbr = TransferWithBbr(kLossRates[i], 5 * 1024 * 1024);
+    const QuicBandwidth cubic =
+        TransferWithCubic(kLossRates[i], 5 * 1024 * 1024);
+    EXPECT_LT(cubic.Scale(2), bbr) << "loss rate: " << kLossRates[i];
+  }
+}
+
+TEST_F(BbrTcpSenderSimulationTest, OnePercentLoss) {
+  const QuicBandwidth bbr = TransferWithBbr(0.01f, 5 * 1024 * 1024);
+  // Random loss doesn't shrink the model, so most of the link stays in use.
+  EXPECT_LT(bandwidth_.Scale(0.5f), bbr);
+}
+
+}  // namespace test
+}  // namespace net
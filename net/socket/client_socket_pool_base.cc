@@ -219,17 +219,11 @@ bool ClientSocketPoolBaseHelper::IsStalled() const {
     return false;
   // So in order to be stalled, |this| must be using at least |max_sockets_| AND
   // |this| must have a request that is actually stalled on the global socket
-  // limit.  To find such a request, look for a group that has more requests
-  // than jobs AND where the number of sockets is less than
-  // |max_sockets_per_group_|.  (If the number of sockets is equal to
-  // |max_sockets_per_group_|, then the request is stalled on the group limit,
-  // which does not count.)
-  for (GroupMap::const_iterator it = group_map_.begin();
-       it != group_map_.end(); ++it) {
-    if (it->second->IsStalledOnPoolMaxSockets(max_sockets_per_group_))
-      return true;
-  }
-  return false;
+  // limit.  Such a request is in a group that has more requests than jobs AND
+  // where the number of sockets is less than |max_sockets_per_group_|.  (If the
+  // number of sockets is equal to |max_sockets_per_group_|, then the request is
+  // stalled on the group limit, which does not count.)
+  return !stalled_groups_.empty();
 }
 
 void ClientSocketPoolBaseHelper::AddLowerLayeredPool(
@@ -462,6 +456,7 @@ bool ClientSocketPoolBaseHelper::AssignIdleSocketToRequest(
 
     ++it;
   }
+  group->UpdateIndexes();
 
   // If we haven't found an idle socket, that means there are no used idle
   // sockets.  Pick the oldest (first) idle socket (FIFO).
@@ -475,6 +470,7 @@ bool ClientSocketPoolBaseHelper::AssignIdleSocketToRequest(
         base::TimeTicks::Now() - idle_socket_it->start_time;
     IdleSocket idle_socket = *idle_socket_it;
     idle_sockets->erase(idle_socket_it);
+    group->UpdateIndexes();
     // TODO(davidben): If |idle_time| is under some low watermark, consider
     // treating as UNUSED rather than UNUSED_IDLE. This will avoid
     // HttpNetworkTransaction retrying on some errors.
@@ -688,6 +684,7 @@ void ClientSocketPoolBaseHelper::CleanupIdleSockets(bool force) {
         ++j;
       }
     }
+    group->UpdateIndexes();
 
     // Delete group if no longer needed.
     if (group->IsEmpty()) {
@@ -703,7 +700,7 @@ ClientSocketPoolBaseHelper::Group* ClientSocketPoolBaseHelper::GetOrCreateGroup(
   GroupMap::iterator it = group_map_.find(group_name);
   if (it != group_map_.end())
     return it->second;
-  Group* group = new Group;
+  Group* group = new Group(group_name, this);
   group_map_[group_name] = group;
   return group;
 }
@@ -826,41 +823,22 @@ void ClientSocketPoolBaseHelper::CheckForStalledSocketGroups() {
 
 // Search for the highest priority pending request, amongst the groups that
 // are not at the |max_sockets_per_group_| limit. Note: for requests with
-// the same priority, the winner is based on group hash ordering (and not
+// the same priority, the winner is based on group name ordering (and not
 // insertion order).
 bool ClientSocketPoolBaseHelper::FindTopStalledGroup(
     Group** group,
     std::string* group_name) const {
   CHECK((group && group_name) || (!group && !group_name));
-  Group* top_group = NULL;
-  const std::string* top_group_name = NULL;
-  bool has_stalled_group = false;
-  for (GroupMap::const_iterator i = group_map_.begin();
-       i != group_map_.end(); ++i) {
-    Group* curr_group = i->second;
-    if (!curr_group->has_pending_requests())
-      continue;
-    if (curr_group->IsStalledOnPoolMaxSockets(max_sockets_per_group_)) {
-      if (!group)
-        return true;
-      has_stalled_group = true;
-      bool has_higher_priority = !top_group ||
-          curr_group->TopPendingPriority() > top_group->TopPendingPriority();
-      if (has_higher_priority) {
-        top_group = curr_group;
-        top_group_name = &i->first;
-      }
-    }
-  }
+  if (stalled_groups_.empty())
+    return false;
 
-  if (top_group) {
-    CHECK(group);
+  Group* top_group = *stalled_groups_.begin();
+  DCHECK(top_group->IsStalledOnPoolMaxSockets(max_sockets_per_group_));
+  if (group) {
     *group = top_group;
-    *group_name = *top_group_name;
-  } else {
-    CHECK(!has_stalled_group);
+    *group_name = top_group->group_name();
   }
-  return has_stalled_group;
+  return true;
 }
 
 void ClientSocketPoolBaseHelper::OnConnectJobComplete(
@@ -1010,6 +988,7 @@ void ClientSocketPoolBaseHelper::AddIdleSocket(
   idle_socket.start_time = base::TimeTicks::Now();
 
   group->mutable_idle_sockets()->push_back(idle_socket);
+  group->UpdateIndexes();
   IncrementIdleCount();
 }
 
@@ -1076,21 +1055,22 @@ bool ClientSocketPoolBaseHelper::CloseOneIdleSocketExceptInGroup(
     const Group* exception_group) {
   CHECK_GT(idle_socket_count(), 0);
 
-  for (GroupMap::iterator i = group_map_.begin(); i != group_map_.end(); ++i) {
-    Group* group = i->second;
+  for (GroupSet::iterator i = idle_socket_groups_.begin();
+       i != idle_socket_groups_.end(); ++i) {
+    Group* group = *i;
     if (exception_group == group)
       continue;
     std::list<IdleSocket>* idle_sockets = group->mutable_idle_sockets();
+    DCHECK(!idle_sockets->empty());
 
-    if (!idle_sockets->empty()) {
-      delete idle_sockets->front().socket;
-      idle_sockets->pop_front();
-      DecrementIdleCount();
-      if (group->IsEmpty())
-        RemoveGroup(i);
+    delete idle_sockets->front().socket;
+    idle_sockets->pop_front();
+    group->UpdateIndexes();
+    DecrementIdleCount();
+    if (group->IsEmpty())
+      RemoveGroup(group->group_name());
 
-      return true;
-    }
+    return true;
   }
 
   return false;
@@ -1142,13 +1122,60 @@ void ClientSocketPoolBaseHelper::TryToCloseSocketsInLayeredPools() {
   }
 }
 
-ClientSocketPoolBaseHelper::Group::Group()
-    : unassigned_job_count_(0),
+bool ClientSocketPoolBaseHelper::StalledGroupOrder::operator()(
+    const Group* a, const Group* b) const {
+  if (a->stalled_priority_ != b->stalled_priority_)
+    return a->stalled_priority_ > b->stalled_priority_;
+  return a->group_name() < b->group_name();
+}
+
+bool ClientSocketPoolBaseHelper::GroupNameOrder::operator()(
+    const Group* a, const Group* b) const {
+  return a->group_name() < b->group_name();
+}
+
+ClientSocketPoolBaseHelper::Group::Group(const std::string& group_name,
+                                         ClientSocketPoolBaseHelper* pool)
+    : group_name_(group_name),
+      pool_(pool),
+      unassigned_job_count_(0),
       pending_requests_(NUM_PRIORITIES),
-      active_socket_count_(0) {}
+      active_socket_count_(0),
+      in_stalled_groups_(false),
+      stalled_priority_(MINIMUM_PRIORITY),
+      in_idle_socket_groups_(false) {}
 
 ClientSocketPoolBaseHelper::Group::~Group() {
   DCHECK_EQ(0u, unassigned_job_count_);
+  if (in_stalled_groups_)
+    pool_->stalled_groups_.erase(this);
+  if (in_idle_socket_groups_)
+    pool_->idle_socket_groups_.erase(this);
+}
+
+void ClientSocketPoolBaseHelper::Group::UpdateIndexes() {
+  // The priority a group is ordered by can't change while it is in the set, so
+  // a group whose top priority changed is taken out and put back.
+  bool stalled = IsStalledOnPoolMaxSockets(pool_->max_sockets_per_group_);
+  if (in_stalled_groups_ &&
+      (!stalled || TopPendingPriority() != stalled_priority_)) {
+    pool_->stalled_groups_.erase(this);
+    in_stalled_groups_ = false;
+  }
+  if (stalled && !in_stalled_groups_) {
+    stalled_priority_ = TopPendingPriority();
+    pool_->stalled_groups_.insert(this);
+    in_stalled_groups_ = true;
+  }
+
+  bool has_idle_sockets = !idle_sockets_.empty();
+  if (has_idle_sockets != in_idle_socket_groups_) {
+    if (has_idle_sockets)
+      pool_->idle_socket_groups_.insert(this);
+    else
+      pool_->idle_socket_groups_.erase(this);
+    in_idle_socket_groups_ = has_idle_sockets;
+  }
 }
 
 void ClientSocketPoolBaseHelper::Group::StartBackupJobTimer(
@@ -1186,6 +1213,7 @@ void ClientSocketPoolBaseHelper::Group::AddJob(scoped_ptr<ConnectJob> job,
   if (is_preconnect)
     ++unassigned_job_count_;
   jobs_.insert(job.release());
+  UpdateIndexes();
 }
 
 void ClientSocketPoolBaseHelper::Group::RemoveJob(ConnectJob* job) {
@@ -1206,6 +1234,7 @@ void ClientSocketPoolBaseHelper::Group::RemoveJob(ConnectJob* job) {
   // backup job either.
   if (jobs_.empty())
     backup_job_timer_.Stop();
+  UpdateIndexes();
 }
 
 void ClientSocketPoolBaseHelper::Group::OnBackupJobTimerFired(
@@ -1256,6 +1285,7 @@ void ClientSocketPoolBaseHelper::Group::RemoveAllJobs() {
 
   // Stop backup job timer.
   backup_job_timer_.Stop();
+  UpdateIndexes();
 }
 
 const ClientSocketPoolBaseHelper::Request*
@@ -1292,6 +1322,7 @@ void ClientSocketPoolBaseHelper::Group::InsertPendingRequest(
   } else {
     pending_requests_.Insert(request.release(), priority);
   }
+  UpdateIndexes();
 }
 
 scoped_ptr<const ClientSocketPoolBaseHelper::Request>
@@ -1323,6 +1354,7 @@ ClientSocketPoolBaseHelper::Group::RemovePendingRequest(
   // If there are no more requests, kill the backup timer.
   if (pending_requests_.empty())
     backup_job_timer_.Stop();
+  UpdateIndexes();
   return request.Pass();
 }
 
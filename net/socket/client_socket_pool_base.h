@@ -361,14 +361,32 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   typedef PriorityQueue<const Request*> RequestQueue;
   typedef std::map<const ClientSocketHandle*, const Request*> RequestMap;
 
+  class Group;
+
+  // Orders the groups in |stalled_groups_| by the priority of the pending
+  // request they were added for, highest first, and then by name.
+  struct StalledGroupOrder {
+    bool operator()(const Group* a, const Group* b) const;
+  };
+
+  // Orders the groups in |idle_socket_groups_| by name.
+  struct GroupNameOrder {
+    bool operator()(const Group* a, const Group* b) const;
+  };
+
+  typedef std::set<Group*, StalledGroupOrder> StalledGroupSet;
+  typedef std::set<Group*, GroupNameOrder> GroupSet;
+
   // A Group is allocated per group_name when there are idle sockets or pending
   // requests.  Otherwise, the Group object is removed from the map.
   // |active_socket_count| tracks the number of sockets held by clients.
   class Group {
    public:
-    Group();
+    Group(const std::string& group_name, ClientSocketPoolBaseHelper* pool);
     ~Group();
 
+    const std::string& group_name() const { return group_name_; }
+
     bool IsEmpty() const {
       return active_socket_count_ == 0 && idle_sockets_.empty() &&
           jobs_.empty() && pending_requests_.empty();
@@ -444,16 +462,31 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
     scoped_ptr<const Request> FindAndRemovePendingRequest(
         ClientSocketHandle* handle);
 
-    void IncrementActiveSocketCount() { active_socket_count_++; }
-    void DecrementActiveSocketCount() { active_socket_count_--; }
+    void IncrementActiveSocketCount() {
+      active_socket_count_++;
+      UpdateIndexes();
+    }
+    void DecrementActiveSocketCount() {
+      active_socket_count_--;
+      UpdateIndexes();
+    }
+
+    // Adds |this| to, moves it within, or removes it from the pool's
+    // |stalled_groups_| and |idle_socket_groups_| to match its current state.
+    // The methods of Group that change its sockets, jobs or pending requests
+    // call this themselves.
+    void UpdateIndexes();
 
     int unassigned_job_count() const { return unassigned_job_count_; }
     const std::set<ConnectJob*>& jobs() const { return jobs_; }
     const std::list<IdleSocket>& idle_sockets() const { return idle_sockets_; }
     int active_socket_count() const { return active_socket_count_; }
+    // Callers that change the list must call UpdateIndexes() afterwards.
     std::list<IdleSocket>* mutable_idle_sockets() { return &idle_sockets_; }
 
    private:
+    friend struct StalledGroupOrder;
+
     // Returns the iterator's pending request after removing it from
     // the queue.
     scoped_ptr<const Request> RemovePendingRequest(
@@ -468,6 +501,9 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
     // ConnectJobs.
     void SanityCheck();
 
+    const std::string group_name_;
+    ClientSocketPoolBaseHelper* const pool_;
+
     // Total number of ConnectJobs that have never been assigned to a Request.
     // Since jobs use late binding to requests, which ConnectJobs have or have
     // not been assigned to a request are not tracked.  This is incremented on
@@ -482,6 +518,13 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
     int active_socket_count_;  // number of active sockets used by clients
     // A timer for when to start the backup job.
     base::OneShotTimer<Group> backup_job_timer_;
+
+    // Whether |this| is in the pool's |stalled_groups_|, and the priority it
+    // was added with, which orders it there.
+    bool in_stalled_groups_;
+    RequestPriority stalled_priority_;
+    // Whether |this| is in the pool's |idle_socket_groups_|.
+    bool in_idle_socket_groups_;
   };
 
   typedef std::map<std::string, Group*> GroupMap;
@@ -511,8 +554,8 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   // Start cleanup timer for idle sockets.
   void StartIdleSocketTimer();
 
-  // Scans the group map for groups which have an available socket slot and
-  // at least one pending request. Returns true if any groups are stalled, and
+  // Looks for groups which have an available socket slot and more pending
+  // requests than connect jobs. Returns true if any groups are stalled, and
   // if so (and if both |group| and |group_name| are not NULL), fills |group|
   // and |group_name| with data of the stalled group having highest priority.
   bool FindTopStalledGroup(Group** group, std::string* group_name) const;
@@ -595,6 +638,12 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
 
   GroupMap group_map_;
 
+  // The groups for which IsStalledOnPoolMaxSockets() is true, and the groups
+  // that have idle sockets, so that releasing or closing a socket does not
+  // have to scan every group. The groups keep themselves in these sets.
+  StalledGroupSet stalled_groups_;
+  GroupSet idle_socket_groups_;
+
   // Map of the ClientSocketHandles for which we have a pending Task to invoke a
   // callback.  This is necessary since, before we invoke said callback, it's
   // possible that the request is cancelled.
@@ -0,0 +1,119 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/socket/client_socket_pool_base.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "net/base/host_port_pair.h"
+#include "net/base/net_errors.h"
+#include "net/base/net_log.h"
+#include "net/dns/mock_host_resolver.h"
+#include "net/socket/client_socket_handle.h"
+#include "net/socket/client_socket_pool_histograms.h"
+#include "net/socket/transport_client_socket_pool.h"
+#include "net/socket/transport_client_socket_pool_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace net {
+
+namespace {
+
+// A crawler's load: many more hosts than the pool has sockets for, each with
+// a backlog of requests at mixed priorities.
+const int kMaxSockets = 256;
+const int kMaxSocketsPerGroup = 6;
+const int kNumGroups = 2000;
+const int kRequestsPerGroup = 10;
+const int kNumRequests = kNumGroups * kRequestsPerGroup;
+
+void OnRequestComplete(std::vector<int>* completed, int index, int result) {
+  EXPECT_EQ(OK, result);
+  completed->push_back(index);
+}
+
+class ClientSocketPoolBasePerfTest : public ::testing::Test {
+ protected:
+  ClientSocketPoolBasePerfTest()
+      : params_(new TransportSocketParams(
+            HostPortPair("www.example.com", 80),
+            false,
+            false,
+            OnHostResolutionCallback(),
+            TransportSocketParams::COMBINE_CONNECT_AND_WRITE_DEFAULT)),
+        histograms_("PerfTest"),
+        client_socket_factory_(NULL),
+        pool_(kMaxSockets,
+              kMaxSocketsPerGroup,
+              &histograms_,
+              &host_resolver_,
+              &client_socket_factory_,
+              NULL) {
+    // Connects complete synchronously, so the test measures the pool rather
+    // than the message loop.
+    host_resolver_.set_synchronous_mode(true);
+  }
+
+  base::MessageLoopForIO message_loop_;
+  scoped_refptr<TransportSocketParams> params_;
+  ClientSocketPoolHistograms histograms_;
+  MockHostResolver host_resolver_;
+  MockTransportClientSocketFactory client_socket_factory_;
+  TransportClientSocketPool pool_;
+  // Indices of the requests that have a socket and have not released it yet.
+  std::vector<int> completed_;
+};
+
+// Queues |kNumRequests| requests spread over |kNumGroups| groups, then keeps
+// releasing every socket handed out until all requests have been served. Each
+// release wakes the highest priority group stalled on the pool's socket limit,
+// closing an idle socket of another group to make room for it.
+TEST_F(ClientSocketPoolBasePerfTest, ServeBacklog) {
+  scoped_ptr<ClientSocketHandle[]> handles(
+      new ClientSocketHandle[kNumRequests]);
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kNumRequests; ++i) {
+    std::string group_name =
+        "host" + base::IntToString(i % kNumGroups) + ".example.com:80";
+    int rv = handles[i].Init(
+        group_name, params_, static_cast<RequestPriority>(i % NUM_PRIORITIES),
+        base::Bind(&OnRequestComplete, &completed_, i),
+        &pool_, BoundNetLog());
+    if (rv == OK)
+      completed_.push_back(i);
+    else
+      ASSERT_EQ(ERR_IO_PENDING, rv);
+  }
+
+  int num_served = 0;
+  while (num_served < kNumRequests) {
+    std::vector<int> to_release;
+    to_release.swap(completed_);
+    ASSERT_FALSE(to_release.empty());
+    for (size_t i = 0; i < to_release.size(); ++i)
+      handles[to_release[i]].Reset();
+    num_served += to_release.size();
+    base::RunLoop().RunUntilIdle();
+  }
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+
+  EXPECT_TRUE(completed_.empty());
+  perf_test::PrintResult("client_socket_pool_base", "", "serve_backlog",
+                         kNumRequests / elapsed.InSecondsF(), "requests/s",
+                         true);
+}
+
+}  // namespace
+
+}  // namespace net
@@ -14,6 +14,8 @@
 #include "net/socket/ssl_socket.h"
 #include "net/socket/stream_socket.h"
 
+class Pickle;
+
 namespace net {
 
 class CertVerifier;
@@ -149,6 +151,14 @@ class NET_EXPORT SSLClientSocket : public SSLSocket {
   // sessions.
   static void ClearSessionCache();
 
+  // SaveSessionCache writes the sessions of the SSL session cache which may be
+  // resumed to |pickle|. RestoreSessionCache adds the sessions written by an
+  // earlier SaveSessionCache, possibly in another process, back to the cache.
+  // Both return false if the SSL library's session cache can't be persisted,
+  // and RestoreSessionCache also if |pickle| is malformed.
+  static bool SaveSessionCache(Pickle* pickle);
+  static bool RestoreSessionCache(const Pickle& pickle);
+
   virtual bool set_was_npn_negotiated(bool negotiated);
 
   virtual bool was_spdy_negotiated() const;
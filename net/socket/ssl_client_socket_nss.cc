@@ -2856,6 +2856,17 @@ void SSLClientSocket::ClearSessionCache() {
   SSL_ClearSessionCache();
 }
 
+// static
+bool SSLClientSocket::SaveSessionCache(Pickle* pickle) {
+  // NSS keeps its client session cache to itself.
+  return false;
+}
+
+// static
+bool SSLClientSocket::RestoreSessionCache(const Pickle& pickle) {
+  return false;
+}
+
 bool SSLClientSocketNSS::GetSSLInfo(SSLInfo* ssl_info) {
   EnterFunction("");
   ssl_info->Reset();
@@ -17,9 +17,11 @@
 #include "base/environment.h"
 #include "base/memory/singleton.h"
 #include "base/metrics/histogram.h"
+#include "base/pickle.h"
 #include "base/profiler/scoped_tracker.h"
 #include "base/strings/string_piece.h"
 #include "base/synchronization/lock.h"
+#include "base/values.h"
 #include "crypto/ec_private_key.h"
 #include "crypto/openssl_util.h"
 #include "crypto/scoped_openssl_types.h"
@@ -154,6 +156,17 @@ bool IsOCSPStaplingSupported() {
 #endif
 }
 
+base::Value* NetLogSessionCacheLookupCallback(
+    bool hit,
+    const SSLSessionCacheOpenSSL* session_cache,
+    NetLog::LogLevel /* log_level */) {
+  base::DictionaryValue* dict = new base::DictionaryValue();
+  dict->SetBoolean("hit", hit);
+  dict->SetInteger("lookups", static_cast<int>(session_cache->lookup_count()));
+  dict->SetInteger("hits", static_cast<int>(session_cache->hit_count()));
+  return dict;
+}
+
 }  // namespace
 
 class SSLClientSocketOpenSSL::SSLContext {
@@ -345,6 +358,21 @@ void SSLClientSocket::ClearSessionCache() {
   context->session_cache()->Flush();
 }
 
+// static
+bool SSLClientSocket::SaveSessionCache(Pickle* pickle) {
+  SSLClientSocketOpenSSL::SSLContext* context =
+      SSLClientSocketOpenSSL::SSLContext::GetInstance();
+  context->session_cache()->Save(pickle);
+  return true;
+}
+
+// static
+bool SSLClientSocket::RestoreSessionCache(const Pickle& pickle) {
+  SSLClientSocketOpenSSL::SSLContext* context =
+      SSLClientSocketOpenSSL::SSLContext::GetInstance();
+  return context->session_cache()->Restore(pickle);
+}
+
 SSLClientSocketOpenSSL::SSLClientSocketOpenSSL(
     scoped_ptr<ClientSocketHandle> transport_socket,
     const HostPortPair& host_and_port,
@@ -721,6 +749,10 @@ int SSLClientSocketOpenSSL::Init() {
 
   trying_cached_session_ = context->session_cache()->SetSSLSessionWithKey(
       ssl_, GetSessionCacheKey());
+  net_log_.AddEvent(NetLog::TYPE_SSL_SESSION_CACHE_LOOKUP,
+                    base::Bind(&NetLogSessionCacheLookupCallback,
+                               trying_cached_session_,
+                               base::Unretained(context->session_cache())));
 
   BIO* ssl_bio = NULL;
   // 0 => use default buffer sizes.
@@ -1160,9 +1192,8 @@ int SSLClientSocketOpenSSL::DoVerifyCertComplete(int result) {
     // the connection.
     VerifyCT();
 
-    // TODO(joth): Work out if we need to remember the intermediate CA certs
-    // when the server sends them to us, and do so here.
-    SSLContext::GetInstance()->session_cache()->MarkSSLSessionAsGood(ssl_);
+    SSLContext::GetInstance()->session_cache()->MarkSSLSessionAsGood(
+        ssl_, SSL_get_peer_cert_chain(ssl_));
     marked_session_as_good_ = true;
     CheckIfHandshakeFinished();
   } else {
@@ -1188,7 +1219,16 @@ void SSLClientSocketOpenSSL::DoConnectCallback(int rv) {
 }
 
 void SSLClientSocketOpenSSL::UpdateServerCert() {
-  server_cert_chain_->Reset(SSL_get_peer_cert_chain(ssl_));
+  STACK_OF(X509)* chain = SSL_get_peer_cert_chain(ssl_);
+  // Sessions added by RestoreSessionCache() don't carry the certificates of
+  // the server, so resuming one takes those kept by the session cache.
+  ScopedX509Stack cached_chain;
+  if (!chain && SSL_session_reused(ssl_)) {
+    cached_chain.reset(
+        SSLContext::GetInstance()->session_cache()->GetPeerCertChain(ssl_));
+    chain = cached_chain.get();
+  }
+  server_cert_chain_->Reset(chain);
   server_cert_ = server_cert_chain_->AsOSChain();
 
   if (server_cert_.get()) {
@@ -6,8 +6,10 @@
 
 #include "base/callback_helpers.h"
 #include "base/memory/ref_counted.h"
+#include "base/pickle.h"
 #include "base/run_loop.h"
 #include "base/time/time.h"
+#include "base/values.h"
 #include "net/base/address_list.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
@@ -2351,6 +2353,56 @@ TEST(SSLClientSocket, ClearSessionCache) {
   SSLClientSocket::ClearSessionCache();
 }
 
+#if defined(USE_OPENSSL)
+// Verifies that sessions saved by SaveSessionCache are resumed once restored,
+// as by a network service which restarts between connections, so that only
+// the first connection makes a full handshake. The certificate of the server
+// is verified on every connection, although restored sessions don't carry it.
+TEST_F(SSLClientSocketTest, RestoreSessionCache) {
+  SpawnedTestServer::SSLOptions ssl_options;
+  ASSERT_TRUE(StartTestServer(ssl_options));
+  SSLClientSocket::ClearSessionCache();
+  scoped_refptr<X509Certificate> server_cert =
+      ImportCertFromFile(GetTestCertsDirectory(), "ok_cert.pem");
+  ASSERT_TRUE(server_cert.get());
+
+  const int kNumConnections = 3;
+  int num_full_handshakes = 0;
+  for (int i = 0; i < kNumConnections; ++i) {
+    Pickle pickle;
+    ASSERT_TRUE(SSLClientSocket::SaveSessionCache(&pickle));
+    SSLClientSocket::ClearSessionCache();
+    ASSERT_TRUE(SSLClientSocket::RestoreSessionCache(pickle));
+
+    TestCompletionCallback callback;
+    CapturingNetLog log;
+    scoped_ptr<StreamSocket> transport(
+        new TCPClientSocket(addr(), &log, NetLog::Source()));
+    ASSERT_EQ(OK, callback.GetResult(transport->Connect(callback.callback())));
+    scoped_ptr<SSLClientSocket> sock(CreateSSLClientSocket(
+        transport.Pass(), test_server()->host_port_pair(), kDefaultSSLConfig));
+    ASSERT_EQ(OK, callback.GetResult(sock->Connect(callback.callback())));
+
+    SSLInfo ssl_info;
+    ASSERT_TRUE(sock->GetSSLInfo(&ssl_info));
+    if (ssl_info.handshake_type == SSLInfo::HANDSHAKE_FULL)
+      ++num_full_handshakes;
+    ASSERT_TRUE(ssl_info.cert.get());
+    EXPECT_TRUE(ssl_info.cert->Equals(server_cert.get()));
+
+    CapturingNetLog::CapturedEntryList entries;
+    log.GetEntries(&entries);
+    size_t pos = ExpectLogContainsSomewhere(
+        entries, 0, NetLog::TYPE_SSL_SESSION_CACHE_LOOKUP, NetLog::PHASE_NONE);
+    ASSERT_LT(pos, entries.size());
+    bool hit = false;
+    ASSERT_TRUE(entries[pos].params->GetBoolean("hit", &hit));
+    EXPECT_EQ(i > 0, hit);
+  }
+  EXPECT_EQ(1, num_full_handshakes);
+}
+#endif  // defined(USE_OPENSSL)
+
 // Test that the server certificates are properly retrieved from the underlying
 // SSL stack.
 TEST_F(SSLClientSocketTest, VerifyServerChainProperlyOrdered) {
@@ -6,19 +6,57 @@
 
 #include <list>
 #include <map>
+#include <utility>
+#include <vector>
 
 #include <openssl/rand.h>
 #include <openssl/ssl.h>
+#include <openssl/x509.h>
 
 #include "base/containers/hash_tables.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/pickle.h"
+#include "base/stl_util.h"
 #include "base/synchronization/lock.h"
 
 namespace net {
 
 namespace {
 
+// Version of the format written by SSLSessionCacheOpenSSL::Save(). Increment
+// it when the format changes, so that older data is ignored.
+const int kSessionCachePickleVersion = 2;
+
+void FreeX509Stack(STACK_OF(X509)* chain) {
+  sk_X509_pop_free(chain, X509_free);
+}
+
+// Called when OpenSSL copies a session, to give the copy its own reference
+// to the peer certificate chain of the original.
+int DupPeerCertChain(CRYPTO_EX_DATA* to,
+                     const CRYPTO_EX_DATA* from,
+                     void** from_d,
+                     int index,
+                     long argl,
+                     void* argp) {
+  STACK_OF(X509)** chain = reinterpret_cast<STACK_OF(X509)**>(from_d);
+  if (*chain)
+    *chain = X509_chain_up_ref(*chain);
+  return 1;
+}
+
+// Called when a session is freed, to release its peer certificate chain.
+void FreePeerCertChain(void* parent,
+                       void* ptr,
+                       CRYPTO_EX_DATA* ad,
+                       int index,
+                       long argl,
+                       void* argp) {
+  if (ptr)
+    FreeX509Stack(reinterpret_cast<STACK_OF(X509)*>(ptr));
+}
+
 // A helper class to lazily create a new EX_DATA index to map SSL_CTX handles
 // to their corresponding SSLSessionCacheOpenSSLImpl object.
 class SSLContextExIndex {
@@ -28,14 +66,19 @@ public:
     DCHECK_NE(-1, context_index_);
     session_index_ = SSL_SESSION_get_ex_new_index(0, NULL, NULL, NULL, NULL);
     DCHECK_NE(-1, session_index_);
+    chain_index_ = SSL_SESSION_get_ex_new_index(
+        0, NULL, NULL, &DupPeerCertChain, &FreePeerCertChain);
+    DCHECK_NE(-1, chain_index_);
   }
 
   int context_index() const { return context_index_; }
   int session_index() const { return session_index_; }
+  int chain_index() const { return chain_index_; }
 
  private:
   int context_index_;
   int session_index_;
+  int chain_index_;
 };
 
 // static
@@ -54,6 +97,12 @@ static int GetSSLSessionExIndex() {
   return s_ssl_context_ex_instance.Get().session_index();
 }
 
+// Retrieve the global EX_DATA index, created lazily on first call, under
+// which each session holds the certificate chain of its server.
+static int GetPeerCertChainExIndex() {
+  return s_ssl_context_ex_instance.Get().chain_index();
+}
+
 // Helper struct used to store session IDs in a SessionIdIndex container
 // (see definition below). To save memory each entry only holds a pointer
 // to the session ID buffer, which must outlive the entry itself. On the
@@ -155,7 +204,11 @@ class SSLSessionCacheOpenSSLImpl {
   // string, according to the client's preferences.
   SSLSessionCacheOpenSSLImpl(SSL_CTX* ctx,
                              const SSLSessionCacheOpenSSL::Config& config)
-      : ctx_(ctx), config_(config), expiration_check_(0) {
+      : ctx_(ctx),
+        config_(config),
+        expiration_check_(0),
+        lookup_count_(0),
+        hit_count_(0) {
     DCHECK(ctx);
 
     // NO_INTERNAL_STORE disables OpenSSL's builtin cache, and
@@ -210,6 +263,7 @@ class SSLSessionCacheOpenSSLImpl {
 
     DCHECK_EQ(config_.key_func(ssl), cache_key);
 
+    ++lookup_count_;
     if (++expiration_check_ >= config_.expiration_check_count) {
       expiration_check_ = 0;
       FlushExpiredSessionsLocked();
@@ -234,7 +288,10 @@ class SSLSessionCacheOpenSSLImpl {
     ordering_.erase(it->second);
     it->second = ordering_.begin();
 
-    return SSL_set_session(ssl, session) == 1;
+    if (SSL_set_session(ssl, session) != 1)
+      return false;
+    ++hit_count_;
+    return true;
   }
 
   // Return true iff a cached session was associated with the given |cache_key|.
@@ -253,15 +310,35 @@ class SSLSessionCacheOpenSSLImpl {
     return session_is_good != NULL;
   }
 
-  void MarkSSLSessionAsGood(SSL* ssl) {
+  void MarkSSLSessionAsGood(SSL* ssl, STACK_OF(X509)* peer_cert_chain) {
     SSL_SESSION* session = SSL_get_session(ssl);
     CHECK(session);
 
+    base::AutoLock locked(lock_);
+    // Keep the first chain given for the session. Resumed connections give
+    // the same one, or none if the session came from Restore().
+    if (peer_cert_chain &&
+        !SSL_SESSION_get_ex_data(session, GetPeerCertChainExIndex())) {
+      SSL_SESSION_set_ex_data(session, GetPeerCertChainExIndex(),
+                              X509_chain_up_ref(peer_cert_chain));
+    }
+
     // Mark the session as good, allowing it to be used for future connections.
     SSL_SESSION_set_ex_data(
         session, GetSSLSessionExIndex(), reinterpret_cast<void*>(1));
   }
 
+  STACK_OF(X509)* GetPeerCertChain(SSL* ssl) const {
+    SSL_SESSION* session = SSL_get_session(ssl);
+    if (!session)
+      return NULL;
+
+    base::AutoLock locked(lock_);
+    STACK_OF(X509)* chain = reinterpret_cast<STACK_OF(X509)*>(
+        SSL_SESSION_get_ex_data(session, GetPeerCertChainExIndex()));
+    return chain ? X509_chain_up_ref(chain) : NULL;
+  }
+
   // Flush all entries from the cache.
   void Flush() {
     base::AutoLock lock(lock_);
@@ -274,7 +351,132 @@ class SSLSessionCacheOpenSSLImpl {
     }
   }
 
+  void Save(Pickle* pickle) const {
+    base::AutoLock locked(lock_);
+    long now = static_cast<long>(::time(NULL));
+    std::vector<SavedSession> entries;
+    for (MRUSessionList::const_reverse_iterator it = ordering_.rbegin();
+         it != ordering_.rend(); ++it) {
+      SSL_SESSION* session = *it;
+      // Sessions which were never marked as good, or have expired, can't be
+      // resumed. Nor can those without a certificate chain, since it must be
+      // verified again on resumption.
+      STACK_OF(X509)* chain = reinterpret_cast<STACK_OF(X509)*>(
+          SSL_SESSION_get_ex_data(session, GetPeerCertChainExIndex()));
+      if (!SSL_SESSION_get_ex_data(session, GetSSLSessionExIndex()) ||
+          IsSessionExpired(session, now) || !chain ||
+          sk_X509_num(chain) == 0) {
+        continue;
+      }
+
+      SavedSession entry;
+      if (!EncodeSession(session, &entry.encoded_session) ||
+          !EncodeCertChain(chain, &entry.encoded_chain)) {
+        continue;
+      }
+
+      SessionIdIndex::const_iterator id_it = id_index_.find(SessionId(session));
+      DCHECK(id_it != id_index_.end());
+      entry.cache_key = id_it->second->first;
+      entries.push_back(entry);
+    }
+
+    pickle->WriteInt(kSessionCachePickleVersion);
+    pickle->WriteSizeT(entries.size());
+    for (size_t n = 0; n < entries.size(); ++n) {
+      pickle->WriteString(entries[n].cache_key);
+      pickle->WriteString(entries[n].encoded_session);
+      pickle->WriteSizeT(entries[n].encoded_chain.size());
+      for (size_t i = 0; i < entries[n].encoded_chain.size(); ++i)
+        pickle->WriteString(entries[n].encoded_chain[i]);
+    }
+  }
+
+  bool Restore(const Pickle& pickle) {
+    PickleIterator iter(pickle);
+    int version;
+    size_t num_entries;
+    if (!iter.ReadInt(&version) || version != kSessionCachePickleVersion ||
+        !iter.ReadSizeT(&num_entries)) {
+      return false;
+    }
+
+    base::AutoLock locked(lock_);
+    long now = static_cast<long>(::time(NULL));
+    for (size_t n = 0; n < num_entries; ++n) {
+      std::string cache_key;
+      std::string encoded_session;
+      size_t chain_length;
+      if (!iter.ReadString(&cache_key) ||
+          !iter.ReadString(&encoded_session) ||
+          !iter.ReadSizeT(&chain_length) || chain_length == 0) {
+        return false;
+      }
+      STACK_OF(X509)* chain = sk_X509_new_null();
+      for (size_t i = 0; i < chain_length; ++i) {
+        std::string encoded_cert;
+        X509* cert = NULL;
+        if (iter.ReadString(&encoded_cert)) {
+          const unsigned char* in =
+              reinterpret_cast<const unsigned char*>(encoded_cert.data());
+          cert = d2i_X509(NULL, &in, static_cast<long>(encoded_cert.size()));
+        }
+        if (!cert) {
+          FreeX509Stack(chain);
+          return false;
+        }
+        sk_X509_push(chain, cert);
+      }
+
+      const unsigned char* in =
+          reinterpret_cast<const unsigned char*>(encoded_session.data());
+      SSL_SESSION* session = d2i_SSL_SESSION(
+          NULL, &in, static_cast<long>(encoded_session.size()));
+      if (!session) {
+        FreeX509Stack(chain);
+        return false;
+      }
+      // The session now owns |chain|.
+      SSL_SESSION_set_ex_data(session, GetPeerCertChainExIndex(), chain);
+
+      // Skip sessions which can't be indexed or have expired. A session made
+      // for the same key since this process started is more recent than the
+      // saved one, so it is kept.
+      if (session->session_id_length == 0 ||
+          IsSessionExpired(session, now) ||
+          key_index_.find(cache_key) != key_index_.end() ||
+          id_index_.find(SessionId(session)) != id_index_.end()) {
+        SSL_SESSION_free(session);
+        continue;
+      }
+
+      // Only sessions marked as good are saved.
+      SSL_SESSION_set_ex_data(
+          session, GetSSLSessionExIndex(), reinterpret_cast<void*>(1));
+      AddSessionLocked(cache_key, session);
+    }
+    return true;
+  }
+
+  size_t lookup_count() const {
+    base::AutoLock locked(lock_);
+    return lookup_count_;
+  }
+
+  size_t hit_count() const {
+    base::AutoLock locked(lock_);
+    return hit_count_;
+  }
+
  private:
+  // A session written by Save(), with its cache key and the DER encodings of
+  // the session and of the certificates of its server.
+  struct SavedSession {
+    std::string cache_key;
+    std::string encoded_session;
+    std::vector<std::string> encoded_chain;
+  };
+
   // Type for list of SSL_SESSION handles, ordered in MRU order.
   typedef std::list<SSL_SESSION*> MRUSessionList;
   // Type for a dictionary from unique cache keys to session list nodes.
@@ -322,6 +524,46 @@ class SSLSessionCacheOpenSSLImpl {
     DCHECK_EQ(key_index_.size(), id_index_.size());
   }
 
+  // Write the DER encoding of |session| to |out|. Return false on failure.
+  static bool EncodeSession(SSL_SESSION* session, std::string* out) {
+    int length = i2d_SSL_SESSION(session, NULL);
+    if (length <= 0)
+      return false;
+    out->resize(length);
+    unsigned char* buffer =
+        reinterpret_cast<unsigned char*>(string_as_array(out));
+    return i2d_SSL_SESSION(session, &buffer) == length;
+  }
+
+  // Write the DER encodings of the certificates of |chain| to |out|. Return
+  // false on failure.
+  static bool EncodeCertChain(STACK_OF(X509)* chain,
+                              std::vector<std::string>* out) {
+    out->resize(sk_X509_num(chain));
+    for (size_t i = 0; i < out->size(); ++i) {
+      X509* cert = sk_X509_value(chain, i);
+      int length = i2d_X509(cert, NULL);
+      if (length <= 0)
+        return false;
+      std::string& encoded_cert = (*out)[i];
+      encoded_cert.resize(length);
+      unsigned char* buffer =
+          reinterpret_cast<unsigned char*>(string_as_array(&encoded_cert));
+      if (i2d_X509(cert, &buffer) != length)
+        return false;
+    }
+    return true;
+  }
+
+  // Return true iff |session| has expired at time |now|, in seconds since the
+  // Unix epoch.
+  static bool IsSessionExpired(const SSL_SESSION* session, long now) {
+    // Important, use <= instead of < here to allow unit testing to
+    // work properly. That's because unit tests that check the expiration
+    // behaviour will use a session timeout of 0 seconds.
+    return session->time + session->timeout <= now;
+  }
+
   // Used internally to flush expired sessions. Lock must be held.
   void FlushExpiredSessionsLocked() {
     lock_.AssertAcquired();
@@ -333,10 +575,7 @@ class SSLSessionCacheOpenSSLImpl {
     while (it != ordering_.end()) {
       SSL_SESSION* session = *it++;
 
-      // Important, use <= instead of < here to allow unit testing to
-      // work properly. That's because unit tests that check the expiration
-      // behaviour will use a session timeout of 0 seconds.
-      if (session->time + session->timeout <= timeout_secs) {
+      if (IsSessionExpired(session, timeout_secs)) {
         DVLOG(2) << "Expiring session " << session << " for "
                  << SessionKey(session);
         RemoveSessionLocked(session);
@@ -393,14 +632,20 @@ class SSLSessionCacheOpenSSLImpl {
     return 1;
   }
 
-  // Add |session| to the cache in association with |cache_key|. If a session
-  // already exists, it is replaced with the new one. This assumes that the
-  // caller already incremented the session's reference count.
+  // Add |session| to the cache in association with the cache key of |ssl|.
   void OnSessionAdded(SSL* ssl, SSL_SESSION* session) {
     base::AutoLock locked(lock_);
     DCHECK(ssl);
+    AddSessionLocked(config_.key_func(ssl), session);
+  }
+
+  // Add |session| to the cache in association with |cache_key|. If a session
+  // already exists, it is replaced with the new one. This assumes that the
+  // caller already incremented the session's reference count. Lock must be
+  // held.
+  void AddSessionLocked(const std::string& cache_key, SSL_SESSION* session) {
+    lock_.AssertAcquired();
     DCHECK_GT(session->session_id_length, 0U);
-    std::string cache_key = config_.key_func(ssl);
     KeyIndex::iterator it = key_index_.find(cache_key);
     if (it == key_index_.end()) {
       DVLOG(2) << "Add session " << session << " for " << cache_key;
@@ -493,6 +738,8 @@ class SSLSessionCacheOpenSSLImpl {
   SessionIdIndex id_index_;
 
   size_t expiration_check_;
+  size_t lookup_count_;
+  size_t hit_count_;
 };
 
 SSLSessionCacheOpenSSL::~SSLSessionCacheOpenSSL() { delete impl_; }
@@ -521,10 +768,28 @@ bool SSLSessionCacheOpenSSL::SSLSessionIsInCache(
   return impl_->SSLSessionIsInCache(cache_key);
 }
 
-void SSLSessionCacheOpenSSL::MarkSSLSessionAsGood(SSL* ssl) {
-  return impl_->MarkSSLSessionAsGood(ssl);
+void SSLSessionCacheOpenSSL::MarkSSLSessionAsGood(
+    SSL* ssl,
+    STACK_OF(X509)* peer_cert_chain) {
+  return impl_->MarkSSLSessionAsGood(ssl, peer_cert_chain);
+}
+
+STACK_OF(X509)* SSLSessionCacheOpenSSL::GetPeerCertChain(SSL* ssl) const {
+  return impl_->GetPeerCertChain(ssl);
 }
 
 void SSLSessionCacheOpenSSL::Flush() { impl_->Flush(); }
 
+void SSLSessionCacheOpenSSL::Save(Pickle* pickle) const { impl_->Save(pickle); }
+
+bool SSLSessionCacheOpenSSL::Restore(const Pickle& pickle) {
+  return impl_->Restore(pickle);
+}
+
+size_t SSLSessionCacheOpenSSL::lookup_count() const {
+  return impl_->lookup_count();
+}
+
+size_t SSLSessionCacheOpenSSL::hit_count() const { return impl_->hit_count(); }
+
 }  // namespace net
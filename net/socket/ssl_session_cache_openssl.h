@@ -10,9 +10,12 @@
 #include "base/basictypes.h"
 #include "net/base/net_export.h"
 
+class Pickle;
+
 // Avoid including OpenSSL headers here.
 typedef struct ssl_ctx_st SSL_CTX;
 typedef struct ssl_st SSL;
+struct stack_st_X509;  // STACK_OF(X509)
 
 namespace net {
 
@@ -44,6 +47,12 @@ class SSLSessionCacheOpenSSLImpl;
 //  - Clients can call Flush() to remove all sessions from the cache, this is
 //    useful when the system's certificate store has changed.
 //
+//  - Clients can call Save() to serialize the sessions which may be resumed,
+//    and Restore() to add them to the cache of a later process, so that it
+//    doesn't pay full handshakes to the hosts it talked to before. Sessions
+//    read back by OpenSSL lack the server's certificates, so clients resuming
+//    one get them from GetPeerCertChain() instead.
+//
 // This class is thread-safe. There shouldn't be any issue with multiple
 // SSL connections being performed in parallel in multiple threads.
 class NET_EXPORT SSLSessionCacheOpenSSL {
@@ -122,12 +131,38 @@ class NET_EXPORT SSLSessionCacheOpenSSL {
   // OpenSSL does not provide an asynchronous certificate verification
   // callback, it's necessary to manually manage the sessions to ensure that
   // only validated sessions are resumed.
-  void MarkSSLSessionAsGood(SSL* ssl);
+  //
+  // |peer_cert_chain| is the certificate chain that the server sent, which
+  // was verified. The cache keeps a reference to it for GetPeerCertChain()
+  // and Save(), unless it already has a chain for the session.
+  void MarkSSLSessionAsGood(SSL* ssl, struct stack_st_X509* peer_cert_chain);
+
+  // Return a new reference to the certificate chain kept for the session of
+  // |ssl| by MarkSSLSessionAsGood() or Restore(), or NULL if there is none.
+  // The caller must free it with sk_X509_pop_free().
+  struct stack_st_X509* GetPeerCertChain(SSL* ssl) const;
 
   // Flush removes all entries from the cache. This is typically called when
   // the system's certificate store has changed.
   void Flush();
 
+  // Write the sessions that were marked as good and haven't expired to
+  // |pickle|, with their cache keys and certificate chains, from the least to
+  // the most recently used.
+  void Save(Pickle* pickle) const;
+
+  // Add the sessions written to |pickle| by Save() to the cache, keeping their
+  // order of use. Sessions which have expired since, or whose cache key
+  // already has a session, are skipped. Return false if |pickle| is
+  // malformed, in which case the sessions read before the error are kept.
+  bool Restore(const Pickle& pickle);
+
+  // Return the number of calls to SetSSLSession() or SetSSLSessionWithKey()
+  // since the cache was last reset, and how many of them associated a cached
+  // session with the connection.
+  size_t lookup_count() const;
+  size_t hit_count() const;
+
   // TODO(digit): Move to client code.
   static const int kDefaultTimeoutSeconds = 60 * 60;
   static const size_t kMaxEntries = 1024;
@@ -4,13 +4,19 @@
 
 #include "net/socket/ssl_session_cache_openssl.h"
 
+#include <openssl/pem.h>
 #include <openssl/ssl.h>
+#include <openssl/x509.h>
 
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/pickle.h"
 #include "base/strings/stringprintf.h"
 #include "crypto/openssl_util.h"
 #include "crypto/scoped_openssl_types.h"
+#include "net/base/test_data_directory.h"
 
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -34,6 +40,31 @@ namespace {
 typedef crypto::ScopedOpenSSL<SSL, SSL_free>::Type ScopedSSL;
 typedef crypto::ScopedOpenSSL<SSL_CTX, SSL_CTX_free>::Type ScopedSSL_CTX;
 
+void FreeX509Stack(STACK_OF(X509)* chain) {
+  sk_X509_pop_free(chain, X509_free);
+}
+
+typedef crypto::ScopedOpenSSL<STACK_OF(X509), FreeX509Stack>::Type
+    ScopedX509Stack;
+
+// Return a certificate chain holding the certificate of the test server, or
+// NULL on failure.
+STACK_OF(X509)* NewPeerCertChain() {
+  std::string pem;
+  if (!base::ReadFileToString(
+          GetTestCertsDirectory().AppendASCII("ok_cert.pem"), &pem)) {
+    return NULL;
+  }
+  crypto::ScopedBIO bio(BIO_new_mem_buf(const_cast<char*>(pem.data()),
+                                        static_cast<int>(pem.size())));
+  X509* cert = PEM_read_bio_X509(bio.get(), NULL, NULL, NULL);
+  if (!cert)
+    return NULL;
+  STACK_OF(X509)* chain = sk_X509_new_null();
+  sk_X509_push(chain, cert);
+  return chain;
+}
+
 // Helper class used to associate arbitrary std::string keys with SSL objects.
 class SSLKeyHelper {
  public:
@@ -112,6 +143,8 @@ class SSLSessionCacheOpenSSLTest : public testing::Test {
     crypto::EnsureOpenSSLInit();
     ctx_.reset(SSL_CTX_new(SSLv23_client_method()));
     cache_.Reset(ctx_.get(), kDefaultConfig);
+    peer_cert_chain_.reset(NewPeerCertChain());
+    CHECK(peer_cert_chain_);
   }
 
   // Reset cache configuration.
@@ -141,12 +174,37 @@ class SSLSessionCacheOpenSSLTest : public testing::Test {
     ssl_update_cache(ssl, ctx_.get()->session_cache_mode);
   }
 
+  // Add a given SSL object and its session to the cache, as a completed
+  // handshake would: with a cipher suite, which sessions need to be saved,
+  // and marked as good with the certificate chain of the server.
+  void AddGoodSessionToCache(SSL* ssl) {
+    ssl->session->cipher = sk_SSL_CIPHER_value(SSL_get_ciphers(ssl), 0);
+    AddToCache(ssl);
+    cache_.MarkSSLSessionAsGood(ssl, peer_cert_chain_.get());
+  }
+
+  // Return true iff the cache keeps the certificate chain of the server for
+  // the session of |ssl|.
+  bool HasPeerCertChain(SSL* ssl) {
+    ScopedX509Stack chain(cache_.GetPeerCertChain(ssl));
+    return chain && sk_X509_num(chain.get()) == 1 &&
+           X509_cmp(sk_X509_value(chain.get(), 0),
+                    sk_X509_value(peer_cert_chain_.get(), 0)) == 0;
+  }
+
+  // Return the session ID of |session| as a string.
+  static std::string SessionId(const SSL_SESSION* session) {
+    return std::string(reinterpret_cast<const char*>(session->session_id),
+                       session->session_id_length);
+  }
+
   static const SSLSessionCacheOpenSSL::Config kDefaultConfig;
 
  protected:
   ScopedSSL_CTX ctx_;
   // |cache_| must be destroyed before |ctx_| and thus appears after it.
   SSLSessionCacheOpenSSL cache_;
+  ScopedX509Stack peer_cert_chain_;
 };
 
 // static
@@ -215,7 +273,7 @@ TEST_F(SSLSessionCacheOpenSSLTest, SetSSLSession) {
   EXPECT_EQ(2, session->references);
 
   // Mark the session as good, so that it is re-used for the second connection.
-  cache_.MarkSSLSessionAsGood(ssl.get());
+  cache_.MarkSSLSessionAsGood(ssl.get(), NULL);
 
   ssl.reset(NULL);
   EXPECT_EQ(1, session->references);
@@ -232,7 +290,7 @@ TEST_F(SSLSessionCacheOpenSSLTest, SetSSLSessionWithKey) {
   const std::string key("hello");
   ScopedSSL ssl(NewSSL(key));
   AddToCache(ssl.get());
-  cache_.MarkSSLSessionAsGood(ssl.get());
+  cache_.MarkSSLSessionAsGood(ssl.get(), NULL);
   ssl.reset(NULL);
 
   ScopedSSL ssl2(NewSSL(key));
@@ -293,7 +351,7 @@ TEST_F(SSLSessionCacheOpenSSLTest, CheckSessionReplacementWhenNotGood) {
   EXPECT_EQ(2, session2->references);
 
   // Mark the first session as good, simulating it completing.
-  cache_.MarkSSLSessionAsGood(ssl.get());
+  cache_.MarkSSLSessionAsGood(ssl.get(), NULL);
 
   // Third call should find the session ID, but because the second session (the
   // current cache entry) is not yet good, fail to associate it with |ssl3|.
@@ -377,4 +435,177 @@ TEST_F(SSLSessionCacheOpenSSLTest, CheckExpiration) {
   EXPECT_EQ(1U, cache_.size());
 }
 
+TEST_F(SSLSessionCacheOpenSSLTest, LookupCounts) {
+  const std::string key("hello");
+  ScopedSSL ssl(NewSSL(key));
+  EXPECT_FALSE(cache_.SetSSLSession(ssl.get()));
+  AddGoodSessionToCache(ssl.get());
+  ssl.reset(NULL);
+
+  ScopedSSL ssl2(NewSSL(key));
+  EXPECT_TRUE(cache_.SetSSLSessionWithKey(ssl2.get(), key));
+  ScopedSSL ssl3(NewSSL("unknown-key"));
+  EXPECT_FALSE(cache_.SetSSLSession(ssl3.get()));
+
+  EXPECT_EQ(3U, cache_.lookup_count());
+  EXPECT_EQ(1U, cache_.hit_count());
+}
+
+// Check that saved sessions can be resumed once restored, with the
+// certificate chain of their server, and that sessions which were never
+// marked as good, or were marked without a chain, are not saved.
+TEST_F(SSLSessionCacheOpenSSLTest, SaveAndRestore) {
+  ScopedSSL ssl1(NewSSL("key1"));
+  AddGoodSessionToCache(ssl1.get());
+  EXPECT_TRUE(HasPeerCertChain(ssl1.get()));
+  ScopedSSL ssl2(NewSSL("key2"));
+  AddToCache(ssl2.get());
+  ScopedSSL ssl3(NewSSL("key3"));
+  AddGoodSessionToCache(ssl3.get());
+  ScopedSSL ssl4(NewSSL("key4"));
+  ssl4.get()->session->cipher =
+      sk_SSL_CIPHER_value(SSL_get_ciphers(ssl4.get()), 0);
+  AddToCache(ssl4.get());
+  cache_.MarkSSLSessionAsGood(ssl4.get(), NULL);
+  EXPECT_FALSE(HasPeerCertChain(ssl4.get()));
+  const std::string session_id1 = SessionId(ssl1.get()->session);
+  ssl1.reset(NULL);
+  ssl2.reset(NULL);
+  ssl3.reset(NULL);
+  ssl4.reset(NULL);
+
+  Pickle pickle;
+  cache_.Save(&pickle);
+  cache_.Flush();
+  EXPECT_EQ(0U, cache_.size());
+
+  EXPECT_TRUE(cache_.Restore(pickle));
+  EXPECT_EQ(2U, cache_.size());
+  EXPECT_TRUE(cache_.SSLSessionIsInCache("key1"));
+  EXPECT_FALSE(cache_.SSLSessionIsInCache("key2"));
+  EXPECT_TRUE(cache_.SSLSessionIsInCache("key3"));
+  EXPECT_FALSE(cache_.SSLSessionIsInCache("key4"));
+
+  ScopedSSL ssl5(NewSSL("key1"));
+  EXPECT_TRUE(cache_.SetSSLSession(ssl5.get()));
+  EXPECT_EQ(session_id1, SessionId(ssl5.get()->session));
+  EXPECT_TRUE(HasPeerCertChain(ssl5.get()));
+
+  // A resumed connection, which gets no chain of its own, keeps the restored
+  // one.
+  cache_.MarkSSLSessionAsGood(ssl5.get(), NULL);
+  EXPECT_TRUE(HasPeerCertChain(ssl5.get()));
+}
+
+// Check that restored sessions keep their order of use, so that the least
+// recently used ones are evicted first.
+TEST_F(SSLSessionCacheOpenSSLTest, RestoreKeepsOrderOfUse) {
+  ScopedSSL ssl1(NewSSL("key1"));
+  AddGoodSessionToCache(ssl1.get());
+  ScopedSSL ssl2(NewSSL("key2"));
+  AddGoodSessionToCache(ssl2.get());
+  ssl1.reset(NULL);
+  ssl2.reset(NULL);
+
+  // Use the first session, which makes the second one the least recently used.
+  ScopedSSL ssl3(NewSSL("key1"));
+  EXPECT_TRUE(cache_.SetSSLSession(ssl3.get()));
+  ssl3.reset(NULL);
+
+  Pickle pickle;
+  cache_.Save(&pickle);
+
+  SSLSessionCacheOpenSSL::Config config = kDefaultConfig;
+  config.max_entries = 1;
+  ResetConfig(config);
+  EXPECT_TRUE(cache_.Restore(pickle));
+  EXPECT_EQ(1U, cache_.size());
+  EXPECT_TRUE(cache_.SSLSessionIsInCache("key1"));
+  EXPECT_FALSE(cache_.SSLSessionIsInCache("key2"));
+}
+
+// Check that expired sessions are not restored, and that restored sessions
+// don't replace the ones added since they were saved.
+TEST_F(SSLSessionCacheOpenSSLTest, RestoreSkipsExpiredAndReplacedSessions) {
+  ScopedSSL ssl1(NewSSL("key1"));
+  AddGoodSessionToCache(ssl1.get());
+  ScopedSSL ssl2(NewSSL("key2"));
+  AddGoodSessionToCache(ssl2.get());
+  // See CheckExpiration above.
+  ssl2.get()->session->time = 1;
+  ssl1.reset(NULL);
+  ssl2.reset(NULL);
+
+  Pickle pickle;
+  cache_.Save(&pickle);
+  cache_.Flush();
+
+  ScopedSSL ssl3(NewSSL("key1"));
+  AddGoodSessionToCache(ssl3.get());
+  const std::string session_id3 = SessionId(ssl3.get()->session);
+  ssl3.reset(NULL);
+
+  EXPECT_TRUE(cache_.Restore(pickle));
+  EXPECT_EQ(1U, cache_.size());
+  EXPECT_FALSE(cache_.SSLSessionIsInCache("key2"));
+
+  ScopedSSL ssl4(NewSSL("key1"));
+  EXPECT_TRUE(cache_.SetSSLSession(ssl4.get()));
+  EXPECT_EQ(session_id3, SessionId(ssl4.get()->session));
+}
+
+TEST_F(SSLSessionCacheOpenSSLTest, RestoreMalformed) {
+  EXPECT_FALSE(cache_.Restore(Pickle()));
+
+  // Data written by an older version.
+  Pickle old_pickle;
+  old_pickle.WriteInt(1);
+  old_pickle.WriteSizeT(0);
+  EXPECT_FALSE(cache_.Restore(old_pickle));
+
+  ScopedSSL ssl(NewSSL("key1"));
+  AddGoodSessionToCache(ssl.get());
+  Pickle good_pickle;
+  cache_.Save(&good_pickle);
+  PickleIterator iter(good_pickle);
+  int version;
+  size_t num_entries;
+  std::string cache_key;
+  std::string encoded_session;
+  ASSERT_TRUE(iter.ReadInt(&version));
+  ASSERT_TRUE(iter.ReadSizeT(&num_entries));
+  ASSERT_EQ(1U, num_entries);
+  ASSERT_TRUE(iter.ReadString(&cache_key));
+  ASSERT_TRUE(iter.ReadString(&encoded_session));
+  ssl.reset(NULL);
+  cache_.Flush();
+
+  Pickle pickle;
+  pickle.WriteInt(version);
+  pickle.WriteSizeT(1);
+  pickle.WriteString(cache_key);
+  pickle.WriteString("not a session");
+  pickle.WriteSizeT(0);
+  EXPECT_FALSE(cache_.Restore(pickle));
+
+  // A session without certificates.
+  Pickle no_chain_pickle;
+  no_chain_pickle.WriteInt(version);
+  no_chain_pickle.WriteSizeT(1);
+  no_chain_pickle.WriteString(cache_key);
+  no_chain_pickle.WriteString(encoded_session);
+  no_chain_pickle.WriteSizeT(0);
+  EXPECT_FALSE(cache_.Restore(no_chain_pickle));
+
+  Pickle bad_chain_pickle;
+  bad_chain_pickle.WriteInt(version);
+  bad_chain_pickle.WriteSizeT(1);
+  bad_chain_pickle.WriteString(cache_key);
+  bad_chain_pickle.WriteString(encoded_session);
+  bad_chain_pickle.WriteSizeT(1);
+  bad_chain_pickle.WriteString("not a certificate");
+  EXPECT_FALSE(cache_.Restore(bad_chain_pickle));
+  EXPECT_EQ(0U, cache_.size());
+}
+
 }  // namespace net
@@ -0,0 +1,150 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/hpack_encoder.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/perf_time_logger.h"
+#include "net/spdy/hpack_constants.h"
+#include "net/spdy/hpack_header_table.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kIterations = 20000;
+
+typedef std::map<std::string, std::string> HeaderSet;
+
+// Request headers of a browser fetching a page and its subresources from a
+// few origins, in the proportions seen when loading a typical site.
+std::vector<HeaderSet> MakeRequestCorpus() {
+  static const char* const kAuthorities[] = {
+      "www.example.com", "static.example.com", "cdn.example.net",
+      "ads.example.org",
+  };
+  static const char* const kPaths[] = {
+      "/", "/index.html", "/css/site.css", "/js/app.min.js",
+      "/images/logo.png", "/images/hero.jpg", "/fonts/body.woff2",
+      "/api/v1/items?page=2&sort=recent", "/favicon.ico",
+  };
+  static const char* const kAccepts[] = {
+      "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8",
+      "text/css,*/*;q=0.1", "*/*", "image/webp,*/*;q=0.8",
+  };
+
+  std::vector<HeaderSet> corpus;
+  for (size_t i = 0; i < 64; ++i) {
+    HeaderSet headers;
+    headers[":method"] = (i % 16 == 15) ? "POST" : "GET";
+    headers[":scheme"] = "https";
+    headers[":authority"] = kAuthorities[i % arraysize(kAuthorities)];
+    headers[":path"] = kPaths[i % arraysize(kPaths)];
+    headers["accept"] = kAccepts[i % arraysize(kAccepts)];
+    headers["accept-encoding"] = "gzip, deflate, sdch";
+    headers["accept-language"] = "en-US,en;q=0.8";
+    headers["user-agent"] =
+        "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like "
+        "Gecko) Chrome/40.0.2214.85 Safari/537.36";
+    headers["referer"] = "https://www.example.com/";
+    headers["cookie"] =
+        "session=a8f3b2c1d4e5; prefs=lang%3Den; _ga=GA1.2.1234567890." +
+        base::SizeTToString(1400000000 + i / 8);
+    if (i % 4 == 0)
+      headers["cache-control"] = "max-age=0";
+    if (i % 16 == 15) {
+      headers["content-type"] = "application/x-www-form-urlencoded";
+      headers["content-length"] = base::SizeTToString(100 + i);
+    }
+    corpus.push_back(headers);
+  }
+  return corpus;
+}
+
+// Response headers with a mix of repeated and unique values.
+std::vector<HeaderSet> MakeResponseCorpus() {
+  std::vector<HeaderSet> corpus;
+  for (size_t i = 0; i < 64; ++i) {
+    HeaderSet headers;
+    headers[":status"] = (i % 10 == 9) ? "304" : "200";
+    headers["content-type"] = (i % 3 == 0) ? "text/html; charset=utf-8"
+                                           : "application/javascript";
+    headers["content-length"] = base::SizeTToString(1024 + 37 * i);
+    headers["date"] = "Tue, 20 Jan 2015 18:32:" +
+                      base::SizeTToString(10 + i % 50) + " GMT";
+    headers["server"] = "gws";
+    headers["cache-control"] = "private, max-age=0";
+    headers["etag"] = "\"" + base::SizeTToString(0x5f3a9c0 + i) + "\"";
+    headers["vary"] = "Accept-Encoding";
+    headers["x-frame-options"] = "SAMEORIGIN";
+    if (i % 8 == 0) {
+      headers["set-cookie"] =
+          "id=" + base::SizeTToString(i) + "; Path=/; Secure; HttpOnly";
+    }
+    corpus.push_back(headers);
+  }
+  return corpus;
+}
+
+void BenchmarkEncoding(const char* name, const std::vector<HeaderSet>& corpus) {
+  HpackEncoder encoder(ObtainHpackHuffmanTable());
+  std::string output;
+  size_t total_bytes = 0;
+
+  base::PerfTimeLogger timer(name);
+  for (int i = 0; i < kIterations; ++i) {
+    output.clear();
+    ASSERT_TRUE(
+        encoder.EncodeHeaderSet(corpus[i % corpus.size()], &output));
+    total_bytes += output.size();
+  }
+  timer.Done();
+  EXPECT_LT(0u, total_bytes);
+}
+
+TEST(HpackEncoderPerfTest, EncodeRequestHeaders) {
+  BenchmarkEncoding("Hpack_encode_request_headers", MakeRequestCorpus());
+}
+
+TEST(HpackEncoderPerfTest, EncodeResponseHeaders) {
+  BenchmarkEncoding("Hpack_encode_response_headers", MakeResponseCorpus());
+}
+
+// Lookups against a full dynamic table, isolating the table indices from
+// string encoding.
+TEST(HpackEncoderPerfTest, HeaderTableLookups) {
+  HpackHeaderTable table;
+  std::vector<std::pair<std::string, std::string> > fields;
+  for (size_t i = 0; i < 256; ++i) {
+    fields.push_back(std::make_pair("x-header-" + base::SizeTToString(i % 32),
+                                    "value-" + base::SizeTToString(i)));
+  }
+  for (size_t i = 0; i < fields.size(); ++i) {
+    table.TryAddEntry(fields[i].first, fields[i].second);
+  }
+
+  size_t found = 0;
+  base::PerfTimeLogger timer("Hpack_header_table_lookups");
+  for (int i = 0; i < kIterations * 10; ++i) {
+    const std::pair<std::string, std::string>& field =
+        fields[i % fields.size()];
+    if (table.GetByNameAndValue(field.first, field.second) != NULL ||
+        table.GetByName(field.first) != NULL) {
+      ++found;
+    }
+  }
+  timer.Done();
+  EXPECT_LT(0u, found);
+}
+
+}  // namespace
+
+}  // namespace net
@@ -15,26 +15,17 @@ namespace net {
 
 using base::StringPiece;
 
-bool HpackHeaderTable::EntryComparator::operator() (
-    const HpackEntry* lhs, const HpackEntry* rhs) const {
-  int result = lhs->name().compare(rhs->name());
-  if (result != 0)
-    return result < 0;
-  result = lhs->value().compare(rhs->value());
-  if (result != 0)
-    return result < 0;
-  const size_t lhs_index = lhs->IsLookup() ? 0 : 1 + lhs->InsertionIndex();
-  const size_t rhs_index = rhs->IsLookup() ? 0 : 1 + rhs->InsertionIndex();
-  DCHECK(lhs == rhs || lhs_index != rhs_index)
-      << "lhs: (" << lhs->name() << ", " << rhs->value() << ") rhs: ("
-      << rhs->name() << ", " << rhs->value() << ")"
-      << " lhs index: " << lhs_index << " rhs index: " << rhs_index;
-  return lhs_index < rhs_index;
+size_t HpackHeaderTable::NameValueHasher::operator()(
+    const NameValuePair& name_value) const {
+  BASE_HASH_NAMESPACE::hash<StringPiece> string_piece_hasher;
+  return base::HashInts64(string_piece_hasher(name_value.first),
+                          string_piece_hasher(name_value.second));
 }
 
 HpackHeaderTable::HpackHeaderTable()
     : static_entries_(ObtainHpackStaticTable().GetStaticEntries()),
       static_index_(ObtainHpackStaticTable().GetStaticIndex()),
+      static_name_index_(ObtainHpackStaticTable().GetStaticNameIndex()),
       settings_size_bound_(kDefaultHeaderTableSizeSetting),
       size_(0),
       max_size_(kDefaultHeaderTableSizeSetting),
@@ -58,17 +49,16 @@ const HpackEntry* HpackHeaderTable::GetByIndex(size_t index) {
 }
 
 const HpackEntry* HpackHeaderTable::GetByName(StringPiece name) {
-  HpackEntry query(name, "");
   {
-    OrderedEntrySet::const_iterator it = static_index_.lower_bound(&query);
-    if (it != static_index_.end() && (*it)->name() == name) {
-      return *it;
+    NameToEntryMap::const_iterator it = static_name_index_.find(name);
+    if (it != static_name_index_.end()) {
+      return it->second;
     }
   }
   {
-    OrderedEntrySet::const_iterator it = dynamic_index_.lower_bound(&query);
-    if (it != dynamic_index_.end() && (*it)->name() == name) {
-      return *it;
+    NameToEntryMap::const_iterator it = dynamic_name_index_.find(name);
+    if (it != dynamic_name_index_.end()) {
+      return it->second;
     }
   }
   return NULL;
@@ -76,21 +66,17 @@ const HpackEntry* HpackHeaderTable::GetByName(StringPiece name) {
 
 const HpackEntry* HpackHeaderTable::GetByNameAndValue(StringPiece name,
                                                       StringPiece value) {
-  HpackEntry query(name, value);
+  NameValuePair query(name, value);
   {
-    OrderedEntrySet::const_iterator it = static_index_.lower_bound(&query);
-    if (it != static_index_.end() &&
-        (*it)->name() == name &&
-        (*it)->value() == value) {
-      return *it;
+    NameValueToEntryMap::const_iterator it = static_index_.find(query);
+    if (it != static_index_.end()) {
+      return it->second;
     }
   }
   {
-    OrderedEntrySet::const_iterator it = dynamic_index_.lower_bound(&query);
-    if (it != dynamic_index_.end() &&
-        (*it)->name() == name &&
-        (*it)->value() == value) {
-      return *it;
+    NameValueToEntryMap::const_iterator it = dynamic_index_.find(query);
+    if (it != dynamic_index_.end()) {
+      return it->second;
     }
   }
   return NULL;
@@ -159,7 +145,17 @@ void HpackHeaderTable::Evict(size_t count) {
     HpackEntry* entry = &dynamic_entries_.back();
 
     size_ -= entry->Size();
-    CHECK_EQ(1u, dynamic_index_.erase(entry));
+    // A more recent entry with the same name (or name & value) may have
+    // replaced this one in the indices, in which case it must stay there.
+    NameValueToEntryMap::iterator it =
+        dynamic_index_.find(NameValuePair(entry->name(), entry->value()));
+    if (it != dynamic_index_.end() && it->second == entry) {
+      dynamic_index_.erase(it);
+    }
+    NameToEntryMap::iterator name_it = dynamic_name_index_.find(entry->name());
+    if (name_it != dynamic_name_index_.end() && name_it->second == entry) {
+      dynamic_name_index_.erase(name_it);
+    }
     dynamic_entries_.pop_back();
   }
 }
@@ -179,12 +175,22 @@ const HpackEntry* HpackHeaderTable::TryAddEntry(StringPiece name,
                                          value,
                                          false,  // is_static
                                          total_insertions_));
-  CHECK(dynamic_index_.insert(&dynamic_entries_.front()).second);
+  const HpackEntry* new_entry = &dynamic_entries_.front();
+
+  // Replace any older entry with the same name (or name & value). Its key
+  // is erased rather than overwritten, as it references the older entry's
+  // strings, which may be evicted first.
+  NameValuePair key(new_entry->name(), new_entry->value());
+  dynamic_index_.erase(key);
+  CHECK(dynamic_index_.insert(std::make_pair(key, new_entry)).second);
+  dynamic_name_index_.erase(key.first);
+  CHECK(dynamic_name_index_.insert(std::make_pair(key.first, new_entry))
+            .second);
 
   size_ += entry_size;
   ++total_insertions_;
 
-  return &dynamic_entries_.front();
+  return new_entry;
 }
 
 void HpackHeaderTable::DebugLogTableState() const {
@@ -194,14 +200,14 @@ void HpackHeaderTable::DebugLogTableState() const {
     DVLOG(2) << "  " << it->GetDebugString();
   }
   DVLOG(2) << "Full Static Index:";
-  for (OrderedEntrySet::const_iterator it = static_index_.begin();
+  for (NameValueToEntryMap::const_iterator it = static_index_.begin();
       it != static_index_.end(); ++it) {
-    DVLOG(2) << "  " << (*it)->GetDebugString();
+    DVLOG(2) << "  " << it->second->GetDebugString();
   }
   DVLOG(2) << "Full Dynamic Index:";
-  for (OrderedEntrySet::const_iterator it = dynamic_index_.begin();
+  for (NameValueToEntryMap::const_iterator it = dynamic_index_.begin();
       it != dynamic_index_.end(); ++it) {
-    DVLOG(2) << "  " << (*it)->GetDebugString();
+    DVLOG(2) << "  " << it->second->GetDebugString();
   }
 }
 
@@ -7,9 +7,10 @@
 
 #include <cstddef>
 #include <deque>
-#include <set>
+#include <utility>
 
 #include "base/basictypes.h"
+#include "base/containers/hash_tables.h"
 #include "base/macros.h"
 #include "net/base/net_export.h"
 #include "net/spdy/hpack_entry.h"
@@ -37,15 +38,20 @@ class NET_EXPORT_PRIVATE HpackHeaderTable {
   // extended to map to list iterators.
   typedef std::deque<HpackEntry> EntryTable;
 
-  // Implements a total ordering of HpackEntry on name(), value(), then index
-  // ascending. Note that index may change over the lifetime of an HpackEntry,
-  // but the relative index order of two entries will not. This comparator is
-  // composed with the 'lookup' HpackEntry constructor to allow for efficient
-  // lower-bounding of matching entries.
-  struct NET_EXPORT_PRIVATE EntryComparator {
-    bool operator() (const HpackEntry* lhs, const HpackEntry* rhs) const;
+  // Key of the name & value index. Both pieces reference the name() and
+  // value() of the indexed entry, so that queries don't copy either string.
+  typedef std::pair<StringPiece, StringPiece> NameValuePair;
+
+  struct NET_EXPORT_PRIVATE NameValueHasher {
+    size_t operator()(const NameValuePair& name_value) const;
   };
-  typedef std::set<HpackEntry*, EntryComparator> OrderedEntrySet;
+
+  // Each index maps a key to a single entry. Where several entries share a
+  // key, the dynamic indices refer to the most recently inserted one (which
+  // has the lowest index) and the static indices to the first one.
+  typedef base::hash_map<NameValuePair, const HpackEntry*, NameValueHasher>
+      NameValueToEntryMap;
+  typedef base::hash_map<StringPiece, const HpackEntry*> NameToEntryMap;
 
   HpackHeaderTable();
 
@@ -62,7 +68,7 @@ class NET_EXPORT_PRIVATE HpackHeaderTable {
   // Returns the entry matching the index, or NULL.
   const HpackEntry* GetByIndex(size_t index);
 
-  // Returns the lowest-value entry having |name|, or NULL.
+  // Returns the lowest-index entry having |name|, or NULL.
   const HpackEntry* GetByName(StringPiece name);
 
   // Returns the lowest-index matching entry, or NULL.
@@ -105,13 +111,16 @@ class NET_EXPORT_PRIVATE HpackHeaderTable {
   // Evicts |count| oldest entries from the table.
   void Evict(size_t count);
 
-  // |static_entries_| and |static_index_| are owned by HpackStaticTable
-  // singleton.
+  // |static_entries_|, |static_index_| and |static_name_index_| are owned by
+  // HpackStaticTable singleton.
   const EntryTable& static_entries_;
   EntryTable dynamic_entries_;
 
-  const OrderedEntrySet& static_index_;
-  OrderedEntrySet dynamic_index_;
+  // Tracks the entries by name & value, and by name only.
+  const NameValueToEntryMap& static_index_;
+  const NameToEntryMap& static_name_index_;
+  NameValueToEntryMap dynamic_index_;
+  NameToEntryMap dynamic_name_index_;
 
   // Last acknowledged value for SETTINGS_HEADER_TABLE_SIZE.
   size_t settings_size_bound_;
@@ -5,7 +5,6 @@
 #include "net/spdy/hpack_header_table.h"
 
 #include <algorithm>
-#include <set>
 #include <string>
 #include <vector>
 
@@ -62,11 +61,6 @@ class HpackHeaderTablePeer {
     return table_->Evict(count);
   }
 
-  void AddDynamicEntry(StringPiece name, StringPiece value) {
-    table_->dynamic_entries_.push_back(
-        HpackEntry(name, value, false, table_->total_insertions_++));
-  }
-
  private:
   HpackHeaderTable* table_;
 };
@@ -131,11 +125,6 @@ class HpackHeaderTableTest : public ::testing::Test {
     }
   }
 
-  HpackEntry DynamicEntry(string name, string value) {
-    peer_.AddDynamicEntry(name, value);
-    return peer_.dynamic_entries().back();
-  }
-
   HpackHeaderTable table_;
   test::HpackHeaderTablePeer peer_;
 };
@@ -228,18 +217,17 @@ TEST_F(HpackHeaderTableTest, EntryIndexing) {
   EXPECT_EQ(entry1, table_.GetByIndex(68));
   EXPECT_EQ(first_static_entry, table_.GetByIndex(1));
 
-  // Querying by name returns the lowest-value matching entry.
-  EXPECT_EQ(entry3, table_.GetByName("key-1"));
+  // Querying by name returns the lowest-index matching entry.
+  EXPECT_EQ(entry5, table_.GetByName("key-1"));
   EXPECT_EQ(entry7, table_.GetByName("key-2"));
   EXPECT_EQ(entry2->name(),
             table_.GetByName(first_static_entry->name())->name());
   EXPECT_EQ(NULL, table_.GetByName("not-present"));
 
-  // Querying by name & value returns the lowest-index matching entry among
-  // static entries, and the highest-index one among dynamic entries.
+  // Querying by name & value returns the lowest-index matching entry.
   EXPECT_EQ(entry3, table_.GetByNameAndValue("key-1", "Value One"));
   EXPECT_EQ(entry5, table_.GetByNameAndValue("key-1", "Value Two"));
-  EXPECT_EQ(entry4, table_.GetByNameAndValue("key-2", "Value Three"));
+  EXPECT_EQ(entry6, table_.GetByNameAndValue("key-2", "Value Three"));
   EXPECT_EQ(entry7, table_.GetByNameAndValue("key-2", "Value Four"));
   EXPECT_EQ(first_static_entry,
             table_.GetByNameAndValue(first_static_entry->name(),
@@ -262,6 +250,17 @@ TEST_F(HpackHeaderTableTest, EntryIndexing) {
   peer_.Evict(1);
   EXPECT_EQ(NULL, table_.GetByNameAndValue(first_static_entry->name(),
                                            "Value Four"));
+
+  // Evict |entry3| and |entry4|. Their newer duplicates remain queryable.
+  peer_.Evict(2);
+  EXPECT_EQ(NULL, table_.GetByNameAndValue("key-1", "Value One"));
+  EXPECT_EQ(entry5, table_.GetByName("key-1"));
+  EXPECT_EQ(entry6, table_.GetByNameAndValue("key-2", "Value Three"));
+
+  // Evict |entry5|. No entry named "key-1" remains.
+  peer_.Evict(1);
+  EXPECT_EQ(NULL, table_.GetByName("key-1"));
+  EXPECT_EQ(entry7, table_.GetByName("key-2"));
 }
 
 TEST_F(HpackHeaderTableTest, SetSizes) {
@@ -408,41 +407,35 @@ TEST_F(HpackHeaderTableTest, TryAddTooLargeEntry) {
   EXPECT_EQ(0u, peer_.dynamic_entries().size());
 }
 
-TEST_F(HpackHeaderTableTest, ComparatorNameOrdering) {
-  HpackEntry entry1("header", "value");
-  HpackEntry entry2("HEADER", "value");
-
-  HpackHeaderTable::EntryComparator comparator;
-  EXPECT_FALSE(comparator(&entry1, &entry2));
-  EXPECT_TRUE(comparator(&entry2, &entry1));
-}
-
-TEST_F(HpackHeaderTableTest, ComparatorValueOrdering) {
-  HpackEntry entry1("header", "value");
-  HpackEntry entry2("header", "VALUE");
-
-  HpackHeaderTable::EntryComparator comparator;
-  EXPECT_FALSE(comparator(&entry1, &entry2));
-  EXPECT_TRUE(comparator(&entry2, &entry1));
+TEST_F(HpackHeaderTableTest, NameValueHasherDistinguishesFields) {
+  HpackHeaderTable::NameValueHasher hasher;
+  EXPECT_EQ(hasher(HpackHeaderTable::NameValuePair("name", "value")),
+            hasher(HpackHeaderTable::NameValuePair(string("name"),
+                                                   string("value"))));
+  EXPECT_NE(hasher(HpackHeaderTable::NameValuePair("name", "value")),
+            hasher(HpackHeaderTable::NameValuePair("value", "name")));
+  EXPECT_NE(hasher(HpackHeaderTable::NameValuePair("name", "value")),
+            hasher(HpackHeaderTable::NameValuePair("namev", "alue")));
 }
 
-TEST_F(HpackHeaderTableTest, ComparatorIndexOrdering) {
-  HpackHeaderTable::EntryComparator comparator;
-  HpackEntry entry1(DynamicEntry("name", "value"));
-  HpackEntry entry2(DynamicEntry("name", "value"));
-
-  // |entry1| has lower insertion index than |entry2|.
-  EXPECT_TRUE(comparator(&entry1, &entry2));
-  EXPECT_FALSE(comparator(&entry2, &entry1));
-}
+TEST_F(HpackHeaderTableTest, DuplicateEntriesShareIndexKeys) {
+  size_t static_count = peer_.static_entries().size();
+  const HpackEntry* entry1 = table_.TryAddEntry("key", "value");
+  const HpackEntry* entry2 = table_.TryAddEntry("key", "value");
+  EXPECT_NE(entry1, entry2);
+  EXPECT_EQ(static_count + 1, peer_.index_size());
+  EXPECT_EQ(entry2, table_.GetByNameAndValue("key", "value"));
+  EXPECT_EQ(entry2, table_.GetByName("key"));
 
-TEST_F(HpackHeaderTableTest, ComparatorEqualityOrdering) {
-  HpackEntry entry1("name", "value");
-  HpackEntry entry2(DynamicEntry("name", "value"));
+  // Evicting the older duplicate leaves the newer one indexed.
+  peer_.Evict(1);
+  EXPECT_EQ(entry2, table_.GetByNameAndValue("key", "value"));
+  EXPECT_EQ(entry2, table_.GetByName("key"));
 
-  HpackHeaderTable::EntryComparator comparator;
-  EXPECT_FALSE(comparator(&entry1, &entry1));
-  EXPECT_FALSE(comparator(&entry2, &entry2));
+  peer_.Evict(1);
+  EXPECT_EQ(static_count, peer_.index_size());
+  EXPECT_EQ(NULL, table_.GetByNameAndValue("key", "value"));
+  EXPECT_EQ(NULL, table_.GetByName("key"));
 }
 
 }  // namespace
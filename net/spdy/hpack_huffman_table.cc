@@ -5,7 +5,6 @@
 #include "net/spdy/hpack_huffman_table.h"
 
 #include <algorithm>
-#include <cmath>
 
 #include "base/logging.h"
 #include "net/spdy/hpack_input_stream.h"
@@ -217,7 +216,14 @@ bool HpackHuffmanTable::IsInitialized() const {
 
 void HpackHuffmanTable::EncodeString(StringPiece in,
                                      HpackOutputStream* out) const {
-  size_t bit_remnant = 0;
+  string encoded;
+  encoded.reserve(EncodedSize(in));
+
+  // Pending output, stored in the low |bit_buffer_length| bits of
+  // |bit_buffer|. Codes are at most 32 bits long, so flushing whenever 32 or
+  // more bits are pending keeps the buffer from overflowing.
+  uint64 bit_buffer = 0;
+  size_t bit_buffer_length = 0;
   for (size_t i = 0; i != in.size(); i++) {
     uint16 symbol_id = static_cast<uint8>(in[i]);
     CHECK_GT(code_by_id_.size(), symbol_id);
@@ -226,26 +232,30 @@ void HpackHuffmanTable::EncodeString(StringPiece in,
     unsigned length = length_by_id_[symbol_id];
     uint32 code = code_by_id_[symbol_id] >> (32 - length);
 
-    bit_remnant = (bit_remnant + length) % 8;
+    bit_buffer = (bit_buffer << length) | code;
+    bit_buffer_length += length;
 
-    if (length > 24) {
-      out->AppendBits(static_cast<uint8>(code >> 24), length - 24);
-      length = 24;
+    if (bit_buffer_length >= 32) {
+      bit_buffer_length -= 32;
+      uint32 word = static_cast<uint32>(bit_buffer >> bit_buffer_length);
+      encoded.push_back(static_cast<char>(word >> 24));
+      encoded.push_back(static_cast<char>(word >> 16));
+      encoded.push_back(static_cast<char>(word >> 8));
+      encoded.push_back(static_cast<char>(word));
     }
-    if (length > 16) {
-      out->AppendBits(static_cast<uint8>(code >> 16), length - 16);
-      length = 16;
-    }
-    if (length > 8) {
-      out->AppendBits(static_cast<uint8>(code >> 8), length - 8);
-      length = 8;
-    }
-    out->AppendBits(static_cast<uint8>(code), length);
   }
-  if (bit_remnant != 0) {
+  while (bit_buffer_length >= 8) {
+    bit_buffer_length -= 8;
+    encoded.push_back(static_cast<char>(bit_buffer >> bit_buffer_length));
+  }
+  if (bit_buffer_length != 0) {
     // Pad current byte as required.
-    out->AppendBits(pad_bits_ >> bit_remnant, 8 - bit_remnant);
+    uint8 remnant = static_cast<uint8>(bit_buffer << (8 - bit_buffer_length));
+    encoded.push_back(static_cast<char>(remnant |
+                                        (pad_bits_ >> bit_buffer_length)));
   }
+  DCHECK_EQ(EncodedSize(in), encoded.size());
+  out->AppendBytes(encoded);
 }
 
 size_t HpackHuffmanTable::EncodedSize(StringPiece in) const {
@@ -265,39 +275,52 @@ size_t HpackHuffmanTable::EncodedSize(StringPiece in) const {
 bool HpackHuffmanTable::DecodeString(HpackInputStream* in,
                                      size_t out_capacity,
                                      string* out) const {
-  // Number of decode iterations required for a 32-bit code.
-  const int kDecodeIterations = static_cast<int>(
-      std::ceil((32.f - kDecodeTableRootBits) / kDecodeTableBranchBits));
+  StringPiece input;
+  in->ConsumeRemainingBytes(&input);
+  return DecodeString(input, out_capacity, out);
+}
 
+bool HpackHuffmanTable::DecodeString(StringPiece in,
+                                     size_t out_capacity,
+                                     string* out) const {
   out->clear();
 
-  // Current input, stored in the high |bits_available| bits of |bits|.
-  uint32 bits = 0;
+  // Current input, stored in the high |bits_available| bits of |bits|. It is
+  // refilled an octet at a time, so that it always holds at least 56 bits
+  // (and thus a complete code) until the input runs out.
+  uint64 bits = 0;
   size_t bits_available = 0;
-  bool peeked_success = in->PeekBits(&bits_available, &bits);
+  size_t next_octet = 0;
 
   while (true) {
-    const DecodeTable* table = &decode_tables_[0];
-    uint32 index = bits >> (32 - kDecodeTableRootBits);
-
-    for (int i = 0; i != kDecodeIterations; i++) {
-      DCHECK_LT(index, table->size());
-      DCHECK_LT(Entry(*table, index).next_table_index, decode_tables_.size());
+    while (bits_available <= 56 && next_octet != in.size()) {
+      bits |= static_cast<uint64>(static_cast<uint8>(in[next_octet++]))
+              << (56 - bits_available);
+      bits_available += 8;
+    }
+    const uint32 peeked = static_cast<uint32>(bits >> 32);
 
-      table = &decode_tables_[Entry(*table, index).next_table_index];
+    // Walk the decode tables until reaching a terminal or empty entry. Most
+    // codes are resolved by the root table alone.
+    uint8 table_index = 0;
+    const DecodeTable* table = &decode_tables_[0];
+    const DecodeEntry* entry =
+        &Entry(*table, peeked >> (32 - kDecodeTableRootBits));
+    while (entry->length != 0 && entry->next_table_index != table_index) {
+      DCHECK_LT(entry->next_table_index, decode_tables_.size());
+      table_index = entry->next_table_index;
+      table = &decode_tables_[table_index];
       // Mask and shift the portion of the code being indexed into low bits.
-      index = (bits << table->prefix_length) >> (32 - table->indexed_length);
+      entry = &Entry(*table, (peeked << table->prefix_length) >>
+                                 (32 - table->indexed_length));
     }
-    const DecodeEntry& entry = Entry(*table, index);
-
-    if (entry.length > bits_available) {
-      if (!peeked_success) {
-        // Unable to read enough input for a match. If only a portion of
-        // the last byte remains, this is a successful EOF condition.
-        in->ConsumeByteRemainder();
-        return !in->HasMoreData();
-      }
-    } else if (entry.length == 0) {
+
+    if (entry->length > bits_available) {
+      // Unable to read enough input for a match. If only a portion of
+      // the last byte remains, this is a successful EOF condition.
+      DCHECK_EQ(in.size(), next_octet);
+      return bits_available < 8;
+    } else if (entry->length == 0) {
       // The input is an invalid prefix, larger than any prefix in the table.
       return false;
     } else {
@@ -305,16 +328,14 @@ bool HpackHuffmanTable::DecodeString(HpackInputStream* in,
         // This code would cause us to overflow |out_capacity|.
         return false;
       }
-      if (entry.symbol_id < 256) {
+      if (entry->symbol_id < 256) {
         // Assume symbols >= 256 are used for padding.
-        out->push_back(static_cast<char>(entry.symbol_id));
+        out->push_back(static_cast<char>(entry->symbol_id));
       }
 
-      in->ConsumeBits(entry.length);
-      bits = bits << entry.length;
-      bits_available -= entry.length;
+      bits = bits << entry->length;
+      bits_available -= entry->length;
     }
-    peeked_success = in->PeekBits(&bits_available, &bits);
   }
   NOTREACHED();
   return false;
@@ -74,7 +74,8 @@ class NET_EXPORT_PRIVATE HpackHuffmanTable {
   bool IsInitialized() const;
 
   // Encodes the input string to the output stream using the table's Huffman
-  // context.
+  // context. |out| must end on a byte boundary, which is the case after any
+  // HpackOutputStream::AppendUint32() call.
   void EncodeString(base::StringPiece in, HpackOutputStream* out) const;
 
   // Returns the encoded size of the input string.
@@ -89,6 +90,12 @@ class NET_EXPORT_PRIVATE HpackHuffmanTable {
                     size_t out_capacity,
                     std::string* out) const;
 
+  // As above, but decodes the whole octets of |in| directly. Used by
+  // HpackInputStream, as Huffman-encoded literals are always whole octets.
+  bool DecodeString(base::StringPiece in,
+                    size_t out_capacity,
+                    std::string* out) const;
+
  private:
   // Expects symbols ordered on length & ID ascending.
   void BuildDecodeTables(const std::vector<Symbol>& symbols);
@@ -0,0 +1,107 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/hpack_huffman_table.h"
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "net/spdy/hpack_constants.h"
+#include "net/spdy/hpack_output_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace net {
+
+namespace {
+
+const int kIterations = 2000;
+
+// Header names and values typical of requests and responses. Huffman coding
+// is applied to each literal separately, so they're kept apart.
+const char* const kCorpus[] = {
+    "www.example.com",
+    "/api/v1/items?page=2&sort=recent&filter=unread",
+    "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8",
+    "gzip, deflate, sdch",
+    "en-US,en;q=0.8",
+    "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+    "Chrome/40.0.2214.85 Safari/537.36",
+    "session=a8f3b2c1d4e5; prefs=lang%3Den; _ga=GA1.2.1234567890.1400000000",
+    "private, max-age=0",
+    "Tue, 20 Jan 2015 18:32:10 GMT",
+    "application/javascript; charset=utf-8",
+    "\"5f3a9c0-1b2\"",
+    "id=a3fWa; Expires=Wed, 21 Oct 2015 07:28:00 GMT; Path=/; Secure",
+};
+
+class HpackHuffmanTablePerfTest : public ::testing::Test {
+ protected:
+  HpackHuffmanTablePerfTest()
+      : table_(ObtainHpackHuffmanTable()), corpus_size_(0) {}
+
+  void SetUp() override {
+    for (size_t i = 0; i < arraysize(kCorpus); ++i) {
+      literals_.push_back(kCorpus[i]);
+      corpus_size_ += literals_.back().size();
+
+      HpackOutputStream output_stream;
+      table_.EncodeString(literals_.back(), &output_stream);
+      std::string encoded;
+      output_stream.TakeString(&encoded);
+      encoded_literals_.push_back(encoded);
+    }
+  }
+
+  // Reports the throughput of |elapsed| over |kIterations| passes of the
+  // plain-text corpus.
+  void PrintThroughput(const std::string& trace, base::TimeDelta elapsed) {
+    double megabytes =
+        static_cast<double>(corpus_size_) * kIterations / (1024 * 1024);
+    perf_test::PrintResult("hpack_huffman", "", trace,
+                           megabytes / elapsed.InSecondsF(), "MB/s", true);
+  }
+
+  const HpackHuffmanTable& table_;
+  std::vector<std::string> literals_;
+  std::vector<std::string> encoded_literals_;
+  size_t corpus_size_;
+};
+
+TEST_F(HpackHuffmanTablePerfTest, Encode) {
+  size_t encoded_size = 0;
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < literals_.size(); ++j) {
+      HpackOutputStream output_stream;
+      table_.EncodeString(literals_[j], &output_stream);
+      std::string encoded;
+      output_stream.TakeString(&encoded);
+      encoded_size += encoded.size();
+    }
+  }
+  PrintThroughput("encode", base::TimeTicks::Now() - start);
+  EXPECT_LT(0u, encoded_size);
+}
+
+TEST_F(HpackHuffmanTablePerfTest, Decode) {
+  std::string decoded;
+  size_t decoded_size = 0;
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < encoded_literals_.size(); ++j) {
+      ASSERT_TRUE(table_.DecodeString(encoded_literals_[j],
+                                      literals_[j].size(), &decoded));
+      decoded_size += decoded.size();
+    }
+  }
+  PrintThroughput("decode", base::TimeTicks::Now() - start);
+  EXPECT_EQ(corpus_size_ * kIterations, decoded_size);
+}
+
+}  // namespace
+
+}  // namespace net
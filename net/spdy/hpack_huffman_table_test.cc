@@ -487,6 +487,38 @@ TEST_F(HpackHuffmanTableTest, RoundTripSymbolSequence) {
   EXPECT_EQ(input, buffer_out);
 }
 
+TEST_F(HpackHuffmanTableTest, RoundTripEachInputLength) {
+  std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
+  EXPECT_TRUE(table_.Initialize(&code[0], code.size()));
+
+  // Mixes short and long codes, so that encoded symbols straddle the
+  // encoder's flushed words and the decoder's refilled octets at every
+  // alignment.
+  string input;
+  for (size_t i = 0; i != 80; i++) {
+    string buffer_in = EncodeString(input);
+    string buffer_out;
+
+    EXPECT_TRUE(table_.DecodeString(buffer_in, input.size(), &buffer_out));
+    EXPECT_EQ(input, buffer_out);
+
+    input.push_back(static_cast<char>((i * 37) % 256));
+  }
+}
+
+TEST_F(HpackHuffmanTableTest, EncodeAfterPrefix) {
+  std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
+  EXPECT_TRUE(table_.Initialize(&code[0], code.size()));
+
+  HpackOutputStream output_stream;
+  output_stream.AppendPrefix(kStringLiteralHuffmanEncoded);
+  output_stream.AppendUint32(12);
+  table_.EncodeString("www.example.com", &output_stream);
+  string encoding;
+  output_stream.TakeString(&encoding);
+  EXPECT_EQ(a2b_hex("8cf1e3c2e5f23a6ba0ab90f4ff"), encoding);
+}
+
 TEST_F(HpackHuffmanTableTest, EncodedSizeAgreesWithEncodeString) {
   std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
   EXPECT_TRUE(table_.Initialize(&code[0], code.size()));
@@ -57,6 +57,10 @@ class NET_EXPORT_PRIVATE HpackInputStream {
   // remaining bits in the current byte.
   void ConsumeByteRemainder();
 
+  // Consumes all remaining input, which must begin on a byte boundary,
+  // returning it via |out|.
+  void ConsumeRemainingBytes(base::StringPiece* out);
+
   // Accessors for testing.
 
   void SetBitOffsetForTest(size_t bit_offset) {
@@ -4,6 +4,8 @@
 
 #include "net/spdy/hpack_static_table.h"
 
+#include <utility>
+
 #include "base/logging.h"
 #include "net/spdy/hpack_constants.h"
 #include "net/spdy/hpack_entry.h"
@@ -25,7 +27,13 @@ void HpackStaticTable::Initialize(const HpackStaticEntry* static_entry_table,
                                          StringPiece(it->value, it->value_len),
                                          true,  // is_static
                                          total_insertions));
-    CHECK(static_index_.insert(&static_entries_.back()).second);
+    const HpackEntry* entry = &static_entries_.back();
+    CHECK(static_index_.insert(std::make_pair(
+        HpackHeaderTable::NameValuePair(entry->name(), entry->value()),
+        entry)).second);
+    // Several static entries share a name; the first one is indexed.
+    static_name_index_.insert(
+        std::make_pair(StringPiece(entry->name()), entry));
 
     ++total_insertions;
   }
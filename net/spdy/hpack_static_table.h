@@ -11,7 +11,8 @@ namespace net {
 
 struct HpackStaticEntry;
 
-// HpackStaticTable provides |static_entries_| and |static_index_| for HPACK
+// HpackStaticTable provides |static_entries_|, |static_index_| and
+// |static_name_index_| for HPACK
 // encoding and decoding contexts.  Once initialized, an instance is read only
 // and may be accessed only through its const interface.  Such an instance may
 // be shared accross multiple HPACK contexts.
@@ -20,8 +21,9 @@ class NET_EXPORT_PRIVATE HpackStaticTable {
   HpackStaticTable();
   ~HpackStaticTable();
 
-  // Prepares HpackStaticTable by filling up static_entries_ and static_index_
-  // from an array of struct HpackStaticEntry.  Must be called exactly once.
+  // Prepares HpackStaticTable by filling up static_entries_, static_index_ and
+  // static_name_index_ from an array of struct HpackStaticEntry.  Must be
+  // called exactly once.
   void Initialize(const HpackStaticEntry* static_entry_table,
                   size_t static_entry_count);
 
@@ -32,13 +34,17 @@ class NET_EXPORT_PRIVATE HpackStaticTable {
   const HpackHeaderTable::EntryTable& GetStaticEntries() const {
     return static_entries_;
   }
-  const HpackHeaderTable::OrderedEntrySet& GetStaticIndex() const {
+  const HpackHeaderTable::NameValueToEntryMap& GetStaticIndex() const {
     return static_index_;
   }
+  const HpackHeaderTable::NameToEntryMap& GetStaticNameIndex() const {
+    return static_name_index_;
+  }
 
  private:
   HpackHeaderTable::EntryTable static_entries_;
-  HpackHeaderTable::OrderedEntrySet static_index_;
+  HpackHeaderTable::NameValueToEntryMap static_index_;
+  HpackHeaderTable::NameToEntryMap static_name_index_;
 };
 
 }  // namespace net
@@ -33,8 +33,18 @@ TEST_F(HpackStaticTableTest, Initialize) {
   HpackHeaderTable::EntryTable static_entries = table_.GetStaticEntries();
   EXPECT_EQ(static_table.size(), static_entries.size());
 
-  HpackHeaderTable::OrderedEntrySet static_index = table_.GetStaticIndex();
+  HpackHeaderTable::NameValueToEntryMap static_index = table_.GetStaticIndex();
   EXPECT_EQ(static_table.size(), static_index.size());
+
+  // Names repeat in the static table, so the name index is smaller.
+  HpackHeaderTable::NameToEntryMap static_name_index =
+      table_.GetStaticNameIndex();
+  EXPECT_LT(static_name_index.size(), static_table.size());
+  for (HpackHeaderTable::NameToEntryMap::const_iterator it =
+           static_name_index.begin();
+       it != static_name_index.end(); ++it) {
+    EXPECT_EQ(it->first, it->second->name());
+  }
 }
 
 // Test that ObtainHpackStaticTable returns the same instance every time.
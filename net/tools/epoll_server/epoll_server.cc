@@ -4,9 +4,10 @@
 
 #include "net/tools/epoll_server/epoll_server.h"
 
-#include <unistd.h>  // For read, pipe, close and write.
+#include <unistd.h>  // For read, close and write.
 #include <stdlib.h>  // for abort
 #include <errno.h>    // for errno and strerror_r
+#include <sys/eventfd.h>
 #include <algorithm>
 #include <utility>
 #include <vector>
@@ -57,17 +58,14 @@ static const int kErrorBufferSize = 256;
 
 namespace net {
 
-// Clears the pipe and returns.  Used for waking the epoll server up.
-class ReadPipeCallback : public EpollCallbackInterface {
+// Clears the eventfd and returns.  Used for waking the epoll server up.
+class ReadWakeFDCallback : public EpollCallbackInterface {
  public:
   void OnEvent(int fd, EpollEvent* event) override {
     DCHECK(event->in_events == EPOLLIN);
-    int data;
-    int data_read = 1;
-    // Read until the pipe is empty.
-    while (data_read > 0) {
-      data_read = read(fd, &data, sizeof(data));
-    }
+    // A single read resets the counter, however many writes there were.
+    eventfd_t value;
+    eventfd_read(fd, &value);
   }
   void OnShutdown(EpollServer* eps, int fd) override {}
   void OnRegistration(EpollServer*, int, int) override {}
@@ -83,9 +81,8 @@ EpollServer::EpollServer()
     timeout_in_us_(0),
     recorded_now_in_us_(0),
     ready_list_size_(0),
-    wake_cb_(new ReadPipeCallback),
-    read_fd_(-1),
-    write_fd_(-1),
+    wake_cb_(new ReadWakeFDCallback),
+    wake_fd_(-1),
     in_wait_for_events_and_execute_callbacks_(false),
     in_shutdown_(false) {
   // ensure that the epoll_fd_ is valid.
@@ -93,8 +90,8 @@ EpollServer::EpollServer()
   LIST_INIT(&ready_list_);
   LIST_INIT(&tmp_list_);
 
-  int pipe_fds[2];
-  if (pipe(pipe_fds) < 0) {
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wake_fd_ < 0) {
     // Unfortunately, it is impossible to test any such initialization in
     // a constructor (as virtual methods do not yet work).
     // This -could- be solved by moving initialization to an outside
@@ -102,11 +99,10 @@ EpollServer::EpollServer()
     int saved_errno = errno;
     char buf[kErrorBufferSize];
     LOG(FATAL) << "Error " << saved_errno
-               << " in pipe(): " << strerror_r(saved_errno, buf, sizeof(buf));
+               << " in eventfd(): "
+               << strerror_r(saved_errno, buf, sizeof(buf));
   }
-  read_fd_ = pipe_fds[0];
-  write_fd_ = pipe_fds[1];
-  RegisterFD(read_fd_, wake_cb_.get(), EPOLLIN);
+  RegisterFD(wake_fd_, wake_cb_.get(), EPOLLIN);
 }
 
 void EpollServer::CleanupFDToCBMap() {
@@ -157,8 +153,7 @@ EpollServer::~EpollServer() {
 
   CleanupTimeToAlarmCBMap();
 
-  close(read_fd_);
-  close(write_fd_);
+  close(wake_fd_);
   close(epoll_fd_);
 }
 
@@ -368,6 +363,7 @@ void EpollServer::WaitForEventsAndExecuteCallbacks() {
     WaitForEventsAndCallHandleEvents(timeout_in_us_,
                                      events_,
                                      events_size_);
+    RunPostedTasks();
     recorded_now_in_us_ = 0;
     return;
   }
@@ -406,6 +402,7 @@ void EpollServer::WaitForEventsAndExecuteCallbacks() {
                                    events_,
                                    events_size_);
   CallAndReregisterAlarmEvents();
+  RunPostedTasks();
   recorded_now_in_us_ = 0;
 }
 
@@ -482,14 +479,35 @@ void EpollServer::UnregisterAlarm(const AlarmRegToken& iterator_token) {
 
 int EpollServer::NumFDsRegistered() const {
   DCHECK_GE(cb_map_.size(), 1u);
-  // Omit the internal FD (read_fd_)
+  // Omit the internal FD (wake_fd_)
   return cb_map_.size() - 1;
 }
 
 void EpollServer::Wake() {
-  char data = 'd';  // 'd' is for data.  It's good enough for me.
-  int rv = write(write_fd_, &data, 1);
-  DCHECK_EQ(rv, 1);
+  int rv = eventfd_write(wake_fd_, 1);
+  DCHECK_EQ(rv, 0);
+}
+
+void EpollServer::PostTask(const base::Closure& task) {
+  {
+    base::AutoLock lock(posted_tasks_lock_);
+    posted_tasks_.push_back(task);
+  }
+  // Tasks queued after RunPostedTasks() takes the queue are covered by this
+  // wake, as it comes after the task is queued.
+  Wake();
+}
+
+void EpollServer::RunPostedTasks() {
+  std::vector<base::Closure> tasks;
+  {
+    base::AutoLock lock(posted_tasks_lock_);
+    if (posted_tasks_.empty())
+      return;
+    tasks.swap(posted_tasks_);
+  }
+  for (size_t i = 0; i < tasks.size(); ++i)
+    tasks[i].Run();
 }
 
 int64 EpollServer::NowInUsec() const {
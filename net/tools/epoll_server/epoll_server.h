@@ -33,16 +33,18 @@
 #endif
 
 #include "base/basictypes.h"
+#include "base/callback.h"
 #include "base/compiler_specific.h"
 #include "base/containers/hash_tables.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/synchronization/lock.h"
 #include <sys/epoll.h>
 
 namespace net {
 
 class EpollServer;
 class EpollAlarmCallbackInterface;
-class ReadPipeCallback;
+class ReadWakeFDCallback;
 
 struct EpollEvent {
   EpollEvent(int events, bool is_epoll_wait)
@@ -403,13 +405,25 @@ class EpollServer {
   // Summary:
   //   returns the number of file-descriptors registered in this EpollServer.
   // Returns:
-  //   number of FDs registered (discounting the internal pipe used for Wake)
+  //   number of FDs registered (discounting the internal eventfd used for
+  //   Wake)
   virtual int NumFDsRegistered() const;
 
   // Summary:
-  //   Force the epoll server to wake up (by writing to an internal pipe).
+  //   Force the epoll server to wake up (by writing to an internal eventfd).
+  //   May be called from any thread.
   virtual void Wake();
 
+  // Summary:
+  //   Queues 'task' to be run by the thread running this epoll server, at the
+  //   end of its current or next WaitForEventsAndExecuteCallbacks(), and wakes
+  //   the server. Unlike the other methods, this may be called from any
+  //   thread; it is how other threads hand work, such as registering a newly
+  //   accepted fd, to the server.
+  // Args:
+  //   task - the task to run. Tasks run in the order they were posted.
+  void PostTask(const base::Closure& task);
+
   // Summary:
   //   Wrapper around WallTimer's NowInUsec.  We do this so that we can test
   //   EpollServer without using the system clock (and can avoid the flakiness
@@ -947,15 +961,21 @@ class EpollServer {
   void CleanupFDToCBMap();
   void CleanupTimeToAlarmCBMap();
 
-  // The callback registered to the fds below.  As the purpose of their
-  // registration is to wake the epoll server it just clears the pipe and
+  // Runs the tasks queued by PostTask().
+  void RunPostedTasks();
+
+  // The callback registered to the fd below.  As the purpose of its
+  // registration is to wake the epoll server it just clears the eventfd and
   // returns.
-  scoped_ptr<ReadPipeCallback> wake_cb_;
+  scoped_ptr<ReadWakeFDCallback> wake_cb_;
+
+  // An eventfd owned by the epoll server.  The server will be registered to
+  // listen on it and can be woken by Wake() which writes to it.
+  int wake_fd_;
 
-  // A pipe owned by the epoll server.  The server will be registered to listen
-  // on read_fd_ and can be woken by Wake() which writes to write_fd_.
-  int read_fd_;
-  int write_fd_;
+  // Tasks queued by PostTask(), possibly from other threads.
+  base::Lock posted_tasks_lock_;
+  std::vector<base::Closure> posted_tasks_;
 
   // This boolean is checked to see if it is false at the top of the
   // WaitForEventsAndExecuteCallbacks function. If not, then it either returns
@@ -0,0 +1,83 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/epoll_server/epoll_server_pool.h"
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/sys_info.h"
+#include "base/threading/simple_thread.h"
+#include "net/tools/epoll_server/epoll_server.h"
+
+namespace net {
+
+// Runs the event loop of one server until a quit task posted to it runs.
+class EpollServerPool::LoopThread : public base::SimpleThread {
+ public:
+  LoopThread(EpollServer* server, size_t index)
+      : base::SimpleThread("EpollServer" + base::SizeTToString(index)),
+        server_(server),
+        quit_(false) {}
+
+  ~LoopThread() override {}
+
+  void Run() override {
+    // With no timeout the loop only wakes up for events, alarms and posted
+    // tasks.
+    server_->set_timeout_in_us(-1);
+    while (!quit_)
+      server_->WaitForEventsAndExecuteCallbacks();
+  }
+
+  // Called from another thread.
+  void PostQuit() {
+    server_->PostTask(base::Bind(&LoopThread::Quit, base::Unretained(this)));
+  }
+
+ private:
+  // Runs on the loop thread, so |quit_| needs no locking.
+  void Quit() { quit_ = true; }
+
+  EpollServer* const server_;
+  bool quit_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoopThread);
+};
+
+EpollServerPool::EpollServerPool(int num_servers) : next_server_(0) {
+  DCHECK_GE(num_servers, 0);
+  if (num_servers == 0)
+    num_servers = base::SysInfo::NumberOfProcessors();
+  for (int i = 0; i < num_servers; ++i)
+    servers_.push_back(new EpollServer);
+}
+
+EpollServerPool::~EpollServerPool() {
+  Stop();
+}
+
+void EpollServerPool::Start() {
+  DCHECK(threads_.empty());
+  for (size_t i = 0; i < servers_.size(); ++i) {
+    threads_.push_back(new LoopThread(servers_[i], i));
+    threads_.back()->Start();
+  }
+}
+
+void EpollServerPool::Stop() {
+  for (size_t i = 0; i < threads_.size(); ++i)
+    threads_[i]->PostQuit();
+  for (size_t i = 0; i < threads_.size(); ++i)
+    threads_[i]->Join();
+  threads_.clear();
+}
+
+EpollServer* EpollServerPool::NextServer() {
+  EpollServer* server = servers_[next_server_];
+  next_server_ = (next_server_ + 1) % servers_.size();
+  return server;
+}
+
+}  // namespace net
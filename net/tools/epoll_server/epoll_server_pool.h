@@ -0,0 +1,62 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_EPOLL_SERVER_EPOLL_SERVER_POOL_H_
+#define NET_TOOLS_EPOLL_SERVER_EPOLL_SERVER_POOL_H_
+
+#include <stddef.h>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_vector.h"
+
+namespace net {
+
+class EpollServer;
+
+// A fixed set of EpollServers, each running its own event loop on its own
+// thread, so that a server can spread its connections over all cores instead
+// of serving them all from one loop.
+//
+// An EpollServer is not thread-safe: once the pool is started, fds and alarms
+// may only be registered with a server from its own thread. Other threads,
+// such as an acceptor, hand work to a server with EpollServer::PostTask(),
+// e.g. to register a newly accepted connection with NextServer().
+class EpollServerPool {
+ public:
+  // Creates |num_servers| servers, or one per processor if |num_servers| is 0.
+  explicit EpollServerPool(int num_servers);
+
+  // Stops the pool if it is still running.
+  ~EpollServerPool();
+
+  // Starts one thread per server, each running its server's event loop until
+  // Stop() is called.
+  void Start();
+
+  // Asks every event loop to exit once it has run the tasks already posted to
+  // it, and joins the threads. The servers and whatever is registered with
+  // them outlive Stop(), and may be used again from the calling thread.
+  void Stop();
+
+  size_t size() const { return servers_.size(); }
+
+  EpollServer* server(size_t index) { return servers_[index]; }
+
+  // Returns the servers in turn, to spread new connections evenly over them.
+  // Must only be called from one thread at a time.
+  EpollServer* NextServer();
+
+ private:
+  class LoopThread;
+
+  ScopedVector<EpollServer> servers_;
+  ScopedVector<LoopThread> threads_;
+  size_t next_server_;
+
+  DISALLOW_COPY_AND_ASSIGN(EpollServerPool);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_EPOLL_SERVER_EPOLL_SERVER_POOL_H_
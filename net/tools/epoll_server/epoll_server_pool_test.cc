@@ -0,0 +1,100 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/epoll_server/epoll_server_pool.h"
+
+#include <set>
+
+#include "base/bind.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/platform_thread.h"
+#include "net/tools/epoll_server/epoll_server.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+
+namespace {
+
+// Records the thread each task runs on, and signals |done| after
+// |expected_tasks| tasks have run.
+class TaskRecorder {
+ public:
+  explicit TaskRecorder(int expected_tasks)
+      : remaining_(expected_tasks), done_(false, false) {}
+
+  void RecordTask() {
+    base::AutoLock lock(lock_);
+    thread_ids_.insert(base::PlatformThread::CurrentId());
+    if (--remaining_ == 0)
+      done_.Signal();
+  }
+
+  void Wait() { done_.Wait(); }
+
+  size_t num_threads() {
+    base::AutoLock lock(lock_);
+    return thread_ids_.size();
+  }
+
+ private:
+  base::Lock lock_;
+  int remaining_;
+  std::set<base::PlatformThreadId> thread_ids_;
+  base::WaitableEvent done_;
+};
+
+TEST(EpollServerPoolTest, DefaultsToOneServerPerProcessor) {
+  EpollServerPool pool(0);
+  EXPECT_LT(0u, pool.size());
+}
+
+TEST(EpollServerPoolTest, NextServerRoundRobins) {
+  EpollServerPool pool(3);
+  ASSERT_EQ(3u, pool.size());
+  EXPECT_EQ(pool.server(0), pool.NextServer());
+  EXPECT_EQ(pool.server(1), pool.NextServer());
+  EXPECT_EQ(pool.server(2), pool.NextServer());
+  EXPECT_EQ(pool.server(0), pool.NextServer());
+}
+
+TEST(EpollServerPoolTest, PostedTasksRunOnServerThreads) {
+  const int kTasksPerServer = 10;
+  EpollServerPool pool(2);
+  TaskRecorder recorder(kTasksPerServer * pool.size());
+  pool.Start();
+  for (size_t i = 0; i < kTasksPerServer * pool.size(); ++i) {
+    pool.NextServer()->PostTask(
+        base::Bind(&TaskRecorder::RecordTask, base::Unretained(&recorder)));
+  }
+  recorder.Wait();
+  pool.Stop();
+
+  // Each server ran its tasks on its own thread.
+  EXPECT_EQ(pool.size(), recorder.num_threads());
+}
+
+TEST(EpollServerPoolTest, PostedTasksRunWithoutPool) {
+  EpollServer server;
+  TaskRecorder recorder(1);
+  server.PostTask(
+      base::Bind(&TaskRecorder::RecordTask, base::Unretained(&recorder)));
+  server.set_timeout_in_us(0);
+  server.WaitForEventsAndExecuteCallbacks();
+  recorder.Wait();
+  EXPECT_EQ(1u, recorder.num_threads());
+}
+
+TEST(EpollServerPoolTest, StopIsIdempotent) {
+  EpollServerPool pool(2);
+  pool.Start();
+  pool.Stop();
+  pool.Stop();
+}
+
+}  // namespace
+
+}  // namespace test
+}  // namespace net
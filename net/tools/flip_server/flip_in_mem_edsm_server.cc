@@ -12,6 +12,8 @@
 #include <vector>
 
 #include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
 #include "base/logging.h"
 #include "base/synchronization/lock.h"
 #include "net/tools/balsa/split.h"
@@ -102,6 +104,27 @@ void SignalHandler(int signum) {
   }
 }
 
+// Fills |memory_cache| from the current directory, or from the cache image at
+// |image_path| if it is not empty. The image is built first if no flip server
+// has built it yet.
+static void LoadMemoryCache(net::MemoryCache* memory_cache,
+                            const std::string& image_path) {
+  if (image_path.empty()) {
+    memory_cache->AddFiles();
+    return;
+  }
+  base::FilePath path(image_path);
+  if (!base::PathExists(path)) {
+    memory_cache->AddFiles();
+    if (!memory_cache->WriteImage(path))
+      return;
+  }
+  if (!memory_cache->LoadImage(path)) {
+    LOG(ERROR) << "Falling back to reading the cache from disk.";
+    memory_cache->AddFiles();
+  }
+}
+
 static int OpenPidFile(const char* pidfile) {
   int fd;
   struct stat pid_stat;
@@ -188,6 +211,12 @@ int main(int argc, char** argv) {
         "\t  * Leaving the ssl cert and key fields empty will disable ssl"
         " for the\n"
         "\t    http and spdy flip servers\n"
+        "\t--cache-image=<filepath>\n"
+        "\t  * Serve the http and spdy flip servers from a read-only cache"
+        " image,\n"
+        "\t    shared by every flip server using the same file. The image"
+        " is built\n"
+        "\t    from the current directory if it does not exist.\n"
         "\n  Global options:\n"
         "\t--logdest=<file|system|both>\n"
         "\t--logfile=<logfile>\n"
@@ -325,9 +354,13 @@ int main(int argc, char** argv) {
   }
 
   // Spdy Server Acceptor
+  std::string cache_image;
+  if (cl.HasSwitch("cache-image"))
+    cache_image = cl.GetSwitchValueASCII("cache-image");
+
   net::MemoryCache spdy_memory_cache;
   if (cl.HasSwitch("spdy-server")) {
-    spdy_memory_cache.AddFiles();
+    LoadMemoryCache(&spdy_memory_cache, cache_image);
     std::string value = cl.GetSwitchValueASCII("spdy-server");
     std::vector<std::string> valueArgs = split(value, ',');
     while (valueArgs.size() < 4)
@@ -353,7 +386,7 @@ int main(int argc, char** argv) {
   // Spdy Server Acceptor
   net::MemoryCache http_memory_cache;
   if (cl.HasSwitch("http-server")) {
-    http_memory_cache.AddFiles();
+    LoadMemoryCache(&http_memory_cache, cache_image);
     std::string value = cl.GetSwitchValueASCII("http-server");
     std::vector<std::string> valueArgs = split(value, ',');
     while (valueArgs.size() < 4)
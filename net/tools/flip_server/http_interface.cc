@@ -293,6 +293,33 @@ void HttpSM::SendDataFrameImpl(uint32 stream_id,
   EnqueueDataFrame(df);
 }
 
+void HttpSM::SendCachedDataFrame(uint32 stream_id,
+                                 const char* data,
+                                 int64 len) {
+  char chunk_buf[128];
+  int chunk_description_size =
+      snprintf(chunk_buf, sizeof(chunk_buf), "%x\r\n", (unsigned int)len);
+  DataFrame* df = new DataFrame;
+  df->size = chunk_description_size;
+  char* buffer = new char[df->size];
+  df->data = buffer;
+  df->delete_when_done = true;
+  memcpy(buffer, chunk_buf, df->size);
+  EnqueueDataFrame(df);
+
+  df = new DataFrame;
+  df->data = data;
+  df->size = len;
+  df->delete_when_done = false;
+  EnqueueDataFrame(df);
+
+  df = new DataFrame;
+  df->data = "\r\n";
+  df->size = 2;
+  df->delete_when_done = false;
+  EnqueueDataFrame(df);
+}
+
 void HttpSM::EnqueueDataFrame(DataFrame* df) {
   VLOG(2) << ACCEPTOR_CLIENT_IDENT << "HttpSM: Enqueue data frame: stream "
           << stream_id_;
@@ -326,12 +353,10 @@ void HttpSM::GetOutput() {
   if (num_to_write > mci->max_segment_size)
     num_to_write = mci->max_segment_size;
 
-  SendDataFrame(mci->stream_id,
-                mci->file_data->body().data() + mci->body_bytes_consumed,
-                num_to_write,
-                0,
-                true);
-  VLOG(2) << ACCEPTOR_CLIENT_IDENT << "HttpSM: GetOutput SendDataFrame["
+  SendCachedDataFrame(mci->stream_id,
+                      mci->file_data->body().data() + mci->body_bytes_consumed,
+                      num_to_write);
+  VLOG(2) << ACCEPTOR_CLIENT_IDENT << "HttpSM: GetOutput SendCachedDataFrame["
           << mci->stream_id << "]: " << num_to_write;
   mci->body_bytes_consumed += num_to_write;
   mci->bytes_sent += num_to_write;
@@ -117,6 +117,10 @@ class HttpSM : public BalsaVisitorInterface, public SMInterface {
                          int64 len,
                          uint32 flags,
                          bool compress);
+  // Sends |len| bytes of a cached body as a chunk. Unlike SendDataFrame(),
+  // the body is referred to rather than copied, so it must outlive the
+  // connection's output list, as MemoryCache bodies do.
+  void SendCachedDataFrame(uint32 stream_id, const char* data, int64 len);
   void EnqueueDataFrame(DataFrame* df);
   void GetOutput() override;
 
@@ -353,6 +353,29 @@ TEST_F(FlipHttpSMTest, SendDataFrame) {
   ASSERT_EQ("b\r\nfoo bar baz\r\n", StringPiece(df->data, df->size));
 }
 
+TEST_F(FlipHttpSMTest, GetOutputRefersToCachedBody) {
+  uint32 stream_id = 13;
+  memory_cache_->InsertFile(NULL, "foobar", "foo bar baz");
+  MemCacheIter mci;
+  mci.stream_id = stream_id;
+  mci.file_data = memory_cache_->GetFileData("foobar");
+  mci.transformed_header = true;
+  interface_->AddToOutputOrder(mci);
+
+  static_cast<SMInterface*>(interface_.get())->GetOutput();
+
+  ASSERT_EQ(3u, connection_->output_list()->size());
+  std::list<DataFrame*>::const_iterator i = connection_->output_list()->begin();
+  DataFrame* df = *i++;
+  ASSERT_EQ("b\r\n", StringPiece(df->data, df->size));
+  df = *i++;
+  // The body is sent straight from the cache.
+  ASSERT_EQ(mci.file_data->body().data(), df->data);
+  ASSERT_EQ(11u, df->size);
+  df = *i++;
+  ASSERT_EQ("\r\n", StringPiece(df->data, df->size));
+}
+
 TEST_F(FlipHttpSMProxyTest, ProcessBodyData) {
   BalsaVisitorInterface* visitor = interface_.get();
   std::string data = "hello, world";
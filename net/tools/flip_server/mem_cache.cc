@@ -16,6 +16,11 @@
 #include <map>
 #include <string>
 
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/pickle.h"
 #include "base/strings/string_util.h"
 #include "net/tools/balsa/balsa_frame.h"
 #include "net/tools/balsa/balsa_headers.h"
@@ -25,6 +30,10 @@
 namespace {
 // The directory where cache locates);
 const char FLAGS_cache_base_dir[] = ".";
+
+// Identifies a cache image, and its format version.
+const uint32 kImageMagic = 0x464c4943;  // "FLIC"
+const uint32 kImageVersion = 1;
 }  // namespace
 
 namespace net {
@@ -50,10 +59,49 @@ void StoreBodyAndHeadersVisitor::HandleBodyError(BalsaFrame* framer) {
   HandleError();
 }
 
+namespace {
+
+// Appends the data passed to Write() to a string. Used to serialize
+// BalsaHeaders.
+class StringWriter {
+ public:
+  explicit StringWriter(std::string* output) : output_(output) {}
+  void Write(const char* data, size_t size) { output_->append(data, size); }
+
+ private:
+  std::string* output_;
+};
+
+// Parses the header block |raw_headers| into |headers|.
+bool ParseHeaders(const char* raw_headers,
+                  size_t size,
+                  BalsaHeaders* headers) {
+  StoreBodyAndHeadersVisitor visitor;
+  visitor.error_ = false;
+  BalsaFrame framer;
+  framer.set_balsa_visitor(&visitor);
+  framer.set_balsa_headers(headers);
+  framer.ProcessInput(raw_headers, size);
+  return !framer.Error() && !visitor.error_;
+}
+
+}  // namespace
+
 FileData::FileData(const BalsaHeaders* headers,
                    const std::string& filename,
                    const std::string& body)
-    : filename_(filename), body_(body) {
+    : filename_(filename), body_storage_(body), body_(body_storage_) {
+  if (headers) {
+    headers_.reset(new BalsaHeaders);
+    headers_->CopyFrom(*headers);
+  }
+}
+
+FileData::FileData(const BalsaHeaders* headers,
+                   const std::string& filename,
+                   const char* body_data,
+                   size_t body_size)
+    : filename_(filename), body_(body_data, body_size) {
   if (headers) {
     headers_.reset(new BalsaHeaders);
     headers_->CopyFrom(*headers);
@@ -232,6 +280,114 @@ void MemoryCache::InsertFile(const BalsaHeaders* headers,
   InsertFile(new FileData(headers, filename, body));
 }
 
+bool MemoryCache::WriteImage(const base::FilePath& path) const {
+  if (!base::IsValueInRangeForNumericType<uint32>(files_.size())) {
+    LOG(ERROR) << "Too many files for a cache image: " << files_.size();
+    return false;
+  }
+  Pickle pickle;
+  pickle.WriteUInt32(kImageMagic);
+  pickle.WriteUInt32(kImageVersion);
+  pickle.WriteUInt32(static_cast<uint32>(files_.size()));
+  for (Files::const_iterator i = files_.begin(); i != files_.end(); ++i) {
+    FileData* file_data = i->second;
+    std::string raw_headers;
+    if (file_data->headers()) {
+      StringWriter writer(&raw_headers);
+      file_data->headers()->WriteHeaderAndEndingToBuffer(&writer);
+    }
+    if (!base::IsValueInRangeForNumericType<int>(raw_headers.size()) ||
+        !base::IsValueInRangeForNumericType<int>(file_data->body().size())) {
+      LOG(ERROR) << "File too large for a cache image: " << i->first;
+      return false;
+    }
+    pickle.WriteString(i->first);
+    pickle.WriteData(raw_headers.data(), static_cast<int>(raw_headers.size()));
+    pickle.WriteData(file_data->body().data(),
+                     static_cast<int>(file_data->body().size()));
+  }
+  if (!base::IsValueInRangeForNumericType<int>(pickle.size())) {
+    LOG(ERROR) << "Cache image too large: " << pickle.size() << " bytes";
+    return false;
+  }
+
+  // Each writer gets a file of its own, so processes writing an image at the
+  // same time can't truncate or interleave with each other's writes.
+  base::FilePath temp_path;
+  if (!base::CreateTemporaryFileInDir(path.DirName(), &temp_path)) {
+    LOG(ERROR) << "Unable to create a temporary file for cache image: "
+               << path.value();
+    return false;
+  }
+  const int size = static_cast<int>(pickle.size());
+  if (base::WriteFile(temp_path, static_cast<const char*>(pickle.data()),
+                      size) != size) {
+    LOG(ERROR) << "Unable to write cache image: " << temp_path.value();
+    base::DeleteFile(temp_path, false);
+    return false;
+  }
+  if (!base::ReplaceFile(temp_path, path, NULL)) {
+    LOG(ERROR) << "Unable to rename cache image to: " << path.value();
+    base::DeleteFile(temp_path, false);
+    return false;
+  }
+  return true;
+}
+
+bool MemoryCache::LoadImage(const base::FilePath& path) {
+  ClearFiles();
+  image_.reset(new base::MemoryMappedFile);
+  if (!image_->Initialize(path)) {
+    LOG(ERROR) << "Unable to map cache image: " << path.value();
+    image_.reset();
+    return false;
+  }
+
+  if (!base::IsValueInRangeForNumericType<int>(image_->length())) {
+    LOG(ERROR) << "Cache image too large: " << path.value();
+    image_.reset();
+    return false;
+  }
+  Pickle pickle(reinterpret_cast<const char*>(image_->data()),
+                static_cast<int>(image_->length()));
+  PickleIterator iter(pickle);
+  uint32 magic;
+  uint32 version;
+  uint32 file_count;
+  if (!iter.ReadUInt32(&magic) || magic != kImageMagic ||
+      !iter.ReadUInt32(&version) || version != kImageVersion ||
+      !iter.ReadUInt32(&file_count)) {
+    LOG(ERROR) << "Not a cache image: " << path.value();
+    image_.reset();
+    return false;
+  }
+  for (uint32 i = 0; i < file_count; ++i) {
+    std::string filename;
+    const char* raw_headers;
+    int raw_headers_size;
+    const char* body;
+    int body_size;
+    if (!iter.ReadString(&filename) ||
+        !iter.ReadData(&raw_headers, &raw_headers_size) ||
+        !iter.ReadData(&body, &body_size)) {
+      LOG(ERROR) << "Truncated cache image: " << path.value();
+      ClearFiles();
+      image_.reset();
+      return false;
+    }
+    BalsaHeaders headers;
+    if (raw_headers_size > 0 &&
+        !ParseHeaders(raw_headers, raw_headers_size, &headers)) {
+      LOG(ERROR) << "Bad headers for " << filename
+                 << " in cache image: " << path.value();
+      continue;
+    }
+    InsertFile(new FileData(raw_headers_size > 0 ? &headers : NULL, filename,
+                            body, body_size));
+  }
+  return true;
+}
+
 void MemoryCache::InsertFile(FileData* file_data) {
   Files::iterator it = files_.find(file_data->filename());
   if (it != files_.end()) {
@@ -10,10 +10,16 @@
 
 #include "base/compiler_specific.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/strings/string_piece.h"
 #include "net/tools/balsa/balsa_headers.h"
 #include "net/tools/balsa/balsa_visitor_interface.h"
 #include "net/tools/flip_server/constants.h"
 
+namespace base {
+class FilePath;
+class MemoryMappedFile;
+}
+
 namespace net {
 
 class StoreBodyAndHeadersVisitor : public BalsaVisitorInterface {
@@ -65,18 +71,28 @@ class FileData {
   FileData(const BalsaHeaders* headers,
            const std::string& filename,
            const std::string& body);
+  // Refers to the |body_size| bytes at |body_data| instead of copying them.
+  // They must outlive the FileData.
+  FileData(const BalsaHeaders* headers,
+           const std::string& filename,
+           const char* body_data,
+           size_t body_size);
   ~FileData();
 
   BalsaHeaders* headers() { return headers_.get(); }
   const BalsaHeaders* headers() const { return headers_.get(); }
 
   const std::string& filename() { return filename_; }
-  const std::string& body() { return body_; }
+  // Valid for the lifetime of the FileData, so responses may refer to it
+  // rather than copy it.
+  base::StringPiece body() const { return body_; }
 
  private:
   scoped_ptr<BalsaHeaders> headers_;
   std::string filename_;
-  std::string body_;
+  // Empty if the body is not owned by the FileData.
+  std::string body_storage_;
+  base::StringPiece body_;
 
   DISALLOW_COPY_AND_ASSIGN(FileData);
 };
@@ -134,12 +150,28 @@ class MemoryCache {
                   const std::string& filename,
                   const std::string& body);
 
+  // Writes every file in the cache to a cache image at |path|. The image is
+  // written to a new temporary file next to |path| and renamed into place, so
+  // processes never see a partial image, even when several of them write it
+  // at once. Returns false on failure, including when the image would not
+  // fit in 2 GB.
+  bool WriteImage(const base::FilePath& path) const;
+
+  // Replaces the contents of the cache with the cache image at |path|. The
+  // image is mapped read-only and the file bodies are served straight from
+  // the mapping, so every process that loads the same image shares one copy
+  // of the bodies in the page cache. Returns false, leaving the cache empty,
+  // if the image cannot be read.
+  bool LoadImage(const base::FilePath& path);
+
  private:
   void InsertFile(FileData* file_data);
   void ClearFiles();
 
   Files files_;
   std::string cwd_;
+  // The cache image the file bodies point into, if it was loaded from one.
+  scoped_ptr<base::MemoryMappedFile> image_;
 };
 
 class NotifierInterface {
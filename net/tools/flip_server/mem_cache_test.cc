@@ -4,6 +4,10 @@
 
 #include "net/tools/flip_server/mem_cache.h"
 
+#include "base/files/file_enumerator.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "net/tools/balsa/balsa_headers.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -95,6 +99,54 @@ TEST_F(FlipMemoryCacheTest, GetFileDataForHtmlFile) {
   ASSERT_EQ(hello_html, mem_cache_->GetFileData("hello.http"));
 }
 
+TEST_F(FlipMemoryCacheTest, WriteAndLoadImage) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath image_path = temp_dir.path().AppendASCII("image");
+
+  mem_cache_->data_map_["./hello"] =
+      "HTTP/1.0 200 OK\r\n"
+      "key1: value1\r\n\r\n"
+      "body: body\r\n";
+  mem_cache_->ReadAndStoreFileContents("./hello");
+  mem_cache_->InsertFile(NULL, "noheaders", "bare body");
+  ASSERT_TRUE(mem_cache_->WriteImage(image_path));
+  // The temporary file the image was written to has been renamed into place.
+  base::FileEnumerator files(temp_dir.path(), false,
+                             base::FileEnumerator::FILES);
+  EXPECT_EQ(image_path, files.Next());
+  EXPECT_TRUE(files.Next().empty());
+
+  MemoryCache loaded;
+  ASSERT_TRUE(loaded.LoadImage(image_path));
+  FileData* hello = loaded.GetFileData("hello");
+  ASSERT_FALSE(NULL == hello);
+  ASSERT_EQ("200", hello->headers()->response_code());
+  ASSERT_EQ("value1", hello->headers()->GetHeaderPosition("key1")->second);
+  ASSERT_EQ("chunked",
+            hello->headers()->GetHeaderPosition("transfer-encoding")->second);
+  ASSERT_EQ("body: body\r\n", hello->body());
+
+  FileData* no_headers = loaded.GetFileData("noheaders");
+  ASSERT_FALSE(NULL == no_headers);
+  ASSERT_EQ(NULL, no_headers->headers());
+  ASSERT_EQ("bare body", no_headers->body());
+}
+
+TEST_F(FlipMemoryCacheTest, LoadBadImage) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath image_path = temp_dir.path().AppendASCII("image");
+  const char kGarbage[] = "not a cache image";
+  ASSERT_EQ(static_cast<int>(sizeof(kGarbage)),
+            base::WriteFile(image_path, kGarbage, sizeof(kGarbage)));
+
+  mem_cache_->InsertFile(NULL, "foo", "bar");
+  ASSERT_FALSE(mem_cache_->LoadImage(image_path));
+  ASSERT_EQ(NULL, mem_cache_->GetFileData("foo"));
+  ASSERT_FALSE(mem_cache_->LoadImage(temp_dir.path().AppendASCII("missing")));
+}
+
 }  // namespace
 
 }  // namespace net
@@ -6,7 +6,9 @@
 
 #include <errno.h>
 #include <netinet/tcp.h>
+#include <string.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <algorithm>
@@ -20,6 +22,13 @@
 #include "net/tools/flip_server/spdy_ssl.h"
 #include "net/tools/flip_server/streamer_interface.h"
 
+namespace {
+
+// The most data frames SendOutputList() sends in one call.
+const size_t kMaxFramesPerSend = 16;
+
+}  // namespace
+
 namespace net {
 
 // static
@@ -220,6 +229,45 @@ int SMConnection::Send(const char* data, int len, int flags) {
   return rv;
 }
 
+ssize_t SMConnection::SendOutputList(int flags) {
+  DCHECK(!ssl_);
+  struct iovec iov[kMaxFramesPerSend];
+  size_t iov_count = 0;
+  for (OutputList::const_iterator i = output_list_.begin();
+       i != output_list_.end() && iov_count < kMaxFramesPerSend;
+       ++i) {
+    const DataFrame* data_frame = *i;
+    if (data_frame->index >= data_frame->size)
+      continue;
+    iov[iov_count].iov_base =
+        const_cast<char*>(data_frame->data + data_frame->index);
+    iov[iov_count].iov_len = data_frame->size - data_frame->index;
+    ++iov_count;
+  }
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = iov_count;
+  CorkSocket();
+  ssize_t rv = sendmsg(fd_, &msg, flags);
+  if (!(flags & MSG_MORE))
+    UncorkSocket();
+  return rv;
+}
+
+void SMConnection::ConsumeOutputList(size_t bytes) {
+  // Fully sent frames are left for DoWrite() to remove.
+  for (OutputList::iterator i = output_list_.begin();
+       i != output_list_.end() && bytes > 0;
+       ++i) {
+    DataFrame* data_frame = *i;
+    size_t consumed = std::min(bytes, data_frame->size - data_frame->index);
+    data_frame->index += consumed;
+    bytes -= consumed;
+  }
+}
+
 void SMConnection::OnRegistration(EpollServer* eps, int fd, int event_mask) {
   registered_in_epoll_server_ = true;
 }
@@ -575,8 +623,14 @@ bool SMConnection::DoWrite() {
               << ": Adding MSG_MORE flag";
       flags |= MSG_MORE;
     }
-    VLOG(2) << log_prefix_ << "Attempting to send " << size << " bytes.";
-    ssize_t bytes_written = Send(bytes, size, flags);
+    ssize_t bytes_written;
+    if (!ssl_ && output_list_.size() > 1) {
+      VLOG(2) << log_prefix_ << "Attempting to send the output list.";
+      bytes_written = SendOutputList(flags);
+    } else {
+      VLOG(2) << log_prefix_ << "Attempting to send " << size << " bytes.";
+      bytes_written = Send(bytes, size, flags);
+    }
     int stored_errno = errno;
     if (bytes_written == -1) {
       switch (stored_errno) {
@@ -598,7 +652,7 @@ bool SMConnection::DoWrite() {
     } else if (bytes_written > 0) {
       VLOG(2) << log_prefix_ << ACCEPTOR_CLIENT_IDENT
               << "Wrote: " << bytes_written << " bytes";
-      data_frame->index += bytes_written;
+      ConsumeOutputList(bytes_written);
       bytes_sent += bytes_written;
       continue;
     } else if (bytes_written == -2) {
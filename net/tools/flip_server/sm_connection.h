@@ -81,6 +81,14 @@ class SMConnection : public SMConnectionInterface,
 
   int Send(const char* data, int len, int flags);
 
+  // Sends as many of the queued data frames as the socket takes in one
+  // gathering sendmsg(), so that frames referring to cached bodies go out
+  // without being copied. Only for connections without SSL.
+  ssize_t SendOutputList(int flags);
+
+  // Marks |bytes| bytes of the queued data frames as sent.
+  void ConsumeOutputList(size_t bytes);
+
   // EpollCallbackInterface interface.
   void OnRegistration(EpollServer* eps, int fd, int event_mask) override;
   void OnModification(int fd, int event_mask) override {}
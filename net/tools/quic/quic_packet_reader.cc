@@ -0,0 +1,144 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_packet_reader.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include "base/logging.h"
+#include "net/base/ip_endpoint.h"
+#include "net/tools/quic/quic_dispatcher.h"
+#include "net/tools/quic/quic_socket_utils.h"
+
+namespace net {
+namespace tools {
+
+QuicPacketReader::QuicPacketReader() {
+  Initialize();
+}
+
+void QuicPacketReader::Initialize() {
+#if MMSG_MORE
+  // Zero initialize uninitialized memory.
+  memset(mmsg_hdr_, 0, sizeof(mmsg_hdr_));
+
+  for (int i = 0; i < kNumPacketsPerReadMmsgCall; ++i) {
+    packets_[i].iov.iov_base = packets_[i].buf;
+    packets_[i].iov.iov_len = sizeof(packets_[i].buf);
+    memset(&packets_[i].raw_address, 0, sizeof(packets_[i].raw_address));
+    memset(packets_[i].cbuf, 0, sizeof(packets_[i].cbuf));
+    memset(packets_[i].buf, 0, sizeof(packets_[i].buf));
+
+    msghdr* hdr = &mmsg_hdr_[i].msg_hdr;
+    hdr->msg_name = &packets_[i].raw_address;
+    hdr->msg_namelen = sizeof(sockaddr_storage);
+    hdr->msg_iov = &packets_[i].iov;
+    hdr->msg_iovlen = 1;
+
+    hdr->msg_control = packets_[i].cbuf;
+    hdr->msg_controllen = kSpaceForOverflowAndIp;
+  }
+#endif
+}
+
+QuicPacketReader::~QuicPacketReader() {
+}
+
+bool QuicPacketReader::ReadAndDispatchPackets(
+    int fd,
+    int port,
+    ProcessPacketInterface* processor,
+    uint32* packets_dropped) {
+#if MMSG_MORE
+  // Re-set the length fields in case recvmmsg has changed them.
+  for (int i = 0; i < kNumPacketsPerReadMmsgCall; ++i) {
+    DCHECK_EQ(sizeof(packets_[i].buf), packets_[i].iov.iov_len);
+    msghdr* hdr = &mmsg_hdr_[i].msg_hdr;
+    hdr->msg_namelen = sizeof(sockaddr_storage);
+    DCHECK_EQ(1u, hdr->msg_iovlen);
+    hdr->msg_controllen = kSpaceForOverflowAndIp;
+    hdr->msg_flags = 0;
+  }
+
+  int packets_read =
+      recvmmsg(fd, mmsg_hdr_, kNumPacketsPerReadMmsgCall, 0, nullptr);
+
+  if (packets_read <= 0) {
+    if (packets_read < 0 && errno != EAGAIN) {
+      LOG(ERROR) << "Error reading " << strerror(errno);
+    }
+    return false;  // recvmmsg failed.
+  }
+
+  for (int i = 0; i < packets_read; ++i) {
+    if (mmsg_hdr_[i].msg_len == 0) {
+      continue;
+    }
+
+    msghdr* hdr = &mmsg_hdr_[i].msg_hdr;
+    IPEndPoint client_address;
+    const sockaddr* raw_address =
+        reinterpret_cast<const sockaddr*>(&packets_[i].raw_address);
+    if (!client_address.FromSockAddr(raw_address, hdr->msg_namelen)) {
+      LOG(DFATAL) << "Unable to parse the client address.";
+      continue;
+    }
+
+    IPAddressNumber server_ip = QuicSocketUtils::GetAddressFromMsghdr(hdr);
+    if (server_ip.empty()) {
+      LOG(DFATAL) << "Unable to get server address.";
+      continue;
+    }
+
+    IPEndPoint server_address(server_ip, port);
+    QuicEncryptedPacket packet(
+        packets_[i].buf, mmsg_hdr_[i].msg_len, false);
+    processor->ProcessPacket(server_address, client_address, packet);
+  }
+
+  // The kernel reports the socket's running drop count on every packet, so
+  // the most recent one is the most up to date.
+  if (packets_dropped != nullptr) {
+    QuicSocketUtils::GetOverflowFromMsghdr(
+        &mmsg_hdr_[packets_read - 1].msg_hdr, packets_dropped);
+  }
+
+  return true;
+#else
+  return ReadAndDispatchSinglePacket(fd, port, processor, packets_dropped);
+#endif
+}
+
+/* static */
+bool QuicPacketReader::ReadAndDispatchSinglePacket(
+    int fd,
+    int port,
+    ProcessPacketInterface* processor,
+    uint32* packets_dropped) {
+  // Allocate some extra space so we can send an error if the client goes over
+  // the limit.
+  char buf[2 * kMaxPacketSize];
+
+  IPEndPoint client_address;
+  IPAddressNumber server_ip;
+  int bytes_read =
+      QuicSocketUtils::ReadPacket(fd, buf, arraysize(buf),
+                                  packets_dropped,
+                                  &server_ip, &client_address);
+
+  if (bytes_read < 0) {
+    return false;  // We failed to read.
+  }
+
+  QuicEncryptedPacket packet(buf, bytes_read, false);
+
+  IPEndPoint server_address(server_ip, port);
+  processor->ProcessPacket(server_address, client_address, packet);
+
+  return true;
+}
+
+}  // namespace tools
+}  // namespace net
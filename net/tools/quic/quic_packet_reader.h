@@ -0,0 +1,90 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A class to read incoming QUIC packets from the UDP socket in batches.
+
+#ifndef NET_TOOLS_QUIC_QUIC_PACKET_READER_H_
+#define NET_TOOLS_QUIC_QUIC_PACKET_READER_H_
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "base/basictypes.h"
+#include "net/quic/quic_protocol.h"
+
+// recvmmsg() is available in glibc 2.12 and later on Linux.
+#if defined(__linux__) && defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 12))
+#define MMSG_MORE 1
+#else
+#define MMSG_MORE 0
+#endif
+
+namespace net {
+namespace tools {
+
+class ProcessPacketInterface;
+
+// Read in batches of this many packets, to amortize the cost of the system
+// call over several packets.
+const int kNumPacketsPerReadMmsgCall = 16;
+
+class QuicPacketReader {
+ public:
+  QuicPacketReader();
+
+  virtual ~QuicPacketReader();
+
+  // Reads up to kNumPacketsPerReadMmsgCall packets from the given fd with a
+  // single recvmmsg() call and passes them off to |processor|.  Returns true
+  // if at least one packet is read, false otherwise.  Falls back to reading a
+  // single packet when recvmmsg() is not available.
+  // If packets_dropped is non-null, the socket is configured to track
+  // dropped packets, and some packets are read, it will be set to the number of
+  // dropped packets.
+  virtual bool ReadAndDispatchPackets(int fd,
+                                      int port,
+                                      ProcessPacketInterface* processor,
+                                      uint32* packets_dropped);
+
+  // Same contract as above, but reads a single packet with recvmsg().
+  static bool ReadAndDispatchSinglePacket(int fd,
+                                          int port,
+                                          ProcessPacketInterface* processor,
+                                          uint32* packets_dropped);
+
+ private:
+  // Initialize the internal state of the reader.
+  void Initialize();
+
+#if MMSG_MORE
+  // Space for the SO_RXQ_OVFL count and the IP_PKTINFO / IPV6_PKTINFO
+  // control messages of a single packet.
+  static const int kSpaceForOverflowAndIp =
+      CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(in6_pktinfo));
+
+  // Storage for a single packet read by recvmmsg().
+  struct PacketData {
+    iovec iov;
+    // raw_address is used for address information provided by the recvmmsg
+    // call on the packets.
+    struct sockaddr_storage raw_address;
+    // cbuf is used for ancillary data from the kernel on recvmmsg.
+    char cbuf[kSpaceForOverflowAndIp];
+    // Allocate some extra space so we can send an error if the client goes
+    // over the limit.
+    char buf[2 * kMaxPacketSize];
+  };
+
+  PacketData packets_[kNumPacketsPerReadMmsgCall];
+  mmsghdr mmsg_hdr_[kNumPacketsPerReadMmsgCall];
+#endif
+
+  DISALLOW_COPY_AND_ASSIGN(QuicPacketReader);
+};
+
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_PACKET_READER_H_
@@ -0,0 +1,133 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_packet_reader.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_util.h"
+#include "net/tools/quic/quic_dispatcher.h"
+#include "net/tools/quic/quic_socket_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace tools {
+namespace test {
+namespace {
+
+class CountingPacketProcessor : public ProcessPacketInterface {
+ public:
+  explicit CountingPacketProcessor(const IPEndPoint& server_address)
+      : server_address_(server_address), packets_(0), bytes_(0) {}
+
+  void ProcessPacket(const IPEndPoint& server_address,
+                     const IPEndPoint& client_address,
+                     const QuicEncryptedPacket& packet) override {
+    EXPECT_EQ(server_address_, server_address);
+    EXPECT_NE(0, client_address.port());
+    ++packets_;
+    bytes_ += packet.length();
+  }
+
+  int packets() const { return packets_; }
+  size_t bytes() const { return bytes_; }
+
+ private:
+  const IPEndPoint server_address_;
+  int packets_;
+  size_t bytes_;
+};
+
+class QuicPacketReaderTest : public ::testing::Test {
+ protected:
+  QuicPacketReaderTest() : server_fd_(-1), client_fd_(-1), server_port_(0) {}
+
+  void SetUp() override {
+    IPAddressNumber localhost;
+    ASSERT_TRUE(ParseIPLiteralToNumber("127.0.0.1", &localhost));
+
+    server_fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+    ASSERT_LE(0, server_fd_);
+    ASSERT_EQ(0, QuicSocketUtils::SetGetAddressInfo(server_fd_, AF_INET));
+
+    SockaddrStorage storage;
+    ASSERT_TRUE(IPEndPoint(localhost, 0).ToSockAddr(storage.addr,
+                                                    &storage.addr_len));
+    ASSERT_EQ(0, bind(server_fd_, storage.addr, storage.addr_len));
+
+    SockaddrStorage bound;
+    ASSERT_EQ(0, getsockname(server_fd_, bound.addr, &bound.addr_len));
+    ASSERT_TRUE(server_address_.FromSockAddr(bound.addr, bound.addr_len));
+    server_port_ = server_address_.port();
+
+    client_fd_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ASSERT_LE(0, client_fd_);
+  }
+
+  void TearDown() override {
+    if (server_fd_ >= 0)
+      close(server_fd_);
+    if (client_fd_ >= 0)
+      close(client_fd_);
+  }
+
+  void SendPacket(size_t length) {
+    std::string data(length, 'a');
+    SockaddrStorage storage;
+    ASSERT_TRUE(server_address_.ToSockAddr(storage.addr, &storage.addr_len));
+    ASSERT_EQ(static_cast<ssize_t>(length),
+              sendto(client_fd_, data.data(), data.length(), 0,
+                     storage.addr, storage.addr_len));
+  }
+
+  int server_fd_;
+  int client_fd_;
+  int server_port_;
+  IPEndPoint server_address_;
+};
+
+TEST_F(QuicPacketReaderTest, ReadsAllQueuedPackets) {
+  const int kNumPackets = kNumPacketsPerReadMmsgCall + 3;
+  const size_t kPacketLength = 100;
+  for (int i = 0; i < kNumPackets; ++i) {
+    SendPacket(kPacketLength);
+  }
+
+  QuicPacketReader reader;
+  CountingPacketProcessor processor(server_address_);
+  int reads = 0;
+  while (reader.ReadAndDispatchPackets(server_fd_, server_port_, &processor,
+                                       nullptr)) {
+    ++reads;
+  }
+
+  EXPECT_EQ(kNumPackets, processor.packets());
+  EXPECT_EQ(kNumPackets * kPacketLength, processor.bytes());
+#if MMSG_MORE
+  // Loopback delivers the datagrams synchronously, so they are all queued
+  // before the first read and two batches are enough.
+  EXPECT_EQ(2, reads);
+#else
+  EXPECT_EQ(kNumPackets, reads);
+#endif
+}
+
+TEST_F(QuicPacketReaderTest, NothingToRead) {
+  QuicPacketReader reader;
+  CountingPacketProcessor processor(server_address_);
+  EXPECT_FALSE(reader.ReadAndDispatchPackets(server_fd_, server_port_,
+                                             &processor, nullptr));
+  EXPECT_EQ(0, processor.packets());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace tools
+}  // namespace net
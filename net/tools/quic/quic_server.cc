@@ -21,14 +21,17 @@
 #include "net/quic/quic_protocol.h"
 #include "net/tools/quic/quic_dispatcher.h"
 #include "net/tools/quic/quic_in_memory_cache.h"
+#include "net/tools/quic/quic_packet_reader.h"
 #include "net/tools/quic/quic_socket_utils.h"
 
-#define MMSG_MORE 0
-
 #ifndef SO_RXQ_OVFL
 #define SO_RXQ_OVFL 40
 #endif
 
+#ifndef SO_REUSEPORT
+#define SO_REUSEPORT 15
+#endif
+
 namespace net {
 namespace tools {
 
@@ -45,6 +48,7 @@ QuicServer::QuicServer()
       packets_dropped_(0),
       overflow_supported_(false),
       use_recvmmsg_(false),
+      reuse_port_(false),
       crypto_config_(kSourceAddressTokenSecret, QuicRandom::GetInstance()),
       supported_versions_(QuicSupportedVersions()) {
   Initialize();
@@ -57,6 +61,7 @@ QuicServer::QuicServer(const QuicConfig& config,
       packets_dropped_(0),
       overflow_supported_(false),
       use_recvmmsg_(false),
+      reuse_port_(false),
       config_(config),
       crypto_config_(kSourceAddressTokenSecret, QuicRandom::GetInstance()),
       supported_versions_(supported_versions) {
@@ -67,6 +72,7 @@ void QuicServer::Initialize() {
 #if MMSG_MORE
   use_recvmmsg_ = true;
 #endif
+  packet_reader_.reset(new QuicPacketReader());
   epoll_server_.set_timeout_in_us(50 * 1000);
   // Initialize the in memory cache now.
   QuicInMemoryCache::GetInstance();
@@ -123,6 +129,16 @@ bool QuicServer::Listen(const IPEndPoint& address) {
     return false;
   }
 
+  if (reuse_port_) {
+    int reuse_port = 1;
+    rc = setsockopt(
+        fd_, SOL_SOCKET, SO_REUSEPORT, &reuse_port, sizeof(reuse_port));
+    if (rc < 0) {
+      LOG(ERROR) << "SO_REUSEPORT not supported: " << strerror(errno);
+      return false;
+    }
+  }
+
   sockaddr_storage raw_addr;
   socklen_t raw_addr_len = sizeof(raw_addr);
   CHECK(address.ToSockAddr(reinterpret_cast<sockaddr*>(&raw_addr),
@@ -183,11 +199,16 @@ void QuicServer::OnEvent(int fd, EpollEvent* event) {
 
   if (event->in_events & EPOLLIN) {
     DVLOG(1) << "EPOLLIN";
+    uint32* packets_dropped = overflow_supported_ ? &packets_dropped_ : nullptr;
     bool read = true;
     while (read) {
+      if (use_recvmmsg_) {
+        read = packet_reader_->ReadAndDispatchPackets(
+            fd_, port_, dispatcher_.get(), packets_dropped);
+      } else {
         read = ReadAndDispatchSinglePacket(
-            fd_, port_, dispatcher_.get(),
-            overflow_supported_ ? &packets_dropped_ : nullptr);
+            fd_, port_, dispatcher_.get(), packets_dropped);
+      }
     }
   }
   if (event->in_events & EPOLLOUT) {
@@ -205,27 +226,8 @@ bool QuicServer::ReadAndDispatchSinglePacket(int fd,
                                              int port,
                                              ProcessPacketInterface* processor,
                                              uint32* packets_dropped) {
-  // Allocate some extra space so we can send an error if the client goes over
-  // the limit.
-  char buf[2 * kMaxPacketSize];
-
-  IPEndPoint client_address;
-  IPAddressNumber server_ip;
-  int bytes_read =
-      QuicSocketUtils::ReadPacket(fd, buf, arraysize(buf),
-                                  packets_dropped,
-                                  &server_ip, &client_address);
-
-  if (bytes_read < 0) {
-    return false;  // We failed to read.
-  }
-
-  QuicEncryptedPacket packet(buf, bytes_read, false);
-
-  IPEndPoint server_address(server_ip, port);
-  processor->ProcessPacket(server_address, client_address, packet);
-
-  return true;
+  return QuicPacketReader::ReadAndDispatchSinglePacket(
+      fd, port, processor, packets_dropped);
 }
 
 }  // namespace tools
@@ -26,6 +26,7 @@ class QuicServerPeer;
 
 class ProcessPacketInterface;
 class QuicDispatcher;
+class QuicPacketReader;
 
 class QuicServer : public EpollCallbackInterface {
  public:
@@ -35,7 +36,9 @@ class QuicServer : public EpollCallbackInterface {
 
   ~QuicServer() override;
 
-  // Start listening on the specified address.
+  // Start listening on the specified address.  If set_reuse_port(true) was
+  // called first, several servers may listen on the same address, and the
+  // kernel spreads incoming packets across them.
   bool Listen(const IPEndPoint& address);
 
   // Wait up to 50ms, and handle any events which occur.
@@ -72,6 +75,10 @@ class QuicServer : public EpollCallbackInterface {
     crypto_config_.SetProofSource(source);
   }
 
+  // Sets SO_REUSEPORT on the listening socket.  Must be called before
+  // Listen().
+  void set_reuse_port(bool reuse_port) { reuse_port_ = reuse_port; }
+
   bool overflow_supported() { return overflow_supported_; }
 
   uint32 packets_dropped() { return packets_dropped_; }
@@ -119,6 +126,12 @@ class QuicServer : public EpollCallbackInterface {
   // If true, use recvmmsg for reading.
   bool use_recvmmsg_;
 
+  // If true, set SO_REUSEPORT on the listening socket.
+  bool reuse_port_;
+
+  // Reads batches of packets with recvmmsg when use_recvmmsg_ is true.
+  scoped_ptr<QuicPacketReader> packet_reader_;
+
   // config_ contains non-crypto parameters that are negotiated in the crypto
   // handshake.
   QuicConfig config_;
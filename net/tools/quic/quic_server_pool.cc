@@ -0,0 +1,103 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_server_pool.h"
+
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/cancellation_flag.h"
+#include "base/threading/simple_thread.h"
+#include "net/tools/quic/quic_server.h"
+
+namespace net {
+namespace tools {
+
+// Drives the event loop of a single QuicServer until asked to quit.
+class QuicServerPool::ServerThread : public base::SimpleThread {
+ public:
+  ServerThread(QuicServer* server, size_t index)
+      : SimpleThread("quic_server_" + base::SizeTToString(index)),
+        server_(server) {}
+
+  ~ServerThread() override {}
+
+  void Run() override {
+    while (!quit_.IsSet()) {
+      server_->WaitForEvents();
+    }
+    server_->Shutdown();
+  }
+
+  // Asks the thread to exit after its current WaitForEvents() call.
+  void Quit() { quit_.Set(); }
+
+ private:
+  QuicServer* server_;  // Not owned.
+  base::CancellationFlag quit_;
+
+  DISALLOW_COPY_AND_ASSIGN(ServerThread);
+};
+
+QuicServerPool::QuicServerPool(const QuicConfig& config,
+                               const QuicVersionVector& supported_versions,
+                               size_t num_threads)
+    : port_(0) {
+  DCHECK_GT(num_threads, 0u);
+  for (size_t i = 0; i < num_threads; ++i) {
+    QuicServer* server = new QuicServer(config, supported_versions);
+    server->set_reuse_port(true);
+    servers_.push_back(server);
+  }
+}
+
+QuicServerPool::~QuicServerPool() {
+  Shutdown();
+}
+
+bool QuicServerPool::Listen(const IPEndPoint& address) {
+  DCHECK(threads_.empty());
+  IPEndPoint listen_address = address;
+  for (size_t i = 0; i < servers_.size(); ++i) {
+    if (!servers_[i]->Listen(listen_address)) {
+      LOG(ERROR) << "Server " << i << " failed to listen on "
+                 << listen_address.ToString();
+      for (size_t j = 0; j < i; ++j) {
+        servers_[j]->Shutdown();
+      }
+      return false;
+    }
+    if (i == 0) {
+      port_ = servers_[0]->port();
+      listen_address = IPEndPoint(address.address(), port_);
+    }
+  }
+
+  for (size_t i = 0; i < servers_.size(); ++i) {
+    ServerThread* thread = new ServerThread(servers_[i], i);
+    threads_.push_back(thread);
+    thread->Start();
+  }
+  return true;
+}
+
+void QuicServerPool::Shutdown() {
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i]->Quit();
+  }
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i]->Join();
+  }
+  threads_.clear();
+}
+
+uint32 QuicServerPool::packets_dropped() const {
+  uint32 packets_dropped = 0;
+  for (size_t i = 0; i < servers_.size(); ++i) {
+    packets_dropped += servers_[i]->packets_dropped();
+  }
+  return packets_dropped;
+}
+
+}  // namespace tools
+}  // namespace net
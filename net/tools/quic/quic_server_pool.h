@@ -0,0 +1,74 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Runs several QuicServers, each with its own dispatcher, epoll server and
+// thread, listening on the same address with SO_REUSEPORT.  The kernel hashes
+// each client's 4-tuple to one of the sockets, so all packets of a connection
+// reach the same dispatcher as long as the client address does not change.
+
+#ifndef NET_TOOLS_QUIC_QUIC_SERVER_POOL_H_
+#define NET_TOOLS_QUIC_QUIC_SERVER_POOL_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_vector.h"
+#include "net/base/ip_endpoint.h"
+#include "net/quic/quic_config.h"
+#include "net/quic/quic_protocol.h"
+
+namespace net {
+namespace tools {
+
+namespace test {
+class QuicServerPoolPeer;
+}  // namespace test
+
+class QuicServer;
+
+class QuicServerPool {
+ public:
+  QuicServerPool(const QuicConfig& config,
+                 const QuicVersionVector& supported_versions,
+                 size_t num_threads);
+
+  ~QuicServerPool();
+
+  // Binds every server to |address| and starts one thread per server.  If
+  // the port of |address| is 0, the port picked by the kernel for the first
+  // server is used for the rest.  Returns false if any server fails to
+  // listen, in which case no threads are started.
+  bool Listen(const IPEndPoint& address);
+
+  // Stops all threads and shuts down their servers.  Called by the
+  // destructor if needed.
+  void Shutdown();
+
+  // Returns the port the servers are listening on.
+  int port() const { return port_; }
+
+  size_t num_threads() const { return servers_.size(); }
+
+  // Total number of packets dropped by the kernel across all sockets.  Only
+  // accurate after Shutdown(), since the servers update their counters on
+  // their own threads.
+  uint32 packets_dropped() const;
+
+ private:
+  friend class net::tools::test::QuicServerPoolPeer;
+
+  class ServerThread;
+
+  ScopedVector<QuicServer> servers_;
+  ScopedVector<ServerThread> threads_;
+
+  int port_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicServerPool);
+};
+
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_SERVER_POOL_H_
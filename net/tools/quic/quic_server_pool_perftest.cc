@@ -0,0 +1,161 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_server_pool.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_vector.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/threading/simple_thread.h"
+#include "base/time/time.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_util.h"
+#include "net/quic/quic_protocol.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace net {
+namespace tools {
+namespace {
+
+// The load: several client threads, each keeping one packet in flight on
+// each of its sockets.  Every socket has its own address, so the kernel
+// spreads the sockets, not the threads, across the servers.
+const int kNumClientThreads = 4;
+const int kSocketsPerClient = 16;
+const int kRoundsPerClient = 500;
+const int kPacketsPerRun =
+    kNumClientThreads * kSocketsPerClient * kRoundsPerClient;
+
+// Builds a data packet for |connection_id| without the version flag.  Every
+// packet uses a connection ID the servers have not seen, so each one is
+// parsed by a dispatcher, added to its time wait list and answered with a
+// public reset.
+std::string ConstructPacket(QuicConnectionId connection_id) {
+  std::string packet;
+  // public flags (8 byte connection_id, 6 byte sequence number)
+  packet.push_back(static_cast<char>(PACKET_PUBLIC_FLAGS_8BYTE_CONNECTION_ID |
+                                     PACKET_PUBLIC_FLAGS_6BYTE_SEQUENCE));
+  // connection_id
+  for (size_t i = 0; i < sizeof(connection_id); ++i)
+    packet.push_back(static_cast<char>(connection_id >> (8 * i)));
+  // packet sequence number
+  packet.append("\x01\x00\x00\x00\x00\x00", 6);
+  // private flags
+  packet.push_back('\0');
+  return packet;
+}
+
+// Sends |kRoundsPerClient| rounds of one packet per socket to the pool,
+// waiting for all of a round's public resets before starting the next.
+class LoadGenerator : public base::DelegateSimpleThread::Delegate {
+ public:
+  LoadGenerator(const IPEndPoint& server_address, int index)
+      : server_address_(server_address),
+        first_connection_id_(static_cast<QuicConnectionId>(index + 1) << 32),
+        packets_answered_(0) {}
+
+  ~LoadGenerator() override {
+    for (size_t i = 0; i < fds_.size(); ++i)
+      close(fds_[i]);
+  }
+
+  // base::DelegateSimpleThread::Delegate implementation:
+  void Run() override {
+    timeval timeout = {5, 0};
+    for (int i = 0; i < kSocketsPerClient; ++i) {
+      int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+      ASSERT_LE(0, fd);
+      fds_.push_back(fd);
+      ASSERT_EQ(0, setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                              sizeof(timeout)));
+    }
+
+    SockaddrStorage storage;
+    ASSERT_TRUE(server_address_.ToSockAddr(storage.addr, &storage.addr_len));
+    QuicConnectionId connection_id = first_connection_id_;
+    char buffer[kMaxPacketSize];
+    for (int round = 0; round < kRoundsPerClient; ++round) {
+      for (size_t i = 0; i < fds_.size(); ++i) {
+        std::string packet = ConstructPacket(connection_id++);
+        ASSERT_EQ(static_cast<ssize_t>(packet.size()),
+                  sendto(fds_[i], packet.data(), packet.size(), 0,
+                         storage.addr, storage.addr_len));
+      }
+      for (size_t i = 0; i < fds_.size(); ++i) {
+        ASSERT_LT(0, recv(fds_[i], buffer, sizeof(buffer), 0));
+        ASSERT_TRUE(buffer[0] & PACKET_PUBLIC_FLAGS_RST);
+        ++packets_answered_;
+      }
+    }
+  }
+
+  int packets_answered() const { return packets_answered_; }
+
+ private:
+  const IPEndPoint server_address_;
+  const QuicConnectionId first_connection_id_;
+  std::vector<int> fds_;
+  int packets_answered_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadGenerator);
+};
+
+class QuicServerPoolPerfTest : public ::testing::Test {
+ protected:
+  // Starts a pool of |num_threads| servers, runs the load generators against
+  // it and reports how many packets per second the pool answered.
+  void RunLoad(size_t num_threads) {
+    IPAddressNumber localhost;
+    ASSERT_TRUE(ParseIPLiteralToNumber("127.0.0.1", &localhost));
+    QuicServerPool pool(QuicConfig(), QuicSupportedVersions(), num_threads);
+    ASSERT_TRUE(pool.Listen(IPEndPoint(localhost, 0)));
+    IPEndPoint server_address(localhost, pool.port());
+
+    ScopedVector<LoadGenerator> generators;
+    ScopedVector<base::DelegateSimpleThread> threads;
+    for (int i = 0; i < kNumClientThreads; ++i) {
+      generators.push_back(new LoadGenerator(server_address, i));
+      threads.push_back(new base::DelegateSimpleThread(
+          generators[i], "load_generator_" + base::IntToString(i)));
+    }
+
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (size_t i = 0; i < threads.size(); ++i)
+      threads[i]->Start();
+    for (size_t i = 0; i < threads.size(); ++i)
+      threads[i]->Join();
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+
+    int packets_answered = 0;
+    for (size_t i = 0; i < generators.size(); ++i)
+      packets_answered += generators[i]->packets_answered();
+    EXPECT_EQ(kPacketsPerRun, packets_answered);
+
+    pool.Shutdown();
+    EXPECT_EQ(0u, pool.packets_dropped());
+    perf_test::PrintResult("quic_server_pool", "",
+                           "threads_" + base::SizeTToString(num_threads),
+                           packets_answered / elapsed.InSecondsF(),
+                           "packets/s", true);
+  }
+};
+
+TEST_F(QuicServerPoolPerfTest, AnswerNewConnections) {
+  RunLoad(1);
+  RunLoad(2);
+  RunLoad(4);
+}
+
+}  // namespace
+}  // namespace tools
+}  // namespace net
@@ -0,0 +1,165 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_server_pool.h"
+
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_util.h"
+#include "net/quic/quic_protocol.h"
+#include "net/tools/quic/quic_dispatcher.h"
+#include "net/tools/quic/quic_server.h"
+#include "net/tools/quic/quic_time_wait_list_manager.h"
+#include "net/tools/quic/test_tools/quic_dispatcher_peer.h"
+#include "net/tools/quic/test_tools/quic_server_peer.h"
+#include "net/tools/quic/test_tools/quic_server_pool_peer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace tools {
+namespace test {
+namespace {
+
+const size_t kNumServers = 3;
+
+// Each client sends from its own socket, so the kernel hashes each one to a
+// server independently.  With this many, the chance that some server gets
+// none of them is below one in 10^10.
+const size_t kNumClients = 64;
+
+const QuicConnectionId kFirstConnectionId = 0x1000;
+
+// Builds a data packet for |connection_id| without the version flag.  A server
+// that has no session for the connection adds it to its time wait list and
+// answers with a public reset.
+std::string ConstructPacket(QuicConnectionId connection_id) {
+  std::string packet;
+  // public flags (8 byte connection_id, 6 byte sequence number)
+  packet.push_back(static_cast<char>(PACKET_PUBLIC_FLAGS_8BYTE_CONNECTION_ID |
+                                     PACKET_PUBLIC_FLAGS_6BYTE_SEQUENCE));
+  // connection_id
+  for (size_t i = 0; i < sizeof(connection_id); ++i)
+    packet.push_back(static_cast<char>(connection_id >> (8 * i)));
+  // packet sequence number
+  packet.append("\x01\x00\x00\x00\x00\x00", 6);
+  // private flags
+  packet.push_back('\0');
+  return packet;
+}
+
+class QuicServerPoolTest : public ::testing::Test {
+ protected:
+  QuicServerPoolTest()
+      : pool_(QuicConfig(), QuicSupportedVersions(), kNumServers) {}
+
+  void SetUp() override {
+    ASSERT_TRUE(ParseIPLiteralToNumber("127.0.0.1", &localhost_));
+  }
+
+  void TearDown() override {
+    for (size_t i = 0; i < client_fds_.size(); ++i)
+      close(client_fds_[i]);
+  }
+
+  // Sends a packet for |connection_id| to the pool from a new socket and
+  // waits for the public reset.  The socket stays open until the end of the
+  // test, so every client has a distinct address.
+  void SendPacketAndWaitForReset(QuicConnectionId connection_id) {
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ASSERT_LE(0, fd);
+    client_fds_.push_back(fd);
+
+    timeval timeout = {5, 0};
+    ASSERT_EQ(0, setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                            sizeof(timeout)));
+
+    SockaddrStorage storage;
+    ASSERT_TRUE(IPEndPoint(localhost_, pool_.port())
+                    .ToSockAddr(storage.addr, &storage.addr_len));
+    std::string packet = ConstructPacket(connection_id);
+    ASSERT_EQ(static_cast<ssize_t>(packet.size()),
+              sendto(fd, packet.data(), packet.size(), 0, storage.addr,
+                     storage.addr_len));
+
+    char buffer[kMaxPacketSize];
+    ssize_t bytes_read = recv(fd, buffer, sizeof(buffer), 0);
+    ASSERT_LT(static_cast<ssize_t>(1 + sizeof(connection_id)), bytes_read);
+    EXPECT_TRUE(buffer[0] & PACKET_PUBLIC_FLAGS_RST);
+    EXPECT_EQ(0, memcmp(packet.data() + 1, buffer + 1, sizeof(connection_id)));
+  }
+
+  QuicTimeWaitListManager* GetTimeWaitListManager(size_t index) {
+    return QuicDispatcherPeer::GetTimeWaitListManager(
+        QuicServerPeer::GetDispatcher(
+            QuicServerPoolPeer::GetServer(&pool_, index)));
+  }
+
+  IPAddressNumber localhost_;
+  QuicServerPool pool_;
+  std::vector<int> client_fds_;
+};
+
+TEST_F(QuicServerPoolTest, EveryServerReceivesTraffic) {
+  ASSERT_TRUE(pool_.Listen(IPEndPoint(localhost_, 0)));
+  ASSERT_NE(0, pool_.port());
+  ASSERT_EQ(kNumServers, pool_.num_threads());
+  for (size_t i = 0; i < kNumServers; ++i) {
+    EXPECT_EQ(pool_.port(), QuicServerPoolPeer::GetServer(&pool_, i)->port());
+  }
+
+  for (size_t i = 0; i < kNumClients; ++i) {
+    SendPacketAndWaitForReset(kFirstConnectionId + i);
+  }
+
+  // The servers' state may only be inspected once their threads are gone.
+  pool_.Shutdown();
+
+  std::vector<size_t> connections_per_server(kNumServers, 0);
+  for (size_t i = 0; i < kNumClients; ++i) {
+    size_t servers_with_connection = 0;
+    for (size_t j = 0; j < kNumServers; ++j) {
+      if (GetTimeWaitListManager(j)->IsConnectionIdInTimeWait(
+              kFirstConnectionId + i)) {
+        ++servers_with_connection;
+        ++connections_per_server[j];
+      }
+    }
+    // Each connection was handled by exactly one server.
+    EXPECT_EQ(1u, servers_with_connection);
+  }
+  for (size_t j = 0; j < kNumServers; ++j) {
+    EXPECT_LT(0u, connections_per_server[j]) << "server " << j;
+  }
+}
+
+TEST_F(QuicServerPoolTest, ListenFailsOnPortInUse) {
+  // A socket without SO_REUSEPORT keeps the others off its port.
+  int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  ASSERT_LE(0, fd);
+  client_fds_.push_back(fd);
+  SockaddrStorage storage;
+  ASSERT_TRUE(IPEndPoint(localhost_, 0).ToSockAddr(storage.addr,
+                                                   &storage.addr_len));
+  ASSERT_EQ(0, bind(fd, storage.addr, storage.addr_len));
+  SockaddrStorage bound;
+  ASSERT_EQ(0, getsockname(fd, bound.addr, &bound.addr_len));
+  IPEndPoint taken_address;
+  ASSERT_TRUE(taken_address.FromSockAddr(bound.addr, bound.addr_len));
+
+  EXPECT_FALSE(pool_.Listen(taken_address));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace tools
+}  // namespace net
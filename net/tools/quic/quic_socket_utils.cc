@@ -30,16 +30,15 @@ IPAddressNumber QuicSocketUtils::GetAddressFromMsghdr(struct msghdr *hdr) {
          cmsg = CMSG_NXTHDR(hdr, cmsg)) {
       const uint8* addr_data = nullptr;
       int len = 0;
+      // Point into the control message itself, which outlives this block.
       if (cmsg->cmsg_type == IPV6_PKTINFO) {
         in6_pktinfo* info = reinterpret_cast<in6_pktinfo*>CMSG_DATA(cmsg);
-        in6_addr addr = info->ipi6_addr;
-        addr_data = reinterpret_cast<const uint8*>(&addr);
-        len = sizeof(addr);
+        addr_data = reinterpret_cast<const uint8*>(&info->ipi6_addr);
+        len = sizeof(info->ipi6_addr);
       } else if (cmsg->cmsg_type == IP_PKTINFO) {
         in_pktinfo* info = reinterpret_cast<in_pktinfo*>CMSG_DATA(cmsg);
-        in_addr addr = info->ipi_addr;
-        addr_data = reinterpret_cast<const uint8*>(&addr);
-        len = sizeof(addr);
+        addr_data = reinterpret_cast<const uint8*>(&info->ipi_addr);
+        len = sizeof(info->ipi_addr);
       } else {
         continue;
       }
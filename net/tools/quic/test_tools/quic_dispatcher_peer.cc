@@ -60,6 +60,12 @@ QuicDispatcher::WriteBlockedList* QuicDispatcherPeer::GetWriteBlockedList(
   return &dispatcher->write_blocked_list_;
 }
 
+// static
+QuicTimeWaitListManager* QuicDispatcherPeer::GetTimeWaitListManager(
+    QuicDispatcher* dispatcher) {
+  return dispatcher->time_wait_list_manager_.get();
+}
+
 }  // namespace test
 }  // namespace tools
 }  // namespace net
@@ -0,0 +1,22 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/test_tools/quic_server_pool_peer.h"
+
+#include "net/tools/quic/quic_server.h"
+#include "net/tools/quic/quic_server_pool.h"
+
+namespace net {
+namespace tools {
+namespace test {
+
+// static
+QuicServer* QuicServerPoolPeer::GetServer(QuicServerPool* pool,
+                                          size_t index) {
+  return pool->servers_[index];
+}
+
+}  // namespace test
+}  // namespace tools
+}  // namespace net
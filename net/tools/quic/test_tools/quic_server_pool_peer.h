@@ -0,0 +1,31 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_QUIC_TEST_TOOLS_QUIC_SERVER_POOL_PEER_H_
+#define NET_TOOLS_QUIC_TEST_TOOLS_QUIC_SERVER_POOL_PEER_H_
+
+#include "base/basictypes.h"
+
+namespace net {
+
+namespace tools {
+
+class QuicServer;
+class QuicServerPool;
+
+namespace test {
+
+class QuicServerPoolPeer {
+ public:
+  static QuicServer* GetServer(QuicServerPool* pool, size_t index);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(QuicServerPoolPeer);
+};
+
+}  // namespace test
+}  // namespace tools
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_TEST_TOOLS_QUIC_SERVER_POOL_PEER_H_
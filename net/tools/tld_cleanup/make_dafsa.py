@@ -17,6 +17,10 @@ used as a memory efficient replacement for the perfect hash table.
 The input strings are assumed to consist of printable 7-bit ASCII characters
 and the return values are assumed to be one digit integers.
 
+With --reverse the strings are reversed before the graph is built, so that
+lookups can consume a domain name one character at a time from its end and
+find every matching suffix, from the shortest to the longest, in one pass.
+
 In this program a DAFSA is a diamond shaped graph starting at a common
 source node and ending at a common sink node. All internal nodes contain
 a label and each word is represented by the labels in one path from
@@ -438,8 +442,10 @@ def words_to_cxx(words):
   return to_cxx(encode(dafsa))
 
 
-def parse_gperf(infile):
-  """Parses gperf file and extract strings and return code"""
+def parse_gperf(infile, reverse=False):
+  """Parses gperf file and extract strings and return code. The strings are
+  reversed if |reverse| is True.
+  """
   lines = [line.strip() for line in infile]
   # Extract strings after the first '%%' and before the second '%%'.
   begin = lines.index('%%') + 1
@@ -453,15 +459,22 @@ def parse_gperf(infile):
     if line[-1] not in '0124':
       raise InputError('Expected value to be one of {0,1,2,4}, found "%s"' %
                        line[-1])
+  if reverse:
+    return [line[-4::-1] + line[-1] for line in lines]
   return [line[:-3] + line[-1] for line in lines]
 
 
 def main():
-  if len(sys.argv) != 3:
-    print('usage: %s infile outfile' % sys.argv[0])
+  args = sys.argv[1:]
+  reverse = False
+  if args and args[0] == '--reverse':
+    reverse = True
+    args = args[1:]
+  if len(args) != 2:
+    print('usage: %s [--reverse] infile outfile' % sys.argv[0])
     return 1
-  with open(sys.argv[1], 'r') as infile, open(sys.argv[2], 'w') as outfile:
-    outfile.write(words_to_cxx(parse_gperf(infile)))
+  with open(args[0], 'r') as infile, open(args[1], 'w') as outfile:
+    outfile.write(words_to_cxx(parse_gperf(infile, reverse)))
   return 0
 
 
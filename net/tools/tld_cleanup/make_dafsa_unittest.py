@@ -68,6 +68,12 @@ class ParseGperfTest(unittest.TestCase):
     words = [ 'apa1', 'bepa.com2' ]
     self.assertEqual(make_dafsa.parse_gperf(infile), words)
 
+  def testReverse(self):
+    """Tests keys are reversed, but not their return values."""
+    infile = [ '%%', 'apa, 1', 'bepa.com, 2', '%%' ]
+    words = [ 'apa1', 'moc.apeb2' ]
+    self.assertEqual(make_dafsa.parse_gperf(infile, reverse=True), words)
+
 
 class ToDafsaTest(unittest.TestCase):
   def testEmptyInput(self):
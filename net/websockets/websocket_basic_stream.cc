@@ -160,9 +160,8 @@ int WebSocketBasicStream::WriteFrames(ScopedVector<WebSocketFrame>* frames,
     CHECK_LE(frame->header.payload_length, static_cast<uint64>(remaining_size));
     const int frame_size = static_cast<int>(frame->header.payload_length);
     if (frame_size > 0) {
-      const char* const frame_data = frame->data->data();
-      std::copy(frame_data, frame_data + frame_size, dest);
-      MaskWebSocketFramePayload(mask, 0, dest, frame_size);
+      CopyAndMaskWebSocketFramePayload(
+          mask, 0, frame->data->data(), dest, frame_size);
       dest += frame_size;
       remaining_size -= frame_size;
     }
@@ -190,6 +190,16 @@ NET_EXPORT void MaskWebSocketFramePayload(
     char* data,
     int data_size);
 
+// Like MaskWebSocketFramePayload(), but reads the payload from |source| and
+// writes the masked result to |dest| in the same pass, instead of masking
+// in place. |source| and |dest| must not overlap.
+NET_EXPORT void CopyAndMaskWebSocketFramePayload(
+    const WebSocketMaskingKey& masking_key,
+    uint64 frame_offset,
+    const char* source,
+    char* dest,
+    int data_size);
+
 }  // namespace net
 
 #endif  // NET_WEBSOCKETS_WEBSOCKET_FRAME_H_
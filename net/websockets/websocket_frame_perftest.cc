@@ -5,9 +5,11 @@
 #include "net/websockets/websocket_frame.h"
 
 #include <algorithm>
+#include <string>
 #include <vector>
 
 #include "base/macros.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/test/perf_time_logger.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -19,27 +21,56 @@ const int kIterations = 100000;
 const int kLongPayloadSize = 1 << 16;
 const char kMaskingKey[] = "\xFE\xED\xBE\xEF";
 
+// Roughly how many bytes each of the payload size benchmarks masks in total.
+const int64 kBytesPerSizeBenchmark = 1 << 30;
+
 COMPILE_ASSERT(arraysize(kMaskingKey) ==
                    WebSocketFrameHeader::kMaskingKeyLength + 1,
                incorrect_masking_key_size);
 
 class WebSocketFrameTestMaskBenchmark : public ::testing::Test {
  protected:
+  WebSocketFrameTestMaskBenchmark() {
+    std::copy(kMaskingKey,
+              kMaskingKey + WebSocketFrameHeader::kMaskingKeyLength,
+              masking_key_.key);
+  }
+
   void Benchmark(const char* const name,
                  const char* const payload,
                  size_t size) {
     std::vector<char> scratch(payload, payload + size);
-    WebSocketMaskingKey masking_key;
-    std::copy(kMaskingKey,
-              kMaskingKey + WebSocketFrameHeader::kMaskingKeyLength,
-              masking_key.key);
     base::PerfTimeLogger timer(name);
     for (int x = 0; x < kIterations; ++x) {
       MaskWebSocketFramePayload(
-          masking_key, x % size, &scratch.front(), scratch.size());
+          masking_key_, x % size, &scratch.front(), scratch.size());
     }
     timer.Done();
   }
+
+  // Masks payloads of each power of four size from 16 bytes to 16 MB, in
+  // place or while copying them to a separate buffer.
+  void BenchmarkPayloadSizes(const std::string& name, bool copy) {
+    for (int size = 16; size <= 16 << 20; size *= 4) {
+      std::vector<char> source(size, 'a');
+      std::vector<char> dest(size);
+      const int64 iterations =
+          std::max<int64>(1, kBytesPerSizeBenchmark / size);
+      base::PerfTimeLogger timer(
+          (name + "_" + base::IntToString(size)).c_str());
+      for (int64 x = 0; x < iterations; ++x) {
+        if (copy) {
+          CopyAndMaskWebSocketFramePayload(
+              masking_key_, x, &source.front(), &dest.front(), size);
+        } else {
+          MaskWebSocketFramePayload(masking_key_, x, &source.front(), size);
+        }
+      }
+      timer.Done();
+    }
+  }
+
+  WebSocketMaskingKey masking_key_;
 };
 
 TEST_F(WebSocketFrameTestMaskBenchmark, BenchmarkMaskShortPayload) {
@@ -53,6 +84,14 @@ TEST_F(WebSocketFrameTestMaskBenchmark, BenchmarkMaskLongPayload) {
   Benchmark("Frame_mask_long_payload", &payload.front(), payload.size());
 }
 
+TEST_F(WebSocketFrameTestMaskBenchmark, BenchmarkMaskPayloadSizes) {
+  BenchmarkPayloadSizes("Frame_mask_payload", false);
+}
+
+TEST_F(WebSocketFrameTestMaskBenchmark, BenchmarkCopyAndMaskPayloadSizes) {
+  BenchmarkPayloadSizes("Frame_copy_and_mask_payload", true);
+}
+
 }  // namespace
 
 }  // namespace net
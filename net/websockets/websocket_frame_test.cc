@@ -330,6 +330,53 @@ TEST(WebSocketFrameTest, MaskPayloadAlignment) {
   }
 }
 
+// Check CopyAndMaskWebSocketFramePayload() against a byte-at-a-time reference
+// for all combinations of source and destination alignment, frame offset and
+// sizes large enough to use the vectorised path.
+TEST(WebSocketFrameTest, CopyAndMaskPayloadAlignment) {
+  static const size_t kMaxVectorAlignment = 32;
+  static const size_t kMaxDataSize = 200;
+  static const size_t kMaskingKeyLength =
+      WebSocketFrameHeader::kMaskingKeyLength;
+  static const size_t kScratchBufferSize = kMaxVectorAlignment + kMaxDataSize;
+  static const char kTestMask[] = "\x7e\x11\xa3\x5c";
+
+  scoped_ptr<char, base::AlignedFreeDeleter> source(static_cast<char*>(
+      base::AlignedAlloc(kScratchBufferSize, kMaxVectorAlignment)));
+  scoped_ptr<char, base::AlignedFreeDeleter> dest(static_cast<char*>(
+      base::AlignedAlloc(kScratchBufferSize, kMaxVectorAlignment)));
+  for (size_t i = 0; i < kScratchBufferSize; ++i) {
+    source.get()[i] = static_cast<char>(i * 131 + 7);
+  }
+  WebSocketMaskingKey masking_key;
+  std::copy(kTestMask, kTestMask + kMaskingKeyLength, masking_key.key);
+
+  std::vector<char> expected(kMaxDataSize);
+  for (size_t frame_offset = 0; frame_offset < kMaskingKeyLength;
+       ++frame_offset) {
+    for (size_t source_alignment = 0; source_alignment < kMaxVectorAlignment;
+         ++source_alignment) {
+      for (size_t dest_alignment = 0; dest_alignment < kMaxVectorAlignment;
+           dest_alignment += 3) {
+        for (size_t size = 0; size <= kMaxDataSize; size += 7) {
+          const char* const data = source.get() + source_alignment;
+          for (size_t i = 0; i < size; ++i) {
+            expected[i] =
+                data[i] ^ kTestMask[(frame_offset + i) % kMaskingKeyLength];
+          }
+          char* const masked = dest.get() + dest_alignment;
+          CopyAndMaskWebSocketFramePayload(
+              masking_key, frame_offset, data, masked, static_cast<int>(size));
+          ASSERT_TRUE(std::equal(masked, masked + size, expected.begin()))
+              << "Output failed to match for frame_offset=" << frame_offset
+              << ", source_alignment=" << source_alignment
+              << ", dest_alignment=" << dest_alignment << ", size=" << size;
+        }
+      }
+    }
+  }
+}
+
 // "IsKnownDataOpCode" is currently implemented in an "obviously correct"
 // manner, but we test is anyway in case it changes to a more complex
 // implementation in future.
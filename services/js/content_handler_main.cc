@@ -2,8 +2,11 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/files/file_path.h"
 #include "base/i18n/icu_util.h"
+#include "base/strings/string_util.h"
 #include "gin/array_buffer.h"
+#include "gin/code_cache.h"
 #include "gin/public/isolate_holder.h"
 #include "mojo/application/application_runner_chromium.h"
 #include "mojo/application/content_handler_factory.h"
@@ -15,6 +18,14 @@
 namespace mojo {
 namespace js {
 
+namespace {
+
+// Persists compiled code for app and module scripts in the given directory,
+// e.g. --args-for='mojo:js_content_handler --js-code-cache-dir=/tmp/cache'.
+const char kJSCodeCacheDir[] = "--js-code-cache-dir=";
+
+}  // namespace
+
 class JsContentHandler : public ApplicationDelegate,
                          public ContentHandlerFactory::ManagedDelegate {
  public:
@@ -26,6 +37,14 @@ class JsContentHandler : public ApplicationDelegate,
     base::i18n::InitializeICU();
     gin::IsolateHolder::Initialize(gin::IsolateHolder::kStrictMode,
                                    gin::ArrayBufferAllocator::SharedInstance());
+
+    const std::vector<std::string>& args = app->args();
+    for (size_t i = 0; i < args.size(); ++i) {
+      if (StartsWithASCII(args[i], kJSCodeCacheDir, true)) {
+        code_cache_.reset(new gin::CodeCache(base::FilePath(
+            args[i].substr(arraysize(kJSCodeCacheDir) - 1))));
+      }
+    }
   }
 
   // Overridden from ApplicationDelegate:
@@ -38,10 +57,12 @@ class JsContentHandler : public ApplicationDelegate,
   scoped_ptr<ContentHandlerFactory::HandledApplicationHolder> CreateApplication(
       ShellPtr shell,
       URLResponsePtr response) override {
-    return make_scoped_ptr(new JSApp(shell.Pass(), response.Pass()));
+    return make_scoped_ptr(
+        new JSApp(shell.Pass(), response.Pass(), code_cache_.get()));
   }
 
   ContentHandlerFactory content_handler_factory_;
+  scoped_ptr<gin::CodeCache> code_cache_;
 
   DISALLOW_COPY_AND_ASSIGN(JsContentHandler);
 };
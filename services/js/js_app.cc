@@ -22,7 +22,10 @@ namespace js {
 
 const char JSApp::kMainModuleName[] = "main";
 
-JSApp::JSApp(ShellPtr shell, URLResponsePtr response) : shell_(shell.Pass()) {
+JSApp::JSApp(ShellPtr shell,
+             URLResponsePtr response,
+             gin::CodeCache* code_cache)
+    : shell_(shell.Pass()) {
   isolate_holder_.AddRunMicrotasksObserver();
 
   DCHECK(!response.is_null());
@@ -32,6 +35,7 @@ JSApp::JSApp(ShellPtr shell, URLResponsePtr response) : shell_(shell.Pass()) {
 
   v8::Isolate* isolate = isolate_holder_.isolate();
   shell_runner_.reset(new gin::ShellRunner(&runner_delegate_, isolate));
+  shell_runner_->set_code_cache(code_cache);
   gin::Runner::Scope scope(shell_runner_.get());
   shell_runner_->Run(source.c_str(), kMainModuleName);
 
@@ -26,7 +26,8 @@ class ApplicationDelegateImpl;
 class JSApp : public InterfaceImpl<Application>,
               public ContentHandlerFactory::HandledApplicationHolder {
  public:
-  JSApp(ShellPtr shell, URLResponsePtr response);
+  // |code_cache| may be NULL. If not, it must outlive this JSApp.
+  JSApp(ShellPtr shell, URLResponsePtr response, gin::CodeCache* code_cache);
   virtual ~JSApp();
 
   // This method just delegates to shell_->ConnectToApplication().
@@ -29,6 +29,47 @@
 #  define PUP(a) *++(a)
 #endif
 
+/*
+   Google: copies len bytes of a match that starts dist >= 8 bytes back in
+   the output eight bytes at a time. Each chunk is read entirely from bytes
+   that were written before it, but the last one may write up to seven bytes
+   past the end of the match, so the caller must make sure that there is that
+   much room left in the output buffer. Those bytes are overwritten by the
+   codes that follow, or left unused past strm->next_out.
+ */
+#define CHUNK_COPY(out, from, len) \
+    do { \
+        unsigned char FAR *to_ = (out) + OFF; \
+        unsigned char FAR *from_ = (from) + OFF; \
+        (out) += (len); \
+        do { \
+            zmemcpy(to_, from_, 8); \
+            to_ += 8; \
+            from_ += 8; \
+        } while (to_ < (out) + OFF); \
+    } while (0)
+
+/*
+   Google: copies len > 0 bytes of a match from the sliding window.
+   inflateBack() decodes straight into its window, so there the bytes copied
+   and the bytes written may overlap, and they are copied one at a time, in
+   order. CHUNK_COPY() is not used there either, since the bytes past the end
+   of the output are the oldest part of the window, still to be matched.
+ */
+#define WINDOW_COPY(out, from, len) \
+    do { \
+        if (window_out) { \
+            unsigned n_ = (len); \
+            do { \
+                PUP(out) = PUP(from); \
+            } while (--n_); \
+        } \
+        else { \
+            zmemcpy((out) + OFF, (from) + OFF, (len)); \
+            (out) += (len); \
+        } \
+    } while (0)
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -74,6 +115,7 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     unsigned char FAR *out;     /* local strm->next_out */
     unsigned char FAR *beg;     /* inflate()'s initial strm->next_out */
     unsigned char FAR *end;     /* while out < end, enough space available */
+    unsigned char FAR *limit;   /* Google: end of the output buffer */
 #ifdef INFLATE_STRICT
     unsigned dmax;              /* maximum distance from zlib header */
 #endif
@@ -81,6 +123,7 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     unsigned whave;             /* valid bytes in the window */
     unsigned wnext;             /* window write index */
     unsigned char FAR *window;  /* allocated sliding window, if wsize != 0 */
+    int window_out;             /* Google: output is in the window */
     unsigned long hold;         /* local strm->hold */
     unsigned bits;              /* local strm->bits */
     code const FAR *lcode;      /* local strm->lencode */
@@ -93,6 +136,7 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     unsigned len;               /* match length, unused bytes */
     unsigned dist;              /* match distance */
     unsigned char FAR *from;    /* where to copy match from */
+    int from_out;               /* Google: rest of match is from output */
 
     /* copy state to local variables */
     state = (struct inflate_state FAR *)strm->state;
@@ -101,6 +145,7 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     out = strm->next_out - OFF;
     beg = out - (start - strm->avail_out);
     end = out + (strm->avail_out - 257);
+    limit = out + strm->avail_out;
 #ifdef INFLATE_STRICT
     dmax = state->dmax;
 #endif
@@ -108,6 +153,8 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
     whave = state->whave;
     wnext = state->wnext;
     window = state->window;
+    window_out = wsize != 0 && strm->next_out >= window &&
+                 strm->next_out < window + wsize;
     hold = state->hold;
     bits = state->bits;
     lcode = state->lencode;
@@ -214,14 +261,14 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
 #endif
                     }
                     from = window - OFF;
+                    from_out = 0;
                     if (wnext == 0) {           /* very common case */
                         from += wsize - op;
                         if (op < len) {         /* some from window */
                             len -= op;
-                            do {
-                                PUP(out) = PUP(from);
-                            } while (--op);
+                            WINDOW_COPY(out, from, op);
                             from = out - dist;  /* rest from output */
+                            from_out = 1;
                         }
                     }
                     else if (wnext < op) {      /* wrap around window */
@@ -229,17 +276,14 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                         op -= wnext;
                         if (op < len) {         /* some from end of window */
                             len -= op;
-                            do {
-                                PUP(out) = PUP(from);
-                            } while (--op);
+                            WINDOW_COPY(out, from, op);
                             from = window - OFF;
                             if (wnext < len) {  /* some from start of window */
                                 op = wnext;
                                 len -= op;
-                                do {
-                                    PUP(out) = PUP(from);
-                                } while (--op);
+                                WINDOW_COPY(out, from, op);
                                 from = out - dist;      /* rest from output */
+                                from_out = 1;
                             }
                         }
                     }
@@ -247,12 +291,20 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                         from += wnext - op;
                         if (op < len) {         /* some from window */
                             len -= op;
-                            do {
-                                PUP(out) = PUP(from);
-                            } while (--op);
+                            WINDOW_COPY(out, from, op);
                             from = out - dist;  /* rest from output */
+                            from_out = 1;
                         }
                     }
+                    if (!from_out) {            /* rest all from window */
+                        WINDOW_COPY(out, from, len);
+                        continue;
+                    }
+                    if (!window_out && dist >= 8 &&
+                        len + 8 <= (unsigned)(limit - out)) {
+                        CHUNK_COPY(out, from, len);
+                        continue;
+                    }
                     while (len > 2) {
                         PUP(out) = PUP(from);
                         PUP(out) = PUP(from);
@@ -267,6 +319,11 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                 }
                 else {
                     from = out - dist;          /* copy direct from output */
+                    if (!window_out && dist >= 8 &&
+                        len + 8 <= (unsigned)(limit - out)) {
+                        CHUNK_COPY(out, from, len);
+                        continue;
+                    }
                     do {                        /* minimum length is three */
                         PUP(out) = PUP(from);
                         PUP(out) = PUP(from);
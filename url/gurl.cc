@@ -59,19 +59,28 @@ const std::string& EmptyStringForGURL() {
 
 #endif  // WIN32
 
+size_t HashSpec(const std::string& spec) {
+  return BASE_HASH_NAMESPACE::hash<std::string>()(spec);
+}
+
 } // namespace
 
-GURL::GURL() : is_valid_(false) {
+GURL::Rep::Rep() : is_valid(false), hash(0) {
+}
+
+GURL::Rep::~Rep() {
+}
+
+GURL::GURL() {
+}
+
+GURL::GURL(const GURL& other) : rep_(other.rep_) {
 }
 
-GURL::GURL(const GURL& other)
-    : spec_(other.spec_),
-      is_valid_(other.is_valid_),
-      parsed_(other.parsed_) {
-  if (other.inner_url_)
-    inner_url_.reset(new GURL(*other.inner_url_));
-  // Valid filesystem urls should always have an inner_url_.
-  DCHECK(!is_valid_ || !SchemeIsFileSystem() || inner_url_);
+GURL::GURL(EmptyRepSelector) {
+  scoped_refptr<Rep> rep(new Rep);
+  rep->hash = HashSpec(rep->spec);
+  rep_ = rep;
 }
 
 GURL::GURL(const std::string& url_string) {
@@ -89,73 +98,71 @@ GURL::GURL(const std::string& url_string, RetainWhiteSpaceSelector) {
 GURL::GURL(const char* canonical_spec,
            size_t canonical_spec_len,
            const url::Parsed& parsed,
-           bool is_valid)
-    : spec_(canonical_spec, canonical_spec_len),
-      is_valid_(is_valid),
-      parsed_(parsed) {
-  InitializeFromCanonicalSpec();
+           bool is_valid) {
+  scoped_refptr<Rep> rep(new Rep);
+  rep->spec.assign(canonical_spec, canonical_spec_len);
+  rep->is_valid = is_valid;
+  rep->parsed = parsed;
+  InitializeFromCanonicalSpec(rep.get());
 }
 
-GURL::GURL(std::string canonical_spec, const url::Parsed& parsed, bool is_valid)
-    : is_valid_(is_valid),
-      parsed_(parsed) {
-  spec_.swap(canonical_spec);
-  InitializeFromCanonicalSpec();
+GURL::GURL(std::string canonical_spec,
+           const url::Parsed& parsed,
+           bool is_valid) {
+  scoped_refptr<Rep> rep(new Rep);
+  rep->spec.swap(canonical_spec);
+  rep->is_valid = is_valid;
+  rep->parsed = parsed;
+  InitializeFromCanonicalSpec(rep.get());
 }
 
 template<typename STR>
 void GURL::InitCanonical(const STR& input_spec, bool trim_path_end) {
+  scoped_refptr<Rep> rep(new Rep);
   // Reserve enough room in the output for the input, plus some extra so that
   // we have room if we have to escape a few things without reallocating.
-  spec_.reserve(input_spec.size() + 32);
-  url::StdStringCanonOutput output(&spec_);
-  is_valid_ = url::Canonicalize(
+  rep->spec.reserve(input_spec.size() + 32);
+  url::StdStringCanonOutput output(&rep->spec);
+  rep->is_valid = url::Canonicalize(
       input_spec.data(), static_cast<int>(input_spec.length()), trim_path_end,
-      NULL, &output, &parsed_);
+      NULL, &output, &rep->parsed);
 
   output.Complete();  // Must be done before using string.
-  if (is_valid_ && SchemeIsFileSystem()) {
-    inner_url_.reset(new GURL(spec_.data(), parsed_.Length(),
-                              *parsed_.inner_parsed(), true));
-  }
+  InitRep(rep.get());
 }
 
-void GURL::InitializeFromCanonicalSpec() {
-  if (is_valid_ && SchemeIsFileSystem()) {
-    inner_url_.reset(
-        new GURL(spec_.data(), parsed_.Length(),
-                 *parsed_.inner_parsed(), true));
-  }
+void GURL::InitializeFromCanonicalSpec(Rep* rep) {
+  InitRep(rep);
 
 #ifndef NDEBUG
   // For testing purposes, check that the parsed canonical URL is identical to
   // what we would have produced. Skip checking for invalid URLs have no meaning
   // and we can't always canonicalize then reproducabely.
-  if (is_valid_) {
+  if (rep->is_valid) {
     url::Component scheme;
     // We can't do this check on the inner_url of a filesystem URL, as
     // canonical_spec actually points to the start of the outer URL, so we'd
     // end up with infinite recursion in this constructor.
-    if (!url::FindAndCompareScheme(spec_.data(), spec_.length(),
+    if (!url::FindAndCompareScheme(rep->spec.data(), rep->spec.length(),
                                    url::kFileSystemScheme, &scheme) ||
-        scheme.begin == parsed_.scheme.begin) {
-      // We need to retain trailing whitespace on path URLs, as the |parsed_|
+        scheme.begin == rep->parsed.scheme.begin) {
+      // We need to retain trailing whitespace on path URLs, as the |parsed|
       // spec we originally received may legitimately contain trailing white-
       // space on the path or  components e.g. if the #ref has been
       // removed from a "foo:hello #ref" URL (see http://crbug.com/291747).
-      GURL test_url(spec_, RETAIN_TRAILING_PATH_WHITEPACE);
-
-      DCHECK(test_url.is_valid_ == is_valid_);
-      DCHECK(test_url.spec_ == spec_);
-
-      DCHECK(test_url.parsed_.scheme == parsed_.scheme);
-      DCHECK(test_url.parsed_.username == parsed_.username);
-      DCHECK(test_url.parsed_.password == parsed_.password);
-      DCHECK(test_url.parsed_.host == parsed_.host);
-      DCHECK(test_url.parsed_.port == parsed_.port);
-      DCHECK(test_url.parsed_.path == parsed_.path);
-      DCHECK(test_url.parsed_.query == parsed_.query);
-      DCHECK(test_url.parsed_.ref == parsed_.ref);
+      GURL test_url(rep->spec, RETAIN_TRAILING_PATH_WHITEPACE);
+
+      DCHECK(test_url.is_valid() == rep->is_valid);
+      DCHECK(test_url.rep().spec == rep->spec);
+
+      DCHECK(test_url.rep().parsed.scheme == rep->parsed.scheme);
+      DCHECK(test_url.rep().parsed.username == rep->parsed.username);
+      DCHECK(test_url.rep().parsed.password == rep->parsed.password);
+      DCHECK(test_url.rep().parsed.host == rep->parsed.host);
+      DCHECK(test_url.rep().parsed.port == rep->parsed.port);
+      DCHECK(test_url.rep().parsed.path == rep->parsed.path);
+      DCHECK(test_url.rep().parsed.query == rep->parsed.query);
+      DCHECK(test_url.rep().parsed.ref == rep->parsed.ref);
     }
   }
 #endif
@@ -164,14 +171,24 @@ void GURL::InitializeFromCanonicalSpec() {
 GURL::~GURL() {
 }
 
+void GURL::InitRep(Rep* rep) {
+  DCHECK(rep->HasOneRef());
+  rep_ = rep;
+  if (rep->is_valid && SchemeIsFileSystem()) {
+    rep->inner_url.reset(new GURL(rep->spec.data(), rep->parsed.Length(),
+                                  *rep->parsed.inner_parsed(), true));
+  }
+  rep->hash = HashSpec(rep->spec);
+}
+
 GURL& GURL::operator=(GURL other) {
   Swap(&other);
   return *this;
 }
 
 const std::string& GURL::spec() const {
-  if (is_valid_ || spec_.empty())
-    return spec_;
+  if (is_valid() || rep().spec.empty())
+    return rep().spec;
 
   DCHECK(false) << "Trying to get the spec of an invalid URL!";
   return EmptyStringForGURL();
@@ -189,31 +206,29 @@ GURL GURL::ResolveWithCharsetConverter(
     const std::string& relative,
     url::CharsetConverter* charset_converter) const {
   // Not allowed for invalid URLs.
-  if (!is_valid_)
+  if (!is_valid())
     return GURL();
 
-  GURL result;
+  scoped_refptr<Rep> rep(new Rep);
 
   // Reserve enough room in the output for the input, plus some extra so that
   // we have room if we have to escape a few things without reallocating.
-  result.spec_.reserve(spec_.size() + 32);
-  url::StdStringCanonOutput output(&result.spec_);
+  rep->spec.reserve(rep_->spec.size() + 32);
+  url::StdStringCanonOutput output(&rep->spec);
 
-  if (!url::ResolveRelative(spec_.data(), static_cast<int>(spec_.length()),
-                            parsed_, relative.data(),
+  if (!url::ResolveRelative(rep_->spec.data(),
+                            static_cast<int>(rep_->spec.length()),
+                            rep_->parsed, relative.data(),
                             static_cast<int>(relative.length()),
-                            charset_converter, &output, &result.parsed_)) {
+                            charset_converter, &output, &rep->parsed)) {
     // Error resolving, return an empty URL.
     return GURL();
   }
 
   output.Complete();
-  result.is_valid_ = true;
-  if (result.SchemeIsFileSystem()) {
-    result.inner_url_.reset(
-        new GURL(result.spec_.data(), result.parsed_.Length(),
-                 *result.parsed_.inner_parsed(), true));
-  }
+  rep->is_valid = true;
+  GURL result;
+  result.InitRep(rep.get());
   return result;
 }
 
@@ -222,94 +237,88 @@ GURL GURL::ResolveWithCharsetConverter(
     const base::string16& relative,
     url::CharsetConverter* charset_converter) const {
   // Not allowed for invalid URLs.
-  if (!is_valid_)
+  if (!is_valid())
     return GURL();
 
-  GURL result;
+  scoped_refptr<Rep> rep(new Rep);
 
   // Reserve enough room in the output for the input, plus some extra so that
   // we have room if we have to escape a few things without reallocating.
-  result.spec_.reserve(spec_.size() + 32);
-  url::StdStringCanonOutput output(&result.spec_);
+  rep->spec.reserve(rep_->spec.size() + 32);
+  url::StdStringCanonOutput output(&rep->spec);
 
-  if (!url::ResolveRelative(spec_.data(), static_cast<int>(spec_.length()),
-                            parsed_, relative.data(),
+  if (!url::ResolveRelative(rep_->spec.data(),
+                            static_cast<int>(rep_->spec.length()),
+                            rep_->parsed, relative.data(),
                             static_cast<int>(relative.length()),
-                            charset_converter, &output, &result.parsed_)) {
+                            charset_converter, &output, &rep->parsed)) {
     // Error resolving, return an empty URL.
     return GURL();
   }
 
   output.Complete();
-  result.is_valid_ = true;
-  if (result.SchemeIsFileSystem()) {
-    result.inner_url_.reset(
-        new GURL(result.spec_.data(), result.parsed_.Length(),
-                 *result.parsed_.inner_parsed(), true));
-  }
+  rep->is_valid = true;
+  GURL result;
+  result.InitRep(rep.get());
   return result;
 }
 
 // Note: code duplicated below (it's inconvenient to use a template here).
 GURL GURL::ReplaceComponents(
     const url::Replacements<char>& replacements) const {
-  GURL result;
-
   // Not allowed for invalid URLs.
-  if (!is_valid_)
+  if (!is_valid())
     return GURL();
 
+  scoped_refptr<Rep> rep(new Rep);
+
   // Reserve enough room in the output for the input, plus some extra so that
   // we have room if we have to escape a few things without reallocating.
-  result.spec_.reserve(spec_.size() + 32);
-  url::StdStringCanonOutput output(&result.spec_);
+  rep->spec.reserve(rep_->spec.size() + 32);
+  url::StdStringCanonOutput output(&rep->spec);
 
-  result.is_valid_ = url::ReplaceComponents(
-      spec_.data(), static_cast<int>(spec_.length()), parsed_, replacements,
-      NULL, &output, &result.parsed_);
+  rep->is_valid = url::ReplaceComponents(
+      rep_->spec.data(), static_cast<int>(rep_->spec.length()), rep_->parsed,
+      replacements, NULL, &output, &rep->parsed);
 
   output.Complete();
-  if (result.is_valid_ && result.SchemeIsFileSystem()) {
-    result.inner_url_.reset(new GURL(spec_.data(), result.parsed_.Length(),
-                                     *result.parsed_.inner_parsed(), true));
-  }
+  GURL result;
+  result.InitRep(rep.get());
   return result;
 }
 
 // Note: code duplicated above (it's inconvenient to use a template here).
 GURL GURL::ReplaceComponents(
     const url::Replacements<base::char16>& replacements) const {
-  GURL result;
-
   // Not allowed for invalid URLs.
-  if (!is_valid_)
+  if (!is_valid())
     return GURL();
 
+  scoped_refptr<Rep> rep(new Rep);
+
   // Reserve enough room in the output for the input, plus some extra so that
   // we have room if we have to escape a few things without reallocating.
-  result.spec_.reserve(spec_.size() + 32);
-  url::StdStringCanonOutput output(&result.spec_);
+  rep->spec.reserve(rep_->spec.size() + 32);
+  url::StdStringCanonOutput output(&rep->spec);
 
-  result.is_valid_ = url::ReplaceComponents(
-      spec_.data(), static_cast<int>(spec_.length()), parsed_, replacements,
-      NULL, &output, &result.parsed_);
+  rep->is_valid = url::ReplaceComponents(
+      rep_->spec.data(), static_cast<int>(rep_->spec.length()), rep_->parsed,
+      replacements, NULL, &output, &rep->parsed);
 
   output.Complete();
-  if (result.is_valid_ && result.SchemeIsFileSystem()) {
-    result.inner_url_.reset(new GURL(spec_.data(), result.parsed_.Length(),
-                                     *result.parsed_.inner_parsed(), true));
-  }
+  GURL result;
+  result.InitRep(rep.get());
   return result;
 }
 
 GURL GURL::GetOrigin() const {
   // This doesn't make sense for invalid or nonstandard URLs, so return
   // the empty URL
-  if (!is_valid_ || !IsStandard())
+  if (!is_valid() || !IsStandard())
     return GURL();
 
   if (SchemeIsFileSystem())
-    return inner_url_->GetOrigin();
+    return inner_url()->GetOrigin();
 
   url::Replacements<char> replacements;
   replacements.ClearUsername();
@@ -322,7 +331,7 @@ GURL GURL::GetOrigin() const {
 }
 
 GURL GURL::GetAsReferrer() const {
-  if (!is_valid_ ||
+  if (!is_valid() ||
       (!has_ref() && !has_username() && !has_password()))
     return GURL(*this);
 
@@ -336,36 +345,44 @@ GURL GURL::GetAsReferrer() const {
 GURL GURL::GetWithEmptyPath() const {
   // This doesn't make sense for invalid or nonstandard URLs, so return
   // the empty URL.
-  if (!is_valid_ || !IsStandard())
+  if (!is_valid() || !IsStandard())
     return GURL();
 
   // We could optimize this since we know that the URL is canonical, and we are
   // appending a canonical path, so avoiding re-parsing.
-  GURL other(*this);
-  if (parsed_.path.len == 0)
-    return other;
+  if (rep_->parsed.path.len == 0)
+    return *this;
+
+  scoped_refptr<Rep> rep(new Rep);
+  rep->is_valid = true;
+  rep->parsed = rep_->parsed;
 
   // Clear everything after the path.
-  other.parsed_.query.reset();
-  other.parsed_.ref.reset();
-
-  // Set the path, since the path is longer than one, we can just set the
-  // first character and resize.
-  other.spec_[other.parsed_.path.begin] = '/';
-  other.parsed_.path.len = 1;
-  other.spec_.resize(other.parsed_.path.begin + 1);
+  rep->parsed.query.reset();
+  rep->parsed.ref.reset();
+
+  // Set the path, since the path is longer than one, we can just copy the
+  // spec up to it and append a slash.
+  rep->spec.reserve(rep->parsed.path.begin + 1);
+  rep->spec.assign(rep_->spec, 0, rep->parsed.path.begin);
+  rep->spec.push_back('/');
+  rep->parsed.path.len = 1;
+
+  GURL other;
+  other.InitRep(rep.get());
   return other;
 }
 
 bool GURL::IsStandard() const {
-  return url::IsStandard(spec_.data(), parsed_.scheme);
+  return url::IsStandard(rep().spec.data(), rep().parsed.scheme);
 }
 
 bool GURL::SchemeIs(const char* lower_ascii_scheme) const {
-  if (parsed_.scheme.len <= 0)
+  const url::Component& scheme = rep().parsed.scheme;
+  if (scheme.len <= 0)
     return lower_ascii_scheme == NULL;
-  return url::LowerCaseEqualsASCII(spec_.data() + parsed_.scheme.begin,
-                                   spec_.data() + parsed_.scheme.end(),
+  return url::LowerCaseEqualsASCII(rep().spec.data() + scheme.begin,
+                                   rep().spec.data() + scheme.end(),
                                    lower_ascii_scheme);
 }
 
@@ -378,47 +395,50 @@ bool GURL::SchemeIsWSOrWSS() const {
 }
 
 int GURL::IntPort() const {
-  if (parsed_.port.is_nonempty())
-    return url::ParsePort(spec_.data(), parsed_.port);
+  if (rep().parsed.port.is_nonempty())
+    return url::ParsePort(rep().spec.data(), rep().parsed.port);
   return url::PORT_UNSPECIFIED;
 }
 
 int GURL::EffectiveIntPort() const {
   int int_port = IntPort();
   if (int_port == url::PORT_UNSPECIFIED && IsStandard())
-    return url::DefaultPortForScheme(spec_.data() + parsed_.scheme.begin,
-                                     parsed_.scheme.len);
+    return url::DefaultPortForScheme(
+        rep().spec.data() + rep().parsed.scheme.begin,
+        rep().parsed.scheme.len);
   return int_port;
 }
 
 std::string GURL::ExtractFileName() const {
   url::Component file_component;
-  url::ExtractFileName(spec_.data(), parsed_.path, &file_component);
+  url::ExtractFileName(rep().spec.data(), rep().parsed.path, &file_component);
   return ComponentString(file_component);
 }
 
 std::string GURL::PathForRequest() const {
-  DCHECK(parsed_.path.len > 0) << "Canonical path for requests should be non-empty";
-  if (parsed_.ref.len >= 0) {
+  DCHECK(rep().parsed.path.len > 0)
+      << "Canonical path for requests should be non-empty";
+  if (rep().parsed.ref.len >= 0) {
     // Clip off the reference when it exists. The reference starts after the #
     // sign, so we have to subtract one to also remove it.
-    return std::string(spec_, parsed_.path.begin,
-                       parsed_.ref.begin - parsed_.path.begin - 1);
+    return std::string(rep().spec, rep().parsed.path.begin,
+                       rep().parsed.ref.begin - rep().parsed.path.begin - 1);
   }
   // Compute the actual path length, rather than depending on the spec's
   // terminator.  If we're an inner_url, our spec continues on into our outer
   // url's path/query/ref.
-  int path_len = parsed_.path.len;
-  if (parsed_.query.is_valid())
-    path_len = parsed_.query.end() - parsed_.path.begin;
+  int path_len = rep().parsed.path.len;
+  if (rep().parsed.query.is_valid())
+    path_len = rep().parsed.query.end() - rep().parsed.path.begin;
 
-  return std::string(spec_, parsed_.path.begin, path_len);
+  return std::string(rep().spec, rep().parsed.path.begin, path_len);
 }
 
 std::string GURL::HostNoBrackets() const {
   // If host looks like an IPv6 literal, strip the square brackets.
-  url::Component h(parsed_.host);
-  if (h.len >= 2 && spec_[h.begin] == '[' && spec_[h.end() - 1] == ']') {
+  url::Component h(rep().parsed.host);
+  const std::string& spec = rep().spec;
+  if (h.len >= 2 && spec[h.begin] == '[' && spec[h.end() - 1] == ']') {
     h.begin++;
     h.len -= 2;
   }
@@ -426,17 +446,18 @@ std::string GURL::HostNoBrackets() const {
 }
 
 std::string GURL::GetContent() const {
-  return is_valid_ ? ComponentString(parsed_.GetContent()) : std::string();
+  return is_valid() ? ComponentString(rep().parsed.GetContent())
+                    : std::string();
 }
 
 bool GURL::HostIsIPAddress() const {
-  if (!is_valid_ || spec_.empty())
+  if (!is_valid() || rep().spec.empty())
      return false;
 
   url::RawCanonOutputT<char, 128> ignored_output;
   url::CanonHostInfo host_info;
-  url::CanonicalizeIPAddress(spec_.c_str(), parsed_.host, &ignored_output,
-                             &host_info);
+  url::CanonicalizeIPAddress(rep().spec.c_str(), rep().parsed.host,
+                             &ignored_output, &host_info);
   return host_info.IsIPAddress();
 }
 
@@ -447,7 +468,7 @@ const GURL& GURL::EmptyGURL() {
   if (!empty_gurl) {
     // Create the string. Be careful that we don't break in the case that this
     // is being called from multiple threads.
-    GURL* new_empty_gurl = new GURL;
+    GURL* new_empty_gurl = new GURL(EMPTY_REP);
     if (InterlockedCompareExchangePointer(
         reinterpret_cast<PVOID*>(&empty_gurl), new_empty_gurl, NULL)) {
       // The old value was non-NULL, so no replacement was done. Another
@@ -460,13 +481,14 @@ const GURL& GURL::EmptyGURL() {
 
 #else
 
-void EmptyGURLOnce(void) {
-  empty_gurl = new GURL;
+// static
+void GURL::EmptyGURLOnce() {
+  empty_gurl = new GURL(EMPTY_REP);
 }
 
 const GURL& GURL::EmptyGURL() {
   // Avoid static object construction/destruction on startup/shutdown.
-  pthread_once(&empty_gurl_once, EmptyGURLOnce);
+  pthread_once(&empty_gurl_once, &GURL::EmptyGURLOnce);
   return *empty_gurl;
 }
 
@@ -475,21 +497,21 @@ const GURL& GURL::EmptyGURL() {
 bool GURL::DomainIs(const char* lower_ascii_domain,
                     int domain_len) const {
   // Return false if this URL is not valid or domain is empty.
-  if (!is_valid_ || !domain_len)
+  if (!is_valid() || !domain_len)
     return false;
 
-  // FileSystem URLs have empty parsed_.host, so check this first.
-  if (SchemeIsFileSystem() && inner_url_)
-    return inner_url_->DomainIs(lower_ascii_domain, domain_len);
+  // FileSystem URLs have empty parsed.host, so check this first.
+  if (SchemeIsFileSystem() && inner_url())
+    return inner_url()->DomainIs(lower_ascii_domain, domain_len);
 
-  if (!parsed_.host.is_nonempty())
+  if (!rep().parsed.host.is_nonempty())
     return false;
 
   // Check whether the host name is end with a dot. If yes, treat it
   // the same as no-dot unless the input comparison domain is end
   // with dot.
-  const char* last_pos = spec_.data() + parsed_.host.end() - 1;
-  int host_len = parsed_.host.len;
+  const char* last_pos = rep().spec.data() + rep().parsed.host.end() - 1;
+  int host_len = rep().parsed.host.len;
   if ('.' == *last_pos && '.' != lower_ascii_domain[domain_len - 1]) {
     last_pos--;
     host_len--;
@@ -500,7 +522,7 @@ bool GURL::DomainIs(const char* lower_ascii_domain,
     return false;
 
   // Compare this url whether belong specific domain.
-  const char* start_pos = spec_.data() + parsed_.host.begin +
+  const char* start_pos = rep().spec.data() + rep().parsed.host.begin +
                           host_len - domain_len;
 
   if (!url::LowerCaseEqualsASCII(start_pos,
@@ -520,10 +542,7 @@ bool GURL::DomainIs(const char* lower_ascii_domain,
 }
 
 void GURL::Swap(GURL* other) {
-  spec_.swap(other->spec_);
-  std::swap(is_valid_, other->is_valid_);
-  std::swap(parsed_, other->parsed_);
-  inner_url_.swap(other->inner_url_);
+  rep_.swap(other->rep_);
 }
 
 std::ostream& operator<<(std::ostream& out, const GURL& url) {
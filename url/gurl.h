@@ -8,6 +8,9 @@
 #include <iosfwd>
 #include <string>
 
+#include "base/containers/hash_tables.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/strings/string16.h"
 #include "url/url_canon.h"
@@ -24,8 +27,9 @@ class URL_EXPORT GURL {
   // Creates an empty, invalid URL.
   GURL();
 
-  // Copy construction is relatively inexpensive, with most of the time going
-  // to reallocating the string. It does not re-parse.
+  // Copy construction is inexpensive: the copy shares the canonical spec and
+  // its components with |other| rather than duplicating them, and does not
+  // re-parse.
   GURL(const GURL& other);
 
   // The narrow version requires the input be UTF-8. Invalid UTF-8 input will
@@ -63,14 +67,14 @@ class URL_EXPORT GURL {
   // "reasonable looking" so that the user can see how it's busted if
   // displayed to them.
   bool is_valid() const {
-    return is_valid_;
+    return rep().is_valid;
   }
 
   // Returns true if the URL is zero-length. Note that empty URLs are also
   // invalid, and is_valid() will return false for them. This is provided
   // because some users may want to treat the empty case differently.
   bool is_empty() const {
-    return spec_.empty();
+    return rep().spec.empty();
   }
 
   // Returns the raw spec, i.e., the full text of the URL, in canonical UTF-8,
@@ -96,7 +100,7 @@ class URL_EXPORT GURL {
   //
   // The returned string is guaranteed to be valid UTF-8.
   const std::string& possibly_invalid_spec() const {
-    return spec_;
+    return rep().spec;
   }
 
   // Getter for the raw parsed structure. This allows callers to locate parts
@@ -108,23 +112,32 @@ class URL_EXPORT GURL {
   // SURE YOU ARE USING possibly_invalid_spec() to get the spec, and that you
   // don't do anything "important" with invalid specs.
   const url::Parsed& parsed_for_possibly_invalid_spec() const {
-    return parsed_;
+    return rep().parsed;
   }
 
-  // Defiant equality operator!
+  // Returns a hash of the spec, computed once when the URL was constructed.
+  // Equal URLs have equal hashes. See also the hash<GURL> specialization
+  // below, which allows GURL to be used as a key in a base::hash_map.
+  size_t hash() const {
+    return rep().hash;
+  }
+
+  // Defiant equality operator! Copies of the same URL compare equal without
+  // looking at the spec, and most unequal URLs are told apart by their hash.
   bool operator==(const GURL& other) const {
-    return spec_ == other.spec_;
+    return rep_ == other.rep_ ||
+        (rep().hash == other.rep().hash && rep().spec == other.rep().spec);
   }
   bool operator!=(const GURL& other) const {
-    return spec_ != other.spec_;
+    return !(*this == other);
   }
 
   // Allows GURL to used as a key in STL (for example, a std::set or std::map).
   bool operator<(const GURL& other) const {
-    return spec_ < other.spec_;
+    return rep().spec < other.rep().spec;
   }
   bool operator>(const GURL& other) const {
-    return spec_ > other.spec_;
+    return rep().spec > other.rep().spec;
   }
 
   // Resolves a URL that's possibly relative to this object's URL, and returns
@@ -254,31 +267,31 @@ class URL_EXPORT GURL {
   // Getters for various components of the URL. The returned string will be
   // empty if the component is empty or is not present.
   std::string scheme() const {  // Not including the colon. See also SchemeIs.
-    return ComponentString(parsed_.scheme);
+    return ComponentString(rep().parsed.scheme);
   }
   std::string username() const {
-    return ComponentString(parsed_.username);
+    return ComponentString(rep().parsed.username);
   }
   std::string password() const {
-    return ComponentString(parsed_.password);
+    return ComponentString(rep().parsed.password);
   }
   // Note that this may be a hostname, an IPv4 address, or an IPv6 literal
   // surrounded by square brackets, like "[2001:db8::1]".  To exclude these
   // brackets, use HostNoBrackets() below.
   std::string host() const {
-    return ComponentString(parsed_.host);
+    return ComponentString(rep().parsed.host);
   }
   std::string port() const {  // Returns -1 if "default"
-    return ComponentString(parsed_.port);
+    return ComponentString(rep().parsed.port);
   }
   std::string path() const {  // Including first slash following host
-    return ComponentString(parsed_.path);
+    return ComponentString(rep().parsed.path);
   }
   std::string query() const {  // Stuff following '?'
-    return ComponentString(parsed_.query);
+    return ComponentString(rep().parsed.query);
   }
   std::string ref() const {  // Stuff following '#'
-    return ComponentString(parsed_.ref);
+    return ComponentString(rep().parsed.ref);
   }
 
   // Existance querying. These functions will return true if the corresponding
@@ -286,31 +299,31 @@ class URL_EXPORT GURL {
   // being nonempty. http://www.google.com/? has a query that just happens to
   // be empty, and has_query() will return true.
   bool has_scheme() const {
-    return parsed_.scheme.len >= 0;
+    return rep().parsed.scheme.len >= 0;
   }
   bool has_username() const {
-    return parsed_.username.len >= 0;
+    return rep().parsed.username.len >= 0;
   }
   bool has_password() const {
-    return parsed_.password.len >= 0;
+    return rep().parsed.password.len >= 0;
   }
   bool has_host() const {
     // Note that hosts are special, absense of host means length 0.
-    return parsed_.host.len > 0;
+    return rep().parsed.host.len > 0;
   }
   bool has_port() const {
-    return parsed_.port.len >= 0;
+    return rep().parsed.port.len >= 0;
   }
   bool has_path() const {
     // Note that http://www.google.com/" has a path, the path is "/". This can
     // return false only for invalid or nonstandard URLs.
-    return parsed_.path.len >= 0;
+    return rep().parsed.path.len >= 0;
   }
   bool has_query() const {
-    return parsed_.query.len >= 0;
+    return rep().parsed.query.len >= 0;
   }
   bool has_ref() const {
-    return parsed_.ref.len >= 0;
+    return rep().parsed.ref.len >= 0;
   }
 
   // Returns a parsed version of the port. Can also be any of the special
@@ -365,7 +378,7 @@ class URL_EXPORT GURL {
   // Returns the inner URL of a nested URL [currently only non-null for
   // filesystem: URLs].
   const GURL* inner_url() const {
-    return inner_url_.get();
+    return rep().inner_url.get();
   }
 
  private:
@@ -377,31 +390,65 @@ class URL_EXPORT GURL {
   enum RetainWhiteSpaceSelector { RETAIN_TRAILING_PATH_WHITEPACE };
   GURL(const std::string& url_string, RetainWhiteSpaceSelector);
 
+  // The canonical spec of a URL and everything derived from it. A Rep is
+  // never modified once a GURL refers to it, so copies of a GURL share one
+  // Rep, on any thread.
+  struct URL_EXPORT Rep : public base::RefCountedThreadSafe<Rep> {
+    Rep();
+
+    // The actual text of the URL, in canonical ASCII form.
+    std::string spec;
+
+    // Set when the given URL is valid. Otherwise, we may still have a spec and
+    // components, but they may not identify valid resources (for example, an
+    // invalid port number, invalid characters in the scheme, etc.).
+    bool is_valid;
+
+    // Identified components of the canonical spec.
+    url::Parsed parsed;
+
+    // Used for nested schemes [currently only filesystem:].
+    scoped_ptr<GURL> inner_url;
+
+    // Hash of |spec|.
+    size_t hash;
+
+   private:
+    friend class base::RefCountedThreadSafe<Rep>;
+    ~Rep();
+
+    DISALLOW_COPY_AND_ASSIGN(Rep);
+  };
+
   template<typename STR>
   void InitCanonical(const STR& input_spec, bool trim_path_end);
 
-  void InitializeFromCanonicalSpec();
+  void InitializeFromCanonicalSpec(Rep* rep);
+
+  // Makes |rep|, which nothing else refers to yet, the representation of this
+  // URL, filling in its inner URL and hash.
+  void InitRep(Rep* rep);
+
+  // Constructs the URL returned by EmptyGURL(), whose Rep stands in for that
+  // of every default-constructed URL.
+  enum EmptyRepSelector { EMPTY_REP };
+  explicit GURL(EmptyRepSelector);
+  static void EmptyGURLOnce();
+
+  // Returns the representation of this URL. Default-constructed URLs have no
+  // Rep of their own and share the one of EmptyGURL() without referencing it.
+  const Rep& rep() const { return rep_.get() ? *rep_ : *EmptyGURL().rep_; }
 
   // Returns the substring of the input identified by the given component.
   std::string ComponentString(const url::Component& comp) const {
     if (comp.len <= 0)
       return std::string();
-    return std::string(spec_, comp.begin, comp.len);
+    return std::string(rep().spec, comp.begin, comp.len);
   }
 
-  // The actual text of the URL, in canonical ASCII form.
-  std::string spec_;
-
-  // Set when the given URL is valid. Otherwise, we may still have a spec and
-  // components, but they may not identify valid resources (for example, an
-  // invalid port number, invalid characters in the scheme, etc.).
-  bool is_valid_;
-
-  // Identified components of the canonical spec.
-  url::Parsed parsed_;
-
-  // Used for nested schemes [currently only filesystem:].
-  scoped_ptr<GURL> inner_url_;
+  // NULL for default-constructed URLs, so that making and destroying them,
+  // which happens everywhere, touches no reference count.
+  scoped_refptr<const Rep> rep_;
 
   // TODO bug 684583: Add encoding for query params.
 };
@@ -409,4 +456,16 @@ class URL_EXPORT GURL {
 // Stream operator so GURL can be used in assertion statements.
 URL_EXPORT std::ostream& operator<<(std::ostream& out, const GURL& url);
 
+// Provide a hash function so that hash_sets and maps can contain GURL objects.
+namespace BASE_HASH_NAMESPACE {
+
+template<>
+struct hash<GURL> {
+  size_t operator()(const GURL& url) const {
+    return url.hash();
+  }
+};
+
+}  // namespace BASE_HASH_NAMESPACE
+
 #endif  // URL_GURL_H_
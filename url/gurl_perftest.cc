@@ -0,0 +1,165 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "url/gurl.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/containers/hash_tables.h"
+#include "base/macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace {
+
+const int kIterations = 20000;
+const int kURLSetSize = 100000;
+const int kURLSetIterations = 10;
+
+// URLs of the shapes pages load most: resources with long clean paths, search
+// and tracking queries, and fragments. Most need no escaping, so parsing them
+// is dominated by the copies of their path, query and ref.
+const char* const kCorpus[] = {
+    "http://www.example.com/",
+    "https://www.example.com/static/js/application.bundle.min.js?v=1421778730",
+    "https://cdn.example.net/assets/images/products/2015/01/large/"
+    "stainless-steel-water-bottle-750ml.jpg",
+    "https://www.example.com/search?q=how+to+canonicalize+a+url&hl=en"
+    "&source=hp&ei=abcdefghijklmnop&oq=how+to+canonicalize&gs_l=psy-ab.1.0",
+    "http://news.example.org/world/2015/jan/20/"
+    "some-long-headline-for-an-article-about-something#comments",
+    "https://example.com/track?utm_source=newsletter&utm_medium=email"
+    "&utm_campaign=winter_sale&utm_content=header_link&session=8f3a9c2b7e",
+    "https://docs.example.com/document/d/1aBcDeFgHiJkLmNoPqRsTuVwXyZ/"
+    "edit#heading=h.abcdefghijkl",
+    "http://www.example.com/a/b/../c/./d.html?x=%20y#frag ment",
+};
+
+// Returns |kURLSetSize| distinct URLs shaped like the corpus.
+std::vector<GURL> MakeURLSet() {
+  std::vector<GURL> urls;
+  urls.reserve(kURLSetSize);
+  for (int i = 0; i < kURLSetSize; ++i) {
+    GURL url(kCorpus[i % arraysize(kCorpus)]);
+    GURL::Replacements replacements;
+    std::string path = url.path() + base::IntToString(i);
+    replacements.SetPathStr(path);
+    urls.push_back(url.ReplaceComponents(replacements));
+  }
+  return urls;
+}
+
+class GURLPerfTest : public ::testing::Test {
+ protected:
+  void PrintRate(const std::string& trace, base::TimeDelta elapsed) {
+    perf_test::PrintResult("gurl", "", trace,
+                           kIterations * arraysize(kCorpus) /
+                               elapsed.InSecondsF(),
+                           "urls/s", true);
+  }
+};
+
+TEST_F(GURLPerfTest, Parse) {
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < arraysize(kCorpus); ++j) {
+      GURL url(kCorpus[j]);
+      EXPECT_TRUE(url.is_valid());
+    }
+  }
+  PrintRate("parse", base::TimeTicks::Now() - start);
+}
+
+TEST_F(GURLPerfTest, Parse16) {
+  std::vector<base::string16> corpus;
+  for (size_t i = 0; i < arraysize(kCorpus); ++i)
+    corpus.push_back(base::ASCIIToUTF16(kCorpus[i]));
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < corpus.size(); ++j) {
+      GURL url(corpus[j]);
+      EXPECT_TRUE(url.is_valid());
+    }
+  }
+  PrintRate("parse16", base::TimeTicks::Now() - start);
+}
+
+TEST_F(GURLPerfTest, Resolve) {
+  const GURL base_url(kCorpus[1]);
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < arraysize(kCorpus); ++j) {
+      GURL url = base_url.Resolve(kCorpus[j]);
+      EXPECT_TRUE(url.is_valid());
+    }
+  }
+  PrintRate("resolve", base::TimeTicks::Now() - start);
+}
+
+// Reports how much memory a large set of URLs takes, and how much a copy of
+// the set adds to it, the way maps keyed by URL copy the URLs they are given.
+TEST_F(GURLPerfTest, CopyURLSet) {
+  const std::vector<GURL> urls = MakeURLSet();
+  size_t spec_bytes = 0;
+  for (size_t i = 0; i < urls.size(); ++i)
+    spec_bytes += urls[i].possibly_invalid_spec().capacity();
+  perf_test::PrintResult("gurl", "", "url_set_spec_bytes", spec_bytes,
+                         "bytes", true);
+  perf_test::PrintResult("gurl", "", "url_set_copy_bytes",
+                         urls.size() * sizeof(GURL), "bytes", true);
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kURLSetIterations; ++i) {
+    std::vector<GURL> copy(urls);
+    EXPECT_EQ(urls.size(), copy.size());
+  }
+  perf_test::PrintResult(
+      "gurl", "", "copy",
+      kURLSetIterations * urls.size() /
+          (base::TimeTicks::Now() - start).InSecondsF(),
+      "urls/s", true);
+}
+
+TEST_F(GURLPerfTest, LookupURLSet) {
+  const std::vector<GURL> urls = MakeURLSet();
+  std::map<GURL, int> map;
+  base::hash_map<GURL, int> hash_map;
+  for (size_t i = 0; i < urls.size(); ++i) {
+    map[urls[i]] = i;
+    hash_map[urls[i]] = i;
+  }
+
+  // Look up URLs that were parsed separately, so no lookup is answered by
+  // comparing a URL with itself.
+  const std::vector<GURL> keys = MakeURLSet();
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kURLSetIterations; ++i) {
+    for (size_t j = 0; j < keys.size(); ++j)
+      EXPECT_TRUE(map.find(keys[j]) != map.end());
+  }
+  perf_test::PrintResult(
+      "gurl", "", "map_lookup",
+      kURLSetIterations * keys.size() /
+          (base::TimeTicks::Now() - start).InSecondsF(),
+      "lookups/s", true);
+
+  start = base::TimeTicks::Now();
+  for (int i = 0; i < kURLSetIterations; ++i) {
+    for (size_t j = 0; j < keys.size(); ++j)
+      EXPECT_TRUE(hash_map.find(keys[j]) != hash_map.end());
+  }
+  perf_test::PrintResult(
+      "gurl", "", "hash_map_lookup",
+      kURLSetIterations * keys.size() /
+          (base::TimeTicks::Now() - start).InSecondsF(),
+      "lookups/s", true);
+}
+
+}  // namespace
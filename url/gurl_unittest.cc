@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/containers/hash_tables.h"
 #include "base/macros.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "url/gurl.h"
@@ -105,6 +106,20 @@ TEST(GURLTest, Empty) {
   EXPECT_EQ("", url.path());
   EXPECT_EQ("", url.query());
   EXPECT_EQ("", url.ref());
+
+  // Default-constructed URLs behave like EmptyGURL() through copies, swaps
+  // and assignments.
+  EXPECT_EQ(GURL::EmptyGURL(), url);
+  EXPECT_EQ(GURL::EmptyGURL().hash(), url.hash());
+  GURL copy(url);
+  EXPECT_TRUE(copy.is_empty());
+  GURL other("http://www.google.com/");
+  other.Swap(&copy);
+  EXPECT_TRUE(other.is_empty());
+  EXPECT_EQ("http://www.google.com/", copy.spec());
+  copy = url;
+  EXPECT_EQ(url, copy);
+  EXPECT_EQ(PORT_UNSPECIFIED, copy.EffectiveIntPort());
 }
 
 TEST(GURLTest, Copy) {
@@ -635,4 +650,54 @@ TEST(GURLTest, SchemeIsBlob) {
   EXPECT_FALSE(GURL("http://bar/").SchemeIsBlob());
 }
 
+// Copies share the spec of the URL they were made from.
+TEST(GURLTest, CopiesShareSpec) {
+  GURL a("http://www.google.com/foo?bar#baz");
+  GURL b(a);
+  GURL c;
+  c = a;
+  EXPECT_EQ(a.possibly_invalid_spec().data(),
+            b.possibly_invalid_spec().data());
+  EXPECT_EQ(a.possibly_invalid_spec().data(),
+            c.possibly_invalid_spec().data());
+
+  // Copies of a filesystem: URL share its inner URL too.
+  GURL fs("filesystem:http://www.google.com/temporary/foo");
+  ASSERT_TRUE(fs.inner_url());
+  GURL fs_copy(fs);
+  EXPECT_EQ(fs.inner_url(), fs_copy.inner_url());
+
+  // Swapping exchanges the specs without copying them.
+  const char* a_data = a.possibly_invalid_spec().data();
+  GURL d("http://www.example.com/");
+  d.Swap(&a);
+  EXPECT_EQ(a_data, d.possibly_invalid_spec().data());
+  EXPECT_EQ("http://www.example.com/", a.spec());
+}
+
+TEST(GURLTest, Hash) {
+  GURL a("http://www.google.com/foo");
+  GURL b("HTTP://WWW.GOOGLE.COM/foo");
+  GURL c("http://www.google.com/bar");
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(a.hash(), b.hash());
+  EXPECT_NE(a, c);
+  EXPECT_EQ(GURL().hash(), GURL("").hash());
+  EXPECT_EQ(GURL(), GURL(""));
+
+  // URLs that were resolved or had components replaced hash like parsed ones.
+  EXPECT_EQ(c.hash(), a.Resolve("bar").hash());
+  GURL::Replacements replacements;
+  replacements.SetPathStr("/bar");
+  EXPECT_EQ(c.hash(), a.ReplaceComponents(replacements).hash());
+  EXPECT_EQ(GURL("http://www.google.com/").hash(),
+            c.GetWithEmptyPath().hash());
+
+  base::hash_map<GURL, int> map;
+  map[a] = 1;
+  map[c] = 2;
+  EXPECT_EQ(1, map[b]);
+  EXPECT_EQ(2U, map.size());
+}
+
 }  // namespace url
@@ -4,6 +4,7 @@
 
 // Canonicalizers for random bits that aren't big enough for their own files.
 
+#include <stdint.h>
 #include <string.h>
 
 #include "url/url_canon.h"
@@ -19,6 +20,43 @@ inline bool IsRemovableURLWhitespace(int ch) {
   return ch == '\r' || ch == '\n' || ch == '\t';
 }
 
+// Returns true if any of the |input_len| characters of |input| should be
+// removed from the middle of a URL.
+//
+// 8-bit input is scanned a machine word at a time. Only words containing a
+// byte below 0x0E, which is rare in URLs, are checked byte by byte.
+bool HasRemovableURLWhitespace(const char* input, int input_len) {
+  typedef uintptr_t MachineWord;
+  const MachineWord kOnes = static_cast<MachineWord>(-1) / 0xFF;
+  const MachineWord kHighBits = kOnes * 0x80;
+  const int kWordSize = static_cast<int>(sizeof(MachineWord));
+  int i = 0;
+  for (; i + kWordSize <= input_len; i += kWordSize) {
+    MachineWord word;
+    memcpy(&word, &input[i], sizeof(word));
+    // Sets the high bit of some byte if and only if any byte is below 0x0E.
+    if (!((word - kOnes * 0x0E) & ~word & kHighBits))
+      continue;
+    for (int j = i; j < i + kWordSize; j++) {
+      if (IsRemovableURLWhitespace(input[j]))
+        return true;
+    }
+  }
+  for (; i < input_len; i++) {
+    if (IsRemovableURLWhitespace(input[i]))
+      return true;
+  }
+  return false;
+}
+
+bool HasRemovableURLWhitespace(const base::char16* input, int input_len) {
+  for (int i = 0; i < input_len; i++) {
+    if (IsRemovableURLWhitespace(input[i]))
+      return true;
+  }
+  return false;
+}
+
 // Backend for RemoveURLWhitespace (see declaration in url_canon.h).
 // It sucks that we have to do this, since this takes about 13% of the total URL
 // canonicalization time.
@@ -29,15 +67,7 @@ const CHAR* DoRemoveURLWhitespace(const CHAR* input, int input_len,
   // Fast verification that there's nothing that needs removal. This is the 99%
   // case, so we want it to be fast and don't care about impacting the speed
   // when we do find whitespace.
-  int found_whitespace = false;
-  for (int i = 0; i < input_len; i++) {
-    if (!IsRemovableURLWhitespace(input[i]))
-      continue;
-    found_whitespace = true;
-    break;
-  }
-
-  if (!found_whitespace) {
+  if (!HasRemovableURLWhitespace(input, input_len)) {
     // Didn't find any whitespace, we don't need to do anything. We can just
     // return the input as the output.
     *output_len = input_len;
@@ -256,8 +286,14 @@ void DoCanonicalizeRef(const CHAR* spec,
       // shouldn't be using control characters in their anchor names.
       AppendEscapedChar(static_cast<unsigned char>(spec[i]), output);
     } else if (static_cast<UCHAR>(spec[i]) < 0x80) {
-      // Normal ASCII characters are just appended.
-      output->push_back(static_cast<char>(spec[i]));
+      // Normal ASCII characters are just appended, along with the run of them
+      // that follows.
+      int run_end = i + 1;
+      while (run_end < end && static_cast<UCHAR>(spec[run_end]) >= 0x20 &&
+             static_cast<UCHAR>(spec[run_end]) < 0x80)
+        run_end++;
+      AppendASCIIRun(&spec[i], run_end - i, output);
+      i = run_end - 1;
     } else {
       // Non-ASCII characters are appended unescaped, but only when they are
       // valid. Invalid Unicode characters are replaced with the "invalid
@@ -135,6 +135,19 @@ inline void AppendEscapedChar(UINCHAR ch,
   output->push_back(kHexCharLookup[ch & 0xf]);
 }
 
+// Appends |length| characters that need no canonicalization, which must all
+// be 7-bit, to the output unchanged. Canonicalizers use this to copy runs of
+// such characters in one go rather than one at a time.
+inline void AppendASCIIRun(const char* source, int length,
+                           CanonOutput* output) {
+  output->Append(source, length);
+}
+inline void AppendASCIIRun(const base::char16* source, int length,
+                           CanonOutput* output) {
+  for (int i = 0; i < length; i++)
+    output->push_back(static_cast<char>(source[i]));
+}
+
 // The character we'll substitute for undecodable or invalid characters.
 extern const base::char16 kUnicodeReplacementCharacter;
 
@@ -75,6 +75,12 @@ const unsigned char kPathCharLookup[0x100] = {
      ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,
      ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE,  ESCAPE};
 
+// Returns true if the character is copied to the canonical path unchanged.
+template<typename UCHAR>
+inline bool IsOrdinaryPathChar(UCHAR uch) {
+  return uch < 0x80 && !(kPathCharLookup[uch] & SPECIAL);
+}
+
 enum DotDisposition {
   // The given dot is just part of a filename and is not special.
   NOT_A_DIRECTORY,
@@ -285,8 +291,15 @@ bool DoPartialPath(const CHAR* spec,
           AppendEscapedChar(out_ch, output);
         }
       } else {
-        // Nothing special about this character, just append it.
-        output->push_back(out_ch);
+        // Nothing special about this character. Append it along with the run
+        // of ordinary characters that follows, which in an already canonical
+        // path is usually the rest of it up to the next dot.
+        int run_end = i + 1;
+        while (run_end < end &&
+               IsOrdinaryPathChar(static_cast<UCHAR>(spec[run_end])))
+          run_end++;
+        AppendASCIIRun(&spec[i], run_end - i, output);
+        i = run_end - 1;
       }
     }
   }